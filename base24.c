@@ -11,6 +11,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "nelsc_stats.h"
+
 /*
  * The maximum value of an *unsigned* base-24 pair.
  */
@@ -29,6 +31,7 @@ bool base24_pairToInt(const char *str, int32_t *pResult) {
 	int32_t digit_most = 0;
 	int32_t digit_least = 0;
 	int32_t val = 0;
+	NELSC_STATS_BEGIN(stats_start);
 	
 	/* Check parameters */
 	if ((str == NULL) || (pResult == NULL)) {
@@ -69,20 +72,23 @@ bool base24_pairToInt(const char *str, int32_t *pResult) {
 		*pResult = val;
 	}
 	
+	NELSC_STATS_END(NELSC_PROBE_BASE24_PAIRTOINT, stats_start, result);
+	
 	/* Return result */
 	return result;
 }
 
 /*
- * base24_printPair function.
+ * base24_writePair function.
  */
-void base24_printPair(FILE *pFile, int32_t v) {
+void base24_writePair(char *pBuf, int32_t v) {
 	
 	int32_t digit_most = 0;
 	int32_t digit_least = 0;
+	NELSC_STATS_BEGIN(stats_start);
 	
 	/* Check parameters */
-	if ((pFile == NULL) || (v < BASE24_PAIR_MIN) ||
+	if ((pBuf == NULL) || (v < BASE24_PAIR_MIN) ||
 			(v > BASE24_PAIR_MAX)) {
 		abort();
 	}
@@ -96,15 +102,34 @@ void base24_printPair(FILE *pFile, int32_t v) {
 	digit_least = v % 24;
 	digit_most = v / 24;
 	
+	/* Write the two base-24 characters */
+	pBuf[0] = base24_intToDigit(digit_most);
+	pBuf[1] = base24_intToDigit(digit_least);
+	
+	NELSC_STATS_END(NELSC_PROBE_BASE24_WRITEPAIR, stats_start, true);
+}
+
+/*
+ * base24_printPair function.
+ */
+void base24_printPair(FILE *pFile, int32_t v) {
+	
+	char buf[2];
+	
+	/* Check parameters */
+	if ((pFile == NULL) || (v < BASE24_PAIR_MIN) ||
+			(v > BASE24_PAIR_MAX)) {
+		abort();
+	}
+	
+	/* Convert the pair into the buffer */
+	base24_writePair(buf, v);
+	
 	/* Print the two base-24 characters, failing if not exactly two
 	 * characters were output */
-	if (fprintf(
-				pFile,
-				"%c%c",
-				base24_intToDigit(digit_most),
-				base24_intToDigit(digit_least)) != 2) {
+	if (fwrite(buf, 1, 2, pFile) != 2) {
 		abort();
-	}	
+	}
 }
 
 /*
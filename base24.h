@@ -73,6 +73,36 @@
  */
 bool base24_pairToInt(const char *str, int32_t *pResult);
 
+/*
+ * Write the given signed integer value as a base-24 pair in ASCII into
+ * the given character buffer.
+ * 
+ * Exactly two characters are written to pBuf.  No terminating null is
+ * written.
+ * 
+ * The integer value must be in range BASE24_PAIR_MIN to BASE24_PAIR_MAX
+ * (inclusive of boundaries) or a fault will occur.
+ * 
+ * Alphabetic base-24 characters are always written in uppercase.
+ * 
+ * Parameters:
+ * 
+ *   pBuf - the buffer to write the two characters into
+ * 
+ *   v - the signed value to write as a base-24 pair
+ * 
+ * Faults:
+ * 
+ *   - If pBuf is NULL
+ * 
+ *   - If v is out of range
+ * 
+ * Undefined behavior:
+ * 
+ *   - If pBuf has room for fewer than two characters
+ */
+void base24_writePair(char *pBuf, int32_t v);
+
 /*
  * Print the given signed integer value as a base-24 pair in ASCII,
  * writing the output to the given file.
@@ -0,0 +1,328 @@
+/*
+ * decimal.c
+ * 
+ * Implementation of decimal.h
+ * 
+ * See the header for further information.
+ */
+
+#include "decimal.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Use the eight-digit SWAR parser only where a 64-bit word loaded with
+ * memcpy has its first character in the least significant byte.
+ */
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__)
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define DECIMAL_SWAR
+#endif
+#endif
+
+/*
+ * The magnitude of the most negative signed 32-bit integer.
+ */
+#define NEG_LIMIT (UINT32_C(2147483648))
+
+/*
+ * The number of characters converted at once by the SWAR parser.
+ */
+#define SWAR_WIDTH 8
+
+/*
+ * Table of all two-digit decimal pairs "00" through "99".  Pair n is at
+ * offset n * 2.
+ */
+static const char m_pairs[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+/*
+ * Function prototypes
+ */
+static int32_t countDigits(uint32_t u);
+static bool parseDigits(const char *pStr, size_t len, uint64_t *pVal);
+
+/*
+ * Count the number of decimal digits needed to represent an unsigned
+ * value.
+ * 
+ * Parameters:
+ * 
+ *   u - the value
+ * 
+ * Return:
+ * 
+ *   the number of digits, from one to DECIMAL_INT_DIGITS
+ */
+static int32_t countDigits(uint32_t u) {
+	
+	int32_t count = 1;
+	
+	if (u >= UINT32_C(100000)) {
+		count += 5;
+		u /= UINT32_C(100000);
+	}
+	if (u >= UINT32_C(1000)) {
+		count += 3;
+		u /= UINT32_C(1000);
+	}
+	if (u >= UINT32_C(100)) {
+		count += 2;
+		u /= UINT32_C(100);
+	}
+	if (u >= UINT32_C(10)) {
+		count += 1;
+	}
+	
+	return count;
+}
+
+/*
+ * Convert a run of ASCII decimal digits into an unsigned value.
+ * 
+ * Fails if any character is not an ASCII decimal digit.  The caller
+ * must make sure that len is small enough that the value can't overflow
+ * 64 bits.
+ * 
+ * Parameters:
+ * 
+ *   pStr - pointer to the digits
+ * 
+ *   len - the number of digits
+ * 
+ *   pVal - pointer to the variable to receive the value
+ * 
+ * Return:
+ * 
+ *   true if successful, false if a non-digit was encountered
+ */
+static bool parseDigits(const char *pStr, size_t len, uint64_t *pVal) {
+	
+	bool result = true;
+	uint64_t val = 0;
+	uint32_t d = 0;
+#ifdef DECIMAL_SWAR
+	uint64_t w = 0;
+#endif
+
+#ifdef DECIMAL_SWAR
+	/* Convert eight digits at a time -- verify that every byte is in
+	 * range "0" to "9" by checking that the high nibble is 3 both
+	 * before and after adding 6, then fold the digits together
+	 * pairwise */
+	while (len >= SWAR_WIDTH) {
+		memcpy(&w, pStr, SWAR_WIDTH);
+		
+		if (((w & UINT64_C(0xF0F0F0F0F0F0F0F0)) |
+				(((w + UINT64_C(0x0606060606060606)) &
+					UINT64_C(0xF0F0F0F0F0F0F0F0)) >> 4)) !=
+				UINT64_C(0x3333333333333333)) {
+			result = false;
+			break;
+		}
+		
+		w -= UINT64_C(0x3030303030303030);
+		w = (w * 10) + (w >> 8);
+		w = (((w & UINT64_C(0x000000FF000000FF)) *
+					UINT64_C(0x000F424000000064)) +
+				(((w >> 16) & UINT64_C(0x000000FF000000FF)) *
+					UINT64_C(0x0000271000000001))) >> 32;
+		
+		val = (val * UINT64_C(100000000)) + w;
+		pStr += SWAR_WIDTH;
+		len -= SWAR_WIDTH;
+	}
+#endif
+	
+	/* Convert remaining digits one at a time */
+	if (result) {
+		while (len > 0) {
+			d = (uint32_t) ((unsigned char) *pStr) - (uint32_t) '0';
+			if (d > 9) {
+				result = false;
+				break;
+			}
+			val = (val * 10) + d;
+			pStr++;
+			len--;
+		}
+	}
+	
+	if (result) {
+		*pVal = val;
+	}
+	
+	return result;
+}
+
+/*
+ * decimal_writeInt function.
+ */
+size_t decimal_writeInt(char *pBuf, int32_t v, int32_t width) {
+	
+	uint32_t u = 0;
+	uint32_t r = 0;
+	int32_t digits = 0;
+	size_t len = 0;
+	char *pc = NULL;
+	
+	/* Check parameters */
+	if ((pBuf == NULL) || (width < 0) || (width > DECIMAL_INT_DIGITS)) {
+		abort();
+	}
+	
+	/* Write the sign and get the magnitude */
+	if (v < 0) {
+		pBuf[len++] = '-';
+		u = (uint32_t) 0 - (uint32_t) v;
+	} else {
+		u = (uint32_t) v;
+	}
+	
+	/* Determine the number of digits including padding */
+	digits = countDigits(u);
+	
+	while (digits < width) {
+		pBuf[len++] = '0';
+		width--;
+	}
+	
+	/* Write digits from the end two at a time */
+	len += (size_t) digits;
+	pc = pBuf + len;
+	
+	while (u >= 100) {
+		r = (u % 100) * 2;
+		u /= 100;
+		pc -= 2;
+		pc[0] = m_pairs[r];
+		pc[1] = m_pairs[r + 1];
+	}
+	
+	if (u >= 10) {
+		pc -= 2;
+		pc[0] = m_pairs[u * 2];
+		pc[1] = m_pairs[(u * 2) + 1];
+	} else {
+		pc--;
+		*pc = (char) ('0' + u);
+	}
+	
+	/* Return the number of characters written */
+	return len;
+}
+
+/*
+ * decimal_parseInt function.
+ */
+bool decimal_parseInt(const char *pStr, size_t len, int32_t *pResult) {
+	
+	bool result = true;
+	bool neg = false;
+	uint64_t val = 0;
+	
+	/* Check parameters */
+	if ((pStr == NULL) || (pResult == NULL)) {
+		abort();
+	}
+	
+	/* Read the optional sign */
+	if (len > 0) {
+		if (*pStr == '-') {
+			neg = true;
+			pStr++;
+			len--;
+		} else if (*pStr == '+') {
+			pStr++;
+			len--;
+		}
+	}
+	
+	/* Skip leading zeros so that the digit count limits the value, but
+	 * keep at least one digit */
+	while ((len > 1) && (*pStr == '0')) {
+		pStr++;
+		len--;
+	}
+	
+	/* Fail if there are no digits or too many digits */
+	if ((len < 1) || (len > DECIMAL_INT_DIGITS)) {
+		result = false;
+	}
+	
+	/* Convert the digits */
+	if (result) {
+		result = parseDigits(pStr, len, &val);
+	}
+	
+	/* Check the range */
+	if (result) {
+		if (neg) {
+			if (val > NEG_LIMIT) {
+				result = false;
+			}
+		} else {
+			if (val >= NEG_LIMIT) {
+				result = false;
+			}
+		}
+	}
+	
+	/* Write the result */
+	if (result) {
+		if (neg) {
+			*pResult = (val == NEG_LIMIT) ? INT32_MIN :
+							-((int32_t) val);
+		} else {
+			*pResult = (int32_t) val;
+		}
+	}
+	
+	return result;
+}
+
+/*
+ * decimal_scanInt function.
+ */
+bool decimal_scanInt(
+		const char *str,
+		int32_t *pResult,
+		const char **ppTrail) {
+	
+	bool result = true;
+	const char *pc = NULL;
+	
+	/* Check parameters */
+	if ((str == NULL) || (pResult == NULL)) {
+		abort();
+	}
+	
+	/* Find the end of the sign and digit run */
+	pc = str;
+	if ((*pc == '-') || (*pc == '+')) {
+		pc++;
+	}
+	while ((*pc >= '0') && (*pc <= '9')) {
+		pc++;
+	}
+	
+	/* Convert the run */
+	result = decimal_parseInt(str, (size_t) (pc - str), pResult);
+	
+	/* Write the trailing pointer if requested */
+	if (result && (ppTrail != NULL)) {
+		*ppTrail = pc;
+	}
+	
+	return result;
+}
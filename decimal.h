@@ -0,0 +1,138 @@
+#ifndef DECIMAL_H_INCLUDED
+#define DECIMAL_H_INCLUDED
+
+/*
+ * decimal.h
+ * 
+ * Provides fast conversions between signed 32-bit integers and ASCII
+ * decimal text, for use in the bulk paths of NELSC where integer text
+ * conversion would otherwise dominate.
+ * 
+ * Formatting uses a table of two-digit pairs, so that two digits are
+ * produced by each division.  Parsing converts eight digits at a time
+ * with SIMD-within-a-register arithmetic on a 64-bit word when the
+ * platform is little-endian, falling back to a digit-by-digit loop
+ * otherwise.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The maximum number of characters written by decimal_writeInt() when
+ * the requested width is no greater than DECIMAL_INT_DIGITS.  This
+ * includes the sign of the most negative value.
+ */
+#define DECIMAL_INT_MAXLEN 11
+
+/*
+ * The maximum number of decimal digits in a signed 32-bit integer.
+ */
+#define DECIMAL_INT_DIGITS 10
+
+/*
+ * Write a signed integer as ASCII decimal into a buffer.
+ * 
+ * A minus sign is written first if the value is negative.  The digits
+ * are zero-padded on the left so that at least width digits are
+ * written.  A width of zero or one writes no padding.  No terminating
+ * null is written.
+ * 
+ * Parameters:
+ * 
+ *   pBuf - the buffer to write into
+ * 
+ *   v - the value to write
+ * 
+ *   width - the minimum number of digits, in range zero to
+ *   DECIMAL_INT_DIGITS
+ * 
+ * Return:
+ * 
+ *   the number of characters written
+ * 
+ * Faults:
+ * 
+ *   - If pBuf is NULL
+ * 
+ *   - If width is out of range
+ * 
+ * Undefined behavior:
+ * 
+ *   - If pBuf has room for fewer than DECIMAL_INT_MAXLEN characters
+ */
+size_t decimal_writeInt(char *pBuf, int32_t v, int32_t width);
+
+/*
+ * Parse exactly len characters as a signed ASCII decimal integer.
+ * 
+ * The characters must consist of an optional "+" or "-" sign followed
+ * by one or more ASCII decimal digits, with nothing else.  Leading
+ * zeros are allowed.  The function fails if any other character is
+ * present, if there are no digits, or if the value does not fit in a
+ * signed 32-bit integer.
+ * 
+ * This function reads exactly len characters and does not require
+ * null termination.
+ * 
+ * Parameters:
+ * 
+ *   pStr - pointer to the characters to parse
+ * 
+ *   len - the number of characters to parse
+ * 
+ *   pResult - pointer to the variable to receive the parsed value if
+ *   successful
+ * 
+ * Return:
+ * 
+ *   true if successful, false if the characters are not a valid signed
+ *   32-bit decimal integer
+ * 
+ * Faults:
+ * 
+ *   - If pStr or pResult is NULL
+ */
+bool decimal_parseInt(const char *pStr, size_t len, int32_t *pResult);
+
+/*
+ * Scan a signed ASCII decimal integer at the start of a null-terminated
+ * string.
+ * 
+ * An optional "+" or "-" sign is read, followed by all the ASCII
+ * decimal digits that immediately follow.  Leading whitespace is not
+ * skipped.  The run is then converted with decimal_parseInt().
+ * 
+ * If successful and ppTrail is not NULL, *ppTrail is set to point to
+ * the first character following the digits.
+ * 
+ * Parameters:
+ * 
+ *   str - the null-terminated string to scan
+ * 
+ *   pResult - pointer to the variable to receive the scanned value if
+ *   successful
+ * 
+ *   ppTrail - pointer to the pointer to set to the character after the
+ *   integer on success, or NULL
+ * 
+ * Return:
+ * 
+ *   true if successful, false if there is no valid signed 32-bit
+ *   decimal integer at the start of the string
+ * 
+ * Faults:
+ * 
+ *   - If str or pResult is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If str is not null-terminated
+ */
+bool decimal_scanInt(
+		const char *str,
+		int32_t *pResult,
+		const char **ppTrail);
+
+#endif
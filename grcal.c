@@ -8,6 +8,10 @@
 
 #include "grcal.h"
 #include <stdlib.h>
+#include <string.h>
+
+#include "decimal.h"
+#include "nelsc_stats.h"
 
 /*
  * The number of months in a year.
@@ -106,12 +110,6 @@
  */
 #define MAX_YEAR 9999
 
-/*
- * The number of characters in a standard-format YYYY-MM-DD string,
- * assuming that the MM and DD field are zero-padded to two characters.
- */
-#define STANDARD_DATE_LENGTH 10
-
 /*
  * The number of digits in a Gregorian formatted year field.
  */
@@ -128,6 +126,63 @@
  */
 #define DATE_SEPARATOR '-'
 
+/*
+ * The character that introduces the week field of an ISO 8601 week
+ * date.
+ */
+#define WEEK_DESIGNATOR 'W'
+
+/*
+ * The number of digits in the week field of an ISO 8601 week date and
+ * in the day field of an ISO 8601 ordinal date.
+ */
+#define WEEK_FIELD_LENGTH 2
+#define ORDINAL_FIELD_LENGTH 3
+
+/*
+ * The number of days in a week.
+ */
+#define DAYS_PER_WEEK 7
+
+/*
+ * The amount to add to a day offset so that its remainder modulo
+ * DAYS_PER_WEEK counts days from Monday.  Day offset zero, 1200-03-01,
+ * was a Wednesday.
+ */
+#define WEEKDAY_SHIFT 2
+
+/*
+ * The number of digits in a date packed as YYYYMMDD, which is the
+ * number of digits in each of the fixed-width formats.
+ */
+#define PACKED_DIGITS 8
+
+/*
+ * The number of separators in a fixed-width format that has them.
+ */
+#define FORMAT_SEPARATORS 2
+
+/*
+ * Constants for checking and combining eight ASCII decimal digits held
+ * in the bytes of a 64-bit word, with the first digit in the lowest
+ * byte.
+ * 
+ * SWAR_HIGH selects the high nibble of each byte, SWAR_SIX is added to
+ * each byte, and SWAR_DIGITS is the result of the check when every byte
+ * is a digit.  SWAR_LOW selects the value of each digit, and the three
+ * multipliers then combine digits into pairs, pairs into fours, and
+ * fours into the whole value.
+ */
+#define SWAR_HIGH   UINT64_C(0xF0F0F0F0F0F0F0F0)
+#define SWAR_SIX    UINT64_C(0x0606060606060606)
+#define SWAR_DIGITS UINT64_C(0x3333333333333333)
+#define SWAR_LOW    UINT64_C(0x0F0F0F0F0F0F0F0F)
+#define SWAR_BYTES  UINT64_C(0x00FF00FF00FF00FF)
+#define SWAR_WORDS  UINT64_C(0x0000FFFF0000FFFF)
+#define SWAR_MUL_2  UINT64_C(2561)
+#define SWAR_MUL_4  UINT64_C(6553601)
+#define SWAR_MUL_8  UINT64_C(42949672960001)
+
 /*
  * The pattern of March-based month lengths, expressed as a string.
  * 
@@ -142,14 +197,202 @@
  */
 static const char *m_pattern = "+-+-++-+-++*";
 
+/*
+ * The number of 32-bit words in m_leap.
+ */
+#define LEAP_WORDS 275
+
+/*
+ * The leap years from BASE_YEAR up to MAX_YEAR, as a bitset.
+ * 
+ * Bit ((y - BASE_YEAR) % 32) of word ((y - BASE_YEAR) / 32) is set if
+ * the January-based year y is a leap year.  The table was generated
+ * from isLeapYear(), and the engines subprogram of the main program
+ * checks it through grcal_dateToOffsetCascade().
+ */
+static const uint32_t m_leap[LEAP_WORDS] = {
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11111101U,
+	0x11111111U, 0x11111111U, 0x11111011U, 0x11111111U,
+	0x11111111U, 0x11110111U, 0x11111111U, 0x11111111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11011111U,
+	0x11111111U, 0x11111111U, 0x10111111U, 0x11111111U,
+	0x11111111U, 0x01111111U, 0x11111111U, 0x11111111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11111111U,
+	0x11111101U, 0x11111111U, 0x11111111U, 0x11111011U,
+	0x11111111U, 0x11111111U, 0x11110111U, 0x11111111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11111111U,
+	0x11011111U, 0x11111111U, 0x11111111U, 0x10111111U,
+	0x11111111U, 0x11111111U, 0x01111111U, 0x11111111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11111111U,
+	0x11111111U, 0x11111101U, 0x11111111U, 0x11111111U,
+	0x11111011U, 0x11111111U, 0x11111111U, 0x11110111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11111111U,
+	0x11111111U, 0x11011111U, 0x11111111U, 0x11111111U,
+	0x10111111U, 0x11111111U, 0x11111111U, 0x01111111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11111111U,
+	0x11111111U, 0x11111111U, 0x11111101U, 0x11111111U,
+	0x11111111U, 0x11111011U, 0x11111111U, 0x11111111U,
+	0x11110111U, 0x11111111U, 0x11111111U, 0x11111111U,
+	0x11111111U, 0x11111111U, 0x11011111U, 0x11111111U,
+	0x11111111U, 0x10111111U, 0x11111111U, 0x11111111U,
+	0x01111111U, 0x11111111U, 0x11111111U, 0x11111111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11111101U,
+	0x11111111U, 0x11111111U, 0x11111011U, 0x11111111U,
+	0x11111111U, 0x11110111U, 0x11111111U, 0x11111111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11011111U,
+	0x11111111U, 0x11111111U, 0x10111111U, 0x11111111U,
+	0x11111111U, 0x01111111U, 0x11111111U, 0x11111111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11111111U,
+	0x11111101U, 0x11111111U, 0x11111111U, 0x11111011U,
+	0x11111111U, 0x11111111U, 0x11110111U, 0x11111111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11111111U,
+	0x11011111U, 0x11111111U, 0x11111111U, 0x10111111U,
+	0x11111111U, 0x11111111U, 0x01111111U, 0x11111111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11111111U,
+	0x11111111U, 0x11111101U, 0x11111111U, 0x11111111U,
+	0x11111011U, 0x11111111U, 0x11111111U, 0x11110111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11111111U,
+	0x11111111U, 0x11011111U, 0x11111111U, 0x11111111U,
+	0x10111111U, 0x11111111U, 0x11111111U, 0x01111111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11111111U,
+	0x11111111U, 0x11111111U, 0x11111101U, 0x11111111U,
+	0x11111111U, 0x11111011U, 0x11111111U, 0x11111111U,
+	0x11110111U, 0x11111111U, 0x11111111U, 0x11111111U,
+	0x11111111U, 0x11111111U, 0x11011111U, 0x11111111U,
+	0x11111111U, 0x10111111U, 0x11111111U, 0x11111111U,
+	0x01111111U, 0x11111111U, 0x11111111U, 0x11111111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11111101U,
+	0x11111111U, 0x11111111U, 0x11111011U, 0x11111111U,
+	0x11111111U, 0x11110111U, 0x11111111U, 0x11111111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11011111U,
+	0x11111111U, 0x11111111U, 0x10111111U, 0x11111111U,
+	0x11111111U, 0x01111111U, 0x11111111U, 0x11111111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11111111U,
+	0x11111101U, 0x11111111U, 0x11111111U, 0x11111011U,
+	0x11111111U, 0x11111111U, 0x11110111U, 0x11111111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11111111U,
+	0x11011111U, 0x11111111U, 0x11111111U, 0x10111111U,
+	0x11111111U, 0x11111111U, 0x01111111U, 0x11111111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11111111U,
+	0x11111111U, 0x11111101U, 0x11111111U, 0x11111111U,
+	0x11111011U, 0x11111111U, 0x11111111U, 0x11110111U,
+	0x11111111U, 0x11111111U, 0x11111111U, 0x11111111U,
+	0x11111111U, 0x11011111U, 0x11111111U, 0x11111111U,
+	0x10111111U, 0x11111111U, 0x11111111U, 0x01111111U,
+	0x11111111U, 0x11111111U, 0x11111111U
+};
+
+/*
+ * The number of days from the start of the March-based year to the
+ * start of each month, indexed by the standard, one-based month.
+ * 
+ * Element zero is not a month.  It is there so that batch conversions
+ * can send invalid months to it without a branch.
+ */
+static const int32_t m_month_start[MONTH_COUNT + 1] = {
+	0, 306, 337, 0, 31, 61, 92, 122, 153, 184, 214, 245, 275
+};
+
+/*
+ * The number of days in each month of a non-leap year, indexed by the
+ * standard, one-based month.
+ * 
+ * Element zero is not a month and has no days, so that any day in it
+ * is invalid.
+ */
+static const int32_t m_month_days[MONTH_COUNT + 1] = {
+	0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+};
+
+/*
+ * The number of days from the first of January to the Monday that
+ * starts ISO 8601 week one, indexed by the ISO weekday of the first of
+ * January from 1 for Monday up to 7 for Sunday.
+ * 
+ * Week one is the week containing January 4, so it starts up to three
+ * days before the first of January if that falls on Tuesday up to
+ * Thursday, and after it if that falls on Friday up to Sunday.
+ * Element zero is not a weekday.
+ */
+static const int32_t m_week_one[DAYS_PER_WEEK + 1] = {
+	0, 0, -1, -2, -3, 3, 2, 1
+};
+
+/*
+ * The layout of a fixed-width date format.
+ */
+typedef struct {
+	
+	/*
+	 * The number of characters in the format.
+	 */
+	int32_t len;
+	
+	/*
+	 * The position of each digit of the date, in YYYYMMDD order.
+	 */
+	int32_t digit[PACKED_DIGITS];
+	
+	/*
+	 * The position of each separator, or -1 if there are none, and the
+	 * separator character.
+	 */
+	int32_t sep[FORMAT_SEPARATORS];
+	char sep_char;
+
+} FORMAT_LAYOUT;
+
+/*
+ * The layout of each fixed-width format, indexed by GRCAL_FORMAT
+ * constant.
+ */
+static const FORMAT_LAYOUT m_layouts[GRCAL_FORMAT_COUNT] = {
+	{10, {0, 1, 2, 3, 5, 6, 8, 9}, { 4,  7}, '-'},
+	{ 8, {0, 1, 2, 3, 4, 5, 6, 7}, {-1, -1},  0 },
+	{10, {0, 1, 2, 3, 5, 6, 8, 9}, { 4,  7}, '/'},
+	{10, {6, 7, 8, 9, 3, 4, 0, 1}, { 2,  5}, '.'}
+};
+
+/*
+ * The name of each fixed-width format, indexed by GRCAL_FORMAT
+ * constant.
+ */
+static const char *m_format_names[GRCAL_FORMAT_COUNT] = {
+	"iso", "compact", "slash", "dotted"
+};
+
 /*
  * Function prototypes
  */
 static bool isLeapYear(int32_t y);
 static int32_t monthLength(int32_t i);
+static int32_t leapBit(int32_t y);
+static int32_t yearStart(int32_t y);
+static int32_t parseDigits(const char *str, int32_t count);
+static int32_t isoWeekday(int32_t offs);
+static int32_t janFirst(int32_t y);
+static int32_t weekOne(int32_t y);
+static bool swarDigits(uint64_t x, int32_t *pVal);
 static int32_t parseDecimal(char c);
 static int32_t parseYear(const char *str);
 static int32_t parseDayMonth(const char *str, const char **ppTrail);
+static void digitError(
+		SCANERR *pErr,
+		const char *str,
+		int32_t pos,
+		int32_t count,
+		int field);
+static bool checkSeparator(
+		SCANERR *pErr,
+		const char *str,
+		int32_t pos,
+		char c);
+static void dateError(
+		SCANERR *pErr,
+		int32_t y,
+		int32_t m,
+		int32_t d,
+		const int32_t *pPos);
 
 /*
  * Determine whether the given (January-based) year is a leap year
@@ -250,6 +493,50 @@ static int32_t monthLength(int32_t i) {
 	return result;
 }
 
+/*
+ * Look up whether the given (January-based) year is a leap year in the
+ * m_leap bitset.
+ * 
+ * Parameters:
+ * 
+ *   y - the year to check, in range BASE_YEAR up to MAX_YEAR
+ * 
+ * Return:
+ * 
+ *   one if leap year, zero if not
+ * 
+ * Undefined behavior:
+ * 
+ *   - If y is out of range
+ */
+static int32_t leapBit(int32_t y) {
+	y -= BASE_YEAR;
+	return (int32_t) ((m_leap[y >> 5] >> (y & 31)) & 1);
+}
+
+/*
+ * Find the number of days from the start of March-based year zero to
+ * the start of a given March-based year.
+ * 
+ * Years are counted from BASE_YEAR, which begins a quad century, so
+ * the leap days up to the start of the year are simply the years
+ * divisible by four, less those divisible by one hundred, plus those
+ * divisible by four hundred.  The divisions are by constants, which
+ * compilers turn into multiplications.
+ * 
+ * Parameters:
+ * 
+ *   y - the March-based year minus BASE_YEAR, zero or greater
+ * 
+ * Return:
+ * 
+ *   the day offset of the start of the year
+ */
+static int32_t yearStart(int32_t y) {
+	return (y * Y_DAYS) +
+			(y / Q_YEARS) - (y / C_YEARS) + (y / QC_YEARS);
+}
+
 /*
  * Parse the given ASCII character as an ASCII decimal character.
  * 
@@ -462,239 +749,1237 @@ static int32_t parseDayMonth(const char *str, const char **ppTrail) {
 }
 
 /*
- * grcal_offsetToDate function.
+ * Record the error for a field that should be a run of decimal digits
+ * but failed to parse.
+ * 
+ * The error is placed at the first character of the field that is not
+ * a digit, or at the start of the field if they are all digits, which
+ * happens when a field of variable length has too many.
+ * 
+ * Parameters:
+ * 
+ *   pErr - the error to fill in, or NULL
+ * 
+ *   str - the string being parsed
+ * 
+ *   pos - the position of the field in the string
+ * 
+ *   count - the maximum number of digits in the field
+ * 
+ *   field - the SCANERR_FIELD constant of the field
+ * 
+ * Undefined behavior:
+ * 
+ *   - If str is not null-terminated
  */
-void grcal_offsetToDate(
-		int32_t offs,
-		int32_t *pYear,
-		int32_t *pMonth,
-		int32_t *pDayOfMonth) {
-	
-	int32_t qc = 0;
-	int32_t c = 0;
-	int32_t q = 0;
-	int32_t y = 0;
-	int32_t d = 0;
-	
-	int32_t year = 0;
-	int32_t month = 0;
-	int32_t day = 0;
-	
-	int32_t ml = 0;
+static void digitError(
+		SCANERR *pErr,
+		const char *str,
+		int32_t pos,
+		int32_t count,
+		int field) {
+	
+	int reason = SCANERR_DIGIT;
+	int32_t x = 0;
 	
-	/* Check parameter */
-	if ((offs < GRCAL_DAY_MIN) || (offs > GRCAL_DAY_MAX)) {
-		abort();
+	for(x = pos; x < pos + count; x++) {
+		if (str[x] == 0) {
+			reason = SCANERR_END;
+			break;
+		}
+		if (parseDecimal(str[x]) == -1) {
+			break;
+		}
+	}
+	if (x >= pos + count) {
+		x = pos;
 	}
 	
-	/* Compute number of quad centuries, centuries, quad years, and
-	 * years, and adjust offs for remainder of days */
-	qc   = offs / QC_DAYS;
-	offs = offs % QC_DAYS;
-	
-	c    = offs / C_DAYS;
-	offs = offs % C_DAYS;
-	
-	q    = offs / Q_DAYS;
-	offs = offs % Q_DAYS;
+	scanerr_set(pErr, reason, field, x, 0);
+}
+
+/*
+ * Check for a separator character, recording the error if it is not
+ * there.
+ * 
+ * Parameters:
+ * 
+ *   pErr - the error to fill in, or NULL
+ * 
+ *   str - the string being parsed
+ * 
+ *   pos - the position of the separator in the string
+ * 
+ *   c - the separator character
+ * 
+ * Return:
+ * 
+ *   true if the separator is there, false if not
+ * 
+ * Undefined behavior:
+ * 
+ *   - If str has fewer than pos characters before its terminating null
+ */
+static bool checkSeparator(
+		SCANERR *pErr,
+		const char *str,
+		int32_t pos,
+		char c) {
 	
-	y    = offs / Y_DAYS;
-	offs = offs % Y_DAYS;
+	bool result = true;
 	
-	d    = offs;
+	if (str[pos] == 0) {
+		scanerr_set(pErr, SCANERR_END, SCANERR_FIELD_NONE, pos, 0);
+		result = false;
 	
-	/* Special case:  c might be four, but only if the day offset refers
-	 * to the leap day that is added at the end of each quad century; in
-	 * this special case, adjust c, q, y, and d so that they refer to
-	 * the leap day at the end of the quad century */
-	if (c == QC_C_COUNT) {
-		c = QC_C_COUNT - 1;
-		q = C_Q_COUNT - 1;
-		y = Q_Y_COUNT - 1;
-		d = Y_LEAP_DAYS - 1;
+	} else if (str[pos] != c) {
+		scanerr_set(pErr, SCANERR_SEPARATOR, SCANERR_FIELD_NONE,
+			pos, 0);
+		result = false;
 	}
 	
-	/* Special case:  y might be four, but only if the day offset refers
-	 * to the leap day that is added at the end of a quad year; in this
-	 * special case, adjust y and d so that they refer to the leap day
-	 * at the end of a quad year */
-	if (y == Q_Y_COUNT) {
-		y = Q_Y_COUNT - 1;
-		d = Y_LEAP_DAYS - 1;
-	}
+	return result;
+}
+
+/*
+ * Record the error for a year, month, and day that grcal_dateToOffset()
+ * rejected.
+ * 
+ * Parameters:
+ * 
+ *   pErr - the error to fill in, or NULL
+ * 
+ *   y - the year
+ * 
+ *   m - the month
+ * 
+ *   d - the day of the month
+ * 
+ *   pPos - the positions of the year, month, and day fields in the
+ *   string being parsed, in that order
+ */
+static void dateError(
+		SCANERR *pErr,
+		int32_t y,
+		int32_t m,
+		int32_t d,
+		const int32_t *pPos) {
 	
-	/* Compute the (March-based) year */
-	year = 	(qc * QC_YEARS) + (c * C_YEARS) +
-			(q  * Q_YEARS)  +  y            + BASE_YEAR;
+	int32_t len = 0;
 	
-	/* Compute the (March-based) month offset */
-	month = 0;
-	while (d > 0) {
-		/* Get the length in days of the current month offset */
-		ml = monthLength(month);
-		
-		/* If this is a variable-length month or this month contains the
-		 * remaining day offset, break */
-		if ((ml == 0) || (d < ml)) {
-			break;
-		}
-		
-		/* Otherwise, increase the month count and decrease the
-		 * remaining days */
-		month++;
-		d -= ml;
-	}
+	if ((m < 1) || (m > MONTH_COUNT)) {
+		scanerr_set(pErr, SCANERR_RANGE, SCANERR_FIELD_MONTH,
+			pPos[1], m);
 	
-	/* Compute the (final, one-based) day of the month */
-	day = d + 1;
+	} else if ((d < 1) || (d > LONG_MONTH_LENGTH)) {
+		scanerr_set(pErr, SCANERR_RANGE, SCANERR_FIELD_DAY, pPos[2], d);
 	
-	/* Apply the month offset to the month to get the (zero-based, mod
-	 * 12) standard month offset */
-	month += MONTH_OFFSET;
+	} else if ((y <= BASE_YEAR) || (y > MAX_YEAR)) {
+		scanerr_set(pErr, SCANERR_LIMIT, SCANERR_FIELD_YEAR,
+			pPos[0], y);
 	
-	/* If adjusted month went past the end of the year, subtract twelve
-	 * from the month and add one to the year to get the (zero-based)
-	 * standard month offset */
-	if (month >= MONTH_COUNT) {
-		month -= MONTH_COUNT;
-		year++;
+	} else {
+		len = m_month_days[m];
+		if (m == 2) {
+			len += leapBit(y);
+		}
+		if (d > len) {
+			scanerr_set(pErr, SCANERR_MONTH_END, SCANERR_FIELD_DAY,
+				pPos[2], d);
+		} else {
+			scanerr_set(pErr, SCANERR_LIMIT, SCANERR_FIELD_NONE,
+				pPos[0], 0);
+		}
 	}
+}
+
+/*
+ * Parse exactly the given number of ASCII decimal digits.
+ * 
+ * This function stops at the first character that is not a decimal
+ * digit, so it will not read past a terminating null.
+ * 
+ * Parameters:
+ * 
+ *   str - pointer to the ASCII characters to parse
+ * 
+ *   count - the number of digits, in range one up to four
+ * 
+ * Return:
+ * 
+ *   the parsed value, or -1 if any of the characters is not a decimal
+ *   digit
+ */
+static int32_t parseDigits(const char *str, int32_t count) {
 	
-	/* Add one to the month offset to get the standard, one-based month
-	 * number */
-	month++;
-	
-	/* Return any computed results that were requested */
-	if (pYear != NULL) {
-		*pYear = year;
-	}
+	int32_t x = 0;
+	int32_t d = 0;
+	int32_t val = 0;
 	
-	if (pMonth != NULL) {
-		*pMonth = month;
+	for(x = 0; x < count; x++) {
+		d = parseDecimal(str[x]);
+		if (d == -1) {
+			val = -1;
+			break;
+		}
+		val = (val * 10) + d;
 	}
 	
-	if (pDayOfMonth != NULL) {
-		*pDayOfMonth = day;
-	}
+	return val;
 }
 
 /*
- * grcal_dateToOffset function.
+ * Find the ISO 8601 weekday of a Gregorian day offset.
+ * 
+ * Parameters:
+ * 
+ *   offs - the Gregorian day offset, zero or greater
+ * 
+ * Return:
+ * 
+ *   the weekday, from 1 for Monday up to 7 for Sunday
+ */
+static int32_t isoWeekday(int32_t offs) {
+	return ((offs + WEEKDAY_SHIFT) % DAYS_PER_WEEK) + 1;
+}
+
+/*
+ * Find the Gregorian day offset of the first of January of a given
+ * year.
+ * 
+ * Parameters:
+ * 
+ *   y - the (January-based) year, greater than BASE_YEAR
+ * 
+ * Return:
+ * 
+ *   the day offset of the first of January
+ */
+static int32_t janFirst(int32_t y) {
+	return yearStart(y - 1 - BASE_YEAR) + m_month_start[1];
+}
+
+/*
+ * Find the Gregorian day offset of the Monday that starts week one of
+ * an ISO 8601 week-numbering year.
+ * 
+ * Parameters:
+ * 
+ *   y - the week-numbering year, greater than BASE_YEAR
+ * 
+ * Return:
+ * 
+ *   the day offset of the start of week one
+ */
+static int32_t weekOne(int32_t y) {
+	
+	int32_t jan = 0;
+	
+	jan = janFirst(y);
+	return jan + m_week_one[isoWeekday(jan)];
+}
+
+/*
+ * Check that all eight bytes of a word are ASCII decimal digits, and
+ * find the value of the digits as a decimal number.
+ * 
+ * The first digit is in the lowest byte, so it is the most significant
+ * digit of the value.  The check and the conversion are done on the
+ * whole word at once, with no loop over the digits.
+ * 
+ * Parameters:
+ * 
+ *   x - the eight characters
+ * 
+ *   pVal - pointer to the variable to receive the value
+ * 
+ * Return:
+ * 
+ *   true if successful, false if any of the bytes is not a digit
+ */
+static bool swarDigits(uint64_t x, int32_t *pVal) {
+	
+	bool result = true;
+	
+	/* A byte is a digit only if its high nibble is three both before
+	 * and after adding six; a carry out of a byte only happens if that
+	 * byte fails, so it can't hide a failure elsewhere */
+	if (((x & SWAR_HIGH) | (((x + SWAR_SIX) & SWAR_HIGH) >> 4)) !=
+			SWAR_DIGITS) {
+		result = false;
+	}
+	
+	/* Combine the digits into pairs, fours, and then the whole value */
+	if (result) {
+		x = ((x & SWAR_LOW) * SWAR_MUL_2) >> 8;
+		x = ((x & SWAR_BYTES) * SWAR_MUL_4) >> 16;
+		x = ((x & SWAR_WORDS) * SWAR_MUL_8) >> 32;
+		*pVal = (int32_t) x;
+	}
+	
+	return result;
+}
+
+/*
+ * grcal_offsetToDate function.
+ */
+void grcal_offsetToDate(
+		int32_t offs,
+		int32_t *pYear,
+		int32_t *pMonth,
+		int32_t *pDayOfMonth) {
+	
+	uint32_t n = 0;
+	uint32_t century = 0;
+	uint32_t day_of_century = 0;
+	uint64_t p = 0;
+	uint32_t year_of_century = 0;
+	uint32_t day_of_year = 0;
+	uint32_t n_month = 0;
+	uint32_t jan_feb = 0;
+	
+	int32_t year = 0;
+	int32_t month = 0;
+	int32_t day = 0;
+	NELSC_STATS_BEGIN(stats_start);
+	
+	/* Check parameter */
+	if ((offs < GRCAL_DAY_MIN) || (offs > GRCAL_DAY_MAX)) {
+		abort();
+	}
+	
+	/* Find the century and the day within the century; scaling by four
+	 * spreads the leap day at the end of each quad century evenly over
+	 * its four centuries, so one division does the job of the quad
+	 * century and century steps of the cascade */
+	n = (4 * (uint32_t) offs) + 3;
+	century = n / QC_DAYS;
+	day_of_century = (n % QC_DAYS) / 4;
+	
+	/* Find the year within the century and the day within the year with
+	 * a single multiplication -- 2939745 / 2^32 approximates 4 / 1461
+	 * closely enough that the high word of the product is the year and
+	 * the low word, scaled back down, is the day of the year over the
+	 * whole range of day_of_century */
+	p = ((uint64_t) 2939745) * ((4 * (uint64_t) day_of_century) + 3);
+	year_of_century = (uint32_t) (p >> 32);
+	day_of_year = ((uint32_t) p) / 2939745 / 4;
+	
+	/* Find the March-based month (3 up to 14) and the day of the month;
+	 * the month lengths of m_pattern follow the line 2141 / 65536 days
+	 * per month, offset so that each month starts on a whole day */
+	n_month = (2141 * day_of_year) + 197913;
+	month = (int32_t) (n_month >> 16);
+	day = (int32_t) ((n_month & 0xffff) / 2141) + 1;
+	
+	/* Move January and February into the next year without a branch;
+	 * they are the last 59 days of the March-based year */
+	jan_feb = (uint32_t) (day_of_year >= 306);
+	year = (int32_t) ((100 * century) + year_of_century + jan_feb) +
+			BASE_YEAR;
+	month -= (int32_t) (MONTH_COUNT * jan_feb);
+	
+	/* Return any computed results that were requested */
+	if (pYear != NULL) {
+		*pYear = year;
+	}
+	
+	if (pMonth != NULL) {
+		*pMonth = month;
+	}
+	
+	if (pDayOfMonth != NULL) {
+		*pDayOfMonth = day;
+	}
+	
+	NELSC_STATS_END(NELSC_PROBE_GRCAL_OFFSETTODATE, stats_start, true);
+}
+
+/*
+ * grcal_offsetToDateCascade function.
+ */
+void grcal_offsetToDateCascade(
+		int32_t offs,
+		int32_t *pYear,
+		int32_t *pMonth,
+		int32_t *pDayOfMonth) {
+	
+	int32_t qc = 0;
+	int32_t c = 0;
+	int32_t q = 0;
+	int32_t y = 0;
+	int32_t d = 0;
+	
+	int32_t year = 0;
+	int32_t month = 0;
+	int32_t day = 0;
+	
+	int32_t ml = 0;
+	
+	/* Check parameter */
+	if ((offs < GRCAL_DAY_MIN) || (offs > GRCAL_DAY_MAX)) {
+		abort();
+	}
+	
+	/* Compute number of quad centuries, centuries, quad years, and
+	 * years, and adjust offs for remainder of days */
+	qc   = offs / QC_DAYS;
+	offs = offs % QC_DAYS;
+	
+	c    = offs / C_DAYS;
+	offs = offs % C_DAYS;
+	
+	q    = offs / Q_DAYS;
+	offs = offs % Q_DAYS;
+	
+	y    = offs / Y_DAYS;
+	offs = offs % Y_DAYS;
+	
+	d    = offs;
+	
+	/* Special case:  c might be four, but only if the day offset refers
+	 * to the leap day that is added at the end of each quad century; in
+	 * this special case, adjust c, q, y, and d so that they refer to
+	 * the leap day at the end of the quad century */
+	if (c == QC_C_COUNT) {
+		c = QC_C_COUNT - 1;
+		q = C_Q_COUNT - 1;
+		y = Q_Y_COUNT - 1;
+		d = Y_LEAP_DAYS - 1;
+	}
+	
+	/* Special case:  y might be four, but only if the day offset refers
+	 * to the leap day that is added at the end of a quad year; in this
+	 * special case, adjust y and d so that they refer to the leap day
+	 * at the end of a quad year */
+	if (y == Q_Y_COUNT) {
+		y = Q_Y_COUNT - 1;
+		d = Y_LEAP_DAYS - 1;
+	}
+	
+	/* Compute the (March-based) year */
+	year = 	(qc * QC_YEARS) + (c * C_YEARS) +
+			(q  * Q_YEARS)  +  y            + BASE_YEAR;
+	
+	/* Compute the (March-based) month offset */
+	month = 0;
+	while (d > 0) {
+		/* Get the length in days of the current month offset */
+		ml = monthLength(month);
+		
+		/* If this is a variable-length month or this month contains the
+		 * remaining day offset, break */
+		if ((ml == 0) || (d < ml)) {
+			break;
+		}
+		
+		/* Otherwise, increase the month count and decrease the
+		 * remaining days */
+		month++;
+		d -= ml;
+	}
+	
+	/* Compute the (final, one-based) day of the month */
+	day = d + 1;
+	
+	/* Apply the month offset to the month to get the (zero-based, mod
+	 * 12) standard month offset */
+	month += MONTH_OFFSET;
+	
+	/* If adjusted month went past the end of the year, subtract twelve
+	 * from the month and add one to the year to get the (zero-based)
+	 * standard month offset */
+	if (month >= MONTH_COUNT) {
+		month -= MONTH_COUNT;
+		year++;
+	}
+	
+	/* Add one to the month offset to get the standard, one-based month
+	 * number */
+	month++;
+	
+	/* Return any computed results that were requested */
+	if (pYear != NULL) {
+		*pYear = year;
+	}
+	
+	if (pMonth != NULL) {
+		*pMonth = month;
+	}
+	
+	if (pDayOfMonth != NULL) {
+		*pDayOfMonth = day;
+	}
+}
+
+/*
+ * grcal_dateToOffset function.
  */
 bool grcal_dateToOffset(
 		int32_t *pOffs,
 		int32_t year,
-		int32_t month,
-		int32_t dayofmonth) {
+		int32_t month,
+		int32_t dayofmonth) {
+	
+	bool result = true;
+	int32_t month_len = 0;
+	int32_t offs = 0;
+	NELSC_STATS_BEGIN(stats_start);
+	
+	/* Fail if the year is out of range, or the month is out of range,
+	 * or dayofmonth is less than one */
+	if ((year <= BASE_YEAR) || (year > MAX_YEAR) ||
+			(month < 1) || (month > MONTH_COUNT) || (dayofmonth < 1)) {
+		result = false;
+	}
+	
+	/* Check the day against the length of the month, adding the leap
+	 * day to February in leap years */
+	if (result) {
+		month_len = m_month_days[month] +
+						(leapBit(year) & (int32_t) (month == 2));
+		if (dayofmonth > month_len) {
+			result = false;
+		}
+	}
+	
+	/* Add up the days to the start of the March-based year, which
+	 * begins in the previous year for January and February, the days to
+	 * the start of the month, and the days within the month */
+	if (result) {
+		offs = yearStart(year - BASE_YEAR -
+							(int32_t) (month <= MONTH_OFFSET)) +
+				m_month_start[month] + dayofmonth - 1;
+	}
+	
+	/* Fail if offset is outside the allowable range */
+	if (result) {
+		if ((offs < GRCAL_DAY_MIN) || (offs > GRCAL_DAY_MAX)) {
+			result = false;
+		}
+	}
+	
+	/* Write the computed offset, if it was requested */
+	if (result) {
+		if (pOffs != NULL) {
+			*pOffs = offs;
+		}
+	}
+	
+	NELSC_STATS_END(NELSC_PROBE_GRCAL_DATETOOFFSET,
+		stats_start, result);
+	
+	/* Return status */
+	return result;
+}
+
+/*
+ * grcal_datesToOffsets function.
+ */
+size_t grcal_datesToOffsets(
+		int32_t *pOffs,
+		const int32_t *pYear,
+		const int32_t *pMonth,
+		const int32_t *pDay,
+		size_t count) {
+	
+	size_t result = 0;
+	size_t i = 0;
+	int32_t ok = 0;
+	int32_t y = 0;
+	int32_t m = 0;
+	int32_t d = 0;
+	int32_t month_len = 0;
+	int32_t offs = 0;
+	
+	/* Check parameters */
+	if ((count > 0) && ((pOffs == NULL) || (pYear == NULL) ||
+			(pMonth == NULL) || (pDay == NULL))) {
+		abort();
+	}
+	
+	/* Convert each date without branching on its validity; invalid
+	 * fields are multiplied down to zero, which keeps all the table
+	 * lookups in range, and the result is masked to -1 at the end */
+	for(i = 0; i < count; i++) {
+		y = pYear[i];
+		m = pMonth[i];
+		d = pDay[i];
+		
+		ok = (int32_t) (y > BASE_YEAR) & (int32_t) (y <= MAX_YEAR) &
+				(int32_t) (m >= 1) & (int32_t) (m <= MONTH_COUNT) &
+				(int32_t) (d >= 1);
+		y = (y * ok) - (BASE_YEAR * ok);
+		m = m * ok;
+		
+		month_len = m_month_days[m] +
+						(leapBit(y + BASE_YEAR) & (int32_t) (m == 2));
+		ok &= (int32_t) (d <= month_len);
+		d = d * ok;
+		
+		offs = yearStart(y - (int32_t) (m <= MONTH_OFFSET)) +
+				m_month_start[m] + d - 1;
+		ok &= (int32_t) (offs >= GRCAL_DAY_MIN) &
+				(int32_t) (offs <= GRCAL_DAY_MAX);
+		
+		pOffs[i] = (offs & -ok) | ~(-ok);
+		result += (size_t) ok;
+	}
+	
+	/* Return count of valid dates */
+	return result;
+}
+
+/*
+ * grcal_dateToOffsetCascade function.
+ */
+bool grcal_dateToOffsetCascade(
+		int32_t *pOffs,
+		int32_t year,
+		int32_t month,
+		int32_t dayofmonth) {
+	
+	bool result = true;
+	int32_t month_len = 0;
+	
+	int32_t qc = 0;
+	int32_t c = 0;
+	int32_t q = 0;
+	
+	int32_t offs = 0;
+	int32_t x = 0;
+	
+	/* Fail if the year is BASE_YEAR or less, or if month or dayofmonth
+	 * are less than one */
+	if ((year <= BASE_YEAR) || (month < 1) || (dayofmonth < 1)) {
+		result = false;
+	}
+	
+	/* Fail if the year is greater than MAX_YEAR or if month is greater
+	 * than MONTH_COUNT -- the range of everything but the upper bound
+	 * of dayofmonth has now been checked */
+	if (result) {
+		if ((year > MAX_YEAR) || (month > MONTH_COUNT)) {
+			result = false;
+		}
+	}
+	
+	/* Convert to zero-based day offset within month */
+	if (result) {
+		dayofmonth--;
+	}
+	
+	/* Convert to March-based year offsets by making month zero-based,
+	 * then subtracting two months, and decrementing the year and adding
+	 * twelve to the month if it goes below zero */
+	if (result) {
+		month = month - 1 - MONTH_OFFSET;
+		if (month < 0) {
+			year--;
+			month += MONTH_COUNT;
+		}
+	}
+	
+	/* Check the day offset against the length of the month, taking leap
+	 * years into account */
+	if (result) {
+		/* Get the length of the month */
+		month_len = monthLength(month);
+		
+		/* If month is variable length, use leap year to determine month
+		 * length -- increment year because March-based years have their
+		 * last (leap) month in the next year according to the
+		 * January-based years used for leap year calculations */
+		if (month_len == 0) {
+			if (isLeapYear(year + 1)) {
+				month_len = LEAP_MONTH_LENGTH;
+			} else {
+				month_len = NONLEAP_MONTH_LENGTH;
+			}
+		}
+		
+		/* Verify upper bound of day offset within month */
+		if (dayofmonth >= month_len) {
+			result = false;
+		}
+	}
+	
+	/* We've now converted to March-based offsets and checked the range
+	 * of the input parameters -- begin by decreasing the year by
+	 * BASE_YEAR to make it relative to the base year */
+	if (result) {
+		year -= BASE_YEAR;
+	}
+	
+	/* Get the number of quad centuries, centuries, and quad years in
+	 * the year offset, leaving year as the remainder years */
+	if (result) {
+		qc   = year / QC_YEARS;
+		year = year % QC_YEARS;
+		
+		c    = year / C_YEARS;
+		year = year % C_YEARS;
+		
+		q    = year / Q_YEARS;
+		year = year % Q_YEARS;
+	}
+	
+	/* Calculate the number of days to the start of the year */
+	if (result) {
+		offs = (qc * QC_DAYS) + (c    * C_DAYS) + 
+			   (q  * Q_DAYS ) + (year * Y_DAYS);
+	}
+	
+	/* Get to the start of the month by adding month lengths together;
+	 * the variable length month won't figure in here because that is
+	 * the last month in March-based years and we are only getting to
+	 * the beginning of months, not passing them */
+	if (result) {
+		for(x = 0; x < month; x++) {
+			offs += monthLength(x);
+		}
+	}
+	
+	/* Finally, add the month-in-day offset in */
+	if (result) {
+		offs += dayofmonth;
+	}
+	
+	/* Fail if offset is outside the allowable range */
+	if (result) {
+		if ((offs < GRCAL_DAY_MIN) || (offs > GRCAL_DAY_MAX)) {
+			result = false;
+		}
+	}
+	
+	/* Write the computed offset, if it was requested */
+	if (result) {
+		if (pOffs != NULL) {
+			*pOffs = offs;
+		}
+	}
+	
+	/* Return status */
+	return result;
+}
+
+/*
+ * grcal_writeDate function.
+ */
+void grcal_writeDate(
+		char *pBuf,
+		int32_t y,
+		int32_t m,
+		int32_t d) {
+	
+	NELSC_STATS_BEGIN(stats_start);
+	
+	/* Check parameters */
+	if ((pBuf == NULL) || (!grcal_dateToOffset(NULL, y, m, d))) {
+		abort();
+	}
+	
+	/* Write the fields and separators */
+	decimal_writeInt(pBuf, y, YEAR_FIELD_LENGTH);
+	pBuf[4] = DATE_SEPARATOR;
+	decimal_writeInt(pBuf + 5, m, DAYMONTH_FIELD_MAXLENGTH);
+	pBuf[7] = DATE_SEPARATOR;
+	decimal_writeInt(pBuf + 8, d, DAYMONTH_FIELD_MAXLENGTH);
+	
+	NELSC_STATS_END(NELSC_PROBE_GRCAL_WRITEDATE, stats_start, true);
+}
+
+/*
+ * grcal_printDate function.
+ */
+void grcal_printDate(
+		FILE *pFile,
+		int32_t y,
+		int32_t m,
+		int32_t d) {
+	
+	char buf[GRCAL_DATE_LENGTH];
+	
+	/* Check parameters */
+	if ((pFile == NULL) || (!grcal_dateToOffset(NULL, y, m, d))) {
+		abort();
+	}
+	
+	/* Print the date */
+	grcal_writeDate(buf, y, m, d);
+	if (fwrite(buf, 1, GRCAL_DATE_LENGTH, pFile) != GRCAL_DATE_LENGTH) {
+		abort();
+	}
+}
+
+/*
+ * grcal_scanDate function.
+ */
+int32_t grcal_scanDate(
+		const char *str,
+		const char **ppTrail,
+		SCANERR *pErr) {
+	
+	bool result = true;
+	
+	int32_t year = 0;
+	int32_t month = 0;
+	int32_t day = 0;
+	int32_t pos[3];
+	
+	int32_t offs = 0;
+	
+	const char *pc = NULL;
+	NELSC_STATS_BEGIN(stats_start);
+	
+	/* Initialize arrays */
+	memset(pos, 0, sizeof(pos));
+	
+	/* Fail if str is NULL */
+	if (str == NULL) {
+		scanerr_set(pErr, SCANERR_END, SCANERR_FIELD_NONE, 0, 0);
+		result = false;
+	}
+	
+	/* Attempt to read each field, verifying the separators between them
+	 * as well, and remembering where each field starts */
+	pc = str;
+
+	if (result) {
+		year = parseYear(pc);
+		if (year != -1) {
+			pc += YEAR_FIELD_LENGTH;
+		} else {
+			digitError(pErr, str, 0, YEAR_FIELD_LENGTH,
+				SCANERR_FIELD_YEAR);
+			result = false;
+		}
+	}
+
+	if (result) {
+		if (checkSeparator(pErr, str, (int32_t) (pc - str),
+				DATE_SEPARATOR)) {
+			pc++;
+		} else {
+			result = false;
+		}
+	}
+
+	if (result) {
+		pos[1] = (int32_t) (pc - str);
+		month = parseDayMonth(pc, &pc);
+		if (month == -1) {
+			digitError(pErr, str, pos[1], DAYMONTH_FIELD_MAXLENGTH,
+				SCANERR_FIELD_MONTH);
+			result = false;
+		}
+	}
+
+	if (result) {
+		if (checkSeparator(pErr, str, (int32_t) (pc - str),
+				DATE_SEPARATOR)) {
+			pc++;
+		} else {
+			result = false;
+		}
+	}
+
+	if (result) {
+		pos[2] = (int32_t) (pc - str);
+		day = parseDayMonth(pc, &pc);
+		if (day == -1) {
+			digitError(pErr, str, pos[2], DAYMONTH_FIELD_MAXLENGTH,
+				SCANERR_FIELD_DAY);
+			result = false;
+		}
+	}
+
+	/* Convert to a Gregorian day offset */
+	if (result) {
+		result = grcal_dateToOffset(&offs, year, month, day);
+		if (!result) {
+			dateError(pErr, year, month, day, pos);
+		}
+	}
+
+	/* If succeeded, write trailing pointer if requested; if failed, set
+	 * result to -1 */
+	if (result) {
+		if (ppTrail != NULL) {
+			*ppTrail = pc;
+		}
+	} else {
+		offs = -1;
+	}
+
+	NELSC_STATS_END(NELSC_PROBE_GRCAL_SCANDATE, stats_start, result);
+	
+	/* Return result */
+	return offs;
+}
+
+/*
+ * grcal_formatFind function.
+ */
+int grcal_formatFind(const char *pName) {
+	
+	int result = -1;
+	int i = 0;
+	
+	/* Check parameters */
+	if (pName == NULL) {
+		abort();
+	}
+	
+	for(i = 0; i < GRCAL_FORMAT_COUNT; i++) {
+		if (strcmp(pName, m_format_names[i]) == 0) {
+			result = i;
+			break;
+		}
+	}
+	
+	return result;
+}
+
+/*
+ * grcal_formatLength function.
+ */
+size_t grcal_formatLength(int fmt) {
+	
+	/* Check parameters */
+	if ((fmt < 0) || (fmt >= GRCAL_FORMAT_COUNT)) {
+		abort();
+	}
+	
+	return (size_t) m_layouts[fmt].len;
+}
+
+/*
+ * grcal_writeFormat function.
+ */
+size_t grcal_writeFormat(
+		char *pBuf,
+		int fmt,
+		int32_t y,
+		int32_t m,
+		int32_t d) {
+	
+	const FORMAT_LAYOUT *pl = NULL;
+	int32_t i = 0;
+	
+	/* Check parameters */
+	if ((pBuf == NULL) || (fmt < 0) || (fmt >= GRCAL_FORMAT_COUNT) ||
+			(!grcal_dateToOffset(NULL, y, m, d))) {
+		abort();
+	}
+	
+	/* Write the fields at the positions of their first digits, and
+	 * then the separators */
+	pl = &(m_layouts[fmt]);
+	
+	decimal_writeInt(pBuf + pl->digit[0], y, YEAR_FIELD_LENGTH);
+	decimal_writeInt(pBuf + pl->digit[4], m, DAYMONTH_FIELD_MAXLENGTH);
+	decimal_writeInt(pBuf + pl->digit[6], d, DAYMONTH_FIELD_MAXLENGTH);
+	
+	for(i = 0; i < FORMAT_SEPARATORS; i++) {
+		if (pl->sep[i] >= 0) {
+			pBuf[pl->sep[i]] = pl->sep_char;
+		}
+	}
+	
+	return (size_t) pl->len;
+}
+
+/*
+ * grcal_scanFormat function.
+ */
+int32_t grcal_scanFormat(
+		int fmt,
+		const char *str,
+		const char **ppTrail,
+		SCANERR *pErr) {
+	
+	bool result = true;
+	const FORMAT_LAYOUT *pl = NULL;
+	const char *pNull = NULL;
+	uint64_t x = 0;
+	int32_t i = 0;
+	int32_t packed = 0;
+	int32_t pos[3];
+	int32_t offs = -1;
+	
+	/* Check parameters */
+	if ((str == NULL) || (fmt < 0) || (fmt >= GRCAL_FORMAT_COUNT)) {
+		abort();
+	}
+	
+	pl = &(m_layouts[fmt]);
+	
+	/* Make sure the string is at least as long as the format, so that
+	 * the fixed positions can be read directly */
+	pNull = (const char *) memchr(str, 0, (size_t) pl->len);
+	if (pNull != NULL) {
+		scanerr_set(pErr, SCANERR_END, SCANERR_FIELD_NONE,
+			(int32_t) (pNull - str), 0);
+		result = false;
+	}
+	
+	/* Gather the digits into one word in YYYYMMDD order, check the
+	 * separators, and check that no digit follows the date */
+	if (result) {
+		for(i = 0; i < PACKED_DIGITS; i++) {
+			x |= ((uint64_t) (unsigned char) str[pl->digit[i]]) <<
+					(8 * i);
+		}
+		for(i = 0; i < FORMAT_SEPARATORS; i++) {
+			if (pl->sep[i] >= 0) {
+				if (!checkSeparator(pErr, str, pl->sep[i],
+						pl->sep_char)) {
+					result = false;
+					break;
+				}
+			}
+		}
+	}
+	if (result) {
+		if (parseDecimal(str[pl->len]) != -1) {
+			scanerr_set(pErr, SCANERR_TRAILING, SCANERR_FIELD_NONE,
+				pl->len, 0);
+			result = false;
+		}
+	}
+	
+	/* Check and combine the digits, then convert the packed date; only
+	 * if that fails are the digits looked at one at a time, to find
+	 * where the error is */
+	if (result) {
+		result = swarDigits(x, &packed);
+		if (!result) {
+			for(i = 0; i < PACKED_DIGITS; i++) {
+				if (parseDecimal(str[pl->digit[i]]) == -1) {
+					break;
+				}
+			}
+			scanerr_set(pErr, SCANERR_DIGIT,
+				(i < 4) ? SCANERR_FIELD_YEAR :
+					((i < 6) ? SCANERR_FIELD_MONTH : SCANERR_FIELD_DAY),
+				pl->digit[i], 0);
+		}
+	}
+	if (result) {
+		offs = grcal_unpackDate(packed);
+		if (offs == -1) {
+			pos[0] = pl->digit[0];
+			pos[1] = pl->digit[4];
+			pos[2] = pl->digit[6];
+			dateError(pErr, packed / 10000, (packed / 100) % 100,
+				packed % 100, pos);
+			result = false;
+		}
+	}
+	
+	/* If succeeded, write trailing pointer if requested */
+	if (result) {
+		if (ppTrail != NULL) {
+			*ppTrail = str + pl->len;
+		}
+	}
+	
+	return offs;
+}
+
+/*
+ * grcal_packDate function.
+ */
+int32_t grcal_packDate(int32_t offs) {
+	
+	int32_t y = 0;
+	int32_t m = 0;
+	int32_t d = 0;
+	
+	/* Convert, which also checks the range */
+	grcal_offsetToDate(offs, &y, &m, &d);
+	
+	return (y * 10000) + (m * 100) + d;
+}
+
+/*
+ * grcal_unpackDate function.
+ */
+int32_t grcal_unpackDate(int32_t packed) {
+	
+	int32_t offs = -1;
+	
+	if (packed >= 0) {
+		if (!grcal_dateToOffset(&offs,
+				packed / 10000, (packed / 100) % 100, packed % 100)) {
+			offs = -1;
+		}
+	}
+	
+	return offs;
+}
+
+/*
+ * grcal_weekday function.
+ */
+int32_t grcal_weekday(int32_t offs) {
+	
+	/* Check parameter */
+	if ((offs < GRCAL_DAY_MIN) || (offs > GRCAL_DAY_MAX)) {
+		abort();
+	}
+	
+	return isoWeekday(offs);
+}
+
+/*
+ * grcal_offsetToWeekDate function.
+ */
+void grcal_offsetToWeekDate(
+		int32_t offs,
+		int32_t *pYear,
+		int32_t *pWeek,
+		int32_t *pWeekday) {
+	
+	int32_t year = 0;
+	int32_t start = 0;
+	
+	/* Check parameter */
+	if ((offs < GRCAL_DAY_MIN) || (offs > GRCAL_DAY_MAX)) {
+		abort();
+	}
+	
+	/* Start from the Gregorian year, and move to the next or previous
+	 * week-numbering year if the day falls outside its weeks */
+	grcal_offsetToDate(offs, &year, NULL, NULL);
+	
+	start = weekOne(year + 1);
+	if (offs >= start) {
+		year++;
+	} else {
+		start = weekOne(year);
+		if (offs < start) {
+			year--;
+			start = weekOne(year);
+		}
+	}
+	
+	/* Return any computed results that were requested */
+	if (pYear != NULL) {
+		*pYear = year;
+	}
+	
+	if (pWeek != NULL) {
+		*pWeek = ((offs - start) / DAYS_PER_WEEK) + 1;
+	}
+	
+	if (pWeekday != NULL) {
+		*pWeekday = isoWeekday(offs);
+	}
+}
+
+/*
+ * grcal_weekDateToOffset function.
+ */
+bool grcal_weekDateToOffset(
+		int32_t *pOffs,
+		int32_t year,
+		int32_t week,
+		int32_t weekday) {
 	
 	bool result = true;
-	int32_t month_len = 0;
-	
-	int32_t qc = 0;
-	int32_t c = 0;
-	int32_t q = 0;
-	
+	int32_t start = 0;
 	int32_t offs = 0;
-	int32_t x = 0;
 	
-	/* Fail if the year is BASE_YEAR or less, or if month or dayofmonth
-	 * are less than one */
-	if ((year <= BASE_YEAR) || (month < 1) || (dayofmonth < 1)) {
+	/* Fail if the year, week, or weekday is out of range; the number
+	 * of weeks in the year is checked next */
+	if ((year <= BASE_YEAR) || (year > MAX_YEAR) || (week < 1) ||
+			(weekday < 1) || (weekday > DAYS_PER_WEEK)) {
 		result = false;
 	}
 	
-	/* Fail if the year is greater than MAX_YEAR or if month is greater
-	 * than MONTH_COUNT -- the range of everything but the upper bound
-	 * of dayofmonth has now been checked */
+	/* Fail if the week is past the end of the week-numbering year */
 	if (result) {
-		if ((year > MAX_YEAR) || (month > MONTH_COUNT)) {
+		start = weekOne(year);
+		if ((week - 1) * DAYS_PER_WEEK >= weekOne(year + 1) - start) {
 			result = false;
 		}
 	}
 	
-	/* Convert to zero-based day offset within month */
-	if (result) {
-		dayofmonth--;
-	}
-	
-	/* Convert to March-based year offsets by making month zero-based,
-	 * then subtracting two months, and decrementing the year and adding
-	 * twelve to the month if it goes below zero */
+	/* Compute the offset and fail if it is outside the allowable
+	 * range */
 	if (result) {
-		month = month - 1 - MONTH_OFFSET;
-		if (month < 0) {
-			year--;
-			month += MONTH_COUNT;
+		offs = start + ((week - 1) * DAYS_PER_WEEK) + (weekday - 1);
+		if ((offs < GRCAL_DAY_MIN) || (offs > GRCAL_DAY_MAX)) {
+			result = false;
 		}
 	}
 	
-	/* Check the day offset against the length of the month, taking leap
-	 * years into account */
+	/* Write the computed offset, if it was requested */
 	if (result) {
-		/* Get the length of the month */
-		month_len = monthLength(month);
-		
-		/* If month is variable length, use leap year to determine month
-		 * length -- increment year because March-based years have their
-		 * last (leap) month in the next year according to the
-		 * January-based years used for leap year calculations */
-		if (month_len == 0) {
-			if (isLeapYear(year + 1)) {
-				month_len = LEAP_MONTH_LENGTH;
-			} else {
-				month_len = NONLEAP_MONTH_LENGTH;
-			}
-		}
-		
-		/* Verify upper bound of day offset within month */
-		if (dayofmonth >= month_len) {
-			result = false;
+		if (pOffs != NULL) {
+			*pOffs = offs;
 		}
 	}
 	
-	/* We've now converted to March-based offsets and checked the range
-	 * of the input parameters -- begin by decreasing the year by
-	 * BASE_YEAR to make it relative to the base year */
-	if (result) {
-		year -= BASE_YEAR;
-	}
+	/* Return status */
+	return result;
+}
+
+/*
+ * grcal_offsetToOrdinal function.
+ */
+void grcal_offsetToOrdinal(
+		int32_t offs,
+		int32_t *pYear,
+		int32_t *pDayOfYear) {
 	
-	/* Get the number of quad centuries, centuries, and quad years in
-	 * the year offset, leaving year as the remainder years */
-	if (result) {
-		qc   = year / QC_YEARS;
-		year = year % QC_YEARS;
-		
-		c    = year / C_YEARS;
-		year = year % C_YEARS;
-		
-		q    = year / Q_YEARS;
-		year = year % Q_YEARS;
+	int32_t year = 0;
+	
+	/* Check parameter */
+	if ((offs < GRCAL_DAY_MIN) || (offs > GRCAL_DAY_MAX)) {
+		abort();
 	}
 	
-	/* Calculate the number of days to the start of the year */
-	if (result) {
-		offs = (qc * QC_DAYS) + (c    * C_DAYS) + 
-			   (q  * Q_DAYS ) + (year * Y_DAYS);
+	/* Count the days from the first of January */
+	grcal_offsetToDate(offs, &year, NULL, NULL);
+	
+	if (pYear != NULL) {
+		*pYear = year;
 	}
 	
-	/* Get to the start of the month by adding month lengths together;
-	 * the variable length month won't figure in here because that is
-	 * the last month in March-based years and we are only getting to
-	 * the beginning of months, not passing them */
-	if (result) {
-		for(x = 0; x < month; x++) {
-			offs += monthLength(x);
-		}
+	if (pDayOfYear != NULL) {
+		*pDayOfYear = offs - janFirst(year) + 1;
 	}
+}
+
+/*
+ * grcal_ordinalToOffset function.
+ */
+bool grcal_ordinalToOffset(
+		int32_t *pOffs,
+		int32_t year,
+		int32_t dayofyear) {
 	
-	/* Finally, add the month-in-day offset in */
+	bool result = true;
+	int32_t offs = 0;
+	
+	/* Fail if the year is out of range or the day is not in the
+	 * year */
+	if ((year <= BASE_YEAR) || (year > MAX_YEAR) || (dayofyear < 1)) {
+		result = false;
+	}
 	if (result) {
-		offs += dayofmonth;
+		if (dayofyear > Y_DAYS + leapBit(year)) {
+			result = false;
+		}
 	}
 	
-	/* Fail if offset is outside the allowable range */
+	/* Compute the offset and fail if it is outside the allowable
+	 * range */
 	if (result) {
+		offs = janFirst(year) + dayofyear - 1;
 		if ((offs < GRCAL_DAY_MIN) || (offs > GRCAL_DAY_MAX)) {
 			result = false;
 		}
@@ -712,105 +1997,232 @@ bool grcal_dateToOffset(
 }
 
 /*
- * grcal_printDate function.
+ * grcal_writeWeekDate function.
  */
-void grcal_printDate(
-		FILE *pFile,
-		int32_t y,
-		int32_t m,
-		int32_t d) {
+void grcal_writeWeekDate(char *pBuf, int32_t offs) {
+	
+	int32_t y = 0;
+	int32_t w = 0;
+	int32_t d = 0;
 	
 	/* Check parameters */
-	if ((pFile == NULL) || (!grcal_dateToOffset(NULL, y, m, d))) {
+	if (pBuf == NULL) {
 		abort();
 	}
 	
-	/* Print the date */
-	if (fprintf(
-			pFile, "%04d-%02d-%02d",
-			(int) y, (int) m, (int) d) != STANDARD_DATE_LENGTH) {
+	/* Convert and write the fields and separators */
+	grcal_offsetToWeekDate(offs, &y, &w, &d);
+	
+	decimal_writeInt(pBuf, y, YEAR_FIELD_LENGTH);
+	pBuf[4] = DATE_SEPARATOR;
+	pBuf[5] = WEEK_DESIGNATOR;
+	decimal_writeInt(pBuf + 6, w, WEEK_FIELD_LENGTH);
+	pBuf[8] = DATE_SEPARATOR;
+	pBuf[9] = (char) ('0' + d);
+}
+
+/*
+ * grcal_writeOrdinal function.
+ */
+void grcal_writeOrdinal(char *pBuf, int32_t offs) {
+	
+	int32_t y = 0;
+	int32_t d = 0;
+	
+	/* Check parameters */
+	if (pBuf == NULL) {
 		abort();
 	}
+	
+	/* Convert and write the fields and separator */
+	grcal_offsetToOrdinal(offs, &y, &d);
+	
+	decimal_writeInt(pBuf, y, YEAR_FIELD_LENGTH);
+	pBuf[4] = DATE_SEPARATOR;
+	decimal_writeInt(pBuf + 5, d, ORDINAL_FIELD_LENGTH);
 }
 
 /*
- * grcal_scanDate function.
+ * grcal_scanWeekDate function.
  */
-int32_t grcal_scanDate(const char *str, const char **ppTrail) {
+int32_t grcal_scanWeekDate(
+		const char *str,
+		const char **ppTrail,
+		SCANERR *pErr) {
 	
 	bool result = true;
-	
 	int32_t year = 0;
-	int32_t month = 0;
-	int32_t day = 0;
-	
-	int32_t offs = 0;
-	
-	const char *pc = NULL;
+	int32_t week = 0;
+	int32_t weekday = 0;
+	int32_t offs = -1;
 	
 	/* Fail if str is NULL */
 	if (str == NULL) {
+		scanerr_set(pErr, SCANERR_END, SCANERR_FIELD_NONE, 0, 0);
 		result = false;
 	}
 	
-	/* Attempt to read each field, verifying the separators between them
-	 * as well */
-	pc = str;
-
+	/* Read each field and check the separators between them; each
+	 * check stops at a terminating null, so nothing is read past the
+	 * end of the string */
 	if (result) {
-		year = parseYear(pc);
-		if (year != -1) {
-			pc += YEAR_FIELD_LENGTH;
-		} else {
+		year = parseYear(str);
+		if (year == -1) {
+			digitError(pErr, str, 0, YEAR_FIELD_LENGTH,
+				SCANERR_FIELD_YEAR);
 			result = false;
 		}
 	}
-
 	if (result) {
-		if (*pc == DATE_SEPARATOR) {
-			pc++;
-		} else {
+		result = checkSeparator(pErr, str, 4, DATE_SEPARATOR);
+	}
+	if (result) {
+		result = checkSeparator(pErr, str, 5, WEEK_DESIGNATOR);
+	}
+	if (result) {
+		week = parseDigits(str + 6, WEEK_FIELD_LENGTH);
+		if (week == -1) {
+			digitError(pErr, str, 6, WEEK_FIELD_LENGTH,
+				SCANERR_FIELD_WEEK);
 			result = false;
 		}
 	}
-
 	if (result) {
-		month = parseDayMonth(pc, &pc);
-		if (month == -1) {
+		result = checkSeparator(pErr, str, 8, DATE_SEPARATOR);
+	}
+	if (result) {
+		weekday = parseDigits(str + 9, 1);
+		if (weekday == -1) {
+			digitError(pErr, str, 9, 1, SCANERR_FIELD_DAY);
 			result = false;
 		}
 	}
-
+	
+	/* Check the fields that can be out of range in any year, then
+	 * convert to a Gregorian day offset, which only fails if the week
+	 * is past the end of the year or the date is out of range */
 	if (result) {
-		if (*pc == DATE_SEPARATOR) {
-			pc++;
-		} else {
+		if ((week < 1) || (week > 53)) {
+			scanerr_set(pErr, SCANERR_RANGE, SCANERR_FIELD_WEEK,
+				6, week);
+			result = false;
+		
+		} else if ((weekday < 1) || (weekday > DAYS_PER_WEEK)) {
+			scanerr_set(pErr, SCANERR_RANGE, SCANERR_FIELD_DAY, 9,
+				weekday);
+			result = false;
+		
+		} else if ((year <= BASE_YEAR) || (year > MAX_YEAR)) {
+			scanerr_set(pErr, SCANERR_LIMIT, SCANERR_FIELD_YEAR,
+				0, year);
 			result = false;
 		}
 	}
+	if (result) {
+		result = grcal_weekDateToOffset(&offs, year, week, weekday);
+		if (!result) {
+			if ((week - 1) * DAYS_PER_WEEK >=
+					weekOne(year + 1) - weekOne(year)) {
+				scanerr_set(pErr, SCANERR_YEAR_END, SCANERR_FIELD_WEEK,
+					6, week);
+			} else {
+				scanerr_set(pErr, SCANERR_LIMIT, SCANERR_FIELD_NONE,
+					0, 0);
+			}
+		}
+	}
+	
+	/* If succeeded, write trailing pointer if requested; if failed, set
+	 * result to -1 */
+	if (result) {
+		if (ppTrail != NULL) {
+			*ppTrail = str + GRCAL_WEEKDATE_LENGTH;
+		}
+	} else {
+		offs = -1;
+	}
+	
+	/* Return result */
+	return offs;
+}
 
+/*
+ * grcal_scanOrdinal function.
+ */
+int32_t grcal_scanOrdinal(
+		const char *str,
+		const char **ppTrail,
+		SCANERR *pErr) {
+	
+	bool result = true;
+	int32_t year = 0;
+	int32_t day = 0;
+	int32_t offs = -1;
+	
+	/* Fail if str is NULL */
+	if (str == NULL) {
+		scanerr_set(pErr, SCANERR_END, SCANERR_FIELD_NONE, 0, 0);
+		result = false;
+	}
+	
+	/* Read the fields and check the separator, and make sure the day
+	 * field isn't the start of a longer run of digits */
 	if (result) {
-		day = parseDayMonth(pc, &pc);
+		year = parseYear(str);
+		if (year == -1) {
+			digitError(pErr, str, 0, YEAR_FIELD_LENGTH,
+				SCANERR_FIELD_YEAR);
+			result = false;
+		}
+	}
+	if (result) {
+		result = checkSeparator(pErr, str, 4, DATE_SEPARATOR);
+	}
+	if (result) {
+		day = parseDigits(str + 5, ORDINAL_FIELD_LENGTH);
 		if (day == -1) {
+			digitError(pErr, str, 5, ORDINAL_FIELD_LENGTH,
+				SCANERR_FIELD_DAY);
+			result = false;
+		
+		} else if (parseDecimal(str[8]) != -1) {
+			scanerr_set(pErr, SCANERR_TRAILING, SCANERR_FIELD_NONE,
+				8, 0);
 			result = false;
 		}
 	}
-
-	/* Convert to a Gregorian day offset */
+	
+	/* Convert to a Gregorian day offset, working out why if that
+	 * fails */
 	if (result) {
-		result = grcal_dateToOffset(&offs, year, month, day);
+		result = grcal_ordinalToOffset(&offs, year, day);
+		if (!result) {
+			if ((day < 1) || (day > Y_DAYS + 1)) {
+				scanerr_set(pErr, SCANERR_RANGE, SCANERR_FIELD_DAY,
+					5, day);
+			} else if ((year <= BASE_YEAR) || (year > MAX_YEAR)) {
+				scanerr_set(pErr, SCANERR_LIMIT, SCANERR_FIELD_YEAR,
+					0, year);
+			} else if (day > Y_DAYS + leapBit(year)) {
+				scanerr_set(pErr, SCANERR_YEAR_END, SCANERR_FIELD_DAY,
+					5, day);
+			} else {
+				scanerr_set(pErr, SCANERR_LIMIT, SCANERR_FIELD_NONE,
+					0, 0);
+			}
+		}
 	}
-
+	
 	/* If succeeded, write trailing pointer if requested; if failed, set
 	 * result to -1 */
 	if (result) {
 		if (ppTrail != NULL) {
-			*ppTrail = pc;
+			*ppTrail = str + GRCAL_ORDINAL_LENGTH;
 		}
 	} else {
 		offs = -1;
 	}
-
+	
 	/* Return result */
 	return offs;
 }
@@ -6,7 +6,8 @@
  * 
  * Provides functions for working with Gregorian calendar dates.  This
  * only provides the core Gregorian functions of moving between counts
- * of days and year-month-day dates.
+ * of days and year-month-day dates, along with the ISO 8601 week dates
+ * and ordinal dates and a few other fixed-width date formats.
  */
 
 #include <stdbool.h>
@@ -14,6 +15,8 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include "scanerr.h"
+
 /*
  * The minimum valid Gregorian day offset.
  * 
@@ -31,6 +34,50 @@
  */
 #define GRCAL_DAY_MAX 3214073
 
+/*
+ * The number of characters in a Gregorian date written in YYYY-MM-DD
+ * format, with the MM and DD fields zero-padded to two characters.
+ */
+#define GRCAL_DATE_LENGTH 10
+
+/*
+ * The number of characters in an ISO 8601 week date written in
+ * YYYY-Www-D format.
+ */
+#define GRCAL_WEEKDATE_LENGTH 10
+
+/*
+ * The number of characters in an ISO 8601 ordinal date written in
+ * YYYY-DDD format.
+ */
+#define GRCAL_ORDINAL_LENGTH 8
+
+/*
+ * The fixed-width Gregorian date formats:
+ * 
+ *   ISO     - YYYY-MM-DD
+ *   COMPACT - YYYYMMDD
+ *   SLASH   - YYYY/MM/DD
+ *   DOTTED  - DD.MM.YYYY
+ * 
+ * In each of them, the month and day are always two digits.
+ */
+#define GRCAL_FORMAT_ISO     0
+#define GRCAL_FORMAT_COMPACT 1
+#define GRCAL_FORMAT_SLASH   2
+#define GRCAL_FORMAT_DOTTED  3
+
+/*
+ * The number of fixed-width Gregorian date formats.
+ */
+#define GRCAL_FORMAT_COUNT 4
+
+/*
+ * The maximum number of characters in a date written in any of the
+ * fixed-width formats.
+ */
+#define GRCAL_FORMAT_MAXLEN 10
+
 /*
  * Convert a Gregorian day offset into the year, month, and day of
  * month.
@@ -71,6 +118,39 @@ void grcal_offsetToDate(
 		int32_t *pMonth,
 		int32_t *pDayOfMonth);
 
+/*
+ * Reference version of grcal_offsetToDate().
+ * 
+ * grcal_offsetToDate() finds the date with closed-form multiply and
+ * shift formulas, without any branches beyond its parameter checks.
+ * This function gets the same results the long way, by dividing the
+ * offset into quad centuries, centuries, quad years, and years, and
+ * then walking the month lengths.  It is kept so that the two can be
+ * checked against each other over the whole range of offsets.
+ * 
+ * Parameters:
+ * 
+ *   offs - the Gregorian day offset to convert
+ * 
+ *   pYear - pointer to the variable to receive the Gregorian year, or
+ *   NULL
+ * 
+ *   pMonth - pointer to the variable to receive the Gregorian month, or
+ *   NULL
+ * 
+ *   pDayOfMonth - pointer to the variable to receive the Gregorian day
+ *   of the month, or NULL
+ * 
+ * Faults:
+ * 
+ *   - If offs is out of range
+ */
+void grcal_offsetToDateCascade(
+		int32_t offs,
+		int32_t *pYear,
+		int32_t *pMonth,
+		int32_t *pDayOfMonth);
+
 /*
  * Convert a Gregorian date into a Gregorian day offset.
  * 
@@ -107,6 +187,120 @@ bool grcal_dateToOffset(
 		int32_t month,
 		int32_t dayofmonth);
 
+/*
+ * Reference version of grcal_dateToOffset().
+ * 
+ * grcal_dateToOffset() validates and converts dates with a leap year
+ * bitset and a table of month starts.  This function gets the same
+ * results the long way, with the leap year rules and by walking the
+ * month lengths.  It is kept so that the two can be checked against
+ * each other.
+ * 
+ * Parameters:
+ * 
+ *   pOffs - pointer to the variable to receive the converted Gregorian
+ *   day offset, or NULL
+ * 
+ *   year - the Gregorian year
+ * 
+ *   month - the month of the year
+ * 
+ *   dayofmonth - the day of the month
+ * 
+ * Return:
+ * 
+ *   true if successful, false if provided year-month-day combination is
+ *   not valid
+ */
+bool grcal_dateToOffsetCascade(
+		int32_t *pOffs,
+		int32_t year,
+		int32_t month,
+		int32_t dayofmonth);
+
+/*
+ * Validate and convert a batch of Gregorian dates into Gregorian day
+ * offsets.
+ * 
+ * The dates are given as three parallel arrays of years, months, and
+ * days of the month.  Each date gets the same result as from
+ * grcal_dateToOffset(), with -1 written to pOffs for invalid dates.
+ * 
+ * The loop does not branch on the dates, so that compilers can
+ * vectorize it and mixed valid and invalid input costs no branch
+ * mispredictions.
+ * 
+ * Parameters:
+ * 
+ *   pOffs - the array to receive the day offsets
+ * 
+ *   pYear - the array of Gregorian years
+ * 
+ *   pMonth - the array of months of the year
+ * 
+ *   pDay - the array of days of the month
+ * 
+ *   count - the number of dates in each of the arrays
+ * 
+ * Return:
+ * 
+ *   the number of valid dates
+ * 
+ * Faults:
+ * 
+ *   - If count is greater than zero and any of the arrays is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If any of the arrays has fewer than count elements
+ */
+size_t grcal_datesToOffsets(
+		int32_t *pOffs,
+		const int32_t *pYear,
+		const int32_t *pMonth,
+		const int32_t *pDay,
+		size_t count);
+
+/*
+ * Write a formatted Gregorian date in YYYY-MM-DD format into the given
+ * character buffer in ASCII format.
+ * 
+ * Exactly GRCAL_DATE_LENGTH characters are written.  No terminating
+ * null is written.
+ * 
+ * The m and d arguments are one-indexed, so the first month of the year
+ * is one and the first day of the month is one.
+ * 
+ * The provided year, month, day combination must be valid within the
+ * Gregorian calendar.  A fault occurs if an invalid date is specified.
+ * 
+ * Parameters:
+ * 
+ *   pBuf - the buffer to write into
+ * 
+ *   y - the year
+ * 
+ *   m - the month of the year
+ * 
+ *   d - the day of the month
+ * 
+ * Faults:
+ * 
+ *   - If pBuf is NULL
+ * 
+ *   - If y, m, and d are not a valid Gregorian combination of year,
+ *     month, and day
+ * 
+ * Undefined behavior:
+ * 
+ *   - If pBuf has room for fewer than GRCAL_DATE_LENGTH characters
+ */
+void grcal_writeDate(
+		char *pBuf,
+		int32_t y,
+		int32_t m,
+		int32_t d);
+
 /*
  * Print a formatted Gregorian date in YYYY-MM-DD format to the given
  * file in ASCII format.
@@ -166,6 +360,10 @@ void grcal_printDate(
  * not valid in the Gregorian calendar system, or if it is out of range
  * of the Gregorian day offset (GRCAL_DAY_MIN to GRCAL_DAY_MAX).
  * 
+ * If the parsing fails and pErr is not NULL, *pErr is set to the
+ * reason, the field, and the position in str where parsing stopped.
+ * Reporting the error costs nothing when parsing succeeds.
+ * 
  * Parameters:
  * 
  *   str - the string to parse
@@ -173,6 +371,8 @@ void grcal_printDate(
  *   ppTrail - pointer to the pointer to be set to the character
  *   following the date on successful return, or NULL
  * 
+ *   pErr - the error to fill in if parsing fails, or NULL
+ * 
  * Return:
  * 
  *   the Gregorian day offset, or -1 if parsing failed or str is NULL
@@ -181,6 +381,408 @@ void grcal_printDate(
  * 
  *   - If the provided string is not null-terminated
  */
-int32_t grcal_scanDate(const char *str, const char **ppTrail);
+int32_t grcal_scanDate(
+		const char *str,
+		const char **ppTrail,
+		SCANERR *pErr);
+
+/*
+ * Find a fixed-width Gregorian date format by name.
+ * 
+ * The names are "iso", "compact", "slash", and "dotted", matching the
+ * GRCAL_FORMAT constants.
+ * 
+ * Parameters:
+ * 
+ *   pName - the null-terminated name of the format
+ * 
+ * Return:
+ * 
+ *   the GRCAL_FORMAT constant, or -1 if there is no format with that
+ *   name
+ * 
+ * Faults:
+ * 
+ *   - If pName is NULL
+ */
+int grcal_formatFind(const char *pName);
+
+/*
+ * Return the number of characters in a date written in a fixed-width
+ * Gregorian date format.
+ * 
+ * Parameters:
+ * 
+ *   fmt - the format, one of the GRCAL_FORMAT constants
+ * 
+ * Return:
+ * 
+ *   the number of characters
+ * 
+ * Faults:
+ * 
+ *   - If fmt is not a valid format
+ */
+size_t grcal_formatLength(int fmt);
+
+/*
+ * Write a Gregorian date in a fixed-width format.
+ * 
+ * grcal_formatLength() characters are written, which is at most
+ * GRCAL_FORMAT_MAXLEN.  No terminating null is written.
+ * 
+ * Parameters:
+ * 
+ *   pBuf - the buffer to write into
+ * 
+ *   fmt - the format, one of the GRCAL_FORMAT constants
+ * 
+ *   y - the year
+ * 
+ *   m - the month of the year
+ * 
+ *   d - the day of the month
+ * 
+ * Return:
+ * 
+ *   the number of characters written
+ * 
+ * Faults:
+ * 
+ *   - If pBuf is NULL
+ * 
+ *   - If fmt is not a valid format
+ * 
+ *   - If y, m, and d are not a valid Gregorian combination of year,
+ *     month, and day
+ * 
+ * Undefined behavior:
+ * 
+ *   - If pBuf has room for fewer than grcal_formatLength() characters
+ */
+size_t grcal_writeFormat(
+		char *pBuf,
+		int fmt,
+		int32_t y,
+		int32_t m,
+		int32_t d);
+
+/*
+ * Parse a Gregorian date in a fixed-width format at the start of a
+ * null-terminated ASCII string.
+ * 
+ * Every field must have exactly its full number of digits, and the
+ * date must not be directly followed by another decimal digit.  The
+ * eight digits are checked and combined together in one 64-bit word
+ * rather than one at a time.
+ * 
+ * This function will not read past a terminating null.  It does not
+ * skip leading whitespace.  Errors are reported through pErr in the
+ * same way as grcal_scanDate().  The digits are only examined one at a
+ * time when the combined check fails.
+ * 
+ * Parameters:
+ * 
+ *   fmt - the format, one of the GRCAL_FORMAT constants
+ * 
+ *   str - the string to parse
+ * 
+ *   ppTrail - pointer to the pointer to be set to the character
+ *   following the date on successful return, or NULL
+ * 
+ *   pErr - the error to fill in if parsing fails, or NULL
+ * 
+ * Return:
+ * 
+ *   the Gregorian day offset, or -1 if parsing failed, the date is not
+ *   valid, or it is out of range GRCAL_DAY_MIN to GRCAL_DAY_MAX
+ * 
+ * Faults:
+ * 
+ *   - If fmt is not a valid format
+ * 
+ *   - If str is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If str is not null-terminated
+ */
+int32_t grcal_scanFormat(
+		int fmt,
+		const char *str,
+		const char **ppTrail,
+		SCANERR *pErr);
+
+/*
+ * Pack a Gregorian day offset into the decimal integer with digits
+ * YYYYMMDD, such as 20000101.
+ * 
+ * Parameters:
+ * 
+ *   offs - the Gregorian day offset
+ * 
+ * Return:
+ * 
+ *   the packed date
+ * 
+ * Faults:
+ * 
+ *   - If offs is out of range GRCAL_DAY_MIN to GRCAL_DAY_MAX
+ */
+int32_t grcal_packDate(int32_t offs);
+
+/*
+ * Unpack a decimal integer with digits YYYYMMDD into a Gregorian day
+ * offset.
+ * 
+ * Parameters:
+ * 
+ *   packed - the packed date
+ * 
+ * Return:
+ * 
+ *   the Gregorian day offset, or -1 if packed is not a valid date or is
+ *   out of range GRCAL_DAY_MIN to GRCAL_DAY_MAX
+ */
+int32_t grcal_unpackDate(int32_t packed);
+
+/*
+ * Find the ISO 8601 weekday of a Gregorian day offset.
+ * 
+ * Parameters:
+ * 
+ *   offs - the Gregorian day offset
+ * 
+ * Return:
+ * 
+ *   the weekday, from 1 for Monday up to 7 for Sunday
+ * 
+ * Faults:
+ * 
+ *   - If offs is out of range
+ */
+int32_t grcal_weekday(int32_t offs);
+
+/*
+ * Convert a Gregorian day offset into an ISO 8601 week date.
+ * 
+ * ISO weeks begin on Monday, and week one of a year is the week that
+ * contains January 4.  The first days of January may therefore belong
+ * to the last week of the previous week-numbering year, and the last
+ * days of December may belong to week one of the next.  Years have 52
+ * or 53 weeks.
+ * 
+ * Parameters:
+ * 
+ *   offs - the Gregorian day offset to convert
+ * 
+ *   pYear - pointer to the variable to receive the week-numbering year,
+ *   or NULL
+ * 
+ *   pWeek - pointer to the variable to receive the week, or NULL
+ * 
+ *   pWeekday - pointer to the variable to receive the weekday from 1
+ *   for Monday up to 7 for Sunday, or NULL
+ * 
+ * Faults:
+ * 
+ *   - If offs is out of range
+ */
+void grcal_offsetToWeekDate(
+		int32_t offs,
+		int32_t *pYear,
+		int32_t *pWeek,
+		int32_t *pWeekday);
+
+/*
+ * Convert an ISO 8601 week date into a Gregorian day offset.
+ * 
+ * The function fails if the week is not in the week-numbering year,
+ * the weekday is not in range 1 to 7, or the date is out of range of
+ * the Gregorian day offset (GRCAL_DAY_MIN to GRCAL_DAY_MAX).
+ * 
+ * Parameters:
+ * 
+ *   pOffs - pointer to the variable to receive the converted Gregorian
+ *   day offset, or NULL
+ * 
+ *   year - the week-numbering year
+ * 
+ *   week - the week of the year
+ * 
+ *   weekday - the weekday, from 1 for Monday up to 7 for Sunday
+ * 
+ * Return:
+ * 
+ *   true if successful, false if the week date is not valid
+ */
+bool grcal_weekDateToOffset(
+		int32_t *pOffs,
+		int32_t year,
+		int32_t week,
+		int32_t weekday);
+
+/*
+ * Convert a Gregorian day offset into an ISO 8601 ordinal date.
+ * 
+ * Parameters:
+ * 
+ *   offs - the Gregorian day offset to convert
+ * 
+ *   pYear - pointer to the variable to receive the Gregorian year, or
+ *   NULL
+ * 
+ *   pDayOfYear - pointer to the variable to receive the one-based day
+ *   of the year, or NULL
+ * 
+ * Faults:
+ * 
+ *   - If offs is out of range
+ */
+void grcal_offsetToOrdinal(
+		int32_t offs,
+		int32_t *pYear,
+		int32_t *pDayOfYear);
+
+/*
+ * Convert an ISO 8601 ordinal date into a Gregorian day offset.
+ * 
+ * The function fails if the day is not in the year, or the date is out
+ * of range of the Gregorian day offset (GRCAL_DAY_MIN to
+ * GRCAL_DAY_MAX).
+ * 
+ * Parameters:
+ * 
+ *   pOffs - pointer to the variable to receive the converted Gregorian
+ *   day offset, or NULL
+ * 
+ *   year - the Gregorian year
+ * 
+ *   dayofyear - the one-based day of the year
+ * 
+ * Return:
+ * 
+ *   true if successful, false if the ordinal date is not valid
+ */
+bool grcal_ordinalToOffset(
+		int32_t *pOffs,
+		int32_t year,
+		int32_t dayofyear);
+
+/*
+ * Write an ISO 8601 week date in YYYY-Www-D format into the given
+ * character buffer in ASCII format.
+ * 
+ * Exactly GRCAL_WEEKDATE_LENGTH characters are written.  No terminating
+ * null is written.
+ * 
+ * Parameters:
+ * 
+ *   pBuf - the buffer to write into
+ * 
+ *   offs - the Gregorian day offset to write
+ * 
+ * Faults:
+ * 
+ *   - If pBuf is NULL
+ * 
+ *   - If offs is out of range
+ * 
+ * Undefined behavior:
+ * 
+ *   - If pBuf has room for fewer than GRCAL_WEEKDATE_LENGTH characters
+ */
+void grcal_writeWeekDate(char *pBuf, int32_t offs);
+
+/*
+ * Write an ISO 8601 ordinal date in YYYY-DDD format into the given
+ * character buffer in ASCII format.
+ * 
+ * Exactly GRCAL_ORDINAL_LENGTH characters are written.  No terminating
+ * null is written.
+ * 
+ * Parameters:
+ * 
+ *   pBuf - the buffer to write into
+ * 
+ *   offs - the Gregorian day offset to write
+ * 
+ * Faults:
+ * 
+ *   - If pBuf is NULL
+ * 
+ *   - If offs is out of range
+ * 
+ * Undefined behavior:
+ * 
+ *   - If pBuf has room for fewer than GRCAL_ORDINAL_LENGTH characters
+ */
+void grcal_writeOrdinal(char *pBuf, int32_t offs);
+
+/*
+ * Parse an ISO 8601 week date in YYYY-Www-D format in a given ASCII
+ * string.
+ * 
+ * All fields must have exactly the number of digits shown, and the W
+ * must be uppercase.  The return value and the use of ppTrail are the
+ * same as for grcal_scanDate().  The function fails if the week date is
+ * not valid according to grcal_weekDateToOffset().  Errors are reported
+ * through pErr in the same way as grcal_scanDate(), with a week 53 in a
+ * year of 52 weeks reported as past the end of the year.
+ * 
+ * Parameters:
+ * 
+ *   str - the string to parse
+ * 
+ *   ppTrail - pointer to the pointer to be set to the character
+ *   following the date on successful return, or NULL
+ * 
+ *   pErr - the error to fill in if parsing fails, or NULL
+ * 
+ * Return:
+ * 
+ *   the Gregorian day offset, or -1 if parsing failed
+ * 
+ * Undefined behavior:
+ * 
+ *   - If the provided string is not null-terminated
+ */
+int32_t grcal_scanWeekDate(
+		const char *str,
+		const char **ppTrail,
+		SCANERR *pErr);
+
+/*
+ * Parse an ISO 8601 ordinal date in YYYY-DDD format in a given ASCII
+ * string.
+ * 
+ * Both fields must have exactly the number of digits shown, and the day
+ * field must not be followed by another decimal digit.  The return
+ * value and the use of ppTrail are the same as for grcal_scanDate().
+ * The function fails if the ordinal date is not valid according to
+ * grcal_ordinalToOffset().  Errors are reported through pErr in the
+ * same way as grcal_scanDate().
+ * 
+ * Parameters:
+ * 
+ *   str - the string to parse
+ * 
+ *   ppTrail - pointer to the pointer to be set to the character
+ *   following the date on successful return, or NULL
+ * 
+ *   pErr - the error to fill in if parsing fails, or NULL
+ * 
+ * Return:
+ * 
+ *   the Gregorian day offset, or -1 if parsing failed
+ * 
+ * Undefined behavior:
+ * 
+ *   - If the provided string is not null-terminated
+ */
+int32_t grcal_scanOrdinal(
+		const char *str,
+		const char **ppTrail,
+		SCANERR *pErr);
 
 #endif
@@ -0,0 +1,294 @@
+/*
+ * jdn.c
+ * 
+ * Implementation of jdn.h
+ * 
+ * See the header for further information.
+ */
+
+#include "jdn.h"
+#include <stdlib.h>
+#include <string.h>
+
+#include "decimal.h"
+#include "grcal.h"
+
+/*
+ * The day count of Gregorian day offset zero (1200-03-01) in each
+ * system, indexed by JDN_SYS constant.
+ */
+static const int32_t m_base[JDN_SYS_COUNT] = {
+	2159411, -240590, 437986
+};
+
+/*
+ * The fraction of a day from midnight to the start of the day in each
+ * system, indexed by JDN_SYS constant.  Julian Dates start at noon.
+ */
+static const double m_start[JDN_SYS_COUNT] = {
+	0.5, 0.0, 0.0
+};
+
+/*
+ * The name of each system in text form, indexed by JDN_SYS constant.
+ */
+static const char *m_names[JDN_SYS_COUNT] = {
+	"JD", "MJD", "RD"
+};
+
+/*
+ * jdn_fromGrcal function.
+ */
+int32_t jdn_fromGrcal(int sys, int32_t offs) {
+	
+	/* Check parameters */
+	if ((sys < 0) || (sys >= JDN_SYS_COUNT) ||
+			(offs < GRCAL_DAY_MIN) || (offs > GRCAL_DAY_MAX)) {
+		abort();
+	}
+	
+	return offs + m_base[sys];
+}
+
+/*
+ * jdn_toGrcal function.
+ */
+bool jdn_toGrcal(int sys, int32_t n, int32_t *pOffs) {
+	
+	bool result = true;
+	int32_t offs = 0;
+	
+	/* Check parameters */
+	if ((sys < 0) || (sys >= JDN_SYS_COUNT)) {
+		abort();
+	}
+	
+	/* Check the range before subtracting, so that the subtraction
+	 * can't overflow */
+	if ((n < GRCAL_DAY_MIN + m_base[sys]) ||
+			(n > GRCAL_DAY_MAX + m_base[sys])) {
+		result = false;
+	}
+	
+	if (result) {
+		offs = n - m_base[sys];
+		if (pOffs != NULL) {
+			*pOffs = offs;
+		}
+	}
+	
+	return result;
+}
+
+/*
+ * jdn_fromGrcalInstant function.
+ */
+double jdn_fromGrcalInstant(int sys, int32_t offs, double frac) {
+	
+	/* Check parameters */
+	if (!((frac >= 0.0) && (frac < 1.0))) {
+		abort();
+	}
+	
+	return ((double) jdn_fromGrcal(sys, offs)) - m_start[sys] + frac;
+}
+
+/*
+ * jdn_toGrcalInstant function.
+ */
+bool jdn_toGrcalInstant(
+		int sys,
+		double t,
+		int32_t *pOffs,
+		double *pFrac) {
+	
+	bool result = true;
+	double x = 0.0;
+	int32_t offs = 0;
+	
+	/* Check parameters */
+	if ((sys < 0) || (sys >= JDN_SYS_COUNT)) {
+		abort();
+	}
+	
+	/* Get the fractional Gregorian day offset, and check that it is in
+	 * range; the comparisons also fail if t is not a number */
+	x = t + m_start[sys] - (double) m_base[sys];
+	if (!((x >= (double) GRCAL_DAY_MIN) &&
+			(x < (double) GRCAL_DAY_MAX + 1.0))) {
+		result = false;
+	}
+	
+	/* Split into the day and the fraction; truncation rounds down
+	 * since the value is positive */
+	if (result) {
+		offs = (int32_t) x;
+		if (pOffs != NULL) {
+			*pOffs = offs;
+		}
+		if (pFrac != NULL) {
+			*pFrac = x - (double) offs;
+		}
+	}
+	
+	return result;
+}
+
+/*
+ * jdn_fromGrcalBatch function.
+ */
+void jdn_fromGrcalBatch(
+		int sys,
+		int32_t *pOut,
+		const int32_t *pOffs,
+		size_t count) {
+	
+	size_t i = 0;
+	int32_t base = 0;
+	int32_t ok = 0;
+	int32_t bad = 0;
+	
+	/* Check parameters */
+	if ((sys < 0) || (sys >= JDN_SYS_COUNT) ||
+			((count > 0) && ((pOut == NULL) || (pOffs == NULL)))) {
+		abort();
+	}
+	
+	/* Convert everything, and only then fault if anything was out of
+	 * range, which keeps the branch out of the loop; out-of-range
+	 * offsets are multiplied down to zero so the addition can't
+	 * overflow */
+	base = m_base[sys];
+	for(i = 0; i < count; i++) {
+		ok = (int32_t) (pOffs[i] >= GRCAL_DAY_MIN) &
+				(int32_t) (pOffs[i] <= GRCAL_DAY_MAX);
+		bad |= 1 - ok;
+		pOut[i] = (pOffs[i] * ok) + base;
+	}
+	if (bad) {
+		abort();
+	}
+}
+
+/*
+ * jdn_toGrcalBatch function.
+ */
+size_t jdn_toGrcalBatch(
+		int sys,
+		int32_t *pOffs,
+		const int32_t *pIn,
+		size_t count) {
+	
+	size_t result = 0;
+	size_t i = 0;
+	int32_t base = 0;
+	int32_t lo = 0;
+	int32_t hi = 0;
+	int32_t ok = 0;
+	
+	/* Check parameters */
+	if ((sys < 0) || (sys >= JDN_SYS_COUNT) ||
+			((count > 0) && ((pOffs == NULL) || (pIn == NULL)))) {
+		abort();
+	}
+	
+	/* Convert each count, multiplying out-of-range counts down to zero
+	 * so the subtraction can't overflow, and masking their results
+	 * to -1 */
+	base = m_base[sys];
+	lo = GRCAL_DAY_MIN + base;
+	hi = GRCAL_DAY_MAX + base;
+	for(i = 0; i < count; i++) {
+		ok = (int32_t) (pIn[i] >= lo) & (int32_t) (pIn[i] <= hi);
+		pOffs[i] = (((pIn[i] * ok) - (base * ok)) & -ok) | ~(-ok);
+		result += (size_t) ok;
+	}
+	
+	return result;
+}
+
+/*
+ * jdn_write function.
+ */
+size_t jdn_write(char *pBuf, int sys, int32_t offs) {
+	
+	size_t len = 0;
+	int32_t n = 0;
+	
+	/* Check parameters */
+	if (pBuf == NULL) {
+		abort();
+	}
+	
+	/* Convert first, which checks the system and the range */
+	n = jdn_fromGrcal(sys, offs);
+	
+	/* Write the name and the count */
+	len = strlen(m_names[sys]);
+	memcpy(pBuf, m_names[sys], len);
+	len += decimal_writeInt(pBuf + len, n, 1);
+	
+	return len;
+}
+
+/*
+ * jdn_scan function.
+ */
+int32_t jdn_scan(
+		const char *str,
+		int *pSys,
+		const char **ppTrail,
+		SCANERR *pErr) {
+	
+	int sys = -1;
+	int i = 0;
+	size_t len = 0;
+	int32_t n = 0;
+	int32_t offs = -1;
+	const char *pc = NULL;
+	
+	/* Check parameters */
+	if (str == NULL) {
+		abort();
+	}
+	
+	/* Find the system name; no name is a prefix of another, so at most
+	 * one of them matches */
+	for(i = 0; i < JDN_SYS_COUNT; i++) {
+		len = strlen(m_names[i]);
+		if (strncmp(str, m_names[i], len) == 0) {
+			sys = i;
+			break;
+		}
+	}
+	
+	/* Parse the count and convert it, recording why if either fails */
+	if (sys >= 0) {
+		if (decimal_scanInt(str + len, &n, &pc)) {
+			if (!jdn_toGrcal(sys, n, &offs)) {
+				scanerr_set(pErr, SCANERR_LIMIT, SCANERR_FIELD_COUNT,
+					(int32_t) len, n);
+				offs = -1;
+			}
+		} else {
+			scanerr_set(pErr,
+				(str[len] == 0) ? SCANERR_END : SCANERR_DIGIT,
+				SCANERR_FIELD_COUNT, (int32_t) len, 0);
+		}
+	
+	} else {
+		scanerr_set(pErr, SCANERR_FORMAT, SCANERR_FIELD_NONE, 0, 0);
+	}
+	
+	/* Report the system and the end of the count if successful */
+	if (offs != -1) {
+		if (pSys != NULL) {
+			*pSys = sys;
+		}
+		if (ppTrail != NULL) {
+			*ppTrail = pc;
+		}
+	}
+	
+	return offs;
+}
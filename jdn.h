@@ -0,0 +1,296 @@
+#ifndef JDN_H_INCLUDED
+#define JDN_H_INCLUDED
+
+/*
+ * jdn.h
+ * 
+ * Provides direct conversions between Gregorian day offsets (see
+ * grcal) and the day counts that other systems use to exchange dates:
+ * 
+ *   JD  - the Julian Day Number, where day 2451545 is 2000-01-01
+ *   MJD - the Modified Julian Day, where day 51544 is 2000-01-01
+ *   RD  - the Rata Die, where day 1 is 0001-01-01 proleptic Gregorian
+ * 
+ * Each system is a fixed displacement from Gregorian day offsets, so
+ * conversions are a single addition plus a range check.  NELSC
+ * absolute day offsets convert by adding NELSC_CYCLE_GROFFS first.
+ * 
+ * There are also fractional variants for instants within a day, with
+ * the day fraction counted from midnight.  Julian Dates begin at noon,
+ * so the Julian Date of midnight at the start of a day is half a day
+ * less than its Julian Day Number.  Modified Julian Dates and Rata Die
+ * moments begin at midnight.
+ * 
+ * In text, a day count is written as the name of its system directly
+ * followed by a signed decimal, such as JD2451545, MJD51544, or
+ * RD730120.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "scanerr.h"
+
+/*
+ * The day count systems.
+ */
+#define JDN_SYS_JD  0
+#define JDN_SYS_MJD 1
+#define JDN_SYS_RD  2
+
+/*
+ * The number of day count systems.
+ */
+#define JDN_SYS_COUNT 3
+
+/*
+ * The maximum number of characters written by jdn_write().
+ */
+#define JDN_MAXLEN 11
+
+/*
+ * Convert a Gregorian day offset into a day count.
+ * 
+ * Parameters:
+ * 
+ *   sys - the day count system, one of the JDN_SYS constants
+ * 
+ *   offs - the Gregorian day offset
+ * 
+ * Return:
+ * 
+ *   the day count
+ * 
+ * Faults:
+ * 
+ *   - If sys is not a valid system
+ * 
+ *   - If offs is out of range GRCAL_DAY_MIN to GRCAL_DAY_MAX
+ */
+int32_t jdn_fromGrcal(int sys, int32_t offs);
+
+/*
+ * Convert a day count into a Gregorian day offset.
+ * 
+ * Parameters:
+ * 
+ *   sys - the day count system, one of the JDN_SYS constants
+ * 
+ *   n - the day count
+ * 
+ *   pOffs - pointer to the variable to receive the Gregorian day
+ *   offset, or NULL
+ * 
+ * Return:
+ * 
+ *   true if successful, false if the day is outside the Gregorian
+ *   range GRCAL_DAY_MIN to GRCAL_DAY_MAX
+ * 
+ * Faults:
+ * 
+ *   - If sys is not a valid system
+ */
+bool jdn_toGrcal(int sys, int32_t n, int32_t *pOffs);
+
+/*
+ * Convert an instant given as a Gregorian day offset and a fraction of
+ * the day into a fractional day count.
+ * 
+ * Parameters:
+ * 
+ *   sys - the day count system, one of the JDN_SYS constants
+ * 
+ *   offs - the Gregorian day offset
+ * 
+ *   frac - the fraction of the day since midnight, zero or greater and
+ *   less than one
+ * 
+ * Return:
+ * 
+ *   the fractional day count
+ * 
+ * Faults:
+ * 
+ *   - If sys is not a valid system
+ * 
+ *   - If offs is out of range GRCAL_DAY_MIN to GRCAL_DAY_MAX
+ * 
+ *   - If frac is out of range
+ */
+double jdn_fromGrcalInstant(int sys, int32_t offs, double frac);
+
+/*
+ * Convert a fractional day count into a Gregorian day offset and the
+ * fraction of that day since midnight.
+ * 
+ * Parameters:
+ * 
+ *   sys - the day count system, one of the JDN_SYS constants
+ * 
+ *   t - the fractional day count
+ * 
+ *   pOffs - pointer to the variable to receive the Gregorian day
+ *   offset, or NULL
+ * 
+ *   pFrac - pointer to the variable to receive the fraction of the day,
+ *   or NULL
+ * 
+ * Return:
+ * 
+ *   true if successful, false if the instant is outside the Gregorian
+ *   range or t is not a number
+ * 
+ * Faults:
+ * 
+ *   - If sys is not a valid system
+ */
+bool jdn_toGrcalInstant(
+		int sys,
+		double t,
+		int32_t *pOffs,
+		double *pFrac);
+
+/*
+ * Convert an array of Gregorian day offsets into day counts.
+ * 
+ * Parameters:
+ * 
+ *   sys - the day count system, one of the JDN_SYS constants
+ * 
+ *   pOut - the array to receive the day counts
+ * 
+ *   pOffs - the array of Gregorian day offsets
+ * 
+ *   count - the number of elements in each array
+ * 
+ * Faults:
+ * 
+ *   - If sys is not a valid system
+ * 
+ *   - If count is greater than zero and either array is NULL
+ * 
+ *   - If any of the offsets is out of range
+ * 
+ * Undefined behavior:
+ * 
+ *   - If either array has fewer than count elements
+ */
+void jdn_fromGrcalBatch(
+		int sys,
+		int32_t *pOut,
+		const int32_t *pOffs,
+		size_t count);
+
+/*
+ * Convert an array of day counts into Gregorian day offsets.
+ * 
+ * Day counts outside the Gregorian range give -1.  The loop does not
+ * branch on the data, so that compilers can vectorize it.
+ * 
+ * Parameters:
+ * 
+ *   sys - the day count system, one of the JDN_SYS constants
+ * 
+ *   pOffs - the array to receive the Gregorian day offsets
+ * 
+ *   pIn - the array of day counts
+ * 
+ *   count - the number of elements in each array
+ * 
+ * Return:
+ * 
+ *   the number of day counts in range
+ * 
+ * Faults:
+ * 
+ *   - If sys is not a valid system
+ * 
+ *   - If count is greater than zero and either array is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If either array has fewer than count elements
+ */
+size_t jdn_toGrcalBatch(
+		int sys,
+		int32_t *pOffs,
+		const int32_t *pIn,
+		size_t count);
+
+/*
+ * Write a day count in text form, such as JD2451545.
+ * 
+ * At most JDN_MAXLEN characters are written.  No terminating null is
+ * written.
+ * 
+ * Parameters:
+ * 
+ *   pBuf - the buffer to write into
+ * 
+ *   sys - the day count system, one of the JDN_SYS constants
+ * 
+ *   offs - the Gregorian day offset to write
+ * 
+ * Return:
+ * 
+ *   the number of characters written
+ * 
+ * Faults:
+ * 
+ *   - If pBuf is NULL
+ * 
+ *   - If sys is not a valid system
+ * 
+ *   - If offs is out of range GRCAL_DAY_MIN to GRCAL_DAY_MAX
+ * 
+ * Undefined behavior:
+ * 
+ *   - If pBuf has room for fewer than JDN_MAXLEN characters
+ */
+size_t jdn_write(char *pBuf, int sys, int32_t offs);
+
+/*
+ * Parse a day count in text form, such as JD2451545, at the start of a
+ * null-terminated string.
+ * 
+ * The system name must be in uppercase and directly followed by an
+ * optional sign and the decimal digits.  Leading whitespace is not
+ * skipped.
+ * 
+ * If successful and pSys is not NULL, the system is written to *pSys.
+ * If successful and ppTrail is not NULL, *ppTrail is set to point to
+ * the character following the digits.  If parsing fails and pErr is
+ * not NULL, the reason and position are written to *pErr.
+ * 
+ * Parameters:
+ * 
+ *   str - the null-terminated string to parse
+ * 
+ *   pSys - pointer to the variable to receive the system, or NULL
+ * 
+ *   ppTrail - pointer to the pointer to set to the character after the
+ *   day count, or NULL
+ * 
+ *   pErr - the error to fill in if parsing fails, or NULL
+ * 
+ * Return:
+ * 
+ *   the Gregorian day offset, or -1 if there is no day count at the
+ *   start of the string or it is outside the Gregorian range
+ * 
+ * Faults:
+ * 
+ *   - If str is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If str is not null-terminated
+ */
+int32_t jdn_scan(
+		const char *str,
+		int *pSys,
+		const char **ppTrail,
+		SCANERR *pErr);
+
+#endif
@@ -5,18 +5,42 @@
  * "main" method.
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <ctype.h>
 #include <errno.h>
+#include <limits.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "base24.h"
+#include "decimal.h"
 #include "grcal.h"
+#include "jdn.h"
+#include "nelsc_arena.h"
 #include "nelsc_cycle.h"
+#include "nelsc_dayindex.h"
+#include "nelsc_detect.h"
+#include "nelsc_events.h"
+#include "nelsc_eytz.h"
 #include "nelsc_format.h"
+#include "nelsc_hist.h"
+#include "nelsc_pool.h"
+#include "nelsc_shm.h"
+#include "nelsc_simd.h"
+#include "nelsc_sink.h"
+#include "nelsc_sort.h"
+#include "nelsc_spsc.h"
+#include "nelsc_stats.h"
+#include "nelsc_strftime.h"
+#include "nelsc_table.h"
+#include "scanerr.h"
 
 /*
  * The day offset from the first day of the month that full moon week
@@ -53,614 +77,5942 @@
  */
 #define EQUINOX_DAY 20
 
-/* Local function prototypes */
-static const char *getCustom(int argc, char *argv[], int i);
-static int getCustomCount(int argc);
-static bool stringToLong(const char *str, long *pLong);
-static bool pairToLong(const char *str, long *pLong);
-static bool dateToOffset(const char *str, int32_t *pOffset);
+/*
+ * The number of months in each chunk of a full moon report that is
+ * printed in parallel.
+ */
+#define FULLMOON_CHUNK 512
 
-static void printDayInformation(int32_t day);
-static void fullMoons(int32_t mfirst, int32_t mlast);
+/*
+ * The number of years in each chunk of the new year report that is
+ * printed in parallel, and the resulting number of chunks.
+ */
+#define NEWYEAR_CHUNK 48
+#define NEWYEAR_CHUNKS \
+	(((NELSC_CYCLE_YEARMAX - NELSC_CYCLE_YEARMIN) / NEWYEAR_CHUNK) + 1)
 
-static int sub_help(void);
-static int sub_to24pair(int argc, char *argv[]);
-static int sub_from24pair(int argc, char *argv[]);
-static int sub_to24digit(int argc, char *argv[]);
-static int sub_from24digit(int argc, char *argv[]);
-static int sub_day(int argc, char *argv[]);
-static int sub_month(int argc, char *argv[]);
-static int sub_date(int argc, char *argv[]);
-static int sub_fullmoon(int argc, char *argv[]);
-static int sub_newyear(int argc, char *argv[]);
+/*
+ * The maximum number of characters in the report written by
+ * printDayInformation().
+ */
+#define DAYINFO_MAXLEN 256
 
 /*
- * Get the custom program argument with index i.
- * 
- * The first custom program argument is index zero.  If the requested
- * custom program argument index exceeds the number of custom program
- * arguments, then an empty string is returned.
- * 
- * The first custom program argument is the second element of argv --
- * the first element is assumed to be the module name.
- * 
- * Parameters:
- * 
- *   argc - the number of program arguments in argv
- * 
- *   argv - an array of null-terminated strings representing the program
- *   arguments, with argc elements; the first element is name of the
- *   program module, while the second element is the first custom
- *   argument (if it exists)
- * 
- *   i - the custom program argument to return, with zero corresponding
- *   to the first custom argument
- * 
- * Return:
- * 
- *   the null-terminated custom program argument, or an empty string if
- *   the requested argument does not exist
- * 
- * Faults:
- * 
- *   - If argc is negative
- * 
- *   - If argv is NULL
- * 
- *   - If any element of argv is NULL
- * 
- *   - If i is negative
+ * The maximum number of characters in a line of input to the convert
+ * subprogram, including the line feed and terminating null.
+ */
+#define CONVERT_LINE_MAX 256
+
+/*
+ * The number of dates that the convert subprogram decomposes and
+ * formats together in a single batch.
+ */
+#define CONVERT_BATCH 4096
+
+/*
+ * The initial size in bytes of the output buffer of each block in the
+ * convert pipeline.  The buffers grow as needed.
+ */
+#define CONVERT_OUTBUF 65536
+
+/*
+ * The size in bytes of the input buffer of each block in the convert
+ * pipeline, and the alignment of the input buffers.
+ */
+#define CONVERT_BLOCK_SIZE 262144
+#define CONVERT_ALIGN 4096
+
+/*
+ * The maximum number of converter threads in the convert pipeline.
+ */
+#define CONVERT_WORKERS_MAX 8
+
+/*
+ * The number of blocks in the convert pipeline for each converter
+ * thread.  Two more blocks are added so that the reader and the writer
+ * each have one to work on.
+ */
+#define CONVERT_BLOCKS_PER_WORKER 2
+
+/*
+ * The capacity of each queue in the convert pipeline.  This must be a
+ * power of two greater than the largest number of blocks, so that a
+ * queue can always hold all the blocks plus an end marker.
+ */
+#define CONVERT_QUEUE_CAP 32
+
+/*
+ * The outcomes of converting a block in the convert pipeline.
+ */
+#define CONVERT_OK        0
+#define CONVERT_ERR_PARSE 1
+#define CONVERT_ERR_LONG  2
+
+/*
+ * The most bytes a dead-letter record of the convert subprogram adds to
+ * the text of the line that failed, for its line index, error code,
+ * format name, and column.
+ */
+#define CONVERT_DEAD_EXTRA 64
+
+/*
+ * The least number of lines the error budget of the convert subprogram
+ * is measured against, so that a few failures at the start of the input
+ * don't stop the job before the error rate means anything.  At the end
+ * of input, the budget is measured against the actual number of lines.
+ */
+#define CONVERT_BUDGET_LINES 1000
+
+/*
+ * The default and greatest memory limits of the sort subprogram, in
+ * mebibytes.  The least limit is NELSC_SORT_MEM_MIN.
+ */
+#define SORT_MEM_DEFAULT 64
+#define SORT_MEM_MAX 65536
+
+/*
+ * The maximum length of a line read by the sort and join subprograms,
+ * including the line feed and the terminating null.
+ */
+#define RECORD_LINE_MAX NELSC_SORT_LINE_MAX
+
+/*
+ * The results of readRecord().
+ */
+#define RECORD_OK   0
+#define RECORD_END  1
+#define RECORD_FAIL 2
+
+/*
+ * The modes of the join subprogram.
+ */
+#define JOIN_AUTO  0
+#define JOIN_MERGE 1
+#define JOIN_HASH  2
+
+/*
+ * The maximum number of characters in a command line read by the batch
+ * subprogram, including the line feed and terminating null.
+ */
+#define BATCH_LINE_MAX 1024
+
+/*
+ * The maximum number of arguments on a command line read by the batch
+ * subprogram, including the subprogram name.
+ */
+#define BATCH_ARG_MAX 16
+
+/*
+ * The number of bytes of responses that the batch subprogram gathers
+ * before passing them on to the output sink.
+ */
+#define BATCH_OUTBUF 65536
+
+/*
+ * Value of arg_max in a SUBPROGRAM indicating that there is no upper
+ * limit on the number of additional arguments.
+ */
+#define ARGS_ANY (-1)
+
+/*
+ * The number of slots in the subprogram hash table.
  * 
- * Undefined behavior:
+ * This must be a power of two.  m_slots is generated from the names in
+ * SUBPROGRAM_NAMES when the program is compiled, and compiling fails if
+ * two names hash to the same slot.
+ */
+#define SUBPROGRAM_SLOTS 32
+
+/*
+ * The hash of a subprogram name of len characters, given its first
+ * character, its middle character at index len / 2, and its last
+ * character.  hashName() computes the same hash at run time.
+ */
+#define SUBPROGRAM_HASH(len, first, mid, last) \
+	((((len) * 2) + ((first) * 5) + (mid) + (last)) & \
+		(SUBPROGRAM_SLOTS - 1))
+
+/*
+ * The name of each subprogram, with its index in m_subprograms and the
+ * characters of the name that the hash reads.  C can't read the
+ * characters of a string literal in a constant expression, so they are
+ * given beside each name.
  * 
- *   - If argv has fewer elements than are indicated with argc
+ * Each entry is expanded with a macro X(index, name, first, mid, last)
+ * to generate m_slots and check it when the program is compiled.
+ */
+#define SUBPROGRAM_NAMES(X) \
+	X( 0, "help",        'h', 'l', 'p') \
+	X( 1, "to24pair",    't', 'p', 'r') \
+	X( 2, "from24pair",  'f', '4', 'r') \
+	X( 3, "to24digit",   't', 'd', 't') \
+	X( 4, "from24digit", 'f', '4', 't') \
+	X( 5, "day",         'd', 'a', 'y') \
+	X( 6, "month",       'm', 'n', 'h') \
+	X( 7, "date",        'd', 't', 'e') \
+	X( 8, "fullmoon",    'f', 'm', 'n') \
+	X( 9, "newyear",     'n', 'y', 'r') \
+	X(10, "convert",     'c', 'v', 't') \
+	X(11, "batch",       'b', 't', 'h') \
+	X(12, "stats",       's', 'a', 's') \
+	X(13, "shm",         's', 'h', 'm') \
+	X(14, "engines",     'e', 'i', 's') \
+	X(15, "sort",        's', 'r', 't') \
+	X(16, "join",        'j', 'i', 'n') \
+	X(17, "events",      'e', 'n', 's') \
+	X(18, "bench",       'b', 'n', 'h')
+
+/*
+ * Expansions of SUBPROGRAM_NAMES entries: the slot of a name, its slot
+ * initializer in m_slots, and terms that total the names, the bits of
+ * their slots, and the union of those bits.
+ */
+#define SLOT_OF(index, name, first, mid, last) \
+	SUBPROGRAM_HASH(sizeof(name) - 1, first, mid, last)
+#define SLOT_INIT(index, name, first, mid, last) \
+	[SLOT_OF(index, name, first, mid, last)] = (index) + 1,
+#define SLOT_COUNT(index, name, first, mid, last) + 1
+#define SLOT_SUM(index, name, first, mid, last) \
+	+ (1ULL << SLOT_OF(index, name, first, mid, last))
+#define SLOT_UNION(index, name, first, mid, last) \
+	| (1ULL << SLOT_OF(index, name, first, mid, last))
+
+/*
+ * The range of years that the grcal date checks cover, one year past
+ * the valid range in each direction, and the number of dates checked
+ * in each year, which covers months 0 up to 13 and days 0 up to 32.
+ */
+#define GRCAL_CHECK_YEAR_MIN 1199
+#define GRCAL_CHECK_YEAR_MAX 10000
+#define GRCAL_CHECK_DATES (14 * 33)
+
+/*
+ * The number of times the bench subprogram runs each lookup over all
+ * the days, keeping the fastest run, and the seed of the generator that
+ * shuffles the days into random order.
+ */
+#define BENCH_PASSES 5
+#define BENCH_SEED UINT32_C(0x9E3779B9)
+
+/*
+ * The alignment in bytes of the data of each lookup timed by the bench
+ * subprogram, which must suit the strictest of them.
+ */
+#define BENCH_ALIGN NELSC_EYTZ_ALIGN
+
+/*
+ * Pointer to a subprogram procedure.
  * 
- *   - If any string indicated by argv is not null-terminated
+ * All subprograms take the full program arguments, a sink to write
+ * output to, and a sink to write error messages to, and return
+ * EXIT_SUCCESS or EXIT_FAILURE.
  */
-static const char *getCustom(int argc, char *argv[], int i) {
+typedef int (*SUBPROGRAM_PROC)(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+
+/*
+ * A record in the subprogram registry.
+ */
+typedef struct {
 	
-	int x = 0;
-	char *result = NULL;
+	/*
+	 * The name of the subprogram, as given in the first custom
+	 * argument.
+	 */
+	const char *pName;
 	
-	/* Check arguments */
-	if ((argc < 0) || (argv == NULL) || (i < 0)) {
-		abort();
-	}
+	/*
+	 * The minimum number of additional arguments, not counting the
+	 * subprogram name.
+	 */
+	int arg_min;
 	
-	for(x = 0; x < argc; x++) {
-		if (argv[x] == NULL) {
-			abort();
-		}
-	}
+	/*
+	 * The maximum number of additional arguments, not counting the
+	 * subprogram name, or ARGS_ANY if there is no limit.
+	 */
+	int arg_max;
 	
-	/* Determine whether i is in range */
-	if (i < getCustomCount(argc)) {
-		/* i is in range -- read the custom argument */
-		result = argv[i + 1];
-	} else {
-		/* i is out of range -- return empty string */
-		result = "";
-	}
+	/*
+	 * Whether the subprogram is available within batch mode.
+	 */
+	bool batch;
 	
-	/* Return result */
-	return result;
-}
+	/*
+	 * The subprogram procedure.
+	 */
+	SUBPROGRAM_PROC proc;
+	
+	/*
+	 * The entry for this subprogram in the helpscreen, consisting of
+	 * lines that each end with a line feed.
+	 */
+	const char *pHelp;
+
+} SUBPROGRAM;
 
 /*
- * Get the total number of custom program arguments, given the argc
- * value that was passed to main.
- * 
- * The argc value is one greater than the custom program argument count,
- * because the first argument is the module name.
- * 
- * If argc is zero, zero is returned.
+ * Pointer to a function that prints one chunk of a report.
  * 
- * Parameters:
- * 
- *   argc - the number of program arguments
- * 
- * Return:
- * 
- *   the number of custom program arguments
- * 
- * Faults:
- * 
- *   - If argc is negative
+ * Used with runReport().  The function is called on a worker thread
+ * and must only write to the given sink and to data belonging to its
+ * own chunk.
  */
-static int getCustomCount(int argc) {
-	int result = 0;
-	
-	if (argc > 0) {
-		result = argc - 1;
-	} else if (argc == 0) {
-		result = 0;
-	} else {
-		abort();
-	}
-	
-	return result;
-}
+typedef void (*REPORT_CHUNK)(
+		void *pCustom, int32_t chunk, NELSC_SINK *pOut);
 
 /*
- * Convert the given null-terminated string representing a signed
- * integer in ASCII decimal into a long value.
- * 
- * If successful, the converted long value is stored to *pLong and true
- * is returned.  If the string could not be parsed, *pLong is unmodified
- * and false is returned.
- * 
- * Parameters:
- * 
- *   str - pointer to the string to convert
- * 
- *   pLong - pointer to the variable to receive the converted long value
- *   on success
- * 
- * Return:
- * 
- *   true if successful, false if parsing error
- * 
- * Faults:
- * 
- *   - If str is NULL
- * 
- *   - If pLong is NULL
- * 
- * Undefined behavior:
- * 
- *   - If str is not null-terminated
+ * A report being printed in parallel by runReport().
  */
-static bool stringToLong(const char *str, long *pLong) {
+typedef struct {
 	
-	bool result = true;
-	long i = 0;
-	char *endptr = NULL;
+	/*
+	 * The function that prints a chunk.
+	 */
+	REPORT_CHUNK fn;
 	
-	/* Check parameters */
-	if ((str == NULL) || (pLong == NULL)) {
-		abort();
-	}
+	/*
+	 * Custom data passed through to fn.
+	 */
+	void *pCustom;
 	
-	/* Attempt to convert the string as a base-10 decimal */
-	errno = 0;
-	i = strtol(str, &endptr, 10);
+	/*
+	 * The buffer sink for each chunk.
+	 */
+	NELSC_SINK **ppSinks;
+
+} REPORT_JOB;
+
+/*
+ * A full moon report being printed by fullMoons().
+ */
+typedef struct {
 	
-	/* Check for parsing error */
-	if (errno != 0) {
-		result = false;
-	}
+	/*
+	 * The first month of the report.
+	 */
+	int32_t mfirst;
 	
-	/* If endptr equals original string, it means parameter was empty,
-	 * so fail */
-	if (result) {
-		if (endptr == str) {
-			result = false;
-		}
-	}
+	/*
+	 * The last month of the report.
+	 */
+	int32_t mlast;
+
+} FULLMOON_JOB;
+
+/*
+ * Statistics gathered over the years of a new year report.
+ */
+typedef struct {
 	
-	/* Make sure the unconverted part of the argument is either empty or
-	 * consists only of whitespace */
-	if (result) {
-		while(*endptr != 0) {
-			if (!isspace(*endptr)) {
-				result = false;
-				break;
-			}
-			endptr++;
-		}
-	}
+	/*
+	 * The minimum and maximum equinox month offsets.
+	 */
+	int32_t min_drift;
+	int32_t max_drift;
 	
-	/* If successful, write the result */
-	if (result) {
-		*pLong = i;
-	}
+	/*
+	 * The earliest Gregorian month and day of the first day of a year.
+	 */
+	int32_t earliest_month;
+	int32_t earliest_day;
 	
-	/* Return the status */
-	return result;
-}
+	/*
+	 * The latest Gregorian month and day of the first day of a year.
+	 */
+	int32_t latest_month;
+	int32_t latest_day;
+
+} NEWYEAR_STATS;
+
 
 /*
- * Convert the given null-terminated string representing a signed
- * base-24 pair in ASCII into a long value.
- * 
- * If successful, the converted long value is stored to *pLong and true
- * is returned.  If the string could not be parsed, *pLong is unmodified
- * and false is returned.
- * 
- * Parameters:
+ * A block of input lines passing through the convert pipeline, along
+ * with the converted output for those lines.
+ * 
+ * Blocks go from the reader to a converter, from the converter to the
+ * writer, and from the writer back to the reader, so that only one
+ * thread uses a block at a time.
+ */
+typedef struct {
+	
+	/*
+	 * The input buffer, CONVERT_BLOCK_SIZE bytes aligned to
+	 * CONVERT_ALIGN.
+	 */
+	char *pIn;
+	
+	/*
+	 * The number of input bytes in the block.  Unless final is set, the
+	 * block holds only complete lines, or one partial line that filled
+	 * the whole block.  If failed lines are dead-lettered, the reader
+	 * drops the rest of such a partial line.
+	 */
+	size_t in_len;
+	
+	/*
+	 * Whether this is the last block of input, in which case the last
+	 * line may lack a line feed.
+	 */
+	bool final;
+	
+	/*
+	 * The output buffer.
+	 */
+	char *pOut;
+	
+	/*
+	 * The number of output bytes in the block.
+	 */
+	size_t out_len;
+	
+	/*
+	 * The number of bytes allocated for pOut.
+	 */
+	size_t out_cap;
+	
+	/*
+	 * The number of lines that were consumed from the input buffer,
+	 * either converted into the output buffer or, if dead-lettering,
+	 * recorded in the dead-letter buffer.
+	 */
+	long lines;
+	
+	/*
+	 * The dead-letter buffer, its length in bytes, and the number of
+	 * bytes allocated for it, which is zero until the first failed
+	 * line.  Each record is the index of the line within the block as
+	 * an int32_t and the number of output bytes before the line as a
+	 * size_t, followed by the error code, format, column, and text of
+	 * the line, separated by tabs and ending with a line feed.
+	 */
+	char *pDead;
+	size_t dead_len;
+	size_t dead_cap;
+	
+	/*
+	 * The number of records in the dead-letter buffer.
+	 */
+	long dead;
+	
+	/*
+	 * The number of converted lines in each format, indexed by
+	 * NELSC_DETECT constant.
+	 */
+	uint64_t formats[NELSC_DETECT_COUNT];
+	
+	/*
+	 * CONVERT_OK if all lines were converted, otherwise the error that
+	 * stopped conversion at the line following the converted lines.
+	 */
+	int err;
+	
+	/*
+	 * If err is CONVERT_ERR_PARSE, the parse error of the line and the
+	 * NELSC_DETECT constant of its format, as reported by the parser
+	 * that failed.
+	 */
+	SCANERR scan_err;
+	int err_format;
+
+} CONVERT_BLOCK;
+
+/*
+ * The shared state of the convert pipeline.
+ * 
+ * One reader thread fills blocks from standard input and hands them out
+ * to the converter threads in turn.  The thread running the convert
+ * subprogram is the writer, which collects the converted blocks from
+ * the converters in the same turn order, so output stays in input
+ * order.  Each connection is a separate single-producer,
+ * single-consumer queue.
+ */
+typedef struct {
+	
+	/*
+	 * The compiled output format.
+	 */
+	const NELSC_STRFTIME *pFmt;
+	
+	/*
+	 * The GRCAL_FORMAT constant of the input format, or -1 to detect
+	 * the format of each line.
+	 */
+	int in_fmt;
+	
+	/*
+	 * Whether lines that fail to parse are recorded in the dead-letter
+	 * buffers of their blocks instead of stopping the conversion.
+	 */
+	bool dead_letter;
+	
+	/*
+	 * The number of converter threads.
+	 */
+	int32_t workers;
+	
+	/*
+	 * Queue of free blocks, from the writer to the reader.
+	 */
+	NELSC_SPSC *pFree;
+	
+	/*
+	 * Queues of filled blocks, from the reader to each converter.
+	 */
+	NELSC_SPSC *pWork[CONVERT_WORKERS_MAX];
+	
+	/*
+	 * Queues of converted blocks, from each converter to the writer.
+	 */
+	NELSC_SPSC *pDone[CONVERT_WORKERS_MAX];
+	
+	/*
+	 * Set by the writer when an error stops the conversion.  Accessed
+	 * with atomic operations.
+	 */
+	int stop;
+	
+	/*
+	 * Set by the reader if reading standard input failed.  Only read
+	 * after the reader has been joined.
+	 */
+	bool read_error;
+
+} CONVERT_PIPE;
+
+/*
+ * The start parameter of a converter thread.
+ */
+typedef struct {
+	
+	/*
+	 * The pipeline.
+	 */
+	CONVERT_PIPE *pPipe;
+	
+	/*
+	 * The index of the converter, which selects its queues.
+	 */
+	int32_t index;
+
+} CONVERT_WORKER;
+
+/*
+ * Statistics about the commands of a single subprogram run in batch
+ * mode.
+ */
+typedef struct {
+	
+	/*
+	 * Histogram of the time taken by each command, in nanoseconds.
+	 */
+	NELSC_HIST *pLatency;
+	
+	/*
+	 * The number of commands run, and how many of them failed.
+	 */
+	uint64_t requests;
+	uint64_t errors;
+
+} BATCH_COMMAND;
+
+/*
+ * Statistics about the batch session in progress.
+ */
+typedef struct {
+	
+	/*
+	 * The statistics of each subprogram, with the same indices as
+	 * m_subprograms, or NULL if no batch session is in progress.
+	 */
+	BATCH_COMMAND *pCommands;
+	
+	/*
+	 * The number of command lines run, including those that didn't
+	 * name a known subprogram, and how many of them failed.
+	 */
+	uint64_t requests;
+	uint64_t errors;
+	
+	/*
+	 * The number of bytes of command lines read and of responses
+	 * produced.
+	 */
+	uint64_t bytes_in;
+	uint64_t bytes_out;
+	
+	/*
+	 * The number of bytes of responses gathered but not yet written,
+	 * and the largest this has been.
+	 */
+	uint64_t pending;
+	uint64_t max_pending;
+
+} BATCH_STATS;
+
+/*
+ * Pointer to a function that checks an alternative calendar engine
+ * against its reference implementation over the whole range of inputs.
+ * 
+ * The number of inputs checked is written to *pCount.  If a mismatch
+ * is found, the first input that gives a different result is written
+ * to *pBad and false is returned.
+ */
+typedef bool (*ENGINE_CHECK)(int32_t *pCount, int32_t *pBad);
+
+/*
+ * Record of an alternative calendar engine in the engine registry.
+ */
+typedef struct {
+	
+	/*
+	 * The name of the engine and the name of the reference
+	 * implementation it must agree with.
+	 */
+	const char *pName;
+	const char *pRef;
+	
+	/*
+	 * The function that checks the engine against the reference.
+	 */
+	ENGINE_CHECK check;
+
+} ENGINE;
+
+/*
+ * Pointer to a function that prepares the data of a month lookup in
+ * the memory at pData.
+ */
+typedef void (*LOOKUP_BUILD)(void *pData);
+
+/*
+ * Pointer to a function that finds the NELSC month containing day
+ * offset d using the data at pData, with the same results as
+ * nelsc_cycle_dayToMonth().
+ */
+typedef int32_t (*LOOKUP_FIND)(
+		const void *pData, int32_t d, int32_t *pOffset);
+
+/*
+ * Record of a month lookup in the registry timed by the bench
+ * subprogram.
+ */
+typedef struct {
+	
+	/*
+	 * The name of the lookup.
+	 */
+	const char *pName;
+	
+	/*
+	 * The number of bytes of data the lookup needs, which are aligned
+	 * to BENCH_ALIGN, and the function that prepares them, which is
+	 * NULL if the lookup needs no data.
+	 */
+	size_t data_size;
+	LOOKUP_BUILD build;
+	
+	/*
+	 * The function that performs the lookup.
+	 */
+	LOOKUP_FIND find;
+
+} LOOKUP;
+
+/* Local function prototypes */
+static const char *getCustom(int argc, char *argv[], int i);
+static int getCustomCount(int argc);
+static bool stringToLong(const char *str, long *pLong);
+static bool stringToPercent(const char *str, double *pPercent);
+static bool pairToLong(const char *str, long *pLong);
+static bool dateToOffset(
+		const char *str,
+		int fmt,
+		int32_t *pOffset,
+		int *pDetected,
+		SCANERR *pErr);
+static size_t appendString(char *pBuf, const char *str);
+static void writePair(NELSC_SINK *pOut, int32_t v);
+static void writeGrDate(
+		NELSC_SINK *pOut, int32_t y, int32_t m, int32_t d);
+
+static void printDayInformation(NELSC_SINK *pOut, int32_t day);
+static NELSC_POOL *getPool(void);
+static void reportTask(void *pCustom, int32_t chunk);
+static void runReport(
+		NELSC_SINK *pOut,
+		int32_t chunks,
+		REPORT_CHUNK fn,
+		void *pCustom);
+
+static void fullMoonWeek(int32_t m, int32_t *pBegin, int32_t *pEnd);
+static void fullMoonRange(
+		NELSC_SINK *pOut, int32_t mfirst, int32_t mlast, bool first);
+static void fullMoonChunk(
+		void *pCustom, int32_t chunk, NELSC_SINK *pOut);
+static void fullMoons(NELSC_SINK *pOut, int32_t mfirst, int32_t mlast);
+static void newYearRange(
+		NELSC_SINK *pOut,
+		int32_t yfirst,
+		int32_t ylast,
+		NEWYEAR_STATS *pStats);
+static void newYearChunk(
+		void *pCustom, int32_t chunk, NELSC_SINK *pOut);
+
+static int32_t convertWorkers(void);
+static void convertFormat(
+		const NELSC_STRFTIME *pFmt,
+		CONVERT_BLOCK *pBlock,
+		const int32_t *pDays,
+		NELSC_STRFTIME_DATE *pDates,
+		size_t count);
+static void convertBlock(
+		const NELSC_STRFTIME *pFmt,
+		int in_fmt,
+		bool dead_letter,
+		CONVERT_BLOCK *pBlock,
+		int32_t *pDays,
+		NELSC_STRFTIME_DATE *pDates);
+static void convertDeadLetter(
+		CONVERT_BLOCK *pBlock,
+		const char *pLine,
+		size_t len,
+		int detected,
+		const SCANERR *pErr);
+static void *convertReader(void *pParam);
+static void *convertWorker(void *pParam);
+static void convertDiagnose(
+		NELSC_SINK *pErr,
+		const CONVERT_BLOCK *pBlock,
+		long line);
+static bool convertWriteBlock(
+		NELSC_SINK *pOut,
+		NELSC_SINK *pDead,
+		const CONVERT_BLOCK *pBlock,
+		double budget,
+		long *pLines,
+		long *pFailed);
+static void recordWhere(
+		NELSC_SINK *pErr,
+		const char *pName,
+		long line_num);
+static int readRecord(
+		FILE *pIn,
+		const char *pName,
+		char *pLine,
+		size_t cap,
+		long *pLineNum,
+		size_t *pLen,
+		int32_t *pOffs,
+		NELSC_SINK *pErr);
+static void joinWrite(
+		NELSC_SINK *pOut,
+		const char *pLeft,
+		size_t left_len,
+		const char *pRight,
+		size_t right_len);
+static int joinNext(
+		FILE *pIn,
+		const char *pName,
+		char *pLine,
+		long *pLineNum,
+		size_t *pLen,
+		int32_t *pOffs,
+		bool *pUnsorted,
+		NELSC_SINK *pErr);
+static bool joinCheckSorted(
+		FILE *pIn,
+		const char *pName,
+		char *pLine,
+		bool *pSorted,
+		NELSC_SINK *pErr);
+static NELSC_DAYINDEX *joinIndex(
+		FILE *pIn,
+		const char *pName,
+		char *pLine,
+		NELSC_SINK *pErr);
+static void joinProbe(
+		NELSC_SINK *pOut,
+		const NELSC_DAYINDEX *pIndex,
+		const char *pLine,
+		size_t len,
+		int32_t offs);
+static bool joinStream(
+		const NELSC_DAYINDEX *pIndex,
+		FILE *pLeft,
+		const char *pLeftName,
+		char *pLine,
+		long *pLineNum,
+		NELSC_SINK *pOut,
+		NELSC_SINK *pErr);
+static bool joinMerge(
+		FILE *pLeft,
+		const char *pLeftName,
+		FILE *pRight,
+		const char *pRightName,
+		char *pLine,
+		bool fall_back,
+		NELSC_SINK *pOut,
+		NELSC_SINK *pErr);
+static bool joinHash(
+		FILE *pLeft,
+		const char *pLeftName,
+		FILE *pRight,
+		const char *pRightName,
+		char *pLine,
+		NELSC_SINK *pOut,
+		NELSC_SINK *pErr);
+static bool eventsBuild(
+		const char *pStore,
+		const char *pInName,
+		NELSC_SINK *pErr);
+static void eventsWrite(
+		NELSC_SINK *pOut,
+		const NELSC_EVENTS *pEvents,
+		int32_t first,
+		int32_t count);
+static uint64_t batchClock(void);
+static void batchBegin(void);
+static void batchEnd(void);
+static bool checkGrcalAffine(int32_t *pCount, int32_t *pBad);
+static bool checkGrcalTables(int32_t *pCount, int32_t *pBad);
+static bool checkNelscTable(int32_t *pCount, int32_t *pBad);
+static bool checkNelscEytz(int32_t *pCount, int32_t *pBad);
+static bool checkNelscSimd(int32_t *pCount, int32_t *pBad);
+static bool checkNelscKeys(int32_t *pCount, int32_t *pBad);
+static void buildTable(void *pData);
+static void buildEytz(void *pData);
+static void buildSimd(void *pData);
+static int32_t findCycle(
+		const void *pData, int32_t d, int32_t *pOffset);
+static int32_t findTable(
+		const void *pData, int32_t d, int32_t *pOffset);
+static int32_t findEytz(
+		const void *pData, int32_t d, int32_t *pOffset);
+static int32_t findSimd(
+		const void *pData, int32_t d, int32_t *pOffset);
+static uint64_t benchRun(
+		const LOOKUP *pLookup,
+		const void *pData,
+		const int32_t *pDays,
+		int32_t count,
+		int64_t *pSum);
+static int sub_help(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+static int sub_to24pair(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+static int sub_from24pair(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+static int sub_to24digit(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+static int sub_from24digit(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+static int sub_day(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+static int sub_month(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+static int sub_date(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+static int sub_fullmoon(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+static int sub_newyear(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+static int sub_convert(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+static int sub_batch(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+static int sub_stats(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+static int sub_shm(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+static int sub_engines(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+static int sub_sort(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+static int sub_join(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+static int sub_events(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+static int sub_bench(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr);
+
+static size_t hashName(const char *pName);
+static const SUBPROGRAM *findSubprogram(const char *pName);
+static void reportArgCount(NELSC_SINK *pErr, const SUBPROGRAM *pSub);
+static int dispatch(
+		int argc, char *argv[], 
+		NELSC_SINK *pOut, NELSC_SINK *pErr, bool batch);
+
+/*
+ * The thread pool used for printing reports in parallel, or NULL if it
+ * hasn't been created yet.
+ * 
+ * Use getPool() to access this.
+ */
+static NELSC_POOL *m_pool = NULL;
+
+/*
+ * The statistics of the batch session in progress, which the stats
+ * subprogram reports.
+ */
+static BATCH_STATS m_batch;
+
+/*
+ * The subprogram registry.
+ * 
+ * Subprograms are listed in the order they appear on the helpscreen.
+ */
+static const SUBPROGRAM m_subprograms[] = {
+	{"help", 0, ARGS_ANY, true, &sub_help,
+"  help - show this helpscreen.\n"
+	},
+	{"to24pair", 1, 1, true, &sub_to24pair,
+"  to24pair [i] - convert signed decimal integer i into a base-24\n"
+"  pair in signed style.\n"
+	},
+	{"from24pair", 1, 1, true, &sub_from24pair,
+"  from24pair [p] - convert base-24 pair i in signed style into a\n"
+"  signed decimal integer.  p must have exactly two base-24 digits.\n"
+	},
+	{"to24digit", 1, 1, true, &sub_to24digit,
+"  to24digit [i] - convert integer i into an unsigned base-24 digit.\n"
+"  i must be in range 0-23.\n"
+	},
+	{"from24digit", 1, 1, true, &sub_from24digit,
+"  from24digit [d] - convert base-24 digit d into a decimal integer.\n"
+"  d must contain only one base-24 digit.\n"
+	},
+	{"day", 1, 1, true, &sub_day,
+"  day [d] - provide information about the day indicated by NELSC\n"
+"  absolute day offset d.\n"
+	},
+	{"month", 1, 1, true, &sub_month,
+"  month [m] - provide information about the first day of the month\n"
+"  indicated by NELSC absolute month offset m.\n"
+	},
+	{"date", 1, 1, true, &sub_date,
+"  date [d] - provide information about a particular calendar date.\n"
+"  The parameter d must be a NELSC date in 3T:C4-7 format, a\n"
+"  Gregorian date in YYYY-MM-DD format, an ISO 8601 week date in\n"
+"  YYYY-Www-D format or ordinal date in YYYY-DDD format, or a Julian\n"
+"  Day Number, Modified Julian Day, or Rata Die such as JD2451545,\n"
+"  MJD51544, or RD730120.\n"
+	},
+	{"fullmoon", 2, 2, true, &sub_fullmoon,
+"  fullmoon [m1] [m2] - return the Gregorian dates of the full moon\n"
+"  weeks in NELSC from NELSC absolute month offset m1 up to m2.  The\n"
+"  full moon does not always actually happen in the full moon week.\n"
+	},
+	{"newyear", 0, 0, true, &sub_newyear,
+"  newyear - create a chart of all NELSC years and the Gregorian date\n"
+"  of the first day of the year for each year, along with minimum and\n"
+"  maximum Gregorian month and day for the first day of the year, and\n"
+"  for each year the offset from the first month that March 20\n"
+"  (an approximation of the equinox) happens.\n"
+	},
+	{"convert", 1, 4, false, &sub_convert,
+"  convert [f] [in] [dl] [max] - read calendar dates (NELSC,\n"
+"  Gregorian, ISO week or ordinal, or day counts such as\n"
+"  JD2451545), one per line, from standard input and write each to\n"
+"  standard output using the layout given by format string f.\n"
+"  Gregorian dates may be in YYYY-MM-DD, YYYYMMDD, YYYY/MM/DD, or\n"
+"  DD.MM.YYYY format; with in as \"iso\", \"compact\", \"slash\", or\n"
+"  \"dotted\", every line must be in that one format.  Format\n"
+"  conversions include %N (NELSC date), %Y/%y (year as\n"
+"  base-24/decimal), %M/%m (month as base-24/decimal), %W (week),\n"
+"  %w (day of week), %d (day of month), %D (absolute day), %A\n"
+"  (absolute month), %F (Gregorian date), %K, %L, %P (Gregorian\n"
+"  date as YYYYMMDD, YYYY/MM/DD, DD.MM.YYYY), %G, %O, %E (Gregorian\n"
+"  year, month, day), %J (Julian Day Number), %j (Modified Julian\n"
+"  Day), %R (Rata Die), %V (ISO week date), %v (ISO ordinal date),\n"
+"  %k (NELSC sort key in hexadecimal), %n, %t, and %%.  A \"-\"\n"
+"  after the percent sign suppresses zero padding of %m, %d, %O,\n"
+"  and %E.  A line that fails to parse stops the conversion and is\n"
+"  reported with the column and the reason.  If a dead-letter file\n"
+"  dl is given (with in as \"auto\" to detect formats), failed lines\n"
+"  are instead written to dl with their line number, error code,\n"
+"  format, and column, and conversion goes on unless more than max\n"
+"  percent of the lines fail (default 100, fractions such as 0.5\n"
+"  allowed), in which case it stops at the line that went over.\n"
+"  Lines that are too long are written to dl cut short, with the\n"
+"  code \"long\".\n"
+	},
+	{"batch", 0, 1, false, &sub_batch,
+"  batch [flush] - read command lines from standard input, one per\n"
+"  line, and run each of them within this process.  Each response is\n"
+"  terminated by a line with \"=\" and the exit status of the\n"
+"  command.  Blank lines and lines starting with \"#\" are skipped\n"
+"  and get no response.  With \"flush\", output is flushed after\n"
+"  each response.\n"
+	},
+	{"stats", 0, 1, true, &sub_stats,
+"  stats [reset] - within batch mode, report the number of commands\n"
+"  run, failures, bytes in and out, and latency percentiles of each\n"
+"  subprogram.  With \"reset\", the statistics are then cleared.\n"
+	},
+	{"shm", 1, 2, false, &sub_shm,
+"  shm [c] [name] - with c as \"publish\", place the precomputed\n"
+"  cycle tables in POSIX shared memory segment name (default\n"
+"  \"/nelsc\") for other processes to map read-only; with \"check\",\n"
+"  verify the published tables; with \"unlink\", remove the segment.\n"
+	},
+	{"engines", 0, 0, true, &sub_engines,
+"  engines - check each alternative calendar engine against its\n"
+"  reference implementation over every input in its range.\n"
+	},
+	{"sort", 0, 1, false, &sub_sort,
+"  sort [mem] - read records from standard input, one per line, each\n"
+"  starting with a calendar date in any format that convert reads,\n"
+"  and write them to standard output in order of date, keeping the\n"
+"  input order of records with the same date.  At most about mem\n"
+"  mebibytes of memory are used (default 64, at least 4); larger\n"
+"  inputs are sorted in runs that are spilled to temporary files\n"
+"  and then merged.\n"
+	},
+	{"join", 2, 3, false, &sub_join,
+"  join l r [mode] - join the records in files l and r, each a line\n"
+"  starting with a calendar date in any format that convert reads,\n"
+"  writing the two records of each pair with the same date on one\n"
+"  line, separated by a tab.  The left file may be \"-\" for standard\n"
+"  input.  With mode \"merge\", both files must be sorted by date and\n"
+"  are read once in step; with \"hash\", r is loaded into memory\n"
+"  indexed by day and l may be in any order, so r should be the\n"
+"  smaller file.  With \"auto\", the default, hash is used if r is\n"
+"  not sorted; otherwise the files are merged, and if l turns out\n"
+"  not to be sorted, the rest of l is joined as with hash.  l is\n"
+"  read only once, so it may be a pipe.\n"
+	},
+	{"events", 2, 4, true, &sub_events,
+"  events c s [a] [b] - with c as \"build\", lay out the events in\n"
+"  file a, one per line each starting with a calendar date, as an\n"
+"  event store in file s that is indexed by day; with \"day\", write\n"
+"  the events on date a from store s; with \"range\", write the\n"
+"  events from date a to date b; with \"verify\", check all of store\n"
+"  s.  Stores are mapped into memory rather than read, so a query\n"
+"  takes the same time whatever their size.\n"
+	},
+	{"bench", 0, 0, true, &sub_bench,
+"  bench - time each way of finding the month that contains a day,\n"
+"  over every NELSC day in order and in random order, and report\n"
+"  the nanoseconds per lookup and the bytes of data each one uses.\n"
+	}
+};
+
+/*
+ * The number of records in m_subprograms.
+ */
+#define SUBPROGRAM_COUNT \
+	((int) (sizeof(m_subprograms) / sizeof(m_subprograms[0])))
+
+/*
+ * Perfect hash table for looking up subprograms by name.
+ * 
+ * Each slot holds one more than the index within m_subprograms of the
+ * subprogram whose name hashes to that slot with hashName(), or zero if
+ * no name hashes to the slot.  No two registered names share a slot, so
+ * a lookup needs only one string comparison.
+ */
+static const int8_t m_slots[SUBPROGRAM_SLOTS] = {
+	SUBPROGRAM_NAMES(SLOT_INIT)
+};
+
+/*
+ * Compile-time checks of m_slots: SUBPROGRAM_NAMES must list every
+ * subprogram, and the bits of the slots only total their union if no
+ * two names share a slot.  A failed check declares an array of negative
+ * size.
+ */
+typedef char SLOTS_COMPLETE_CHECK[
+	((0 SUBPROGRAM_NAMES(SLOT_COUNT)) == SUBPROGRAM_COUNT) ? 1 : -1];
+typedef char SLOTS_DISTINCT_CHECK[
+	((0ULL SUBPROGRAM_NAMES(SLOT_SUM)) ==
+		(0ULL SUBPROGRAM_NAMES(SLOT_UNION))) ? 1 : -1];
+
+/*
+ * The registry of alternative calendar engines, each of which is
+ * checked against its reference by the engines subprogram.
+ */
+static const ENGINE m_engines[] = {
+	{"grcal affine", "grcal cascade", &checkGrcalAffine},
+	{"grcal tables", "grcal cascade", &checkGrcalTables},
+	{"nelsc table", "nelsc cycle", &checkNelscTable},
+	{"nelsc eytzinger", "nelsc cycle", &checkNelscEytz},
+	{"nelsc simd", "nelsc cycle", &checkNelscSimd},
+	{"nelsc keys", "nelsc format", &checkNelscKeys}
+};
+
+/*
+ * The number of records in m_engines.
+ */
+#define ENGINE_COUNT ((int) (sizeof(m_engines) / sizeof(m_engines[0])))
+
+/*
+ * The registry of month lookups timed by the bench subprogram.  The
+ * first is the pattern walk of nelsc_cycle, which the others are
+ * compared with.
+ */
+static const LOOKUP m_lookups[] = {
+	{"cycle walk", 0, NULL, &findCycle},
+	{"table index", sizeof(NELSC_TABLE), &buildTable, &findTable},
+	{"eytzinger", sizeof(NELSC_EYTZ), &buildEytz, &findEytz},
+	{"simd pattern", sizeof(NELSC_SIMD), &buildSimd, &findSimd}
+};
+
+/*
+ * The number of records in m_lookups.
+ */
+#define LOOKUP_COUNT ((int) (sizeof(m_lookups) / sizeof(m_lookups[0])))
+
+/*
+ * The NELSC_DETECT constant of each fixed-width Gregorian format,
+ * indexed by GRCAL_FORMAT constant.
+ */
+static const int m_grcal_formats[GRCAL_FORMAT_COUNT] = {
+	NELSC_DETECT_GREGORIAN, NELSC_DETECT_COMPACT, NELSC_DETECT_SLASH,
+	NELSC_DETECT_DOTTED
+};
+
+/*
+ * Get the custom program argument with index i.
+ * 
+ * The first custom program argument is index zero.  If the requested
+ * custom program argument index exceeds the number of custom program
+ * arguments, then an empty string is returned.
+ * 
+ * The first custom program argument is the second element of argv --
+ * the first element is assumed to be the module name.
+ * 
+ * Parameters:
+ * 
+ *   argc - the number of program arguments in argv
+ * 
+ *   argv - an array of null-terminated strings representing the program
+ *   arguments, with argc elements; the first element is name of the
+ *   program module, while the second element is the first custom
+ *   argument (if it exists)
+ * 
+ *   i - the custom program argument to return, with zero corresponding
+ *   to the first custom argument
+ * 
+ * Return:
+ * 
+ *   the null-terminated custom program argument, or an empty string if
+ *   the requested argument does not exist
+ * 
+ * Faults:
+ * 
+ *   - If argc is negative
+ * 
+ *   - If argv is NULL
+ * 
+ *   - If any element of argv is NULL
+ * 
+ *   - If i is negative
+ * 
+ * Undefined behavior:
+ * 
+ *   - If argv has fewer elements than are indicated with argc
+ * 
+ *   - If any string indicated by argv is not null-terminated
+ */
+static const char *getCustom(int argc, char *argv[], int i) {
+	
+	int x = 0;
+	char *result = NULL;
+	
+	/* Check arguments */
+	if ((argc < 0) || (argv == NULL) || (i < 0)) {
+		abort();
+	}
+	
+	for(x = 0; x < argc; x++) {
+		if (argv[x] == NULL) {
+			abort();
+		}
+	}
+	
+	/* Determine whether i is in range */
+	if (i < getCustomCount(argc)) {
+		/* i is in range -- read the custom argument */
+		result = argv[i + 1];
+	} else {
+		/* i is out of range -- return empty string */
+		result = "";
+	}
+	
+	/* Return result */
+	return result;
+}
+
+/*
+ * Get the total number of custom program arguments, given the argc
+ * value that was passed to main.
+ * 
+ * The argc value is one greater than the custom program argument count,
+ * because the first argument is the module name.
+ * 
+ * If argc is zero, zero is returned.
+ * 
+ * Parameters:
+ * 
+ *   argc - the number of program arguments
+ * 
+ * Return:
+ * 
+ *   the number of custom program arguments
+ * 
+ * Faults:
+ * 
+ *   - If argc is negative
+ */
+static int getCustomCount(int argc) {
+	int result = 0;
+	
+	if (argc > 0) {
+		result = argc - 1;
+	} else if (argc == 0) {
+		result = 0;
+	} else {
+		abort();
+	}
+	
+	return result;
+}
+
+/*
+ * Convert the given null-terminated string representing a signed
+ * integer in ASCII decimal into a long value.
+ * 
+ * If successful, the converted long value is stored to *pLong and true
+ * is returned.  If the string could not be parsed, *pLong is unmodified
+ * and false is returned.
+ * 
+ * Parameters:
+ * 
+ *   str - pointer to the string to convert
+ * 
+ *   pLong - pointer to the variable to receive the converted long value
+ *   on success
+ * 
+ * Return:
+ * 
+ *   true if successful, false if parsing error
+ * 
+ * Faults:
+ * 
+ *   - If str is NULL
+ * 
+ *   - If pLong is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If str is not null-terminated
+ */
+static bool stringToLong(const char *str, long *pLong) {
+	
+	bool result = true;
+	int32_t i = 0;
+	const char *pc = NULL;
+	
+	/* Check parameters */
+	if ((str == NULL) || (pLong == NULL)) {
+		abort();
+	}
+	
+	/* Skip leading whitespace */
+	pc = str;
+	while (isspace((unsigned char) *pc)) {
+		pc++;
+	}
+	
+	/* Attempt to convert the string as a base-10 decimal */
+	result = decimal_scanInt(pc, &i, &pc);
+	
+	/* Make sure the unconverted part of the argument is either empty or
+	 * consists only of whitespace */
+	if (result) {
+		while(*pc != 0) {
+			if (!isspace((unsigned char) *pc)) {
+				result = false;
+				break;
+			}
+			pc++;
+		}
+	}
+	
+	/* If successful, write the result */
+	if (result) {
+		*pLong = (long) i;
+	}
+	
+	/* Return the status */
+	return result;
+}
+
+
+/*
+ * Convert the given null-terminated string representing a percentage
+ * in ASCII decimal, which may have a fractional part, into a double
+ * value.
+ * 
+ * If successful, the converted percentage is stored to *pPercent and
+ * true is returned.  If the string could not be parsed or is not in
+ * range zero to 100, *pPercent is unmodified and false is returned.
+ * 
+ * Parameters:
+ * 
+ *   str - pointer to the string to convert
+ * 
+ *   pPercent - pointer to the variable to receive the converted
+ *   percentage on success
+ * 
+ * Return:
+ * 
+ *   true if successful, false if parsing error
+ * 
+ * Faults:
+ * 
+ *   - If str is NULL
+ * 
+ *   - If pPercent is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If str is not null-terminated
+ */
+static bool stringToPercent(const char *str, double *pPercent) {
+	
+	bool result = true;
+	double d = 0.0;
+	const char *pc = NULL;
+	char *pTail = NULL;
+	
+	/* Check parameters */
+	if ((str == NULL) || (pPercent == NULL)) {
+		abort();
+	}
+	
+	/* Only plain decimal numbers are accepted, so that strtod() does
+	 * not also take hexadecimal, infinities, or NaN */
+	for(pc = str; *pc != 0; pc++) {
+		if ((!isdigit((unsigned char) *pc)) && (*pc != '.') &&
+				(!isspace((unsigned char) *pc))) {
+			result = false;
+			break;
+		}
+	}
+	
+	/* Convert the string, which must not be empty */
+	if (result) {
+		d = strtod(str, &pTail);
+		if (pTail == str) {
+			result = false;
+		}
+		pc = pTail;
+	}
+	
+	/* Make sure the unconverted part of the argument is either empty or
+	 * consists only of whitespace */
+	if (result) {
+		while(*pc != 0) {
+			if (!isspace((unsigned char) *pc)) {
+				result = false;
+				break;
+			}
+			pc++;
+		}
+	}
+	
+	/* Check the range */
+	if (result) {
+		if ((d < 0.0) || (d > 100.0)) {
+			result = false;
+		}
+	}
+	
+	/* If successful, write the result */
+	if (result) {
+		*pPercent = d;
+	}
+	
+	/* Return the status */
+	return result;
+}
+
+/*
+ * Convert the given null-terminated string representing a signed
+ * base-24 pair in ASCII into a long value.
+ * 
+ * If successful, the converted long value is stored to *pLong and true
+ * is returned.  If the string could not be parsed, *pLong is unmodified
+ * and false is returned.
+ * 
+ * Parameters:
+ * 
+ *   str - pointer to the string to convert
+ * 
+ *   pLong - pointer to the variable to receive the converted long value
+ *   on success
+ * 
+ * Return:
+ * 
+ *   true if successful, false if parsing error
+ * 
+ * Faults:
+ * 
+ *   - If str is NULL
+ * 
+ *   - If pLong is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If str is not null-terminated
+ */
+static bool pairToLong(const char *str, long *pLong) {
+	
+	bool result = true;
+	int32_t i = 0;
+	const char *pc = NULL;
+	
+	/* Check parameters */
+	if ((str == NULL) || (pLong == NULL)) {
+		abort();
+	}
+	
+	/* Find the first non-whitespace character, failing if there is no
+	 * such thing */
+	pc = str;
+	while (*pc != 0) {
+		if (!isspace(*pc)) {
+			break;
+		}
+		pc++;
+	}
+	if (*pc == 0) {
+		result = false;
+	}
+	
+	/* Attempt to parse a base-24 pair */
+	if (result) {
+		result = base24_pairToInt(pc, &i);
+	}
+	
+	/* Verify that anything after a valid base-24 pair is whitespace */
+	if (result) {
+		pc = pc + 2;	/* Skip the base-24 pair that was just parsed */
+		while (*pc != 0) {
+			if (!isspace(*pc)) {
+				result = false;
+				break;
+			}
+			pc++;
+		}
+	}
+	
+	/* If successful, write the result */
+	if (result) {
+		*pLong = (long) i;
+	}
+	
+	/* Return the status */
+	return result;
+}
+
+/*
+ * Convert the given null-terminated string representing a calendar date
+ * in ASCII into a NELSC absolute day offset.
+ * 
+ * This supports NELSC dates, Gregorian dates (YYYY-MM-DD format, or
+ * any of the other fixed-width formats of grcal_scanFormat()), ISO 8601
+ * week dates (YYYY-Www-D format) and ordinal dates (YYYY-DDD format),
+ * and day counts in the text form of jdn_scan(), such as JD2451545.
+ * 
+ * The format is classified with nelsc_detect_classify(), and the date
+ * is then read by the one parser for that format.  If fmt is a
+ * GRCAL_FORMAT constant, the date must instead be in that format.
+ * 
+ * If successful, the converted offset is stored to *pOffset and true is
+ * returned.  If the string could not be parsed, *pOffset is unmodified
+ * and false is returned.  The parser that failed fills in *pErr as it
+ * goes, so explaining the failure does not parse the date again.  The
+ * position in the error counts from the start of str.
+ * 
+ * Parameters:
  * 
  *   str - pointer to the string to convert
  * 
- *   pLong - pointer to the variable to receive the converted long value
- *   on success
+ *   fmt - the GRCAL_FORMAT constant of the format the date must be in,
+ *   or -1 to detect the format
+ * 
+ *   pOffset - pointer to the variable to receive the converted day
+ *   offset on success
+ * 
+ *   pDetected - pointer to the variable to receive the NELSC_DETECT
+ *   constant of the format of the date, or NULL; this is written even
+ *   if parsing fails, and is NELSC_DETECT_UNKNOWN if the format could
+ *   not be told
+ * 
+ *   pErr - the error to fill in if parsing fails, or NULL
+ * 
+ * Return:
+ * 
+ *   true if successful, false if parsing error
+ * 
+ * Faults:
+ * 
+ *   - If str is NULL
+ * 
+ *   - If pOffset is NULL
+ * 
+ *   - If fmt is neither -1 nor a valid format
+ * 
+ * Undefined behavior:
+ * 
+ *   - If str is not null-terminated
+ */
+static bool dateToOffset(
+		const char *str,
+		int fmt,
+		int32_t *pOffset,
+		int *pDetected,
+		SCANERR *pErr) {
+	
+	bool result = true;
+	bool gregorian = false;
+	int detected = NELSC_DETECT_UNKNOWN;
+	int32_t d = 0;
+	size_t len = 0;
+	const char *pc = NULL;
+	const char *pStart = NULL;
+	
+	/* Check parameters */
+	if ((str == NULL) || (pOffset == NULL) ||
+			(fmt < -1) || (fmt >= GRCAL_FORMAT_COUNT)) {
+		abort();
+	}
+	
+	/* Find the first non-whitespace character, failing if there is no
+	 * such thing */
+	pc = str;
+	while (*pc != 0) {
+		if (!isspace(*pc)) {
+			break;
+		}
+		pc++;
+	}
+	if (*pc == 0) {
+		scanerr_set(pErr, SCANERR_END, SCANERR_FIELD_NONE,
+			(int32_t) (pc - str), 0);
+		result = false;
+	}
+	pStart = pc;
+	
+	/* Get the format of the date, which is either the given format or
+	 * classified from the shape of the text up to the next whitespace
+	 * character */
+	if (result) {
+		if (fmt >= 0) {
+			detected = m_grcal_formats[fmt];
+		} else {
+			len = 0;
+			while ((pc[len] != 0) &&
+					(!isspace((unsigned char) pc[len]))) {
+				len++;
+			}
+			detected = nelsc_detect_classify(pc, len);
+			if (detected == NELSC_DETECT_UNKNOWN) {
+				scanerr_set(pErr, SCANERR_FORMAT, SCANERR_FIELD_NONE,
+					(int32_t) (pc - str), 0);
+				result = false;
+			}
+		}
+	}
+	
+	/* Parse the date with the one parser for its format; all formats
+	 * besides NELSC give Gregorian day offsets */
+	if (result) {
+		gregorian = true;
+		d = -1;
+		if (fmt >= 0) {
+			d = grcal_scanFormat(fmt, pc, &pc, pErr);
+		
+		} else if (detected == NELSC_DETECT_NELSC) {
+			gregorian = false;
+			if (nelsc_format_scanDate(pc, &d, pErr)) {
+				pc = pc + NELSC_FORMAT_DATE_LENGTH;
+			} else {
+				result = false;
+			}
+		
+		} else if (detected == NELSC_DETECT_GREGORIAN) {
+			d = grcal_scanDate(pc, &pc, pErr);
+		
+		} else if (detected == NELSC_DETECT_COMPACT) {
+			d = grcal_scanFormat(GRCAL_FORMAT_COMPACT, pc, &pc,
+				pErr);
+		
+		} else if (detected == NELSC_DETECT_SLASH) {
+			d = grcal_scanFormat(GRCAL_FORMAT_SLASH, pc, &pc, pErr);
+		
+		} else if (detected == NELSC_DETECT_DOTTED) {
+			d = grcal_scanFormat(GRCAL_FORMAT_DOTTED, pc, &pc,
+				pErr);
+		
+		} else if (detected == NELSC_DETECT_WEEK) {
+			d = grcal_scanWeekDate(pc, &pc, pErr);
+		
+		} else if (detected == NELSC_DETECT_ORDINAL) {
+			d = grcal_scanOrdinal(pc, &pc, pErr);
+		
+		} else if (detected == NELSC_DETECT_DAYCOUNT) {
+			d = jdn_scan(pc, NULL, &pc, pErr);
+		}
+		
+		if (gregorian && (d == -1)) {
+			result = false;
+		}
+		
+		/* Make the position of any error relative to the whole string
+		 * rather than to the start of the date */
+		if ((!result) && (pErr != NULL)) {
+			pErr->pos += (int32_t) (pStart - str);
+		}
+	}
+	
+	/* If Gregorian, convert offset to NELSC absolute day, and check
+	 * range is in NELSC */
+	if (result) {
+		if (gregorian) {
+			d -= NELSC_CYCLE_GROFFS;
+			if ((d < NELSC_CYCLE_DAYMIN) || (d > NELSC_CYCLE_DAYMAX)) {
+				scanerr_set(pErr, SCANERR_LIMIT, SCANERR_FIELD_NONE,
+					(int32_t) (pStart - str), 0);
+				result = false;
+			}
+		}
+	}
+	
+	/* Verify that anything after a valid date is whitespace */
+	if (result) {
+		while (*pc != 0) {
+			if (!isspace(*pc)) {
+				scanerr_set(pErr, SCANERR_TRAILING, SCANERR_FIELD_NONE,
+					(int32_t) (pc - str), 0);
+				result = false;
+				break;
+			}
+			pc++;
+		}
+	}
+	
+	/* Write the format whether or not the date was parsed, and the
+	 * result if successful */
+	if (pDetected != NULL) {
+		*pDetected = detected;
+	}
+	if (result) {
+		*pOffset = d;
+	}
+	
+	/* Return the status */
+	return result;
+}
+
+/*
+ * Copy a null-terminated string into a buffer, not including the
+ * terminating null.
+ * 
+ * Parameters:
+ * 
+ *   pBuf - the buffer to copy into
+ * 
+ *   str - the null-terminated string to copy
+ * 
+ * Return:
+ * 
+ *   the number of characters copied
+ * 
+ * Faults:
+ * 
+ *   - If pBuf or str is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If pBuf is too small
+ */
+static size_t appendString(char *pBuf, const char *str) {
+	
+	size_t len = 0;
+	
+	/* Check parameters */
+	if ((pBuf == NULL) || (str == NULL)) {
+		abort();
+	}
+	
+	/* Copy the string */
+	len = strlen(str);
+	memcpy(pBuf, str, len);
+	
+	/* Return the length */
+	return len;
+}
+
+/*
+ * Write a base-24 pair in signed style to a sink.
+ * 
+ * Parameters:
+ * 
+ *   pOut - the sink to write to
+ * 
+ *   v - the value to write, in range BASE24_PAIR_MIN to
+ *   BASE24_PAIR_MAX
+ * 
+ * Faults:
+ * 
+ *   - If pOut is NULL
+ * 
+ *   - If v is out of range
+ */
+static void writePair(NELSC_SINK *pOut, int32_t v) {
+	
+	char buf[2];
+	
+	base24_writePair(buf, v);
+	nelsc_sink_write(pOut, buf, 2);
+}
+
+/*
+ * Write a Gregorian date in YYYY-MM-DD format to a sink.
+ * 
+ * Parameters:
+ * 
+ *   pOut - the sink to write to
+ * 
+ *   y - the Gregorian year
+ * 
+ *   m - the Gregorian month
+ * 
+ *   d - the Gregorian day of month
+ * 
+ * Faults:
+ * 
+ *   - If pOut is NULL
+ * 
+ *   - If the date is not valid
+ */
+static void writeGrDate(
+		NELSC_SINK *pOut, int32_t y, int32_t m, int32_t d) {
+	
+	char buf[GRCAL_DATE_LENGTH];
+	
+	grcal_writeDate(buf, y, m, d);
+	nelsc_sink_write(pOut, buf, GRCAL_DATE_LENGTH);
+}
+
+/*
+ * Print information about the day indicated by the provided NELSC
+ * absolute day offset.
+ * 
+ * Parameters:
+ * 
+ *   pOut - the sink to write the information to
+ * 
+ *   day - the NELSC absolute day offset
+ * 
+ * Faults:
+ * 
+ *   - If pOut is NULL
+ * 
+ *   - If day is out of range
+ */
+static void printDayInformation(NELSC_SINK *pOut, int32_t day) {
+	
+	int32_t year = 0;
+	int32_t month_of_year = 0;
+	int32_t absolute_month = 0;
+	int32_t day_of_month = 0;
+	
+	int32_t gr_year = 0;
+	int32_t gr_month = 0;
+	int32_t gr_day = 0;
+	
+	char buf[DAYINFO_MAXLEN];
+	size_t len = 0;
+	
+	/* Check parameters */
+	if ((pOut == NULL) ||
+			(day < NELSC_CYCLE_DAYMIN) || (day > NELSC_CYCLE_DAYMAX)) {
+		abort();
+	}
+	
+	/* Compute the information */
+	absolute_month = nelsc_cycle_dayToMonth(day, &day_of_month);
+	year = nelsc_cycle_monthToYear(absolute_month, &month_of_year);
+	
+	grcal_offsetToDate(
+		(day + NELSC_CYCLE_GROFFS),
+		&gr_year,
+		&gr_month,
+		&gr_day);
+	
+	/* Build the report in the buffer */
+	len += appendString(buf + len, "Day offset:      ");
+	len += decimal_writeInt(buf + len, day, 0);
+	
+	len += appendString(buf + len, "\nAbsolute month:  ");
+	len += decimal_writeInt(buf + len, absolute_month, 0);
+	
+	len += appendString(buf + len, "\nNELSC date:      ");
+	nelsc_format_writeDate(
+		buf + len, year, month_of_year, day_of_month);
+	len += NELSC_FORMAT_DATE_LENGTH;
+	
+	len += appendString(buf + len, "\nMonth length:    ");
+	if (nelsc_cycle_isLongMonth(absolute_month)) {
+		len += appendString(buf + len, "long");
+	} else {
+		len += appendString(buf + len, "short");
+	}
+	
+	len += appendString(buf + len, "\nYear length:     ");
+	if (nelsc_cycle_isLongYear(year)) {
+		len += appendString(buf + len, "long");
+	} else {
+		len += appendString(buf + len, "short");
+	}
+	
+	len += appendString(buf + len, "\nGregorian date:  ");
+	grcal_writeDate(buf + len, gr_year, gr_month, gr_day);
+	len += GRCAL_DATE_LENGTH;
+	
+	len += appendString(buf + len, "\n");
+	
+	/* Print the report */
+	nelsc_sink_write(pOut, buf, len);
+}
+
+/*
+ * Get the thread pool used for printing reports in parallel.
+ * 
+ * The pool is created on first use with one worker per online
+ * processor and is released by main() before the program exits.  This
+ * function must only be called from the main thread.
+ * 
+ * Return:
+ * 
+ *   the report thread pool
+ */
+static NELSC_POOL *getPool(void) {
+	if (m_pool == NULL) {
+		m_pool = nelsc_pool_new(0);
+	}
+	return m_pool;
+}
+
+/*
+ * Print a single chunk of a report on a worker thread.
+ * 
+ * This is the NELSC_POOL_TASK function used by runReport().  pCustom
+ * points to the REPORT_JOB, and the chunk is printed into its own
+ * buffer sink.
+ * 
+ * Parameters:
+ * 
+ *   pCustom - the REPORT_JOB
+ * 
+ *   chunk - the chunk to print
+ */
+static void reportTask(void *pCustom, int32_t chunk) {
+	
+	const REPORT_JOB *pJob = NULL;
+	
+	pJob = (const REPORT_JOB *) pCustom;
+	(*(pJob->fn))(pJob->pCustom, chunk, (pJob->ppSinks)[chunk]);
+}
+
+/*
+ * Print a report made up of a sequence of independent chunks.
+ * 
+ * The chunks are printed in parallel on the report thread pool, each
+ * into its own buffer sink.  Once all the chunks are done, the buffers
+ * are written to pOut in chunk order, so the output is the same as if
+ * the chunks had been printed one after the other.
+ * 
+ * Parameters:
+ * 
+ *   pOut - the sink to write the report to
+ * 
+ *   chunks - the number of chunks in the report
+ * 
+ *   fn - the function that prints a chunk
+ * 
+ *   pCustom - custom data passed through to fn
+ * 
+ * Faults:
+ * 
+ *   - If pOut or fn is NULL
+ * 
+ *   - If chunks is less than one
+ * 
+ *   - If memory allocation fails
+ */
+static void runReport(
+		NELSC_SINK *pOut,
+		int32_t chunks,
+		REPORT_CHUNK fn,
+		void *pCustom) {
+	
+	REPORT_JOB job;
+	int32_t i = 0;
+	
+	/* Check parameters */
+	if ((pOut == NULL) || (fn == NULL) || (chunks < 1)) {
+		abort();
+	}
+	
+	/* Create a buffer sink for each chunk */
+	job.fn = fn;
+	job.pCustom = pCustom;
+	job.ppSinks = (NELSC_SINK **) calloc(
+					(size_t) chunks, sizeof(NELSC_SINK *));
+	if (job.ppSinks == NULL) {
+		abort();
+	}
+	for(i = 0; i < chunks; i++) {
+		(job.ppSinks)[i] = nelsc_sink_newBuffer();
+	}
+	
+	/* Print the chunks in parallel */
+	nelsc_pool_run(getPool(), &reportTask, &job, chunks);
+	
+	/* Write the chunks in order and release them */
+	for(i = 0; i < chunks; i++) {
+		nelsc_sink_drain(pOut, (job.ppSinks)[i]);
+		nelsc_sink_free((job.ppSinks)[i]);
+	}
+	free(job.ppSinks);
+	job.ppSinks = NULL;
+}
+
+/*
+ * Compute the full moon week of a NELSC month.
+ * 
+ * Parameters:
+ * 
+ *   m - the NELSC absolute month offset
+ * 
+ *   pBegin - pointer to the variable to receive the Gregorian day
+ *   offset of the first day of the full moon week
+ * 
+ *   pEnd - pointer to the variable to receive the Gregorian day offset
+ *   of the last day of the full moon week
+ * 
+ * Faults:
+ * 
+ *   - If m is out of range
+ */
+static void fullMoonWeek(int32_t m, int32_t *pBegin, int32_t *pEnd) {
+	
+	int32_t m_begin = 0;
+	
+	/* Start with the first day of the month */
+	m_begin = nelsc_cycle_monthToDay(m);
+	
+	/* Compute full moon week boundaries depending on whether this is a
+	 * long or short month */
+	if (nelsc_cycle_isLongMonth(m)) {
+		*pBegin = m_begin + FULLMOON_LONG_BEGIN;
+		*pEnd   = m_begin + FULLMOON_LONG_END;
+	} else {
+		*pBegin = m_begin + FULLMOON_SHORT_BEGIN;
+		*pEnd   = m_begin + FULLMOON_SHORT_END;
+	}
+	
+	/* Convert NELSC absolute day offsets to Gregorian offsets */
+	*pBegin += NELSC_CYCLE_GROFFS;
+	*pEnd   += NELSC_CYCLE_GROFFS;
+}
+
+/*
+ * Print the full moon weeks of a range of months that may be a part of
+ * a larger report.
+ * 
+ * A blank line is printed before a full moon week if its begin year is
+ * different from the begin year of the full moon week of the previous
+ * month.  If first is true, mfirst is the start of the report and no
+ * blank line is printed before it.  Otherwise, the month before mfirst
+ * is assumed to have been printed by an earlier part of the report.
+ * 
+ * Parameters:
+ * 
+ *   pOut - the sink to write the full moon weeks to
+ * 
+ *   mfirst - the first month in the range
+ * 
+ *   mlast - the last month in the range
+ * 
+ *   first - true if mfirst is the start of the report
+ * 
+ * Faults:
+ * 
+ *   - If mfirst or mlast is out of range
+ * 
+ *   - If first is false and mfirst is NELSC_CYCLE_MONMIN
+ */
+static void fullMoonRange(
+		NELSC_SINK *pOut, int32_t mfirst, int32_t mlast, bool first) {
+	
+	int32_t m = 0;
+	int32_t lyear = -1;
+	
+	int32_t fmw_begin = 0;
+	int32_t fmw_end = 0;
+	
+	int32_t b_year = 0;
+	int32_t b_month = 0;
+	int32_t b_day = 0;
+	
+	int32_t e_year = 0;
+	int32_t e_month = 0;
+	int32_t e_day = 0;
+	
+	/* If this range continues a report, start with the begin year of
+	 * the previous month */
+	if (!first) {
+		fullMoonWeek(mfirst - 1, &fmw_begin, &fmw_end);
+		grcal_offsetToDate(fmw_begin, &lyear, &b_month, &b_day);
+	}
+	
+	/* Print the full moon week for each month in range */
+	for(m = mfirst; m <= mlast; m++) {
+		/* Convert begin and end days to Gregorian dates */
+		fullMoonWeek(m, &fmw_begin, &fmw_end);
+		grcal_offsetToDate(fmw_begin, &b_year, &b_month, &b_day);
+		grcal_offsetToDate(fmw_end,   &e_year, &e_month, &e_day);
+
+		/* If lyear is not -1 (indicating first time through the loop),
+		 * prefix a blank line if the year of the begin date is
+		 * different from the last begin date's year */
+		if ((lyear != -1) && (lyear != b_year)) {
+			nelsc_sink_printf(pOut, "\n");
+		}
+		
+		/* Store the begin year of the current full moon in lyear */
+		lyear = b_year;
+		
+		/* Write the dates */
+		writeGrDate(pOut, b_year, b_month, b_day);
+		nelsc_sink_printf(pOut, " - ");
+		writeGrDate(pOut, e_year, e_month, e_day);
+		nelsc_sink_printf(pOut, "\n");
+	}
+}
+
+/*
+ * Print one chunk of a full moon report.
+ * 
+ * This is a REPORT_CHUNK function for runReport().  pCustom points to
+ * the FULLMOON_JOB describing the report.  Chunk i covers the
+ * FULLMOON_CHUNK months starting FULLMOON_CHUNK * i months after the
+ * first month of the report, stopping early at its last month.
+ * 
+ * Parameters:
+ * 
+ *   pCustom - the FULLMOON_JOB
+ * 
+ *   chunk - the chunk to print
+ * 
+ *   pOut - the sink to write the chunk to
+ */
+static void fullMoonChunk(
+		void *pCustom, int32_t chunk, NELSC_SINK *pOut) {
+	
+	const FULLMOON_JOB *pJob = NULL;
+	int32_t lo = 0;
+	int32_t hi = 0;
+	
+	pJob = (const FULLMOON_JOB *) pCustom;
+	
+	lo = pJob->mfirst + (chunk * FULLMOON_CHUNK);
+	hi = lo + (FULLMOON_CHUNK - 1);
+	if (hi > pJob->mlast) {
+		hi = pJob->mlast;
+	}
+	
+	fullMoonRange(pOut, lo, hi, (chunk == 0));
+}
+
+/*
+ * Print the NELSC full moon weeks from NELSC absolute month mfirst up
+ * to and including NELSC absolute month mlast.
+ * 
+ * mfirst and mlast must both be in range NELSC_CYCLE_MONMIN up to
+ * NELSC_CYCLE_MONMAX (inclusive of boundaries).  mlast must be greater
+ * than or equal to mfirst.
+ * 
+ * The months are split into chunks of FULLMOON_CHUNK months that are
+ * printed in parallel with runReport().  The output is the same as if
+ * the months were printed one after the other.
+ * 
+ * Parameters:
+ * 
+ *   pOut - the sink to write the full moon weeks to
+ * 
+ *   mfirst - the first month in the range
+ * 
+ *   mlast - the last month in the range
+ * 
+ * Faults:
+ * 
+ *   - If pOut is NULL
+ * 
+ *   - If mfirst or mlast is out of range
+ * 
+ *   - If mfirst is greater than mlast
+ */
+static void fullMoons(NELSC_SINK *pOut, int32_t mfirst, int32_t mlast) {
+	
+	FULLMOON_JOB job;
+	
+	/* Check parameters */
+	if ((pOut == NULL) ||
+		(mfirst < NELSC_CYCLE_MONMIN) ||
+		(mfirst > NELSC_CYCLE_MONMAX) ||
+		(mlast < NELSC_CYCLE_MONMIN) ||
+		(mlast > NELSC_CYCLE_MONMAX) ||
+		(mfirst > mlast)) {
+		abort();
+	}
+	
+	/* Print the report in chunks */
+	job.mfirst = mfirst;
+	job.mlast = mlast;
+	
+	runReport(pOut, ((mlast - mfirst) / FULLMOON_CHUNK) + 1,
+		&fullMoonChunk, &job);
+}
+
+/*
+ * Print the rows of a range of years of the new year report and gather
+ * statistics over them.
+ * 
+ * A blank line is printed before every fourth row of the full report,
+ * counting from NELSC_CYCLE_YEARMIN, except for the first row.
+ * 
+ * Parameters:
+ * 
+ *   pOut - the sink to write the rows to
+ * 
+ *   yfirst - the first year in the range
+ * 
+ *   ylast - the last year in the range
+ * 
+ *   pStats - the statistics to fill in for the range
+ * 
+ * Faults:
+ * 
+ *   - If yfirst or ylast is out of range
+ * 
+ *   - If yfirst is greater than ylast
+ */
+static void newYearRange(
+		NELSC_SINK *pOut,
+		int32_t yfirst,
+		int32_t ylast,
+		NEWYEAR_STATS *pStats) {
+	
+	int32_t y = 0;
+	int32_t d = 0;
+	int32_t abs_month = 0;
+	int32_t abs_equinox = 0;
+	int32_t year_drift = 0;
+	int32_t gr_year = 0;
+	int32_t gr_month = 0;
+	int32_t gr_day = 0;
+	int32_t gr_equinox = 0;
+	
+	/* Check parameters */
+	if ((yfirst < NELSC_CYCLE_YEARMIN) ||
+			(ylast > NELSC_CYCLE_YEARMAX) ||
+			(yfirst > ylast)) {
+		abort();
+	}
+	
+	/* Go through each year */
+	for(y = yfirst; y <= ylast; y++) {
+		
+		/* If this row is not the first row and its row index is a
+		 * multiple of four, prefix a blank line */
+		if ((y != NELSC_CYCLE_YEARMIN) &&
+			((y - NELSC_CYCLE_YEARMIN) % 4 == 0)) {
+			nelsc_sink_printf(pOut, "\n");
+		}
+		
+		/* Begin by printing the year */
+		writePair(pOut, y);
+		
+		/* Convert the year into a day offset and an absolute month */
+		abs_month = nelsc_cycle_yearToMonth(y);
+		d = nelsc_cycle_monthToDay(abs_month);
+		
+		/* Apply Gregorian offset to convert it to Gregorian */
+		d += NELSC_CYCLE_GROFFS;
+		
+		/* Split into Gregorian year-month-day */
+		grcal_offsetToDate(d, &gr_year, &gr_month, &gr_day);
+		
+		/* Figure out the equinox offset that year */
+		grcal_dateToOffset(
+			&gr_equinox, gr_year, EQUINOX_MONTH, EQUINOX_DAY);
+		
+		/* Get the NELSC absolute month of the equinox -- except in the
+		 * first year, use one less than the least month, since the
+		 * NELSC calendar doesn't go that far back */
+		if (y > NELSC_CYCLE_YEARMIN) {
+			abs_equinox = nelsc_cycle_dayToMonth(
+							gr_equinox - NELSC_CYCLE_GROFFS,
+							NULL);
+		} else {
+			abs_equinox = abs_month - 1;
+		}
+		
+		/* Compute the year drift */
+		year_drift = abs_equinox - abs_month;
+		
+		/* Print the rest of the line */
+		nelsc_sink_printf(pOut, "  ");
+		writeGrDate(pOut, gr_year, gr_month, gr_day);
+		nelsc_sink_printf(pOut,
+			"  equinox month offset %2d\n", (int) year_drift);
+		
+		/* If this is the first year of the range, use its values to
+		 * initialize the statistics; else, update the statistics
+		 * appropriately */
+		if (y == yfirst) {
+			pStats->min_drift = year_drift;
+			pStats->max_drift = year_drift;
+			pStats->earliest_month = gr_month;
+			pStats->earliest_day = gr_day;
+			pStats->latest_month = gr_month;
+			pStats->latest_day = gr_day;
+		
+		} else {
+			if (year_drift < pStats->min_drift) {
+				pStats->min_drift = year_drift;
+			}
+			if (year_drift > pStats->max_drift) {
+				pStats->max_drift = year_drift;
+			}
+			
+			if ((pStats->earliest_month > gr_month) ||
+				((pStats->earliest_month == gr_month) &&
+					(pStats->earliest_day > gr_day))) {
+				pStats->earliest_month = gr_month;
+				pStats->earliest_day = gr_day;
+			}
+			
+			if ((pStats->latest_month < gr_month) ||
+				((pStats->latest_month == gr_month) &&
+					(pStats->latest_day < gr_day))) {
+				pStats->latest_month = gr_month;
+				pStats->latest_day = gr_day;
+			}
+		}
+	}
+}
+
+/*
+ * Print one chunk of the new year report.
+ * 
+ * This is a REPORT_CHUNK function for runReport().  pCustom points to
+ * an array of NEWYEAR_STATS with one element per chunk.  Chunk i covers
+ * the NEWYEAR_CHUNK years starting NEWYEAR_CHUNK * i years after
+ * NELSC_CYCLE_YEARMIN, stopping early at NELSC_CYCLE_YEARMAX, and
+ * stores its statistics in element i of the array.
+ * 
+ * Parameters:
+ * 
+ *   pCustom - the NEWYEAR_STATS array
+ * 
+ *   chunk - the chunk to print
+ * 
+ *   pOut - the sink to write the chunk to
+ */
+static void newYearChunk(
+		void *pCustom, int32_t chunk, NELSC_SINK *pOut) {
+	
+	NEWYEAR_STATS *pStats = NULL;
+	int32_t lo = 0;
+	int32_t hi = 0;
+	
+	pStats = (NEWYEAR_STATS *) pCustom;
+	
+	lo = NELSC_CYCLE_YEARMIN + (chunk * NEWYEAR_CHUNK);
+	hi = lo + (NEWYEAR_CHUNK - 1);
+	if (hi > NELSC_CYCLE_YEARMAX) {
+		hi = NELSC_CYCLE_YEARMAX;
+	}
+	
+	newYearRange(pOut, lo, hi, &(pStats[chunk]));
+}
+
+
+/*
+ * Choose the number of converter threads for the convert pipeline.
+ * 
+ * One converter is used for each online processor beyond the first,
+ * which is left for the reader and writer, within the range one up to
+ * CONVERT_WORKERS_MAX.
+ * 
+ * Return:
+ * 
+ *   the number of converter threads
+ */
+static int32_t convertWorkers(void) {
+	
+	long online = 0;
+	int32_t result = 1;
+	
+	online = sysconf(_SC_NPROCESSORS_ONLN);
+	if (online > CONVERT_WORKERS_MAX) {
+		result = CONVERT_WORKERS_MAX;
+	} else if (online > 2) {
+		result = (int32_t) (online - 1);
+	}
+	
+	return result;
+}
+
+/*
+ * Decompose a batch of day offsets and append them to the output
+ * buffer of a block in the given format, growing the buffer as needed.
+ * 
+ * Parameters:
+ * 
+ *   pFmt - the compiled output format
+ * 
+ *   pBlock - the block to append to
+ * 
+ *   pDays - the day offsets
+ * 
+ *   pDates - scratch space for count decomposed dates
+ * 
+ *   count - the number of day offsets
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static void convertFormat(
+		const NELSC_STRFTIME *pFmt,
+		CONVERT_BLOCK *pBlock,
+		const int32_t *pDays,
+		NELSC_STRFTIME_DATE *pDates,
+		size_t count) {
+	
+	size_t pos = 0;
+	size_t done = 0;
+	size_t need = 0;
+	
+	nelsc_strftime_decomposeBatch(pDays, count, pDates);
+	
+	need = nelsc_strftime_maxLength(pFmt) + 1;
+	while (pos < count) {
+		/* Make sure there is room for at least one more record */
+		if (pBlock->out_cap - pBlock->out_len < need) {
+			pBlock->out_cap *= 2;
+			if (pBlock->out_cap - pBlock->out_len < need) {
+				pBlock->out_cap = pBlock->out_len + need;
+			}
+			pBlock->pOut = (char *) realloc(
+								pBlock->pOut, pBlock->out_cap);
+			if (pBlock->pOut == NULL) {
+				abort();
+			}
+		}
+		
+		pBlock->out_len += nelsc_strftime_batch(
+							pFmt, &(pDates[pos]), count - pos,
+							pBlock->pOut + pBlock->out_len,
+							pBlock->out_cap - pBlock->out_len,
+							&done);
+		pos += done;
+	}
+}
+
+/*
+ * Convert all the lines in the input buffer of a block into its output
+ * buffer.
+ * 
+ * Conversion stops at the first line that is too long or can't be
+ * parsed as a calendar date, and the error is recorded in the block.
+ * If dead_letter is set, lines that are too long or can't be parsed
+ * are instead recorded in the dead-letter buffer of the block and
+ * conversion goes on, so the only bookkeeping for failures is done
+ * here, on the converter thread that owns the block.  The dates before
+ * a failed line are formatted before it is recorded, so that the
+ * writer can cut the output short at any failed line.
+ * 
+ * Parameters:
+ * 
+ *   pFmt - the compiled output format
+ * 
+ *   in_fmt - the GRCAL_FORMAT constant of the input format, or -1 to
+ *   detect the format of each line
+ * 
+ *   dead_letter - true to record failed lines and continue, false to
+ *   stop at the first failed line
+ * 
+ *   pBlock - the block to convert
+ * 
+ *   pDays - scratch space for CONVERT_BATCH day offsets
+ * 
+ *   pDates - scratch space for CONVERT_BATCH decomposed dates
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static void convertBlock(
+		const NELSC_STRFTIME *pFmt,
+		int in_fmt,
+		bool dead_letter,
+		CONVERT_BLOCK *pBlock,
+		int32_t *pDays,
+		NELSC_STRFTIME_DATE *pDates) {
+	
+	char line[CONVERT_LINE_MAX];
+	const char *pc = NULL;
+	const char *pEnd = NULL;
+	const char *pLF = NULL;
+	size_t len = 0;
+	size_t count = 0;
+	int detected = 0;
+	
+	pBlock->out_len = 0;
+	pBlock->lines = 0;
+	pBlock->dead_len = 0;
+	pBlock->dead = 0;
+	pBlock->err = CONVERT_OK;
+	memset(pBlock->formats, 0, sizeof(pBlock->formats));
+	
+	pc = pBlock->pIn;
+	pEnd = pBlock->pIn + pBlock->in_len;
+	
+	while ((pc < pEnd) && (pBlock->err == CONVERT_OK)) {
+		/* Find the end of the line; a line without a line feed is only
+		 * allowed at the end of input, and is otherwise a line that
+		 * filled the whole block */
+		pLF = (const char *) memchr(pc, '\n', (size_t) (pEnd - pc));
+		if (pLF != NULL) {
+			len = (size_t) (pLF - pc);
+		} else {
+			len = (size_t) (pEnd - pc);
+		}
+		
+		/* Lines must leave room for the line feed that fgets() would
+		 * have kept; when dead-lettering, the start of a longer line is
+		 * recorded and the rest of it is skipped */
+		if ((len > CONVERT_LINE_MAX - 2) ||
+				((pLF == NULL) && (!(pBlock->final)))) {
+			if (!dead_letter) {
+				pBlock->err = CONVERT_ERR_LONG;
+				break;
+			}
+			if (len > CONVERT_LINE_MAX - 2) {
+				len = CONVERT_LINE_MAX - 2;
+			}
+			if (count > 0) {
+				convertFormat(pFmt, pBlock, pDays, pDates, count);
+				count = 0;
+			}
+			convertDeadLetter(pBlock, pc, len, NELSC_DETECT_UNKNOWN,
+				NULL);
+			pc = (pLF != NULL) ? (pLF + 1) : pEnd;
+			(pBlock->lines)++;
+			continue;
+		}
+		
+		/* Copy the line */
+		memcpy(line, pc, len);
+		line[len] = 0;
+		
+		pc += len;
+		if (pLF != NULL) {
+			pc++;
+		}
+		
+		/* Parse the line */
+		if (!dateToOffset(line, in_fmt, &(pDays[count]), &detected,
+				&(pBlock->scan_err))) {
+			if (dead_letter) {
+				if (count > 0) {
+					convertFormat(pFmt, pBlock, pDays, pDates, count);
+					count = 0;
+				}
+				convertDeadLetter(pBlock, line, len, detected,
+					&(pBlock->scan_err));
+				(pBlock->lines)++;
+				continue;
+			}
+			pBlock->err = CONVERT_ERR_PARSE;
+			pBlock->err_format = detected;
+			break;
+		}
+		(pBlock->formats[detected])++;
+		count++;
+		(pBlock->lines)++;
+		
+		/* Format full batches as they are filled */
+		if (count >= CONVERT_BATCH) {
+			convertFormat(pFmt, pBlock, pDays, pDates, count);
+			count = 0;
+		}
+	}
+	
+	/* Format the remaining dates, including those preceding a line
+	 * that failed */
+	if (count > 0) {
+		convertFormat(pFmt, pBlock, pDays, pDates, count);
+	}
+}
+
+/*
+ * Record a line that failed to parse in the dead-letter buffer of a
+ * block.
+ * 
+ * The record is made up of the index of the line within the block, the
+ * number of output bytes that precede the line, the short code of the
+ * error, the name of the detected format (or
+ * "unknown"), the one-based column of the error, and the text of the
+ * line.  The writer adds the line number when it copies the record to
+ * the dead-letter file.
+ * 
+ * A line that is too long is recorded with the code "long" and the
+ * column of the first character beyond the limit, followed by the
+ * start of the line.
+ * 
+ * Parameters:
+ * 
+ *   pBlock - the block holding the line
+ * 
+ *   pLine - the text of the line, without its line feed
+ * 
+ *   len - the number of characters in the line
+ * 
+ *   detected - the NELSC_DETECT constant of the format of the line, or
+ *   NELSC_DETECT_UNKNOWN
+ * 
+ *   pErr - the parse error of the line, or NULL if the line is too
+ *   long
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static void convertDeadLetter(
+		CONVERT_BLOCK *pBlock,
+		const char *pLine,
+		size_t len,
+		int detected,
+		const SCANERR *pErr) {
+	
+	size_t need = 0;
+	int32_t index = 0;
+	int count = 0;
+	const char *pCode = "long";
+	long column = CONVERT_LINE_MAX - 1;
+	
+	if (pErr != NULL) {
+		pCode = scanerr_code(pErr->reason);
+		column = ((long) pErr->pos) + 1;
+	}
+	
+	/* Make sure there is room for the record */
+	need = sizeof(int32_t) + sizeof(size_t) + len + CONVERT_DEAD_EXTRA;
+	if (pBlock->dead_cap - pBlock->dead_len < need) {
+		pBlock->dead_cap *= 2;
+		if (pBlock->dead_cap - pBlock->dead_len < need) {
+			pBlock->dead_cap = pBlock->dead_len + need;
+		}
+		pBlock->pDead = (char *) realloc(
+							pBlock->pDead, pBlock->dead_cap);
+		if (pBlock->pDead == NULL) {
+			abort();
+		}
+	}
+	
+	/* Write the record */
+	index = (int32_t) pBlock->lines;
+	memcpy(pBlock->pDead + pBlock->dead_len, &index, sizeof(int32_t));
+	pBlock->dead_len += sizeof(int32_t);
+	memcpy(pBlock->pDead + pBlock->dead_len, &(pBlock->out_len),
+		sizeof(size_t));
+	pBlock->dead_len += sizeof(size_t);
+	
+	count = snprintf(pBlock->pDead + pBlock->dead_len,
+				CONVERT_DEAD_EXTRA,
+				"\t%s\t%s\t%ld\t", pCode,
+				(detected != NELSC_DETECT_UNKNOWN) ?
+					nelsc_detect_name(detected) : "unknown",
+				column);
+	if ((count < 0) || (count >= CONVERT_DEAD_EXTRA)) {
+		abort();
+	}
+	pBlock->dead_len += (size_t) count;
+	
+	memcpy(pBlock->pDead + pBlock->dead_len, pLine, len);
+	pBlock->dead_len += len;
+	pBlock->pDead[pBlock->dead_len] = '\n';
+	(pBlock->dead_len)++;
+	
+	(pBlock->dead)++;
+}
+
+/*
+ * The start function of the reader thread of the convert pipeline.
+ * 
+ * Takes free blocks, fills them with complete lines read from standard
+ * input, and hands them out to the converters in turn.  Reading stops
+ * at the end of input, on a read error, or when the writer stops the
+ * pipeline.  An end marker is then sent to every converter.
+ * 
+ * Parameters:
+ * 
+ *   pParam - the CONVERT_PIPE
+ * 
+ * Return:
+ * 
+ *   always NULL
+ */
+static void *convertReader(void *pParam) {
+	
+	CONVERT_PIPE *pPipe = NULL;
+	CONVERT_BLOCK *pBlock = NULL;
+	char *pCarry = NULL;
+	size_t carry_len = 0;
+	size_t len = 0;
+	size_t i = 0;
+	ssize_t retval = 0;
+	bool eof = false;
+	bool has_lf = false;
+	const char *pLF = NULL;
+	int32_t next = 0;
+	
+	pPipe = (CONVERT_PIPE *) pParam;
+	
+	/* Allocate a buffer for the partial line at the end of a block,
+	 * which is carried over to the start of the next block */
+	pCarry = (char *) malloc(CONVERT_BLOCK_SIZE);
+	if (pCarry == NULL) {
+		abort();
+	}
+	
+	while ((!eof) &&
+			(!__atomic_load_n(&(pPipe->stop), __ATOMIC_ACQUIRE))) {
+		/* Get a free block and start it with the carried-over line */
+		pBlock = (CONVERT_BLOCK *) nelsc_spsc_pop(pPipe->pFree);
+		memcpy(pBlock->pIn, pCarry, carry_len);
+		len = carry_len;
+		carry_len = 0;
+		
+		/* Read until the block holds at least one complete line, the
+		 * block is full, or input ends */
+		has_lf = false;
+		while ((!has_lf) && (len < CONVERT_BLOCK_SIZE)) {
+			retval = read(STDIN_FILENO, pBlock->pIn + len,
+							CONVERT_BLOCK_SIZE - len);
+			if (retval < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				pPipe->read_error = true;
+				eof = true;
+				break;
+			
+			} else if (retval == 0) {
+				eof = true;
+				break;
+			}
+			
+			if (memchr(pBlock->pIn + len, '\n', (size_t) retval)
+					!= NULL) {
+				has_lf = true;
+			}
+			len += (size_t) retval;
+		}
+		
+		/* Unless this is the end of input, move any partial line at the
+		 * end of the block over to the next block */
+		pBlock->in_len = len;
+		if ((!eof) && has_lf) {
+			i = len;
+			while (pBlock->pIn[i - 1] != '\n') {
+				i--;
+			}
+			carry_len = len - i;
+			memcpy(pCarry, pBlock->pIn + i, carry_len);
+			pBlock->in_len = i;
+		
+		} else if ((!eof) && pPipe->dead_letter) {
+			/* The line filled the whole block, so it will be
+			 * dead-lettered; drop the rest of it, carrying over what
+			 * follows its line feed */
+			while (!has_lf) {
+				retval = read(STDIN_FILENO, pCarry, CONVERT_BLOCK_SIZE);
+				if (retval < 0) {
+					if (errno == EINTR) {
+						continue;
+					}
+					pPipe->read_error = true;
+					eof = true;
+					break;
+				
+				} else if (retval == 0) {
+					eof = true;
+					break;
+				}
+				
+				pLF = (const char *) memchr(pCarry, '\n',
+										(size_t) retval);
+				if (pLF != NULL) {
+					has_lf = true;
+					carry_len = (size_t) retval -
+									((size_t) (pLF - pCarry) + 1);
+					memmove(pCarry, pLF + 1, carry_len);
+				}
+			}
+		}
+		pBlock->final = eof;
+		
+		/* Hand the block to the next converter */
+		nelsc_spsc_push((pPipe->pWork)[next], pBlock);
+		next = (next + 1) % pPipe->workers;
+	}
+	
+	/* Send an end marker to every converter */
+	for(i = 0; i < (size_t) pPipe->workers; i++) {
+		nelsc_spsc_push((pPipe->pWork)[i], NULL);
+	}
+	
+	free(pCarry);
+	return NULL;
+}
+
+/*
+ * The start function of a converter thread of the convert pipeline.
+ * 
+ * Converts each block received from the reader and passes it on to the
+ * writer, until the end marker is received, which is then also passed
+ * on.  Once the writer has stopped the pipeline, blocks are passed on
+ * without converting them.
+ * 
+ * Parameters:
+ * 
+ *   pParam - the CONVERT_WORKER of the thread
+ * 
+ * Return:
+ * 
+ *   always NULL
+ */
+static void *convertWorker(void *pParam) {
+	
+	CONVERT_WORKER *pw = NULL;
+	CONVERT_PIPE *pPipe = NULL;
+	CONVERT_BLOCK *pBlock = NULL;
+	NELSC_ARENA *pArena = NULL;
+	int32_t *pDays = NULL;
+	NELSC_STRFTIME_DATE *pDates = NULL;
+	
+	pw = (CONVERT_WORKER *) pParam;
+	pPipe = pw->pPipe;
+	pArena = nelsc_arena_local();
+	
+	/* Convert blocks until the end marker */
+	while (true) {
+		pBlock = (CONVERT_BLOCK *) nelsc_spsc_pop(
+										(pPipe->pWork)[pw->index]);
+		if (pBlock == NULL) {
+			break;
+		}
+		
+		if (!__atomic_load_n(&(pPipe->stop), __ATOMIC_ACQUIRE)) {
+			/* Take the batch buffers from the arena of the thread,
+			 * which is reset for each block */
+			nelsc_arena_reset(pArena);
+			pDays = (int32_t *) nelsc_arena_alloc(pArena,
+						CONVERT_BATCH * sizeof(int32_t));
+			pDates = (NELSC_STRFTIME_DATE *) nelsc_arena_alloc(pArena,
+						CONVERT_BATCH * sizeof(NELSC_STRFTIME_DATE));
+			
+			convertBlock(pPipe->pFmt, pPipe->in_fmt, pPipe->dead_letter,
+						pBlock, pDays, pDates);
+		
+		} else {
+			pBlock->out_len = 0;
+			pBlock->lines = 0;
+			pBlock->dead_len = 0;
+			pBlock->dead = 0;
+			pBlock->err = CONVERT_OK;
+			memset(pBlock->formats, 0, sizeof(pBlock->formats));
+		}
+		
+		nelsc_spsc_push((pPipe->pDone)[pw->index], pBlock);
+	}
+	nelsc_spsc_push((pPipe->pDone)[pw->index], NULL);
+	
+	return NULL;
+}
+
+/*
+ * Report why the line that stopped a convert block failed to parse.
+ * 
+ * The error was recorded by the parser while it read the line, so
+ * nothing is parsed again here.  The column counts from one.
+ * 
+ * Parameters:
+ * 
+ *   pErr - the sink to report to
+ * 
+ *   pBlock - the block that stopped with CONVERT_ERR_PARSE
+ * 
+ *   line - the line number of the line that failed
+ */
+static void convertDiagnose(
+		NELSC_SINK *pErr,
+		const CONVERT_BLOCK *pBlock,
+		long line) {
+	
+	char desc[SCANERR_DESCRIBE_MAX];
+	
+	scanerr_describe(desc, &(pBlock->scan_err));
+	
+	if (pBlock->err_format != NELSC_DETECT_UNKNOWN) {
+		nelsc_sink_printf(pErr, "Line %ld, column %ld: %s in %s date\n",
+			line, ((long) pBlock->scan_err.pos) + 1, desc,
+			nelsc_detect_name(pBlock->err_format));
+	} else {
+		nelsc_sink_printf(pErr, "Line %ld, column %ld: %s\n",
+			line, ((long) pBlock->scan_err.pos) + 1, desc);
+	}
+}
+
+/*
+ * Write the output of a converted block, and copy its dead-letter
+ * records to the dead-letter file with the line number of each failed
+ * line put in front of it.
+ * 
+ * The error budget is checked at each failed line, before anything
+ * after it is written.  The failed lines so far are measured against
+ * all the lines up to and including the failed line, or against
+ * CONVERT_BUDGET_LINES lines if there have been fewer.  Once a failed
+ * line takes the failures over budget, it is the last line whose
+ * output or record is written.
+ * 
+ * Parameters:
+ * 
+ *   pOut - the sink to write the output to
+ * 
+ *   pDead - the sink of the dead-letter file, or NULL if the block has
+ *   no dead-letter records
+ * 
+ *   pBlock - the block
+ * 
+ *   budget - the error budget as a percentage of lines
+ * 
+ *   pLines - the number of input lines before the block, which is
+ *   advanced past the lines that were written
+ * 
+ *   pFailed - the number of failed lines before the block, which is
+ *   advanced past the failed lines that were written
+ * 
+ * Return:
+ * 
+ *   true if the whole block was written, false if a failed line went
+ *   over budget
+ */
+static bool convertWriteBlock(
+		NELSC_SINK *pOut,
+		NELSC_SINK *pDead,
+		const CONVERT_BLOCK *pBlock,
+		double budget,
+		long *pLines,
+		long *pFailed) {
+	
+	bool result = true;
+	const char *pc = NULL;
+	const char *pEnd = NULL;
+	const char *pLF = NULL;
+	int32_t index = 0;
+	size_t out_pos = 0;
+	size_t out_end = 0;
+	long lines = 0;
+	
+	out_end = pBlock->out_len;
+	
+	pc = pBlock->pDead;
+	pEnd = pBlock->pDead + pBlock->dead_len;
+	while (pc < pEnd) {
+		memcpy(&index, pc, sizeof(int32_t));
+		pc += sizeof(int32_t);
+		memcpy(&out_pos, pc, sizeof(size_t));
+		pc += sizeof(size_t);
+		
+		pLF = (const char *) memchr(pc, '\n', (size_t) (pEnd - pc));
+		if (pLF == NULL) {
+			abort();
+		}
+		
+		nelsc_sink_printf(pDead, "%ld", *pLines + index + 1);
+		nelsc_sink_write(pDead, pc, (size_t) (pLF - pc) + 1);
+		pc = pLF + 1;
+		
+		/* Check the budget up to this line */
+		(*pFailed)++;
+		lines = *pLines + index + 1;
+		if (lines < CONVERT_BUDGET_LINES) {
+			lines = CONVERT_BUDGET_LINES;
+		}
+		if (((double) *pFailed) * 100.0 > budget * ((double) lines)) {
+			*pLines += index + 1;
+			out_end = out_pos;
+			result = false;
+			break;
+		}
+	}
+	
+	nelsc_sink_write(pOut, pBlock->pOut, out_end);
+	if (result) {
+		*pLines += pBlock->lines;
+	}
+	
+	return result;
+}
+
+/*
+ * Write the place of a record in an input file at the start of an error
+ * message, such as "Line 5" for standard input or "a.txt, line 5" for a
+ * named file.
+ * 
+ * Parameters:
+ * 
+ *   pErr - the sink to write the error message to
+ * 
+ *   pName - the name of the file, or NULL for standard input
+ * 
+ *   line_num - the one-based line number of the record
+ */
+static void recordWhere(
+		NELSC_SINK *pErr,
+		const char *pName,
+		long line_num) {
+	
+	if (pName == NULL) {
+		nelsc_sink_printf(pErr, "Line %ld", line_num);
+	} else {
+		nelsc_sink_printf(pErr, "%s, line %ld", pName, line_num);
+	}
+}
+
+/*
+ * Read a record from a file of records, one per line, each starting
+ * with a calendar date in any format that convert reads.
+ * 
+ * The line feed is dropped from the line, and the date is converted to
+ * a day offset.  If the line is too long or doesn't start with a valid
+ * date, or the file can't be read, an error message is written and
+ * RECORD_FAIL is returned.
+ * 
+ * Parameters:
+ * 
+ *   pIn - the file to read from
+ * 
+ *   pName - the name of the file for error messages, or NULL for
+ *   standard input
+ * 
+ *   pLine - the buffer to read the line into
+ * 
+ *   cap - the capacity of the line buffer, including room for the line
+ *   feed and the terminating null
+ * 
+ *   pLineNum - the number of lines read so far, which is incremented
+ *   when a line is read
+ * 
+ *   pLen - receives the length of the line without its line feed
+ * 
+ *   pOffs - receives the day offset of the date of the record
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ * Return:
+ * 
+ *   RECORD_OK if a record was read, RECORD_END at the end of the file,
+ *   or RECORD_FAIL if there was an error
+ * 
+ * Faults:
+ * 
+ *   - If any pointer parameter other than pName is NULL
+ * 
+ *   - If cap is less than two or greater than INT_MAX
+ */
+static int readRecord(
+		FILE *pIn,
+		const char *pName,
+		char *pLine,
+		size_t cap,
+		long *pLineNum,
+		size_t *pLen,
+		int32_t *pOffs,
+		NELSC_SINK *pErr) {
+	
+	int result = RECORD_OK;
+	size_t len = 0;
+	size_t end = 0;
+	int detected = 0;
+	char saved = 0;
+	bool parsed = false;
+	SCANERR err;
+	char desc[SCANERR_DESCRIBE_MAX];
+	
+	memset(&err, 0, sizeof(SCANERR));
+	
+	/* Check parameters */
+	if ((pIn == NULL) || (pLine == NULL) || (pLineNum == NULL) ||
+			(pLen == NULL) || (pOffs == NULL) || (pErr == NULL)) {
+		abort();
+	}
+	if ((cap < 2) || (cap > INT_MAX)) {
+		abort();
+	}
+	
+	/* Read the line, telling the end of the file from an error */
+	if (fgets(pLine, (int) cap, pIn) == NULL) {
+		result = RECORD_END;
+		if (ferror(pIn)) {
+			nelsc_sink_printf(pErr, "Error reading %s!\n",
+				(pName != NULL) ? pName : "standard input");
+			result = RECORD_FAIL;
+		}
+	}
+	
+	/* Drop the line feed, failing if the line didn't fit */
+	if (result == RECORD_OK) {
+		(*pLineNum)++;
+		len = strlen(pLine);
+		if ((len > 0) && (pLine[len - 1] == '\n')) {
+			len--;
+		} else if (!feof(pIn)) {
+			recordWhere(pErr, pName, *pLineNum);
+			nelsc_sink_printf(pErr, " is too long!\n");
+			result = RECORD_FAIL;
+		}
+	}
+	
+	/* Parse the date, which ends at the first whitespace character
+	 * after it, by briefly ending the line there */
+	if (result == RECORD_OK) {
+		end = 0;
+		while ((end < len) && isspace((unsigned char) pLine[end])) {
+			end++;
+		}
+		while ((end < len) && (!isspace((unsigned char) pLine[end]))) {
+			end++;
+		}
+		saved = pLine[end];
+		pLine[end] = 0;
+		parsed = dateToOffset(pLine, -1, pOffs, &detected, &err);
+		pLine[end] = saved;
+		
+		if (!parsed) {
+			scanerr_describe(desc, &err);
+			recordWhere(pErr, pName, *pLineNum);
+			nelsc_sink_printf(pErr, ": Could not parse record date!\n");
+			recordWhere(pErr, pName, *pLineNum);
+			if (detected != NELSC_DETECT_UNKNOWN) {
+				nelsc_sink_printf(pErr, ", column %ld: %s in %s date\n",
+					((long) err.pos) + 1, desc,
+					nelsc_detect_name(detected));
+			} else {
+				nelsc_sink_printf(pErr, ", column %ld: %s\n",
+					((long) err.pos) + 1, desc);
+			}
+			result = RECORD_FAIL;
+		}
+	}
+	
+	*pLen = len;
+	return result;
+}
+
+/*
+ * Write a joined pair of records as a single line, with the left record
+ * and the right record separated by a tab.
+ * 
+ * Parameters:
+ * 
+ *   pOut - the sink to write to
+ * 
+ *   pLeft - the text of the left record
+ * 
+ *   left_len - the number of characters in the left record
+ * 
+ *   pRight - the text of the right record
+ * 
+ *   right_len - the number of characters in the right record
+ */
+static void joinWrite(
+		NELSC_SINK *pOut,
+		const char *pLeft,
+		size_t left_len,
+		const char *pRight,
+		size_t right_len) {
+	
+	nelsc_sink_write(pOut, pLeft, left_len);
+	nelsc_sink_write(pOut, "\t", 1);
+	nelsc_sink_write(pOut, pRight, right_len);
+	nelsc_sink_write(pOut, "\n", 1);
+}
+
+/*
+ * Read the next record of a file that must be sorted by date, failing
+ * if its date is earlier than the date of the record before it.
+ * 
+ * Parameters:
+ * 
+ *   pIn - the file to read from
+ * 
+ *   pName - the name of the file, or NULL for standard input
+ * 
+ *   pLine - the buffer to read the line into, with a capacity of
+ *   RECORD_LINE_MAX
+ * 
+ *   pLineNum - the number of lines read so far
+ * 
+ *   pLen - receives the length of the line
+ * 
+ *   pOffs - the day offset of the previous record, or
+ *   NELSC_CYCLE_DAYMIN at the start of the file, which receives the
+ *   day offset of the record
+ * 
+ *   pUnsorted - NULL to fail on a record out of order, or a flag that
+ *   is instead set on a record out of order, which is then returned
+ *   as read
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ * Return:
+ * 
+ *   RECORD_OK if a record was read, RECORD_END at the end of the file,
+ *   or RECORD_FAIL if there was an error
+ */
+static int joinNext(
+		FILE *pIn,
+		const char *pName,
+		char *pLine,
+		long *pLineNum,
+		size_t *pLen,
+		int32_t *pOffs,
+		bool *pUnsorted,
+		NELSC_SINK *pErr) {
+	
+	int result = RECORD_OK;
+	int32_t prev = 0;
+	
+	prev = *pOffs;
+	result = readRecord(pIn, pName, pLine, RECORD_LINE_MAX,
+				pLineNum, pLen, pOffs, pErr);
+	
+	if ((result == RECORD_OK) && (*pOffs < prev)) {
+		if (pUnsorted != NULL) {
+			*pUnsorted = true;
+		} else {
+			recordWhere(pErr, pName, *pLineNum);
+			nelsc_sink_printf(pErr,
+				": Records are not sorted by date!\n");
+			result = RECORD_FAIL;
+		}
+	}
+	
+	return result;
+}
+
+/*
+ * Check whether a file of records is sorted by date, and then seek
+ * back to where reading started.
+ * 
+ * If the file can't be seeked, as when it is a pipe, nothing is read
+ * and it is reported as not sorted.
+ * 
+ * Parameters:
+ * 
+ *   pIn - the file
+ * 
+ *   pName - the name of the file, or NULL for standard input
+ * 
+ *   pLine - a line buffer with a capacity of RECORD_LINE_MAX
+ * 
+ *   pSorted - receives whether the file is sorted
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ * Return:
+ * 
+ *   true if successful, false if a record couldn't be read or the file
+ *   couldn't be seeked back
+ */
+static bool joinCheckSorted(
+		FILE *pIn,
+		const char *pName,
+		char *pLine,
+		bool *pSorted,
+		NELSC_SINK *pErr) {
+	
+	bool result = true;
+	int status = RECORD_OK;
+	long line_num = 0;
+	size_t len = 0;
+	int32_t offs = 0;
+	int32_t prev = NELSC_CYCLE_DAYMIN;
+	long start = 0;
+	
+	/* Find where reading starts, which also tells whether the file can
+	 * be read twice */
+	start = ftell(pIn);
+	if (start >= 0) {
+		if (fseek(pIn, start, SEEK_SET)) {
+			start = -1;
+		}
+	}
+	
+	*pSorted = (start >= 0);
+	while (*pSorted) {
+		status = readRecord(pIn, pName, pLine, RECORD_LINE_MAX,
+					&line_num, &len, &offs, pErr);
+		if (status != RECORD_OK) {
+			break;
+		}
+		if (offs < prev) {
+			*pSorted = false;
+		}
+		prev = offs;
+	}
+	
+	if (status == RECORD_FAIL) {
+		result = false;
+	}
+	
+	if (result && (start >= 0)) {
+		if (fseek(pIn, start, SEEK_SET)) {
+			if (pName == NULL) {
+				nelsc_sink_printf(pErr,
+					"Can't rewind standard input!\n");
+			} else {
+				nelsc_sink_printf(pErr, "Can't rewind %s!\n", pName);
+			}
+			result = false;
+		}
+	}
+	
+	return result;
+}
+
+/*
+ * Load a file of records in any order into a day index.
+ * 
+ * Parameters:
+ * 
+ *   pIn - the file
+ * 
+ *   pName - the name of the file, or NULL for standard input
+ * 
+ *   pLine - a line buffer with a capacity of RECORD_LINE_MAX
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ * Return:
+ * 
+ *   the built day index, which must eventually be released with
+ *   nelsc_dayindex_free(), or NULL if a record couldn't be read
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static NELSC_DAYINDEX *joinIndex(
+		FILE *pIn,
+		const char *pName,
+		char *pLine,
+		NELSC_SINK *pErr) {
+	
+	NELSC_DAYINDEX *pIndex = NULL;
+	int status = RECORD_OK;
+	long line_num = 0;
+	size_t len = 0;
+	int32_t offs = 0;
+	
+	pIndex = nelsc_dayindex_new();
+	while (true) {
+		status = readRecord(pIn, pName, pLine, RECORD_LINE_MAX,
+					&line_num, &len, &offs, pErr);
+		if (status != RECORD_OK) {
+			break;
+		}
+		nelsc_dayindex_add(pIndex, offs, pLine, len);
+	}
+	
+	if (status == RECORD_FAIL) {
+		nelsc_dayindex_free(pIndex);
+		pIndex = NULL;
+	} else {
+		nelsc_dayindex_build(pIndex);
+	}
+	
+	return pIndex;
+}
+
+/*
+ * Write each pair of a left record with the right records of its date
+ * in a day index, in the order of the right file.
+ * 
+ * Parameters:
+ * 
+ *   pOut - the sink to write the joined records to
+ * 
+ *   pIndex - the day index of the right records
+ * 
+ *   pLine - the text of the left record
+ * 
+ *   len - the number of characters in the left record
+ * 
+ *   offs - the day offset of the left record
+ */
+static void joinProbe(
+		NELSC_SINK *pOut,
+		const NELSC_DAYINDEX *pIndex,
+		const char *pLine,
+		size_t len,
+		int32_t offs) {
+	
+	const char *pRightLine = NULL;
+	size_t right_len = 0;
+	int32_t first = 0;
+	int32_t count = 0;
+	int32_t i = 0;
+	
+	count = nelsc_dayindex_find(pIndex, offs, &first);
+	for(i = 0; i < count; i++) {
+		pRightLine = nelsc_dayindex_line(pIndex, first + i, &right_len);
+		joinWrite(pOut, pLine, len, pRightLine, right_len);
+	}
+}
+
+/*
+ * Join the rest of a left file of records in any order through a day
+ * index of the right records.
+ * 
+ * Parameters:
+ * 
+ *   pIndex - the day index of the right records
+ * 
+ *   pLeft - the left file
+ * 
+ *   pLeftName - the name of the left file, or NULL for standard input
+ * 
+ *   pLine - a line buffer with a capacity of RECORD_LINE_MAX
+ * 
+ *   pLineNum - the number of lines of the left file read so far
+ * 
+ *   pOut - the sink to write the joined records to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ * Return:
+ * 
+ *   true if successful, false if a record couldn't be read
+ */
+static bool joinStream(
+		const NELSC_DAYINDEX *pIndex,
+		FILE *pLeft,
+		const char *pLeftName,
+		char *pLine,
+		long *pLineNum,
+		NELSC_SINK *pOut,
+		NELSC_SINK *pErr) {
+	
+	int status = RECORD_OK;
+	size_t len = 0;
+	int32_t offs = 0;
+	
+	while (true) {
+		status = readRecord(pLeft, pLeftName, pLine, RECORD_LINE_MAX,
+					pLineNum, &len, &offs, pErr);
+		if (status != RECORD_OK) {
+			break;
+		}
+		joinProbe(pOut, pIndex, pLine, len, offs);
+	}
+	
+	return (status != RECORD_FAIL);
+}
+
+/*
+ * Join two files of records that are both sorted by date, writing each
+ * pair of records with the same date.
+ * 
+ * Both files are read once, in step.  The right records of each date
+ * are gathered in memory, and then paired with each left record of the
+ * date as it is read, so only one date's worth of right records is held
+ * at a time.
+ * 
+ * If fall_back is set, the left file need not be sorted.  At the first
+ * left record out of order, the right file is read again into a day
+ * index, through which that record and the rest of the left file are
+ * joined as by joinHash().  The output is the same as if the whole join
+ * had been done with joinHash(), since both write the pairs in the
+ * order of the left file, and the left file is still read only once.
+ * The rest of the left file is then read even once the right file is
+ * done, to make sure no record is out of order.  The right file must
+ * be seekable.
+ * 
+ * Parameters:
+ * 
+ *   pLeft - the left file
+ * 
+ *   pLeftName - the name of the left file, or NULL for standard input
+ * 
+ *   pRight - the right file
+ * 
+ *   pRightName - the name of the right file
+ * 
+ *   pLine - a line buffer with a capacity of RECORD_LINE_MAX for each
+ *   file, one after the other
+ * 
+ *   fall_back - true to fall back to a day index if the left file is
+ *   not sorted, false to fail
+ * 
+ *   pOut - the sink to write the joined records to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ * Return:
+ * 
+ *   true if successful, false if a record couldn't be read or was out
+ *   of order
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static bool joinMerge(
+		FILE *pLeft,
+		const char *pLeftName,
+		FILE *pRight,
+		const char *pRightName,
+		char *pLine,
+		bool fall_back,
+		NELSC_SINK *pOut,
+		NELSC_SINK *pErr) {
+	
+	bool result = true;
+	char *pLeftLine = NULL;
+	char *pRightLine = NULL;
+	int left_status = RECORD_OK;
+	int right_status = RECORD_OK;
+	long left_num = 0;
+	long right_num = 0;
+	size_t left_len = 0;
+	size_t right_len = 0;
+	int32_t left_offs = NELSC_CYCLE_DAYMIN;
+	int32_t right_offs = NELSC_CYCLE_DAYMIN;
+	int32_t key = 0;
+	bool unsorted = false;
+	bool *pUnsorted = NULL;
+	long right_start = 0;
+	NELSC_DAYINDEX *pIndex = NULL;
+	
+	NELSC_SINK *pGroup = NULL;
+	size_t *pEnds = NULL;
+	size_t end_count = 0;
+	size_t end_cap = 0;
+	size_t i = 0;
+	size_t start = 0;
+	
+	pLeftLine = pLine;
+	pRightLine = pLine + RECORD_LINE_MAX;
+	
+	/* Remember where the right file starts in case of falling back */
+	if (fall_back) {
+		pUnsorted = &unsorted;
+		right_start = ftell(pRight);
+	}
+	
+	pGroup = nelsc_sink_newBuffer();
+	end_cap = 16;
+	pEnds = (size_t *) malloc(end_cap * sizeof(size_t));
+	if (pEnds == NULL) {
+		abort();
+	}
+	
+	left_status = joinNext(pLeft, pLeftName, pLeftLine,
+					&left_num, &left_len, &left_offs, pUnsorted, pErr);
+	if (left_status == RECORD_OK) {
+		right_status = joinNext(pRight, pRightName, pRightLine,
+							&right_num, &right_len, &right_offs,
+							NULL, pErr);
+	}
+	
+	while ((left_status == RECORD_OK) && (right_status == RECORD_OK) &&
+			(!unsorted)) {
+		if (left_offs < right_offs) {
+			left_status = joinNext(pLeft, pLeftName, pLeftLine,
+							&left_num, &left_len, &left_offs,
+							pUnsorted, pErr);
+		
+		} else if (left_offs > right_offs) {
+			right_status = joinNext(pRight, pRightName, pRightLine,
+							&right_num, &right_len, &right_offs,
+							NULL, pErr);
+		
+		} else {
+			/* Gather the right records of the date */
+			key = right_offs;
+			nelsc_sink_clear(pGroup);
+			end_count = 0;
+			while ((right_status == RECORD_OK) && (right_offs == key)) {
+				if (end_count >= end_cap) {
+					end_cap *= 2;
+					pEnds = (size_t *) realloc(pEnds,
+								end_cap * sizeof(size_t));
+					if (pEnds == NULL) {
+						abort();
+					}
+				}
+				nelsc_sink_write(pGroup, pRightLine, right_len);
+				pEnds[end_count] = nelsc_sink_length(pGroup);
+				end_count++;
+				
+				right_status = joinNext(pRight, pRightName, pRightLine,
+							&right_num, &right_len, &right_offs,
+							NULL, pErr);
+			}
+			
+			/* If a right record failed, stop before any of the date is
+			 * written, so a failed join leaves no partial group */
+			if (right_status == RECORD_FAIL) {
+				break;
+			}
+			
+			/* Pair them with each left record of the date */
+			while ((left_status == RECORD_OK) && (left_offs == key)) {
+				start = 0;
+				for(i = 0; i < end_count; i++) {
+					joinWrite(pOut, pLeftLine, left_len,
+						nelsc_sink_data(pGroup) + start,
+						pEnds[i] - start);
+					start = pEnds[i];
+				}
+				
+				left_status = joinNext(pLeft, pLeftName, pLeftLine,
+							&left_num, &left_len, &left_offs,
+							pUnsorted, pErr);
+			}
+		}
+	}
+	
+	/* When falling back, a left record out of order after the end of
+	 * the right file may still have a match earlier in it */
+	if (fall_back) {
+		while ((left_status == RECORD_OK) &&
+				(right_status == RECORD_END) && (!unsorted)) {
+			left_status = joinNext(pLeft, pLeftName, pLeftLine,
+							&left_num, &left_len, &left_offs,
+							pUnsorted, pErr);
+		}
+	}
+	
+	if ((left_status == RECORD_FAIL) || (right_status == RECORD_FAIL)) {
+		result = false;
+	}
+	
+	/* Join the record out of order and the rest of the left file
+	 * through a day index of the right file */
+	if (result && unsorted) {
+		if ((right_start < 0) || fseek(pRight, right_start, SEEK_SET)) {
+			nelsc_sink_printf(pErr, "Can't rewind %s!\n", pRightName);
+			result = false;
+		}
+		if (result) {
+			pIndex = joinIndex(pRight, pRightName, pRightLine, pErr);
+			if (pIndex == NULL) {
+				result = false;
+			}
+		}
+		if (result) {
+			joinProbe(pOut, pIndex, pLeftLine, left_len, left_offs);
+			result = joinStream(pIndex, pLeft, pLeftName, pLeftLine,
+							&left_num, pOut, pErr);
+		}
+		nelsc_dayindex_free(pIndex);
+	}
+	
+	nelsc_sink_free(pGroup);
+	free(pEnds);
+	
+	return result;
+}
+
+/*
+ * Join two files of records in any order, writing each pair of records
+ * with the same date.
+ * 
+ * The right file is loaded into a day index, which is a dense table
+ * with an entry for each day, and the left file is then streamed
+ * through it, so the memory used grows with the right file only.  The
+ * joined records are written in the order of the left file, and the
+ * right records of each date in the order of the right file.
+ * 
+ * Parameters:
+ * 
+ *   pLeft - the left file
+ * 
+ *   pLeftName - the name of the left file, or NULL for standard input
+ * 
+ *   pRight - the right file
+ * 
+ *   pRightName - the name of the right file
+ * 
+ *   pLine - a line buffer with a capacity of RECORD_LINE_MAX
+ * 
+ *   pOut - the sink to write the joined records to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ * Return:
+ * 
+ *   true if successful, false if a record couldn't be read
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static bool joinHash(
+		FILE *pLeft,
+		const char *pLeftName,
+		FILE *pRight,
+		const char *pRightName,
+		char *pLine,
+		NELSC_SINK *pOut,
+		NELSC_SINK *pErr) {
+	
+	bool result = true;
+	NELSC_DAYINDEX *pIndex = NULL;
+	long line_num = 0;
+	
+	/* Index the right records by day */
+	pIndex = joinIndex(pRight, pRightName, pLine, pErr);
+	if (pIndex == NULL) {
+		result = false;
+	}
+	
+	/* Look up each left record */
+	if (result) {
+		result = joinStream(pIndex, pLeft, pLeftName, pLine, &line_num,
+					pOut, pErr);
+	}
+	
+	nelsc_dayindex_free(pIndex);
+	
+	return result;
+}
+
+/*
+ * Build an event store file from a file of events.
+ * 
+ * Each line of the input is an event, starting with a calendar date in
+ * any format that convert reads.  The text of the event is the rest of
+ * the line after the date and the whitespace following it.  Once
+ * written, the file is mapped and checked with nelsc_events_verify().
+ * 
+ * Parameters:
+ * 
+ *   pStore - the path of the store file to write
+ * 
+ *   pInName - the path of the file of events
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ * Return:
+ * 
+ *   true if successful, false if the events couldn't be read or the
+ *   store couldn't be written or didn't verify once written
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static bool eventsBuild(
+		const char *pStore,
+		const char *pInName,
+		NELSC_SINK *pErr) {
+	
+	bool result = true;
+	FILE *pIn = NULL;
+	char *pLine = NULL;
+	NELSC_DAYINDEX *pIndex = NULL;
+	NELSC_EVENTS *pEvents = NULL;
+	int status = RECORD_OK;
+	long line_num = 0;
+	size_t len = 0;
+	size_t start = 0;
+	int32_t offs = 0;
+	
+	pIn = fopen(pInName, "r");
+	if (pIn == NULL) {
+		nelsc_sink_printf(pErr, "Can't open %s!\n", pInName);
+		result = false;
+	}
+	
+	/* Index the text of each event by its day */
+	if (result) {
+		pLine = (char *) malloc(RECORD_LINE_MAX);
+		if (pLine == NULL) {
+			abort();
+		}
+		pIndex = nelsc_dayindex_new();
+		
+		while (true) {
+			status = readRecord(pIn, pInName, pLine, RECORD_LINE_MAX,
+						&line_num, &len, &offs, pErr);
+			if (status != RECORD_OK) {
+				break;
+			}
+			
+			start = 0;
+			while ((start < len) &&
+					isspace((unsigned char) pLine[start])) {
+				start++;
+			}
+			while ((start < len) &&
+					(!isspace((unsigned char) pLine[start]))) {
+				start++;
+			}
+			while ((start < len) &&
+					isspace((unsigned char) pLine[start])) {
+				start++;
+			}
+			nelsc_dayindex_add(pIndex, offs,
+				pLine + start, len - start);
+		}
+		if (status == RECORD_FAIL) {
+			result = false;
+		}
+	}
+	
+	/* Lay out the store and write it */
+	if (result) {
+		nelsc_dayindex_build(pIndex);
+		pEvents = nelsc_events_new(pIndex);
+		if (!nelsc_events_save(pEvents, pStore)) {
+			nelsc_sink_printf(pErr, "Can't write event store %s!\n",
+				pStore);
+			result = false;
+		}
+	}
+	
+	/* Check the whole of the file that was written, which is the one
+	 * time the store is read from end to end */
+	if (result) {
+		nelsc_events_free(pEvents);
+		pEvents = nelsc_events_map(pStore);
+		if (pEvents == NULL) {
+			result = false;
+		} else if (!nelsc_events_verify(pEvents)) {
+			result = false;
+		}
+		if (!result) {
+			nelsc_sink_printf(pErr,
+				"Event store %s did not verify after writing!\n",
+				pStore);
+		}
+	}
+	
+	/* Release resources */
+	if (pIn != NULL) {
+		fclose(pIn);
+	}
+	free(pLine);
+	nelsc_dayindex_free(pIndex);
+	nelsc_events_free(pEvents);
+	
+	return result;
+}
+
+/*
+ * Write a run of consecutive events of a store, one per line, each as
+ * its NELSC date, a tab, and its text.
+ * 
+ * Parameters:
+ * 
+ *   pOut - the sink to write to
+ * 
+ *   pEvents - the store
+ * 
+ *   first - the number of the first event to write
+ * 
+ *   count - the number of events to write
+ */
+static void eventsWrite(
+		NELSC_SINK *pOut,
+		const NELSC_EVENTS *pEvents,
+		int32_t first,
+		int32_t count) {
+	
+	const char *pText = NULL;
+	size_t len = 0;
+	int32_t i = 0;
+	int32_t day = 0;
+	int32_t month = 0;
+	int32_t year = 0;
+	int32_t month_of_year = 0;
+	int32_t day_of_month = 0;
+	char buf[NELSC_FORMAT_DATE_LENGTH + 1];
+	
+	for(i = first; i < first + count; i++) {
+		day = nelsc_events_dayOf(pEvents, i);
+		month = nelsc_cycle_dayToMonth(day, &day_of_month);
+		year = nelsc_cycle_monthToYear(month, &month_of_year);
+		nelsc_format_writeDate(buf, year, month_of_year, day_of_month);
+		buf[NELSC_FORMAT_DATE_LENGTH] = '\t';
+		
+		pText = nelsc_events_text(pEvents, i, &len);
+		nelsc_sink_write(pOut, buf, NELSC_FORMAT_DATE_LENGTH + 1);
+		nelsc_sink_write(pOut, pText, len);
+		nelsc_sink_write(pOut, "\n", 1);
+	}
+}
+
+/*
+ * Read the clock used for timing batch commands.
+ * 
+ * Return:
+ * 
+ *   the current monotonic time in nanoseconds
+ * 
+ * Faults:
+ * 
+ *   - If the clock can't be read
+ */
+static uint64_t batchClock(void) {
+	
+	struct timespec ts;
+	
+	if (clock_gettime(CLOCK_MONOTONIC, &ts)) {
+		abort();
+	}
+	
+	return (((uint64_t) ts.tv_sec) * UINT64_C(1000000000)) +
+			((uint64_t) ts.tv_nsec);
+}
+
+/*
+ * Start gathering statistics in m_batch for a new batch session.
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static void batchBegin(void) {
+	
+	int i = 0;
+	
+	memset(&m_batch, 0, sizeof(BATCH_STATS));
+	
+	m_batch.pCommands = (BATCH_COMMAND *) calloc(
+							(size_t) SUBPROGRAM_COUNT,
+							sizeof(BATCH_COMMAND));
+	if (m_batch.pCommands == NULL) {
+		abort();
+	}
+	
+	for(i = 0; i < SUBPROGRAM_COUNT; i++) {
+		(m_batch.pCommands)[i].pLatency = nelsc_hist_new();
+	}
+}
+
+/*
+ * Stop gathering statistics in m_batch at the end of a batch session
+ * and release them.
+ */
+static void batchEnd(void) {
+	
+	int i = 0;
+	
+	if (m_batch.pCommands != NULL) {
+		for(i = 0; i < SUBPROGRAM_COUNT; i++) {
+			nelsc_hist_free((m_batch.pCommands)[i].pLatency);
+		}
+		free(m_batch.pCommands);
+	}
+	
+	memset(&m_batch, 0, sizeof(BATCH_STATS));
+	m_batch.pCommands = NULL;
+}
+
+/*
+ * Check grcal_offsetToDate() against grcal_offsetToDateCascade() over
+ * every Gregorian day offset.
+ * 
+ * Parameters:
+ * 
+ *   pCount - pointer to variable to receive the number of offsets
+ *   checked
+ * 
+ *   pBad - pointer to variable to receive the first offset with
+ *   different results
+ * 
+ * Return:
+ * 
+ *   true if the results all match, false if not
+ */
+static bool checkGrcalAffine(int32_t *pCount, int32_t *pBad) {
+	
+	bool result = true;
+	int32_t offs = 0;
+	int32_t y = 0;
+	int32_t m = 0;
+	int32_t d = 0;
+	int32_t ref_y = 0;
+	int32_t ref_m = 0;
+	int32_t ref_d = 0;
+	
+	for(offs = GRCAL_DAY_MIN; offs <= GRCAL_DAY_MAX; offs++) {
+		grcal_offsetToDate(offs, &y, &m, &d);
+		grcal_offsetToDateCascade(offs, &ref_y, &ref_m, &ref_d);
+		if ((y != ref_y) || (m != ref_m) || (d != ref_d)) {
+			*pBad = offs;
+			result = false;
+			break;
+		}
+	}
+	
+	*pCount = offs - GRCAL_DAY_MIN;
+	return result;
+}
+
+/*
+ * Check grcal_dateToOffset() and grcal_datesToOffsets() against
+ * grcal_dateToOffsetCascade() over every combination of year, month,
+ * and day just past the valid ranges in each direction.
+ * 
+ * If a mismatch is found, the date is reported in *pBad as the decimal
+ * number with digits YYYYMMDD.
+ * 
+ * Parameters:
+ * 
+ *   pCount - pointer to variable to receive the number of dates
+ *   checked
+ * 
+ *   pBad - pointer to variable to receive the first date with
+ *   different results
+ * 
+ * Return:
+ * 
+ *   true if the results all match, false if not
+ */
+static bool checkGrcalTables(int32_t *pCount, int32_t *pBad) {
+	
+	bool result = true;
+	int32_t years[GRCAL_CHECK_DATES];
+	int32_t months[GRCAL_CHECK_DATES];
+	int32_t days[GRCAL_CHECK_DATES];
+	int32_t offsets[GRCAL_CHECK_DATES];
+	int32_t y = 0;
+	int32_t m = 0;
+	int32_t d = 0;
+	int32_t i = 0;
+	int32_t offs = 0;
+	int32_t ref_offs = 0;
+	int32_t count = 0;
+	bool valid = false;
+	bool ref_valid = false;
+	
+	for(y = GRCAL_CHECK_YEAR_MIN; y <= GRCAL_CHECK_YEAR_MAX; y++) {
+		/* Fill in every month and day of the year */
+		i = 0;
+		for(m = 0; m <= 13; m++) {
+			for(d = 0; d <= 32; d++) {
+				years[i] = y;
+				months[i] = m;
+				days[i] = d;
+				i++;
+			}
+		}
+		grcal_datesToOffsets(
+			offsets, years, months, days, GRCAL_CHECK_DATES);
+		
+		/* Compare each date with the reference */
+		for(i = 0; i < GRCAL_CHECK_DATES; i++) {
+			count++;
+			offs = -1;
+			ref_offs = -1;
+			valid = grcal_dateToOffset(
+						&offs, years[i], months[i], days[i]);
+			ref_valid = grcal_dateToOffsetCascade(
+						&ref_offs, years[i], months[i], days[i]);
+			if ((valid != ref_valid) || (offs != ref_offs) ||
+					(offsets[i] != ref_offs)) {
+				*pBad = (years[i] * 10000) +
+							(months[i] * 100) + days[i];
+				result = false;
+				break;
+			}
+		}
+		if (!result) {
+			break;
+		}
+	}
+	
+	*pCount = count;
+	return result;
+}
+
+/*
+ * Check the nelsc_table lookups against the nelsc_cycle functions over
+ * every NELSC day offset, month offset, and year.
+ * 
+ * If a mismatch is found, the input reported in *pBad may be a day, a
+ * month, or a year offset.
+ * 
+ * Parameters:
+ * 
+ *   pCount - pointer to variable to receive the number of inputs
+ *   checked
+ * 
+ *   pBad - pointer to variable to receive the first input with
+ *   different results
+ * 
+ * Return:
+ * 
+ *   true if the results all match, false if not
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static bool checkNelscTable(int32_t *pCount, int32_t *pBad) {
+	
+	bool result = true;
+	NELSC_TABLE *pTable = NULL;
+	int32_t i = 0;
+	int32_t offs = 0;
+	int32_t ref_offs = 0;
+	int32_t count = 0;
+	
+	pTable = (NELSC_TABLE *) malloc(sizeof(NELSC_TABLE));
+	if (pTable == NULL) {
+		abort();
+	}
+	nelsc_table_build(pTable);
+	
+	for(i = NELSC_CYCLE_DAYMIN; i <= NELSC_CYCLE_DAYMAX; i++) {
+		count++;
+		if ((nelsc_table_dayToMonth(pTable, i, &offs) !=
+					nelsc_cycle_dayToMonth(i, &ref_offs)) ||
+				(offs != ref_offs)) {
+			result = false;
+			break;
+		}
+	}
+	if (result) {
+		for(i = NELSC_CYCLE_MONMIN; i <= NELSC_CYCLE_MONMAX; i++) {
+			count++;
+			if ((nelsc_table_monthToDay(pTable, i) !=
+						nelsc_cycle_monthToDay(i)) ||
+					(nelsc_table_monthToYear(pTable, i, &offs) !=
+						nelsc_cycle_monthToYear(i, &ref_offs)) ||
+					(offs != ref_offs)) {
+				result = false;
+				break;
+			}
+		}
+	}
+	if (result) {
+		for(i = NELSC_CYCLE_YEARMIN; i <= NELSC_CYCLE_YEARMAX; i++) {
+			count++;
+			if (nelsc_table_yearToMonth(pTable, i) !=
+					nelsc_cycle_yearToMonth(i)) {
+				result = false;
+				break;
+			}
+		}
+	}
+	
+	free(pTable);
+	pTable = NULL;
+	
+	if (!result) {
+		*pBad = i;
+	}
+	*pCount = count;
+	return result;
+}
+
+/*
+ * Check the nelsc_eytz searches against the nelsc_cycle functions over
+ * every NELSC day offset and month offset.
+ * 
+ * If a mismatch is found, the input reported in *pBad may be a day or
+ * a month offset.
+ * 
+ * Parameters:
+ * 
+ *   pCount - pointer to variable to receive the number of inputs
+ *   checked
+ * 
+ *   pBad - pointer to variable to receive the first input with
+ *   different results
+ * 
+ * Return:
+ * 
+ *   true if the results all match, false if not
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static bool checkNelscEytz(int32_t *pCount, int32_t *pBad) {
+	
+	bool result = true;
+	NELSC_EYTZ *pEytz = NULL;
+	int32_t i = 0;
+	int32_t offs = 0;
+	int32_t ref_offs = 0;
+	int32_t count = 0;
+	
+	if (posix_memalign((void **) &pEytz, NELSC_EYTZ_ALIGN,
+			sizeof(NELSC_EYTZ))) {
+		abort();
+	}
+	nelsc_eytz_build(pEytz);
+	
+	for(i = NELSC_CYCLE_DAYMIN; i <= NELSC_CYCLE_DAYMAX; i++) {
+		count++;
+		if ((nelsc_eytz_dayToMonth(pEytz, i, &offs) !=
+					nelsc_cycle_dayToMonth(i, &ref_offs)) ||
+				(offs != ref_offs)) {
+			result = false;
+			break;
+		}
+	}
+	if (result) {
+		for(i = NELSC_CYCLE_MONMIN; i <= NELSC_CYCLE_MONMAX; i++) {
+			count++;
+			if ((nelsc_eytz_monthToYear(pEytz, i, &offs) !=
+						nelsc_cycle_monthToYear(i, &ref_offs)) ||
+					(offs != ref_offs)) {
+				result = false;
+				break;
+			}
+		}
+	}
+	
+	free(pEytz);
+	pEytz = NULL;
+	
+	if (!result) {
+		*pBad = i;
+	}
+	*pCount = count;
+	return result;
+}
+
+/*
+ * Check the nelsc_simd search against nelsc_cycle_dayToMonth() over
+ * every NELSC day offset.
+ * 
+ * Parameters:
+ * 
+ *   pCount - pointer to variable to receive the number of inputs
+ *   checked
+ * 
+ *   pBad - pointer to variable to receive the first input with
+ *   different results
+ * 
+ * Return:
+ * 
+ *   true if the results all match, false if not
+ */
+static bool checkNelscSimd(int32_t *pCount, int32_t *pBad) {
+	
+	bool result = true;
+	NELSC_SIMD simd;
+	int32_t i = 0;
+	int32_t offs = 0;
+	int32_t ref_offs = 0;
+	
+	nelsc_simd_build(&simd);
+	
+	for(i = NELSC_CYCLE_DAYMIN; i <= NELSC_CYCLE_DAYMAX; i++) {
+		if ((nelsc_simd_dayToMonth(&simd, i, &offs) !=
+					nelsc_cycle_dayToMonth(i, &ref_offs)) ||
+				(offs != ref_offs)) {
+			*pBad = i;
+			result = false;
+			break;
+		}
+	}
+	
+	*pCount = i - NELSC_CYCLE_DAYMIN;
+	return result;
+}
+
+/*
+ * Check the nelsc_format sort keys against the formatted dates of
+ * every NELSC day offset.
+ * 
+ * The dates of all the days are formatted into one column, and the
+ * keys of the column are made with nelsc_format_dateToKeyBatch().  The
+ * key of each day must match the key made from the date on its own and
+ * from its fields, must be greater than the key of the day before, and
+ * must give back the same date with nelsc_format_keyToDate().
+ * 
+ * Parameters:
+ * 
+ *   pCount - pointer to variable to receive the number of inputs
+ *   checked
+ * 
+ *   pBad - pointer to variable to receive the first input with
+ *   different results
+ * 
+ * Return:
+ * 
+ *   true if the results all match, false if not
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static bool checkNelscKeys(int32_t *pCount, int32_t *pBad) {
+	
+	bool result = true;
+	char *pDates = NULL;
+	uint8_t *pKeys = NULL;
+	const char *pDate = NULL;
+	const uint8_t *pKey = NULL;
+	char date[NELSC_FORMAT_DATE_LENGTH + 1];
+	char back[NELSC_FORMAT_DATE_LENGTH];
+	uint8_t key[NELSC_FORMAT_KEY_LENGTH];
+	size_t days = 0;
+	size_t done = 0;
+	int32_t i = 0;
+	int32_t m = 0;
+	int32_t y = 0;
+	int32_t moy = 0;
+	int32_t dom = 0;
+	
+	/* Format the date of every day into one column */
+	days = (size_t) (NELSC_CYCLE_DAYMAX - NELSC_CYCLE_DAYMIN + 1);
+	pDates = (char *) malloc(days * NELSC_FORMAT_DATE_LENGTH);
+	pKeys = (uint8_t *) malloc(days * NELSC_FORMAT_KEY_LENGTH);
+	if ((pDates == NULL) || (pKeys == NULL)) {
+		abort();
+	}
+	
+	for(i = NELSC_CYCLE_DAYMIN; i <= NELSC_CYCLE_DAYMAX; i++) {
+		m = nelsc_cycle_dayToMonth(i, &dom);
+		y = nelsc_cycle_monthToYear(m, &moy);
+		nelsc_format_writeDate(
+			pDates + ((size_t) (i - NELSC_CYCLE_DAYMIN) *
+						NELSC_FORMAT_DATE_LENGTH),
+			y, moy, dom);
+	}
+	
+	/* Make the keys of the whole column at once */
+	done = nelsc_format_dateToKeyBatch(pKeys, pDates, days, NULL);
+	if (done < days) {
+		i = NELSC_CYCLE_DAYMIN + (int32_t) done;
+		result = false;
+	}
+	
+	/* Check each key against the single conversions and the key of the
+	 * day before */
+	if (result) {
+		for(i = NELSC_CYCLE_DAYMIN; i <= NELSC_CYCLE_DAYMAX; i++) {
+			pDate = pDates + ((size_t) (i - NELSC_CYCLE_DAYMIN) *
+								NELSC_FORMAT_DATE_LENGTH);
+			pKey = pKeys + ((size_t) (i - NELSC_CYCLE_DAYMIN) *
+								NELSC_FORMAT_KEY_LENGTH);
+			
+			memcpy(date, pDate, NELSC_FORMAT_DATE_LENGTH);
+			date[NELSC_FORMAT_DATE_LENGTH] = 0;
+			if ((!nelsc_format_dateToKey(key, date, NULL)) ||
+					(memcmp(key, pKey, NELSC_FORMAT_KEY_LENGTH) != 0)) {
+				result = false;
+				break;
+			}
+			
+			m = nelsc_cycle_dayToMonth(i, &dom);
+			y = nelsc_cycle_monthToYear(m, &moy);
+			nelsc_format_fieldsToKey(key, y, moy + 1, (dom / 7) + 1,
+				(dom % 7) + 1);
+			if (memcmp(key, pKey, NELSC_FORMAT_KEY_LENGTH) != 0) {
+				result = false;
+				break;
+			}
+			
+			if (i > NELSC_CYCLE_DAYMIN) {
+				if (memcmp(pKey - NELSC_FORMAT_KEY_LENGTH, pKey,
+						NELSC_FORMAT_KEY_LENGTH) >= 0) {
+					result = false;
+					break;
+				}
+			}
+			
+			if ((!nelsc_format_keyToDate(back, pKey)) ||
+					(memcmp(back, pDate, NELSC_FORMAT_DATE_LENGTH) !=
+						0)) {
+				result = false;
+				break;
+			}
+		}
+	}
+	
+	free(pDates);
+	pDates = NULL;
+	free(pKeys);
+	pKeys = NULL;
+	
+	if (!result) {
+		*pBad = i;
+	}
+	*pCount = i - NELSC_CYCLE_DAYMIN;
+	return result;
+}
+
+/*
+ * Prepare the data of the table lookup of the bench subprogram.
+ * 
+ * Parameters:
+ * 
+ *   pData - the memory to fill in, which holds an NELSC_TABLE
+ */
+static void buildTable(void *pData) {
+	nelsc_table_build((NELSC_TABLE *) pData);
+}
+
+/*
+ * Prepare the data of the Eytzinger lookup of the bench subprogram.
+ * 
+ * Parameters:
+ * 
+ *   pData - the memory to fill in, which holds an NELSC_EYTZ
+ */
+static void buildEytz(void *pData) {
+	nelsc_eytz_build((NELSC_EYTZ *) pData);
+}
+
+/*
+ * Prepare the data of the vector pattern lookup of the bench
+ * subprogram.
+ * 
+ * Parameters:
+ * 
+ *   pData - the memory to fill in, which holds an NELSC_SIMD
+ */
+static void buildSimd(void *pData) {
+	nelsc_simd_build((NELSC_SIMD *) pData);
+}
+
+/*
+ * Month lookup of the bench subprogram that walks the month pattern
+ * with nelsc_cycle_dayToMonth().
+ * 
+ * Parameters:
+ * 
+ *   pData - ignored
+ * 
+ *   d - the NELSC absolute day offset
+ * 
+ *   pOffset - pointer to variable to receive the offset of the day
+ *   within the month, or NULL
+ * 
+ * Return:
+ * 
+ *   the NELSC absolute month offset of the month that contains day d
+ */
+static int32_t findCycle(
+		const void *pData, int32_t d, int32_t *pOffset) {
+	(void) pData;
+	return nelsc_cycle_dayToMonth(d, pOffset);
+}
+
+/*
+ * Month lookup of the bench subprogram that indexes the tables of
+ * nelsc_table directly.
+ * 
+ * Parameters:
+ * 
+ *   pData - the NELSC_TABLE
+ * 
+ *   d - the NELSC absolute day offset
+ * 
+ *   pOffset - pointer to variable to receive the offset of the day
+ *   within the month, or NULL
+ * 
+ * Return:
+ * 
+ *   the NELSC absolute month offset of the month that contains day d
+ */
+static int32_t findTable(
+		const void *pData, int32_t d, int32_t *pOffset) {
+	return nelsc_table_dayToMonth(
+				(const NELSC_TABLE *) pData, d, pOffset);
+}
+
+/*
+ * Month lookup of the bench subprogram that searches the month starts
+ * in Eytzinger order with nelsc_eytz.
+ * 
+ * Parameters:
+ * 
+ *   pData - the NELSC_EYTZ
+ * 
+ *   d - the NELSC absolute day offset
+ * 
+ *   pOffset - pointer to variable to receive the offset of the day
+ *   within the month, or NULL
+ * 
+ * Return:
+ * 
+ *   the NELSC absolute month offset of the month that contains day d
+ */
+static int32_t findEytz(
+		const void *pData, int32_t d, int32_t *pOffset) {
+	return nelsc_eytz_dayToMonth(
+				(const NELSC_EYTZ *) pData, d, pOffset);
+}
+
+/*
+ * Month lookup of the bench subprogram that searches the 32-month
+ * pattern with vector compares with nelsc_simd.
+ * 
+ * Parameters:
+ * 
+ *   pData - the NELSC_SIMD
+ * 
+ *   d - the NELSC absolute day offset
+ * 
+ *   pOffset - pointer to variable to receive the offset of the day
+ *   within the month, or NULL
+ * 
+ * Return:
+ * 
+ *   the NELSC absolute month offset of the month that contains day d
+ */
+static int32_t findSimd(
+		const void *pData, int32_t d, int32_t *pOffset) {
+	return nelsc_simd_dayToMonth(
+				(const NELSC_SIMD *) pData, d, pOffset);
+}
+
+/*
+ * Time a month lookup of the bench subprogram over an array of days.
+ * 
+ * The lookup is run over all the days BENCH_PASSES times, and the time
+ * of the fastest pass is returned.  The months and offsets found in a
+ * pass are summed into *pSum, so that lookups giving different results
+ * can be told apart and the work can't be optimized away.
+ * 
+ * Parameters:
+ * 
+ *   pLookup - the lookup
+ * 
+ *   pData - the prepared data of the lookup
+ * 
+ *   pDays - the NELSC absolute day offsets to look up
+ * 
+ *   count - the number of days
+ * 
+ *   pSum - pointer to variable to receive the sum of the results
+ * 
+ * Return:
+ * 
+ *   the time of the fastest pass in nanoseconds
+ */
+static uint64_t benchRun(
+		const LOOKUP *pLookup,
+		const void *pData,
+		const int32_t *pDays,
+		int32_t count,
+		int64_t *pSum) {
+	
+	uint64_t result = UINT64_MAX;
+	uint64_t start = 0;
+	uint64_t elapsed = 0;
+	int64_t sum = 0;
+	int32_t offs = 0;
+	int32_t i = 0;
+	int p = 0;
+	
+	for(p = 0; p < BENCH_PASSES; p++) {
+		sum = 0;
+		start = batchClock();
+		for(i = 0; i < count; i++) {
+			sum += (*(pLookup->find))(pData, pDays[i], &offs);
+			sum += offs;
+		}
+		elapsed = batchClock() - start;
+		if (elapsed < result) {
+			result = elapsed;
+		}
+	}
+	
+	*pSum = sum;
+	return result;
+}
+
+/*
+ * Subprogram to display a brief helpscreen.
+ * 
+ * The helpscreen is generated from the help entries in the subprogram
+ * registry.  Any additional arguments are ignored.
+ * 
+ * Parameters:
+ * 
+ *   argc - the number of program arguments in argv
+ * 
+ *   argv - an array of null-terminated strings representing the program
+ *   arguments, with argc elements
+ * 
+ *   pOut - the sink to write the helpscreen to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ * Return:
+ * 
+ *   always EXIT_SUCCESS
+ */
+static int sub_help(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
+	
+	int i = 0;
+	
+	nelsc_sink_puts(pOut, "nelsc command summary:\n\n");
+	for(i = 0; i < SUBPROGRAM_COUNT; i++) {
+		nelsc_sink_puts(pOut, m_subprograms[i].pHelp);
+		nelsc_sink_puts(pOut, "\n");
+	}
+	
+	return EXIT_SUCCESS;
+}
+
+/*
+ * Subprogram to convert a signed decimal integer into a base-24 pair.
+ * 
+ * If the subprogram can't parse the argument or the argument is out
+ * of range, an error message is displayed to the user and EXIT_FAILURE
+ * is returned.
+ * 
+ * The first custom parameter is *not* checked -- that was assumed to
+ * have been interpreted by the main procedure to select this
+ * subprogram.  The number of custom parameters is also *not* checked,
+ * since dispatch() verifies it against the subprogram registry before
+ * calling through.
+ * 
+ * Parameters:
+ * 
+ *   argc - the number of program arguments in argv
+ * 
+ *   argv - an array of null-terminated strings representing the program
+ *   arguments, with argc elements; the first element is name of the
+ *   program module, while the second element is the first custom
+ *   argument (if it exists)
+ * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ * Return:
+ * 
+ *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
+ * 
+ * Faults:
+ * 
+ *   - If argc is negative
+ * 
+ *   - If argv is NULL
+ * 
+ *   - If any element of argv is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If argv has fewer elements than are indicated with argc
+ * 
+ *   - If any string indicated by argv is not null-terminated
+ */
+static int sub_to24pair(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
+	
+	const char *arg_decimal = NULL;
+	long argi = 0;
+	int result = EXIT_SUCCESS;
+	
+	/* Get the decimal argument */
+	arg_decimal = getCustom(argc, argv, 1);
+	
+	/* Convert the argument to a long integer */
+	if (result != EXIT_FAILURE) {
+		if (!stringToLong(arg_decimal, &argi)) {
+			nelsc_sink_printf(pErr,
+				"Could not parse argument as decimal integer!\n");
+			result = EXIT_FAILURE;
+		}
+	}
+	
+	/* Check the range of the argument */
+	if (result != EXIT_FAILURE) {
+		if ((argi < BASE24_PAIR_MIN) || (argi > BASE24_PAIR_MAX)) {
+			nelsc_sink_printf(pErr,
+				"Argument must be in range -96 to 479!\n");
+			result = EXIT_FAILURE;
+		}
+	}
+	
+	/* Perform the conversion */
+	if (result != EXIT_FAILURE) {
+		nelsc_sink_printf(pOut, "Decimal value:  %ld\n", argi);
+		nelsc_sink_printf(pOut, "Base-24 pair:   ");
+		writePair(pOut, (int32_t) argi);
+		nelsc_sink_printf(pOut, "\n");
+	}
+	
+	/* Return result */
+	return result;
+}
+
+/*
+ * Subprogram to convert a base-24 pair in signed style to a signed
+ * decimal integer.
+ * 
+ * If the subprogram can't parse the arguments, an error message is
+ * displayed to the user and EXIT_FAILURE is returned.
+ * 
+ * The first custom parameter is *not* checked -- that was assumed to
+ * have been interpreted by the main procedure to select this
+ * subprogram.  The number of custom parameters is also *not* checked,
+ * since dispatch() verifies it against the subprogram registry before
+ * calling through.
+ * 
+ * Parameters:
+ * 
+ *   argc - the number of program arguments in argv
+ * 
+ *   argv - an array of null-terminated strings representing the program
+ *   arguments, with argc elements; the first element is name of the
+ *   program module, while the second element is the first custom
+ *   argument (if it exists)
+ * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ * Return:
+ * 
+ *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
+ * 
+ * Faults:
+ * 
+ *   - If argc is negative
+ * 
+ *   - If argv is NULL
+ * 
+ *   - If any element of argv is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If argv has fewer elements than are indicated with argc
+ * 
+ *   - If any string indicated by argv is not null-terminated
+ */
+static int sub_from24pair(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
+	
+	const char *arg_pair = NULL;
+	long val = 0;
+	int result = EXIT_SUCCESS;
+	
+	/* Get the base-24 pair argument */
+	arg_pair = getCustom(argc, argv, 1);
+	
+	/* Perform the conversion */
+	if (result != EXIT_FAILURE) {
+		if (!pairToLong(arg_pair, &val)) {
+			nelsc_sink_printf(pErr,
+				"Could not parse as a base-24 pair!\n");
+			result = EXIT_FAILURE;
+		}
+	}
+	
+	/* Report results */
+	if (result != EXIT_FAILURE) {
+		nelsc_sink_printf(pOut, "Base-24 pair:   ");
+		writePair(pOut, (int32_t) val);
+		nelsc_sink_printf(pOut, "\n");
+		nelsc_sink_printf(pOut, "Decimal value:  %ld\n", val);
+	}
+	
+	/* Return result */
+	return result;
+}
+
+/*
+ * Subprogram to convert a decimal integer into an unsigned base-24
+ * digit.
+ * 
+ * The provided integer must be in the range 0 to 23 (inclusive).
+ * 
+ * If the subprogram can't parse the argument or the argument is out
+ * of range, an error message is displayed to the user and EXIT_FAILURE
+ * is returned.
+ * 
+ * The first custom parameter is *not* checked -- that was assumed to
+ * have been interpreted by the main procedure to select this
+ * subprogram.  The number of custom parameters is also *not* checked,
+ * since dispatch() verifies it against the subprogram registry before
+ * calling through.
+ * 
+ * Parameters:
+ * 
+ *   argc - the number of program arguments in argv
+ * 
+ *   argv - an array of null-terminated strings representing the program
+ *   arguments, with argc elements; the first element is name of the
+ *   program module, while the second element is the first custom
+ *   argument (if it exists)
+ * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ * Return:
+ * 
+ *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
+ * 
+ * Faults:
+ * 
+ *   - If argc is negative
+ * 
+ *   - If argv is NULL
+ * 
+ *   - If any element of argv is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If argv has fewer elements than are indicated with argc
+ * 
+ *   - If any string indicated by argv is not null-terminated
+ */
+static int sub_to24digit(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
+	
+	const char *arg_decimal = NULL;
+	long argi = 0;
+	int result = EXIT_SUCCESS;
+	
+	/* Get the decimal argument */
+	arg_decimal = getCustom(argc, argv, 1);
+	
+	/* Convert the argument to a long integer */
+	if (result != EXIT_FAILURE) {
+		if (!stringToLong(arg_decimal, &argi)) {
+			nelsc_sink_printf(pErr,
+				"Could not parse argument as decimal integer!\n");
+			result = EXIT_FAILURE;
+		}
+	}
+	
+	/* Check range */
+	if (result != EXIT_FAILURE) {
+		if ((argi < 0) || (argi > BASE24_DIGIT_MAX)) {
+			nelsc_sink_printf(pErr,
+				"Argument must be in range 0 to 23!\n");
+			result = EXIT_FAILURE;
+		}
+	}
+	
+	/* Perform the conversion */
+	if (result != EXIT_FAILURE) {
+		nelsc_sink_printf(pOut, "Decimal value:  %ld\n", argi);
+		nelsc_sink_printf(pOut, "Base-24 digit:  %c\n",
+			base24_intToDigit((int32_t) argi));
+	}
+	
+	/* Return result */
+	return result;
+}
+
+/*
+ * Subprogram to convert an unsigned base-24 digit to a decimal integer.
+ * 
+ * If the subprogram can't parse the arguments, an error message is
+ * displayed to the user and EXIT_FAILURE is returned.
+ * 
+ * The first custom parameter is *not* checked -- that was assumed to
+ * have been interpreted by the main procedure to select this
+ * subprogram.  The number of custom parameters is also *not* checked,
+ * since dispatch() verifies it against the subprogram registry before
+ * calling through.
+ * 
+ * Parameters:
+ * 
+ *   argc - the number of program arguments in argv
+ * 
+ *   argv - an array of null-terminated strings representing the program
+ *   arguments, with argc elements; the first element is name of the
+ *   program module, while the second element is the first custom
+ *   argument (if it exists)
+ * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ * Return:
+ * 
+ *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
+ * 
+ * Faults:
+ * 
+ *   - If argc is negative
+ * 
+ *   - If argv is NULL
+ * 
+ *   - If any element of argv is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If argv has fewer elements than are indicated with argc
+ * 
+ *   - If any string indicated by argv is not null-terminated
+ */
+static int sub_from24digit(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
+	
+	const char *arg_digit = NULL;
+	const char *pc = NULL;
+	char digit = 0;
+	int val = 0;
+	int result = EXIT_SUCCESS;
+	
+	/* Get the base-24 digit argument */
+	arg_digit = getCustom(argc, argv, 1);
+	
+	/* Scan through arg_digit and make sure there is exactly one
+	 * non-whitespace character; put this character into digit */
+	if (result != EXIT_FAILURE) {
+		pc = arg_digit;
+		while(*pc != 0) {
+			/* Check if current character is whitespace */
+			if (!isspace(*pc)) {
+				/* Not whitespace -- fail if we already have the digit
+				 * character */
+				if (digit != 0) {
+					nelsc_sink_printf(pErr,
+						"Provide no more than one base-24 digit!\n");
+					result = EXIT_FAILURE;
+					break;
+				}
+				
+				/* Otherwise, record the non-whitespace character */
+				digit = *pc;
+			}
+			pc++;
+		}
+		
+		/* Fail if we didn't encounter any non-whitespace characters */
+		if (result != EXIT_FAILURE) {
+			if (digit == 0) {
+				nelsc_sink_printf(pErr,
+					"Provide a base-24 digit!\n");
+				result = EXIT_FAILURE;
+			}
+		}
+	}
+	
+	/* Convert to decimal value */
+	if (result != EXIT_FAILURE) {
+		val = (int) base24_digitToInt(digit);
+		if (val == -1) {
+			nelsc_sink_printf(pErr,
+				"Could not parse as base-24 digit!\n");
+			result = EXIT_FAILURE;
+		}
+	}
+	
+	/* Report results */
+	if (result != EXIT_FAILURE) {
+		nelsc_sink_printf(pOut, "Base-24 digit:  %c\n", digit);
+		nelsc_sink_printf(pOut, "Decimal value:  %d\n", val);
+	}
+	
+	/* Return result */
+	return result;
+}
+
+/*
+ * Subprogram to provide information a particular NELSC absolute day
+ * offset.
+ * 
+ * If the subprogram can't parse the arguments, an error message is
+ * displayed to the user and EXIT_FAILURE is returned.
+ * 
+ * The first custom parameter is *not* checked -- that was assumed to
+ * have been interpreted by the main procedure to select this
+ * subprogram.  The number of custom parameters is also *not* checked,
+ * since dispatch() verifies it against the subprogram registry before
+ * calling through.
+ * 
+ * Parameters:
+ * 
+ *   argc - the number of program arguments in argv
+ * 
+ *   argv - an array of null-terminated strings representing the program
+ *   arguments, with argc elements; the first element is name of the
+ *   program module, while the second element is the first custom
+ *   argument (if it exists)
+ * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ * Return:
+ * 
+ *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
+ * 
+ * Faults:
+ * 
+ *   - If argc is negative
+ * 
+ *   - If argv is NULL
+ * 
+ *   - If any element of argv is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If argv has fewer elements than are indicated with argc
+ * 
+ *   - If any string indicated by argv is not null-terminated
+ */
+static int sub_day(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
+	
+	const char *arg_decimal = NULL;
+	long day = 0;
+	int result = EXIT_SUCCESS;
+	
+	/* Get the decimal argument */
+	arg_decimal = getCustom(argc, argv, 1);
+	
+	/* Convert the argument to a long integer */
+	if (result != EXIT_FAILURE) {
+		if (!stringToLong(arg_decimal, &day)) {
+			nelsc_sink_printf(pErr,
+				"Could not parse argument as decimal integer!\n");
+			result = EXIT_FAILURE;
+		}
+	}
+	
+	/* Check the range of the argument */
+	if (result != EXIT_FAILURE) {
+		if ((day < NELSC_CYCLE_DAYMIN) || (day > NELSC_CYCLE_DAYMAX)) {
+			nelsc_sink_printf(pErr,
+				"Argument must be in range %d to %d!\n",
+				NELSC_CYCLE_DAYMIN,
+				NELSC_CYCLE_DAYMAX);
+			result = EXIT_FAILURE;
+		}
+	}
+
+	/* Print information */
+	if (result != EXIT_FAILURE) {
+		printDayInformation(pOut, (int32_t) day);
+	}
+	
+	/* Return result */
+	return result;
+}
+
+/*
+ * Subprogram to provide information a particular NELSC absolute month
+ * offset.
+ * 
+ * If the subprogram can't parse the arguments, an error message is
+ * displayed to the user and EXIT_FAILURE is returned.
+ * 
+ * The first custom parameter is *not* checked -- that was assumed to
+ * have been interpreted by the main procedure to select this
+ * subprogram.  The number of custom parameters is also *not* checked,
+ * since dispatch() verifies it against the subprogram registry before
+ * calling through.
+ * 
+ * Parameters:
+ * 
+ *   argc - the number of program arguments in argv
+ * 
+ *   argv - an array of null-terminated strings representing the program
+ *   arguments, with argc elements; the first element is name of the
+ *   program module, while the second element is the first custom
+ *   argument (if it exists)
+ * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ * Return:
+ * 
+ *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
+ * 
+ * Faults:
+ * 
+ *   - If argc is negative
+ * 
+ *   - If argv is NULL
+ * 
+ *   - If any element of argv is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If argv has fewer elements than are indicated with argc
+ * 
+ *   - If any string indicated by argv is not null-terminated
+ */
+static int sub_month(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
+	
+	const char *arg_decimal = NULL;
+	long month = 0;
+	int result = EXIT_SUCCESS;
+	
+	/* Get the decimal argument */
+	arg_decimal = getCustom(argc, argv, 1);
+	
+	/* Convert the argument to a long integer */
+	if (result != EXIT_FAILURE) {
+		if (!stringToLong(arg_decimal, &month)) {
+			nelsc_sink_printf(pErr,
+				"Could not parse argument as decimal integer!\n");
+			result = EXIT_FAILURE;
+		}
+	}
+	
+	/* Check the range of the argument */
+	if (result != EXIT_FAILURE) {
+		if ((month < NELSC_CYCLE_MONMIN) ||
+				(month > NELSC_CYCLE_MONMAX)) {
+			nelsc_sink_printf(pErr,
+				"Argument must be in range %d to %d!\n",
+				NELSC_CYCLE_MONMIN,
+				NELSC_CYCLE_MONMAX);
+			result = EXIT_FAILURE;
+		}
+	}
+	
+	/* Print information */
+	if (result != EXIT_FAILURE) {
+		printDayInformation(
+			pOut, nelsc_cycle_monthToDay((int32_t) month));
+	}
+	
+	/* Return result */
+	return result;
+}
+
+/*
+ * Subprogram to provide information a particular calendar date (either
+ * NELSC or Gregorian).
+ * 
+ * If the subprogram can't parse the arguments, an error message is
+ * displayed to the user and EXIT_FAILURE is returned.
+ * 
+ * The first custom parameter is *not* checked -- that was assumed to
+ * have been interpreted by the main procedure to select this
+ * subprogram.  The number of custom parameters is also *not* checked,
+ * since dispatch() verifies it against the subprogram registry before
+ * calling through.
+ * 
+ * Parameters:
+ * 
+ *   argc - the number of program arguments in argv
+ * 
+ *   argv - an array of null-terminated strings representing the program
+ *   arguments, with argc elements; the first element is name of the
+ *   program module, while the second element is the first custom
+ *   argument (if it exists)
+ * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ * Return:
+ * 
+ *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
+ * 
+ * Faults:
+ * 
+ *   - If argc is negative
+ * 
+ *   - If argv is NULL
+ * 
+ *   - If any element of argv is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If argv has fewer elements than are indicated with argc
+ * 
+ *   - If any string indicated by argv is not null-terminated
+ */
+static int sub_date(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
+	
+	const char *arg_date = NULL;
+	int32_t offs = 0;
+	int result = EXIT_SUCCESS;
+	
+	/* Get the date argument */
+	arg_date = getCustom(argc, argv, 1);
+	
+	/* Perform the conversion */
+	if (result != EXIT_FAILURE) {
+		if (!dateToOffset(arg_date, -1, &offs, NULL, NULL)) {
+			nelsc_sink_printf(pErr,
+				"Could not parse as a valid calendar date!\n"
+				"(Note: Gregorian dates must be in range 1828-04-07 to "
+				"2404-04-11.)\n");
+			result = EXIT_FAILURE;
+		}
+	}
+	
+	/* Print information */
+	if (result != EXIT_FAILURE) {
+		printDayInformation(pOut, offs);
+	}
+	
+	/* Return result */
+	return result;
+}
+
+/*
+ * Subprogram to provide the Gregorian dates of the NELSC full moon
+ * weeks for a given range of NELSC months.
+ * 
+ * If the subprogram can't parse the arguments, an error message is
+ * displayed to the user and EXIT_FAILURE is returned.
+ * 
+ * The first custom parameter is *not* checked -- that was assumed to
+ * have been interpreted by the main procedure to select this
+ * subprogram.  The number of custom parameters is also *not* checked,
+ * since dispatch() verifies it against the subprogram registry before
+ * calling through.
+ * 
+ * Parameters:
+ * 
+ *   argc - the number of program arguments in argv
+ * 
+ *   argv - an array of null-terminated strings representing the program
+ *   arguments, with argc elements; the first element is name of the
+ *   program module, while the second element is the first custom
+ *   argument (if it exists)
+ * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
  * 
  * Return:
  * 
- *   true if successful, false if parsing error
+ *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
  * 
  * Faults:
  * 
- *   - If str is NULL
+ *   - If argc is negative
  * 
- *   - If pLong is NULL
+ *   - If argv is NULL
+ * 
+ *   - If any element of argv is NULL
  * 
  * Undefined behavior:
  * 
- *   - If str is not null-terminated
+ *   - If argv has fewer elements than are indicated with argc
+ * 
+ *   - If any string indicated by argv is not null-terminated
  */
-static bool pairToLong(const char *str, long *pLong) {
+static int sub_fullmoon(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
 	
-	bool result = true;
-	int32_t i = 0;
-	const char *pc = NULL;
+	const char *arg_decimal_1 = NULL;
+	const char *arg_decimal_2 = NULL;
+	long month_1 = 0;
+	long month_2 = 0;
+	int result = EXIT_SUCCESS;
 	
-	/* Check parameters */
-	if ((str == NULL) || (pLong == NULL)) {
-		abort();
-	}
+	/* Get the decimal arguments */
+	arg_decimal_1 = getCustom(argc, argv, 1);
+	arg_decimal_2 = getCustom(argc, argv, 2);
 	
-	/* Find the first non-whitespace character, failing if there is no
-	 * such thing */
-	pc = str;
-	while (*pc != 0) {
-		if (!isspace(*pc)) {
-			break;
+	/* Convert the arguments to long integers */
+	if (result != EXIT_FAILURE) {
+		if (!stringToLong(arg_decimal_1, &month_1)) {
+			nelsc_sink_printf(pErr,
+				"Could not parse first argument as decimal integer!\n");
+			result = EXIT_FAILURE;
 		}
-		pc++;
 	}
-	if (*pc == 0) {
-		result = false;
+	
+	if (result != EXIT_FAILURE) {
+		if (!stringToLong(arg_decimal_2, &month_2)) {
+			nelsc_sink_printf(pErr,
+			"Could not parse second argument as decimal integer!\n");
+			result = EXIT_FAILURE;
+		}
 	}
 	
-	/* Attempt to parse a base-24 pair */
-	if (result) {
-		result = base24_pairToInt(pc, &i);
+	/* Check the range of the arguments */
+	if (result != EXIT_FAILURE) {
+		if ((month_1 < NELSC_CYCLE_MONMIN) ||
+				(month_1 > NELSC_CYCLE_MONMAX) ||
+				(month_2 < NELSC_CYCLE_MONMIN) ||
+				(month_2 > NELSC_CYCLE_MONMAX)) {
+			nelsc_sink_printf(pErr,
+				"Arguments must be in range %d to %d!\n",
+				NELSC_CYCLE_MONMIN,
+				NELSC_CYCLE_MONMAX);
+			result = EXIT_FAILURE;
+		}
 	}
 	
-	/* Verify that anything after a valid base-24 pair is whitespace */
-	if (result) {
-		pc = pc + 2;	/* Skip the base-24 pair that was just parsed */
-		while (*pc != 0) {
-			if (!isspace(*pc)) {
-				result = false;
-				break;
-			}
-			pc++;
+	/* Check that second argument is not less than first argument */
+	if (result != EXIT_FAILURE) {
+		if (month_2 < month_1) {
+			nelsc_sink_printf(pErr,
+				"Second argument must not be less than first!\n");
+			result = EXIT_FAILURE;
 		}
 	}
 	
-	/* If successful, write the result */
-	if (result) {
-		*pLong = (long) i;
+	/* Call through to the computation procedure */
+	if (result != EXIT_FAILURE) {
+		fullMoons(pOut, (int32_t) month_1, (int32_t) month_2);
 	}
 	
-	/* Return the status */
+	/* Return result */
 	return result;
 }
 
 /*
- * Convert the given null-terminated string representing a calendar date
- * in ASCII into a NELSC absolute day offset.
+ * Subprogram to provide the Gregorian dates of the first day of each
+ * NELSC year, along with minimum and maximum Gregorian month and day of
+ * the first day of the NELSC year, and for each year the year drift
+ * relative to March 20.
  * 
- * This supports both NELSC and Gregorian dates (YYYY-MM-DD format).
+ * If the subprogram can't parse the arguments, an error message is
+ * displayed to the user and EXIT_FAILURE is returned.
  * 
- * If successful, the converted offset is stored to *pOffset and true is
- * returned.  If the string could not be parsed, *pOffset is unmodified
- * and false is returned.
+ * The first custom parameter is *not* checked -- that was assumed to
+ * have been interpreted by the main procedure to select this
+ * subprogram.  The number of custom parameters is also *not* checked,
+ * since dispatch() verifies it against the subprogram registry before
+ * calling through.
  * 
  * Parameters:
  * 
- *   str - pointer to the string to convert
+ *   argc - the number of program arguments in argv
  * 
- *   pOffset - pointer to the variable to receive the converted day
- *   offset on success
+ *   argv - an array of null-terminated strings representing the program
+ *   arguments, with argc elements; the first element is name of the
+ *   program module, while the second element is the first custom
+ *   argument (if it exists)
+ * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
  * 
  * Return:
  * 
- *   true if successful, false if parsing error
+ *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
  * 
  * Faults:
  * 
- *   - If str is NULL
+ *   - If argc is negative
  * 
- *   - If pOffset is NULL
+ *   - If argv is NULL
+ * 
+ *   - If any element of argv is NULL
  * 
  * Undefined behavior:
  * 
- *   - If str is not null-terminated
+ *   - If argv has fewer elements than are indicated with argc
+ * 
+ *   - If any string indicated by argv is not null-terminated
  */
-static bool dateToOffset(const char *str, int32_t *pOffset) {
+static int sub_newyear(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
 	
-	bool result = true;
-	bool gregorian = false;
-	int32_t d = 0;
-	const char *pc = NULL;
+	int result = EXIT_SUCCESS;
+	NEWYEAR_STATS chunk_stats[NEWYEAR_CHUNKS];
+	NEWYEAR_STATS stats;
+	NEWYEAR_STATS *ps = NULL;
+	int32_t i = 0;
 	
-	/* Check parameters */
-	if ((str == NULL) || (pOffset == NULL)) {
-		abort();
+	/* Generate the report */
+	if (result != EXIT_FAILURE) {
+		/* Print the rows for all the years in parallel chunks */
+		runReport(pOut, NEWYEAR_CHUNKS, &newYearChunk, chunk_stats);
+		
+		/* Merge the statistics of all the chunks */
+		stats = chunk_stats[0];
+		for(i = 1; i < NEWYEAR_CHUNKS; i++) {
+			ps = &(chunk_stats[i]);
+			
+			if (ps->min_drift < stats.min_drift) {
+				stats.min_drift = ps->min_drift;
+			}
+			if (ps->max_drift > stats.max_drift) {
+				stats.max_drift = ps->max_drift;
+			}
+			
+			if ((stats.earliest_month > ps->earliest_month) ||
+				((stats.earliest_month == ps->earliest_month) &&
+					(stats.earliest_day > ps->earliest_day))) {
+				stats.earliest_month = ps->earliest_month;
+				stats.earliest_day = ps->earliest_day;
+			}
+			
+			if ((stats.latest_month < ps->latest_month) ||
+				((stats.latest_month == ps->latest_month) &&
+					(stats.latest_day < ps->latest_day))) {
+				stats.latest_month = ps->latest_month;
+				stats.latest_day = ps->latest_day;
+			}
+		}
+		
+		/* Print the range of new year times and year drifts */
+		nelsc_sink_printf(pOut, "\n");
+		nelsc_sink_printf(pOut,
+				"Range of first day of year:  %02ld-%02ld - "
+				"%02ld-%02ld\n",
+					(long) stats.earliest_month,
+					(long) stats.earliest_day,
+					(long) stats.latest_month,
+					(long) stats.latest_day);
+		nelsc_sink_printf(pOut,
+				"Range of equinox offsets:    [%d, %d]\n",
+					(int) stats.min_drift,
+					(int) stats.max_drift);
 	}
 	
-	/* Find the first non-whitespace character, failing if there is no
-	 * such thing */
-	pc = str;
-	while (*pc != 0) {
-		if (!isspace(*pc)) {
-			break;
+	/* Return result */
+	return result;
+}
+
+/*
+ * Subprogram to convert a stream of calendar dates into a custom output
+ * layout.
+ * 
+ * Each line of standard input must hold a single NELSC or Gregorian
+ * date, in any format accepted by dateToOffset().  If the optional
+ * second custom argument names a grcal fixed-width format, each line
+ * must instead hold a date in that format.  Each date is written to
+ * standard output on its own line, formatted according to the format
+ * string given as the first custom argument.  The format string is
+ * compiled once, and dates are decomposed and formatted in batches.
+ * 
+ * Input is processed in a pipeline.  A reader thread reads standard
+ * input in large blocks of complete lines, converter threads each parse
+ * and format whole blocks, and the calling thread writes the converted
+ * blocks out in input order, so that reading, converting, and writing
+ * all overlap.
+ * 
+ * If the format string can't be compiled, the input format is not
+ * known, or an input line can't be parsed, an error message is
+ * displayed to the user and EXIT_FAILURE is returned.
+ * Output for all lines preceding a line that can't be parsed is still
+ * written.
+ * 
+ * If a dead-letter file is named by the third custom argument, lines
+ * that are too long or can't be parsed are instead written to it, the
+ * former cut short, and conversion stops only once the failed lines
+ * exceed the error budget given by the fourth custom argument, a
+ * percentage that may have a fractional part.  The budget is checked
+ * at each failed line, and no output follows the line that goes over
+ * it.
+ * 
+ * The first custom parameter is *not* checked -- that was assumed to
+ * have been interpreted by the main procedure to select this
+ * subprogram.  The number of custom parameters is also *not* checked,
+ * since dispatch() verifies it against the subprogram registry before
+ * calling through.
+ * 
+ * Parameters:
+ * 
+ *   argc - the number of program arguments in argv
+ * 
+ *   argv - an array of null-terminated strings representing the program
+ *   arguments, with argc elements; the first element is name of the
+ *   program module, while the second element is the first custom
+ *   argument (if it exists)
+ * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ * Return:
+ * 
+ *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
+ * 
+ * Faults:
+ * 
+ *   - If argc is negative
+ * 
+ *   - If argv is NULL
+ * 
+ *   - If any element of argv is NULL
+ * 
+ *   - If memory allocation fails
+ * 
+ * Undefined behavior:
+ * 
+ *   - If argv has fewer elements than are indicated with argc
+ * 
+ *   - If any string indicated by argv is not null-terminated
+ */
+static int sub_convert(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
+	
+	int result = EXIT_SUCCESS;
+	NELSC_STRFTIME *pFmt = NULL;
+	int32_t err_pos = 0;
+	int in_fmt = -1;
+	const char *pDeadPath = NULL;
+	FILE *pDeadFile = NULL;
+	NELSC_SINK *pDead = NULL;
+	bool dead_failed = false;
+	double budget = 100.0;
+	long total_lines = 0;
+	long total_dead = 0;
+	
+	CONVERT_PIPE pipe;
+	CONVERT_WORKER workers[CONVERT_WORKERS_MAX];
+	CONVERT_BLOCK *pBlocks = NULL;
+	CONVERT_BLOCK *pBlock = NULL;
+	pthread_t reader;
+	pthread_t threads[CONVERT_WORKERS_MAX];
+	int32_t block_count = 0;
+	int32_t i = 0;
+	int32_t n = 0;
+	long line_base = 0;
+	
+	memset(&pipe, 0, sizeof(CONVERT_PIPE));
+	
+	/* Get the optional input format */
+	if (getCustomCount(argc) >= 3) {
+		if (strcmp(getCustom(argc, argv, 2), "auto") != 0) {
+			in_fmt = grcal_formatFind(getCustom(argc, argv, 2));
+			if (in_fmt < 0) {
+				nelsc_sink_printf(pErr,
+					"convert input format must be \"auto\", \"iso\", "
+					"\"compact\", \"slash\", or \"dotted\"!\n");
+				result = EXIT_FAILURE;
+			}
 		}
-		pc++;
 	}
-	if (*pc == 0) {
-		result = false;
+	
+	/* Get the optional error budget as a percentage of lines */
+	if (result != EXIT_FAILURE) {
+		if (getCustomCount(argc) >= 5) {
+			if (!stringToPercent(getCustom(argc, argv, 4), &budget)) {
+				nelsc_sink_printf(pErr,
+					"convert error budget must be a percentage from 0 "
+					"to 100!\n");
+				result = EXIT_FAILURE;
+			}
+		}
 	}
 	
-	/* Attempt to parse a calendar date, trying NELSC first and then
-	 * falling back to Gregorian */
-	if (result) {
-		result = nelsc_format_scanDate(pc, &d);
-		if (!result) {
-			gregorian = true;
-			d = grcal_scanDate(pc, &pc);
-			if (d != -1) {
-				result = true;
+	/* Open the optional dead-letter file */
+	if (result != EXIT_FAILURE) {
+		if (getCustomCount(argc) >= 4) {
+			pDeadPath = getCustom(argc, argv, 3);
+			pDeadFile = fopen(pDeadPath, "w");
+			if (pDeadFile != NULL) {
+				pDead = nelsc_sink_newFile(pDeadFile);
 			} else {
-				result = false;
+				nelsc_sink_printf(pErr,
+					"Can't create dead-letter file %s!\n", pDeadPath);
+				result = EXIT_FAILURE;
+			}
+		}
+	}
+	
+	/* Compile the format string */
+	if (result != EXIT_FAILURE) {
+		pFmt = nelsc_strftime_compile(
+					getCustom(argc, argv, 1), &err_pos);
+		if (pFmt == NULL) {
+			nelsc_sink_printf(pErr,
+				"Invalid conversion at format string position %ld!\n",
+				(long) err_pos);
+			result = EXIT_FAILURE;
+		}
+	}
+	
+	/* Set up the pipeline, with all blocks initially free */
+	if (result != EXIT_FAILURE) {
+		pipe.pFmt = pFmt;
+		pipe.in_fmt = in_fmt;
+		pipe.dead_letter = (pDead != NULL);
+		pipe.workers = convertWorkers();
+		pipe.stop = 0;
+		pipe.read_error = false;
+		
+		block_count = pipe.workers * CONVERT_BLOCKS_PER_WORKER + 2;
+		pBlocks = (CONVERT_BLOCK *) calloc(
+					(size_t) block_count, sizeof(CONVERT_BLOCK));
+		if (pBlocks == NULL) {
+			abort();
+		}
+		
+		pipe.pFree = nelsc_spsc_new(CONVERT_QUEUE_CAP);
+		for(i = 0; i < pipe.workers; i++) {
+			(pipe.pWork)[i] = nelsc_spsc_new(CONVERT_QUEUE_CAP);
+			(pipe.pDone)[i] = nelsc_spsc_new(CONVERT_QUEUE_CAP);
+			workers[i].pPipe = &pipe;
+			workers[i].index = i;
+		}
+		
+		for(i = 0; i < block_count; i++) {
+			pBlock = &(pBlocks[i]);
+			if (posix_memalign((void **) &(pBlock->pIn),
+					CONVERT_ALIGN, CONVERT_BLOCK_SIZE)) {
+				abort();
 			}
+			pBlock->out_cap = CONVERT_OUTBUF;
+			pBlock->pOut = (char *) malloc(pBlock->out_cap);
+			if (pBlock->pOut == NULL) {
+				abort();
+			}
+			nelsc_spsc_push(pipe.pFree, pBlock);
 		}
 	}
 	
-	/* Skip over the date if NELSC; if Gregorian, this was already done
-	 * during parsing stage */
-	if (result) {
-		if (!gregorian) {
-			pc = pc + NELSC_FORMAT_DATE_LENGTH;
+	/* Start the reader and the converters */
+	if (result != EXIT_FAILURE) {
+		if (pthread_create(&reader, NULL, &convertReader, &pipe)) {
+			abort();
 		}
-	}
-	
-	/* If Gregorian, convert offset to NELSC absolute day, and check
-	 * range is in NELSC */
-	if (result) {
-		if (gregorian) {
-			d -= NELSC_CYCLE_GROFFS;
-			if ((d < NELSC_CYCLE_DAYMIN) || (d > NELSC_CYCLE_DAYMAX)) {
-				result = false;
+		for(i = 0; i < pipe.workers; i++) {
+			if (pthread_create(&(threads[i]), NULL,
+					&convertWorker, &(workers[i]))) {
+				abort();
 			}
 		}
 	}
 	
-	/* Verify that anything after a valid date is whitespace */
-	if (result) {
-		while (*pc != 0) {
-			if (!isspace(*pc)) {
-				result = false;
+	/* Act as the writer, collecting the converted blocks in input order
+	 * until the end marker; after an error, the remaining blocks are
+	 * collected but discarded */
+	if (pBlocks != NULL) {
+		for(n = 0; true; n = (n + 1) % pipe.workers) {
+			pBlock = (CONVERT_BLOCK *) nelsc_spsc_pop((pipe.pDone)[n]);
+			if (pBlock == NULL) {
 				break;
 			}
-			pc++;
+			
+			if (result != EXIT_FAILURE) {
+				/* Write the output and copy failed lines to the
+				 * dead-letter file, stopping at the failed line that
+				 * goes over budget */
+				if (!convertWriteBlock(pOut, pDead, pBlock, budget,
+						&total_lines, &total_dead)) {
+					nelsc_sink_printf(pErr,
+						"Error budget exceeded: %ld of the first %ld "
+						"lines could not be parsed!\n",
+						total_dead, total_lines);
+					result = EXIT_FAILURE;
+				}
+				nelsc_detect_add(pBlock->formats);
+				
+				/* Stop once the output can't be written, which is
+				 * reported by main() */
+				if (nelsc_sink_failed(pOut)) {
+					result = EXIT_FAILURE;
+				}
+				
+				if (pBlock->err == CONVERT_ERR_PARSE) {
+					nelsc_sink_printf(pErr,
+						"Line %ld: Could not parse as a valid "
+						"calendar date!\n",
+						line_base + pBlock->lines + 1);
+					convertDiagnose(pErr, pBlock,
+						line_base + pBlock->lines + 1);
+					result = EXIT_FAILURE;
+				
+				} else if (pBlock->err == CONVERT_ERR_LONG) {
+					nelsc_sink_printf(pErr,
+						"Line %ld is too long!\n",
+						line_base + pBlock->lines + 1);
+					result = EXIT_FAILURE;
+				}
+				
+				if (result == EXIT_FAILURE) {
+					__atomic_store_n(&(pipe.stop), 1, __ATOMIC_RELEASE);
+				}
+			}
+			
+			line_base += pBlock->lines;
+			nelsc_spsc_push(pipe.pFree, pBlock);
+		}
+		
+		/* The other converters have only their end markers left */
+		for(i = 1; i < pipe.workers; i++) {
+			nelsc_spsc_pop((pipe.pDone)[(n + i) % pipe.workers]);
+		}
+		
+		if (pthread_join(reader, NULL)) {
+			abort();
+		}
+		for(i = 0; i < pipe.workers; i++) {
+			if (pthread_join(threads[i], NULL)) {
+				abort();
+			}
 		}
 	}
 	
-	/* If successful, write the result */
-	if (result) {
-		*pOffset = d;
+	/* Check for input errors */
+	if (result != EXIT_FAILURE) {
+		if (pipe.read_error) {
+			nelsc_sink_printf(pErr, "Error reading standard input!\n");
+			result = EXIT_FAILURE;
+		}
 	}
 	
-	/* Return the status */
-	return result;
-}
-
-/*
- * Print information about the day indicated by the provided NELSC
- * absolute day offset.
- * 
- * Parameters:
- * 
- *   day - the NELSC absolute day offset
- * 
- * Faults:
- * 
- *   - If day is out of range
- */
-static void printDayInformation(int32_t day) {
-	
-	int32_t year = 0;
-	int32_t month_of_year = 0;
-	int32_t absolute_month = 0;
-	int32_t day_of_month = 0;
-	
-	int32_t gr_year = 0;
-	int32_t gr_month = 0;
-	int32_t gr_day = 0;
-	
-	/* Check parameter */
-	if ((day < NELSC_CYCLE_DAYMIN) || (day > NELSC_CYCLE_DAYMAX)) {
-		abort();
+	/* Check the error budget over the whole input */
+	if ((result != EXIT_FAILURE) && (pDead != NULL)) {
+		if (((double) total_dead) * 100.0 >
+				budget * ((double) total_lines)) {
+			nelsc_sink_printf(pErr,
+				"Error budget exceeded: %ld of %ld lines could not be "
+				"parsed!\n", total_dead, total_lines);
+			result = EXIT_FAILURE;
+		}
 	}
 	
-	/* Print information */
-	printf("Day offset:      %ld\n", (long) day);
-	
-	absolute_month = nelsc_cycle_dayToMonth(day, &day_of_month);
-	year = nelsc_cycle_monthToYear(absolute_month, &month_of_year);
-	
-	grcal_offsetToDate(
-		(day + NELSC_CYCLE_GROFFS),
-		&gr_year,
-		&gr_month,
-		&gr_day);
+	/* Close the dead-letter file */
+	if (pDeadFile != NULL) {
+		nelsc_sink_flush(pDead);
+		dead_failed = nelsc_sink_failed(pDead);
+		nelsc_sink_free(pDead);
+		if (fclose(pDeadFile)) {
+			dead_failed = true;
+		}
+		if (dead_failed) {
+			nelsc_sink_printf(pErr,
+				"Error writing dead-letter file %s!\n", pDeadPath);
+			result = EXIT_FAILURE;
+		}
+	}
 	
-	printf("Absolute month:  %ld\n", (long) absolute_month);
-	printf("NELSC date:      ");
-	nelsc_format_printDate(stdout,
-		year, month_of_year, day_of_month);
-	printf("\n");
-	printf("Month length:    ");
-	if (nelsc_cycle_isLongMonth(absolute_month)) {
-		printf("long\n");
-	} else {
-		printf("short\n");
+	/* Release resources */
+	if (pBlocks != NULL) {
+		for(i = 0; i < block_count; i++) {
+			free(pBlocks[i].pIn);
+			free(pBlocks[i].pOut);
+			free(pBlocks[i].pDead);
+		}
+		free(pBlocks);
 	}
-	printf("Year length:     ");
-	if (nelsc_cycle_isLongYear(year)) {
-		printf("long\n");
-	} else {
-		printf("short\n");
+	nelsc_spsc_free(pipe.pFree);
+	for(i = 0; i < pipe.workers; i++) {
+		nelsc_spsc_free((pipe.pWork)[i]);
+		nelsc_spsc_free((pipe.pDone)[i]);
 	}
+	nelsc_strftime_free(pFmt);
 	
-	printf("Gregorian date:  ");
-	grcal_printDate(stdout, gr_year, gr_month, gr_day);
-	printf("\n");
+	/* Return result */
+	return result;
 }
 
 /*
- * Print the NELSC full moon weeks from NELSC absolute month mfirst up
- * to and including NELSC absolute month mlast.
+ * Subprogram to execute many subprogram invocations read from standard
+ * input within a single process.
+ * 
+ * Each line of standard input holds a complete command line, made up of
+ * the subprogram name followed by its arguments, separated by
+ * whitespace.  There is no quoting.  Blank lines and lines beginning
+ * with "#" are ignored.  Each command is dispatched through dispatch()
+ * in the same way as main() does it.
+ * 
+ * The response to each command is written to standard output, with
+ * error messages included in the response, and is always terminated by
+ * a status line consisting of "=" followed by the exit status of the
+ * command (0 for success).  No other output line begins with "=".
+ * Blank and comment lines are not commands, so they get no response,
+ * as the helpscreen states.
+ * 
+ * Responses are gathered in memory and passed on to the output sink in
+ * blocks of around BATCH_OUTBUF bytes.  If the optional custom argument
+ * "flush" is given, each response is instead passed on and the output
+ * sink flushed as soon as the response is complete, which allows batch
+ * mode to be driven interactively or as a coprocess.
+ * 
+ * While the session runs, statistics are gathered in m_batch about the
+ * commands run, their failures and latencies, and the bytes read and
+ * written, which the stats subprogram reports.
+ * 
+ * If the optional custom argument is something other than "flush", an
+ * error message is displayed to the user and EXIT_FAILURE is returned.
+ * Otherwise, EXIT_SUCCESS is returned even if individual commands
+ * failed, unless reading standard input fails.
  * 
- * mfirst and mlast must both be in range NELSC_CYCLE_MONMIN up to
- * NELSC_CYCLE_MONMAX (inclusive of boundaries).  mlast must be greater
- * than or equal to mfirst.
+ * The first custom parameter is *not* checked -- that was assumed to
+ * have been interpreted by the main procedure to select this
+ * subprogram.  The number of custom parameters is also *not* checked,
+ * since dispatch() verifies it against the subprogram registry before
+ * calling through.
  * 
  * Parameters:
  * 
- *   mfirst - the first month in the range
+ *   argc - the number of program arguments in argv
  * 
- *   mlast - the last month in the range
+ *   argv - an array of null-terminated strings representing the program
+ *   arguments, with argc elements; the first element is name of the
+ *   program module, while the second element is the first custom
+ *   argument (if it exists)
+ * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ * Return:
+ * 
+ *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
  * 
  * Faults:
  * 
- *   - If mfirst or mlast is out of range
+ *   - If argc is negative
  * 
- *   - If mfirst is greater than mlast
+ *   - If argv is NULL
+ * 
+ *   - If any element of argv is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If argv has fewer elements than are indicated with argc
+ * 
+ *   - If any string indicated by argv is not null-terminated
  */
-static void fullMoons(int32_t mfirst, int32_t mlast) {
+static int sub_batch(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
 	
-	int32_t m = 0;
-	int32_t lyear = -1;
+	int result = EXIT_SUCCESS;
+	bool flush = false;
 	
-	int32_t m_begin = 0;
-	int32_t fmw_begin = 0;
-	int32_t fmw_end = 0;
+	char line[BATCH_LINE_MAX];
+	char *cmd_argv[BATCH_ARG_MAX + 1];
+	int cmd_argc = 0;
+	int status = 0;
+	bool skip = false;
+	char *pc = NULL;
+	NELSC_SINK *pResp = NULL;
 	
-	int32_t b_year = 0;
-	int32_t b_month = 0;
-	int32_t b_day = 0;
+	const SUBPROGRAM *pSub = NULL;
+	BATCH_COMMAND *pCmd = NULL;
+	size_t resp_start = 0;
+	uint64_t t_start = 0;
+	uint64_t t_end = 0;
 	
-	int32_t e_year = 0;
-	int32_t e_month = 0;
-	int32_t e_day = 0;
-
-	/* Check parameters */
-	if ((mfirst < NELSC_CYCLE_MONMIN) ||
-		(mfirst > NELSC_CYCLE_MONMAX) ||
-		(mlast < NELSC_CYCLE_MONMIN) ||
-		(mlast > NELSC_CYCLE_MONMAX) ||
-		(mfirst > mlast)) {
-		abort();
+	/* Get the optional flush argument */
+	if (getCustomCount(argc) == 2) {
+		if (strcmp(getCustom(argc, argv, 1), "flush") == 0) {
+			flush = true;
+		} else {
+			nelsc_sink_printf(pErr,
+				"batch argument must be \"flush\" if present!\n");
+			result = EXIT_FAILURE;
+		}
 	}
-
-	/* Print the full moon week for each month in range */
-	for(m = mfirst; m <= mlast; m++) {
-		/* Start with the first day of the month */
-		m_begin = nelsc_cycle_monthToDay(m);
-
-		/* Compute full moon week boundaries depending on whether this
-		 * is a long or short month */
-		if (nelsc_cycle_isLongMonth(m)) {
-			fmw_begin = m_begin + FULLMOON_LONG_BEGIN;
-			fmw_end   = m_begin + FULLMOON_LONG_END;
+	
+	/* Gather responses in a buffer so that they are written in bulk,
+	 * and start gathering statistics */
+	if (result != EXIT_FAILURE) {
+		pResp = nelsc_sink_newBuffer();
+		batchBegin();
+	}
+	
+	/* Process each command line, stopping if the responses can no
+	 * longer be written */
+	while ((result != EXIT_FAILURE) && (!nelsc_sink_failed(pOut))) {
+		/* Read the next line */
+		if (fgets(line, BATCH_LINE_MAX, stdin) == NULL) {
+			break;
+		}
+		
+		m_batch.bytes_in += (uint64_t) strlen(line);
+		
+		/* If the line didn't fit, discard the rest of it and report an
+		 * error for the command */
+		skip = false;
+		if ((strchr(line, '\n') == NULL) && (!feof(stdin))) {
+			skip = true;
+			while (fgets(line, BATCH_LINE_MAX, stdin) != NULL) {
+				if (strchr(line, '\n') != NULL) {
+					break;
+				}
+			}
+		}
+		
+		/* Split the line into arguments, with the program module name
+		 * as the first argument */
+		cmd_argv[0] = argv[0];
+		cmd_argc = 1;
+		
+		pc = line;
+		while ((!skip) && (*pc != 0)) {
+			/* Skip whitespace, stopping at the end of the line */
+			while (isspace((unsigned char) *pc)) {
+				pc++;
+			}
+			if (*pc == 0) {
+				break;
+			}
+			
+			/* Comment lines are ignored */
+			if ((cmd_argc == 1) && (*pc == '#')) {
+				break;
+			}
+			
+			/* Record the argument, failing if there are too many */
+			if (cmd_argc > BATCH_ARG_MAX) {
+				skip = true;
+				break;
+			}
+			cmd_argv[cmd_argc] = pc;
+			cmd_argc++;
+			
+			/* Find the end of the argument and terminate it */
+			while ((*pc != 0) && (!isspace((unsigned char) *pc))) {
+				pc++;
+			}
+			if (*pc != 0) {
+				*pc = 0;
+				pc++;
+			}
+		}
+		cmd_argv[cmd_argc] = NULL;
+		
+		/* Ignore blank and comment lines */
+		if ((!skip) && (cmd_argc < 2)) {
+			continue;
+		}
+		
+		/* Run the command, with error messages going into the
+		 * response, and time it */
+		resp_start = nelsc_sink_length(pResp);
+		t_start = batchClock();
+		
+		pSub = NULL;
+		if (skip) {
+			nelsc_sink_printf(pResp, "Command line is too long!\n");
+			status = EXIT_FAILURE;
 		} else {
-			fmw_begin = m_begin + FULLMOON_SHORT_BEGIN;
-			fmw_end   = m_begin + FULLMOON_SHORT_END;
+			pSub = findSubprogram(cmd_argv[1]);
+			status = dispatch(
+						cmd_argc, cmd_argv, pResp, pResp, true);
 		}
-
-		/* Convert NELSC absolute day offsets to Gregorian offsets */
-		fmw_begin += NELSC_CYCLE_GROFFS;
-		fmw_end   += NELSC_CYCLE_GROFFS;
-
-		/* Convert begin and end days to Gregorian dates */
-		grcal_offsetToDate(fmw_begin, &b_year, &b_month, &b_day);
-		grcal_offsetToDate(fmw_end,   &e_year, &e_month, &e_day);
-
-		/* If lyear is not -1 (indicating first time through the loop),
-		 * prefix a blank line if the year of the begin date is
-		 * different from the last begin date's year */
-		if ((lyear != -1) && (lyear != b_year)) {
-			printf("\n");
+		
+		t_end = batchClock();
+		
+		/* Write the status line that terminates the response */
+		nelsc_sink_printf(pResp, "=%d\n", status);
+		
+		/* Update the statistics; a stats command is counted after it
+		 * has run, so it is the first command after a reset */
+		(m_batch.requests)++;
+		if (status != EXIT_SUCCESS) {
+			(m_batch.errors)++;
+		}
+		if (pSub != NULL) {
+			pCmd = &((m_batch.pCommands)[pSub - m_subprograms]);
+			(pCmd->requests)++;
+			if (status != EXIT_SUCCESS) {
+				(pCmd->errors)++;
+			}
+			nelsc_hist_record(pCmd->pLatency, t_end - t_start);
+		}
+		m_batch.bytes_out += (uint64_t)
+								(nelsc_sink_length(pResp) - resp_start);
+		m_batch.pending = (uint64_t) nelsc_sink_length(pResp);
+		if (m_batch.pending > m_batch.max_pending) {
+			m_batch.max_pending = m_batch.pending;
 		}
 		
-		/* Store the begin year of the current full moon in lyear */
-		lyear = b_year;
+		/* Release the scratch space the command took from the arena */
+		nelsc_arena_reset(nelsc_arena_local());
 		
-		/* Write the dates */
-		grcal_printDate(stdout, b_year, b_month, b_day);
-		printf(" - ");
-		grcal_printDate(stdout, e_year, e_month, e_day);
-		printf("\n");
+		/* Pass on the gathered responses when flushing after each
+		 * response or when enough have been gathered */
+		if (flush) {
+			nelsc_sink_drain(pOut, pResp);
+			nelsc_sink_flush(pOut);
+		
+		} else if (nelsc_sink_length(pResp) >= BATCH_OUTBUF) {
+			nelsc_sink_drain(pOut, pResp);
+		}
+		m_batch.pending = (uint64_t) nelsc_sink_length(pResp);
 	}
+	
+	/* Check for input errors */
+	if (result != EXIT_FAILURE) {
+		if (ferror(stdin)) {
+			nelsc_sink_printf(pErr, "Error reading standard input!\n");
+			result = EXIT_FAILURE;
+		}
+	}
+	
+	/* Make sure all responses are written and stop gathering
+	 * statistics */
+	if (pResp != NULL) {
+		nelsc_sink_drain(pOut, pResp);
+		nelsc_sink_free(pResp);
+		batchEnd();
+	}
+	nelsc_sink_flush(pOut);
+	
+	/* Return result */
+	return result;
 }
 
 /*
- * Subprogram to display a brief helpscreen.
- * 
- * Return:
- * 
- *   always EXIT_SUCCESS
- */
-static int sub_help(void) {
-	printf(
-
-"nelsc command summary:\n"
-"\n"
-"  help - show this helpscreen.\n"
-"\n"
-"  to24pair [i] - convert signed decimal integer i into a base-24\n"
-"  pair in signed style.\n"
-"\n"
-"  from24pair [p] - convert base-24 pair i in signed style into a\n"
-"  signed decimal integer.  p must have exactly two base-24 digits.\n"
-"\n"
-"  to24digit [i] - convert integer i into an unsigned base-24 digit.\n"
-"  i must be in range 0-23.\n"
-"\n"
-"  from24digit [d] - convert base-24 digit d into a decimal integer.\n"
-"  d must contain only one base-24 digit.\n"
-"\n"
-"  day [d] - provide information about the day indicated by NELSC\n"
-"  absolute day offset d.\n"
-"\n"
-"  month [m] - provide information about the first day of the month\n"
-"  indicated by NELSC absolute month offset m.\n"
-"\n"
-"  date [d] - provide information about a particular calendar date.\n"
-"  The parameter d must be a NELSC date in 3T:C4-7 format, or a\n"
-"  Gregorian date in YYYY-MM-DD format.\n"
-"\n"
-"  fullmoon [m1] [m2] - return the Gregorian dates of the full moon\n"
-"  weeks in NELSC from NELSC absolute month offset m1 up to m2.  The\n"
-"  full moon does not always actually happen in the full moon week.\n"
-"\n"
-"  newyear - create a chart of all NELSC years and the Gregorian date\n"
-"  of the first day of the year for each year, along with minimum and\n"
-"  maximum Gregorian month and day for the first day of the year, and\n"
-"  for each year the offset from the first month that March 20\n"
-"  (an approximation of the equinox) happens.\n"
-"\n"
-
-	);
-
-	return EXIT_SUCCESS;
-}
-
-/*
- * Subprogram to convert a signed decimal integer into a base-24 pair.
+ * Subprogram to report the statistics of the batch session in
+ * progress.
+ * 
+ * The report gives the number of commands run and how many failed,
+ * the bytes of command lines read and of responses produced, and the
+ * bytes of responses gathered but not yet written.  Then, for each
+ * subprogram that has been run, it gives the number of commands and
+ * failures and the 50th, 90th, 99th, and 99.9th percentile and
+ * maximum latencies in nanoseconds.  Percentiles are accurate to
+ * within about three percent.
  * 
- * If the improper number of custom arguments is specified or the
- * subprogram can't parse the arguments or the argument is out of range,
- * an error message is displayed to the user and EXIT_FAILURE is
- * returned.
+ * If the optional custom argument "reset" is given, all statistics are
+ * cleared after they are reported.
+ * 
+ * This subprogram only works within batch mode.  Otherwise, or if the
+ * optional custom argument is something other than "reset", an error
+ * message is displayed to the user and EXIT_FAILURE is returned.
  * 
  * The first custom parameter is *not* checked -- that was assumed to
  * have been interpreted by the main procedure to select this
- * subprogram.
+ * subprogram.  The number of custom parameters is also *not* checked,
+ * since dispatch() verifies it against the subprogram registry before
+ * calling through.
  * 
  * Parameters:
  * 
@@ -671,6 +6023,10 @@ static int sub_help(void) {
  *   program module, while the second element is the first custom
  *   argument (if it exists)
  * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
  * Return:
  * 
  *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
@@ -689,48 +6045,95 @@ static int sub_help(void) {
  * 
  *   - If any string indicated by argv is not null-terminated
  */
-static int sub_to24pair(int argc, char *argv[]) {
+static int sub_stats(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
 	
-	const char *arg_decimal = NULL;
-	long argi = 0;
 	int result = EXIT_SUCCESS;
+	bool reset = false;
+	const BATCH_COMMAND *pCmd = NULL;
+	int i = 0;
 	
-	/* Verify the total number of custom parameters and get the decimal
-	 * argument */
-	if (getCustomCount(argc) != 2) {
-		fprintf(stderr,
-			"to24pair expects exactly one additional argument!\n");
-		result = EXIT_FAILURE;
+	/* Get the optional reset argument */
+	if (getCustomCount(argc) == 2) {
+		if (strcmp(getCustom(argc, argv, 1), "reset") == 0) {
+			reset = true;
+		} else {
+			nelsc_sink_printf(pErr,
+				"stats argument must be \"reset\" if present!\n");
+			result = EXIT_FAILURE;
+		}
 	}
 	
+	/* Check that a batch session is in progress */
 	if (result != EXIT_FAILURE) {
-		arg_decimal = getCustom(argc, argv, 1);
+		if (m_batch.pCommands == NULL) {
+			nelsc_sink_printf(pErr,
+				"stats is only available in batch mode!\n");
+			result = EXIT_FAILURE;
+		}
 	}
 	
-	/* Convert the argument to a long integer */
+	/* Report the session totals */
 	if (result != EXIT_FAILURE) {
-		if (!stringToLong(arg_decimal, &argi)) {
-			fprintf(stderr,
-				"Could not parse argument as decimal integer!\n");
-			result = EXIT_FAILURE;
-		}
+		nelsc_sink_printf(pOut,
+			"Requests:        %llu\n"
+			"Errors:          %llu\n"
+			"Bytes in:        %llu\n"
+			"Bytes out:       %llu\n"
+			"Pending output:  %llu (max %llu)\n",
+			(unsigned long long) m_batch.requests,
+			(unsigned long long) m_batch.errors,
+			(unsigned long long) m_batch.bytes_in,
+			(unsigned long long) m_batch.bytes_out,
+			(unsigned long long) m_batch.pending,
+			(unsigned long long) m_batch.max_pending);
 	}
 	
-	/* Check the range of the argument */
+	/* Report the latencies of each subprogram that was run */
 	if (result != EXIT_FAILURE) {
-		if ((argi < BASE24_PAIR_MIN) || (argi > BASE24_PAIR_MAX)) {
-			fprintf(stderr,
-				"Argument must be in range -96 to 479!\n");
-			result = EXIT_FAILURE;
+		nelsc_sink_printf(pOut, "\n");
+		nelsc_sink_printf(pOut,
+			"%-11s %8s %7s %8s %8s %8s %8s %8s\n",
+			"command", "count", "errors",
+			"p50", "p90", "p99", "p99.9", "max");
+		
+		for(i = 0; i < SUBPROGRAM_COUNT; i++) {
+			pCmd = &((m_batch.pCommands)[i]);
+			if (pCmd->requests < 1) {
+				continue;
+			}
+			nelsc_sink_printf(pOut,
+				"%-11s %8llu %7llu %8llu %8llu %8llu %8llu %8llu\n",
+				m_subprograms[i].pName,
+				(unsigned long long) pCmd->requests,
+				(unsigned long long) pCmd->errors,
+				(unsigned long long)
+					nelsc_hist_percentile(pCmd->pLatency, 500),
+				(unsigned long long)
+					nelsc_hist_percentile(pCmd->pLatency, 900),
+				(unsigned long long)
+					nelsc_hist_percentile(pCmd->pLatency, 990),
+				(unsigned long long)
+					nelsc_hist_percentile(pCmd->pLatency, 999),
+				(unsigned long long)
+					nelsc_hist_max(pCmd->pLatency));
 		}
 	}
 	
-	/* Perform the conversion */
-	if (result != EXIT_FAILURE) {
-		printf("Decimal value:  %ld\n", argi);
-		printf("Base-24 pair:   ");
-		base24_printPair(stdout, (int32_t) argi);
-		printf("\n");
+	/* Clear the statistics if requested, keeping the pending output
+	 * since that is still waiting to be written */
+	if ((result != EXIT_FAILURE) && reset) {
+		m_batch.requests = 0;
+		m_batch.errors = 0;
+		m_batch.bytes_in = 0;
+		m_batch.bytes_out = 0;
+		m_batch.max_pending = m_batch.pending;
+		
+		for(i = 0; i < SUBPROGRAM_COUNT; i++) {
+			(m_batch.pCommands)[i].requests = 0;
+			(m_batch.pCommands)[i].errors = 0;
+			nelsc_hist_clear((m_batch.pCommands)[i].pLatency);
+		}
 	}
 	
 	/* Return result */
@@ -738,16 +6141,36 @@ static int sub_to24pair(int argc, char *argv[]) {
 }
 
 /*
- * Subprogram to convert a base-24 pair in signed style to a signed
- * decimal integer.
+ * Publish, check, or remove the shared memory segment holding the
+ * precomputed cycle tables.
+ * 
+ * The first custom argument after the subprogram name is the command,
+ * and the optional second one is the name of the segment, which
+ * defaults to NELSC_SHM_DEFAULT_NAME.
+ * 
+ * "publish" builds the tables and places them in the segment, creating
+ * it if necessary.  Other processes can then map the tables read-only
+ * with nelsc_shm_open() instead of building them.  Publishing again
+ * rewrites the tables in place and increments the generation count.
+ * 
+ * "check" maps the segment read-only, compares every lookup of the
+ * mapped tables against the nelsc_cycle functions across the whole
+ * NELSC range, and reports the generation count and table size.  It
+ * fails if a publisher died while writing the segment, or is still
+ * writing it after a second.
  * 
- * If the improper number of custom arguments is specified or the
- * subprogram can't parse the arguments, an error message is displayed
- * to the user and EXIT_FAILURE is returned.
+ * "unlink" removes the segment name.  Processes that already have the
+ * segment mapped keep using it.
+ * 
+ * If the command is unknown, the segment can't be published, opened,
+ * or removed, or the check finds a mismatch, an error message is
+ * displayed to the user and EXIT_FAILURE is returned.
  * 
  * The first custom parameter is *not* checked -- that was assumed to
  * have been interpreted by the main procedure to select this
- * subprogram.
+ * subprogram.  The number of custom parameters is also *not* checked,
+ * since dispatch() verifies it against the subprogram registry before
+ * calling through.
  * 
  * Parameters:
  * 
@@ -758,6 +6181,10 @@ static int sub_to24pair(int argc, char *argv[]) {
  *   program module, while the second element is the first custom
  *   argument (if it exists)
  * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
  * Return:
  * 
  *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
@@ -776,39 +6203,121 @@ static int sub_to24pair(int argc, char *argv[]) {
  * 
  *   - If any string indicated by argv is not null-terminated
  */
-static int sub_from24pair(int argc, char *argv[]) {
+static int sub_shm(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
 	
-	const char *arg_pair = NULL;
-	long val = 0;
 	int result = EXIT_SUCCESS;
+	const char *pCmd = NULL;
+	const char *pName = NELSC_SHM_DEFAULT_NAME;
+	NELSC_SHM *pShm = NULL;
+	int32_t i = 0;
+	int32_t offs = 0;
+	int32_t expect = 0;
+	int32_t expect_offs = 0;
+	uint64_t generation = 0;
 	
-	/* Verify the total number of custom parameters and get the base-24
-	 * pair argument */
-	if (getCustomCount(argc) != 2) {
-		fprintf(stderr,
-			"from24pair expects exactly one additional argument!\n");
-		result = EXIT_FAILURE;
+	/* Get the command and the optional segment name */
+	pCmd = getCustom(argc, argv, 1);
+	if (getCustomCount(argc) == 3) {
+		pName = getCustom(argc, argv, 2);
 	}
 	
-	if (result != EXIT_FAILURE) {
-		arg_pair = getCustom(argc, argv, 1);
-	}
+	if (strcmp(pCmd, "publish") == 0) {
+		/* Build and publish the tables */
+		if (!nelsc_shm_publish(pName)) {
+			nelsc_sink_printf(pErr,
+				"Could not publish shared memory segment %s!\n", pName);
+			result = EXIT_FAILURE;
+		}
 	
-	/* Perform the conversion */
-	if (result != EXIT_FAILURE) {
-		if (!pairToLong(arg_pair, &val)) {
-			fprintf(stderr,
-				"Could not parse as a base-24 pair!\n");
+	} else if (strcmp(pCmd, "unlink") == 0) {
+		/* Remove the segment name */
+		if (!nelsc_shm_unlink(pName)) {
+			nelsc_sink_printf(pErr,
+				"Could not remove shared memory segment %s!\n", pName);
 			result = EXIT_FAILURE;
 		}
-	}
 	
-	/* Report results */
-	if (result != EXIT_FAILURE) {
-		printf("Base-24 pair:   ");
-		base24_printPair(stdout, (int32_t) val);
-		printf("\n");
-		printf("Decimal value:  %ld\n", val);
+	} else if (strcmp(pCmd, "check") == 0) {
+		/* Map the published tables */
+		pShm = nelsc_shm_open(pName);
+		if (pShm == NULL) {
+			nelsc_sink_printf(pErr,
+				"Could not open shared memory segment %s!\n", pName);
+			result = EXIT_FAILURE;
+		}
+		
+		/* Make sure the tables can be read at all, since the lookups
+		 * would otherwise quietly fall back to the cycle functions */
+		if (result != EXIT_FAILURE) {
+			if (!nelsc_shm_generation(pShm, &generation)) {
+				nelsc_sink_printf(pErr,
+					"Shared memory segment %s was left unfinished by "
+					"its publisher!\n", pName);
+				nelsc_shm_close(pShm);
+				pShm = NULL;
+				result = EXIT_FAILURE;
+			}
+		}
+		
+		/* Compare every lookup against the cycle functions */
+		if (result != EXIT_FAILURE) {
+			for(i = NELSC_CYCLE_DAYMIN; i <= NELSC_CYCLE_DAYMAX; i++) {
+				expect = nelsc_cycle_dayToMonth(i, &expect_offs);
+				if ((nelsc_shm_dayToMonth(pShm, i, &offs) != expect) ||
+						(offs != expect_offs)) {
+					result = EXIT_FAILURE;
+					break;
+				}
+			}
+		}
+		if (result != EXIT_FAILURE) {
+			for(i = NELSC_CYCLE_MONMIN; i <= NELSC_CYCLE_MONMAX; i++) {
+				expect = nelsc_cycle_monthToYear(i, &expect_offs);
+				if ((nelsc_shm_monthToDay(pShm, i) !=
+							nelsc_cycle_monthToDay(i)) ||
+						(nelsc_shm_monthToYear(pShm, i, &offs) !=
+							expect) ||
+						(offs != expect_offs)) {
+					result = EXIT_FAILURE;
+					break;
+				}
+			}
+		}
+		if (result != EXIT_FAILURE) {
+			for(i = NELSC_CYCLE_YEARMIN;
+					i <= NELSC_CYCLE_YEARMAX; i++) {
+				if (nelsc_shm_yearToMonth(pShm, i) !=
+						nelsc_cycle_yearToMonth(i)) {
+					result = EXIT_FAILURE;
+					break;
+				}
+			}
+		}
+		
+		/* Report the outcome */
+		if (result != EXIT_FAILURE) {
+			nelsc_sink_printf(pOut,
+				"Segment %s, generation %llu, %lu table bytes: "
+				"tables verified.\n",
+				pName,
+				(unsigned long long) generation,
+				(unsigned long) sizeof(NELSC_TABLE));
+		
+		} else if (pShm != NULL) {
+			nelsc_sink_printf(pErr,
+				"Shared memory segment %s does not match the cycle!\n",
+				pName);
+		}
+		
+		nelsc_shm_close(pShm);
+		pShm = NULL;
+	
+	} else {
+		nelsc_sink_printf(pErr,
+			"shm command must be \"publish\", \"check\", "
+			"or \"unlink\"!\n");
+		result = EXIT_FAILURE;
 	}
 	
 	/* Return result */
@@ -816,19 +6325,21 @@ static int sub_from24pair(int argc, char *argv[]) {
 }
 
 /*
- * Subprogram to convert a decimal integer into an unsigned base-24
- * digit.
- * 
- * The provided integer must be in the range 0 to 23 (inclusive).
- * 
- * If the improper number of custom arguments is specified or the
- * subprogram can't parse the arguments or the argument is out of range,
- * an error message is displayed to the user and EXIT_FAILURE is
- * returned.
- * 
- * The first custom parameter is *not* checked -- that was assumed to
- * have been interpreted by the main procedure to select this
- * subprogram.
+ * Check each alternative calendar engine against its reference
+ * implementation.
+ * 
+ * Each engine in m_engines is run over its whole range of inputs and
+ * compared against the reference.  One line is reported per engine,
+ * giving its name, the reference, and the number of inputs checked.
+ * If any engine gives a different result for some input, that input
+ * is reported to the user and EXIT_FAILURE is returned once all the
+ * engines have been checked.
+ * 
+ * This subprogram doesn't use any custom parameters.  The first custom
+ * parameter is *not* checked -- that was assumed to have been
+ * interpreted by the main procedure to select this subprogram.  The
+ * number of custom parameters is also *not* checked, since dispatch()
+ * verifies it against the subprogram registry before calling through.
  * 
  * Parameters:
  * 
@@ -839,6 +6350,10 @@ static int sub_from24pair(int argc, char *argv[]) {
  *   program module, while the second element is the first custom
  *   argument (if it exists)
  * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
  * Return:
  * 
  *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
@@ -857,63 +6372,57 @@ static int sub_from24pair(int argc, char *argv[]) {
  * 
  *   - If any string indicated by argv is not null-terminated
  */
-static int sub_to24digit(int argc, char *argv[]) {
+static int sub_engines(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
 	
-	const char *arg_decimal = NULL;
-	long argi = 0;
 	int result = EXIT_SUCCESS;
+	const ENGINE *pEngine = NULL;
+	int32_t count = 0;
+	int32_t bad = 0;
+	int i = 0;
 	
-	/* Verify the total number of custom parameters and get the decimal
-	 * argument */
-	if (getCustomCount(argc) != 2) {
-		fprintf(stderr,
-			"to24digit expects exactly one additional argument!\n");
-		result = EXIT_FAILURE;
-	}
-	
-	if (result != EXIT_FAILURE) {
-		arg_decimal = getCustom(argc, argv, 1);
-	}
-	
-	/* Convert the argument to a long integer */
-	if (result != EXIT_FAILURE) {
-		if (!stringToLong(arg_decimal, &argi)) {
-			fprintf(stderr,
-				"Could not parse argument as decimal integer!\n");
-			result = EXIT_FAILURE;
-		}
-	}
-	
-	/* Check range */
-	if (result != EXIT_FAILURE) {
-		if ((argi < 0) || (argi > BASE24_DIGIT_MAX)) {
-			fprintf(stderr,
-				"Argument must be in range 0 to 23!\n");
+	/* Check each engine in turn */
+	for(i = 0; i < ENGINE_COUNT; i++) {
+		pEngine = &(m_engines[i]);
+		count = 0;
+		bad = 0;
+		
+		if ((*(pEngine->check))(&count, &bad)) {
+			nelsc_sink_printf(pOut, "%-16s matches %-22s %9ld inputs\n",
+				pEngine->pName, pEngine->pRef, (long) count);
+		
+		} else {
+			nelsc_sink_printf(pErr,
+				"%s differs from %s on input %ld!\n",
+				pEngine->pName, pEngine->pRef, (long) bad);
 			result = EXIT_FAILURE;
 		}
 	}
 	
-	/* Perform the conversion */
-	if (result != EXIT_FAILURE) {
-		printf("Decimal value:  %ld\n", argi);
-		printf("Base-24 digit:  %c\n",
-			base24_intToDigit((int32_t) argi));
-	}
-	
 	/* Return result */
 	return result;
 }
 
 /*
- * Subprogram to convert an unsigned base-24 digit to a decimal integer.
+ * Subprogram to sort records read from standard input by date.
  * 
- * If the improper number of custom arguments is specified or the
- * subprogram can't parse the arguments, an error message is displayed
- * to the user and EXIT_FAILURE is returned.
+ * Each line of standard input is a record that starts with a calendar
+ * date, in any of the formats read by dateToOffset(), followed by
+ * whitespace or the end of the line.  The records are written to
+ * standard output in order of the NELSC day offset of their dates,
+ * with records of the same date kept in input order.  A record that
+ * lacks a line feed at the end of input is given one.
+ * 
+ * The records are sorted with nelsc_sort within the memory limit given
+ * by the optional custom parameter, in mebibytes, using the report
+ * thread pool to sort runs in parallel.  Sorting stops at the first
+ * line that is too long or doesn't start with a valid date.
  * 
  * The first custom parameter is *not* checked -- that was assumed to
  * have been interpreted by the main procedure to select this
- * subprogram.
+ * subprogram.  The number of custom parameters is also *not* checked,
+ * since dispatch() verifies it against the subprogram registry before
+ * calling through.
  * 
  * Parameters:
  * 
@@ -924,6 +6433,10 @@ static int sub_to24digit(int argc, char *argv[]) {
  *   program module, while the second element is the first custom
  *   argument (if it exists)
  * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
  * Return:
  * 
  *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
@@ -936,95 +6449,111 @@ static int sub_to24digit(int argc, char *argv[]) {
  * 
  *   - If any element of argv is NULL
  * 
+ *   - If memory allocation fails
+ * 
  * Undefined behavior:
  * 
  *   - If argv has fewer elements than are indicated with argc
  * 
  *   - If any string indicated by argv is not null-terminated
  */
-static int sub_from24digit(int argc, char *argv[]) {
+static int sub_sort(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
 	
-	const char *arg_digit = NULL;
-	const char *pc = NULL;
-	char digit = 0;
-	int val = 0;
 	int result = EXIT_SUCCESS;
+	long mem = SORT_MEM_DEFAULT;
+	NELSC_SORT *pSort = NULL;
+	char *pLine = NULL;
+	size_t len = 0;
+	long line_num = 0;
+	int32_t offs = 0;
+	int status = RECORD_OK;
 	
-	/* Verify the total number of custom parameters and get the base-24
-	 * digit argument */
-	if (getCustomCount(argc) != 2) {
-		fprintf(stderr,
-			"from24digit expects exactly one additional argument!\n");
-		result = EXIT_FAILURE;
+	/* Get the optional memory limit */
+	if (getCustomCount(argc) >= 2) {
+		if ((!stringToLong(getCustom(argc, argv, 1), &mem)) ||
+				(mem < NELSC_SORT_MEM_MIN / 1048576) ||
+				(mem > SORT_MEM_MAX)) {
+			nelsc_sink_printf(pErr,
+				"sort memory limit must be from %ld to %ld "
+				"mebibytes!\n",
+				(long) (NELSC_SORT_MEM_MIN / 1048576),
+				(long) SORT_MEM_MAX);
+			result = EXIT_FAILURE;
+		}
 	}
 	
 	if (result != EXIT_FAILURE) {
-		arg_digit = getCustom(argc, argv, 1);
+		pSort = nelsc_sort_new(getPool(), ((size_t) mem) * 1048576);
+		pLine = (char *) malloc(RECORD_LINE_MAX);
+		if (pLine == NULL) {
+			abort();
+		}
 	}
 	
-	/* Scan through arg_digit and make sure there is exactly one
-	 * non-whitespace character; put this character into digit */
-	if (result != EXIT_FAILURE) {
-		pc = arg_digit;
-		while(*pc != 0) {
-			/* Check if current character is whitespace */
-			if (!isspace(*pc)) {
-				/* Not whitespace -- fail if we already have the digit
-				 * character */
-				if (digit != 0) {
-					fprintf(stderr,
-						"Provide no more than one base-24 digit!\n");
-					result = EXIT_FAILURE;
-					break;
-				}
-				
-				/* Otherwise, record the non-whitespace character */
-				digit = *pc;
-			}
-			pc++;
+	/* Read each record, keyed by its date; day offsets are keyed from
+	 * the start of the NELSC range */
+	while (result != EXIT_FAILURE) {
+		status = readRecord(stdin, NULL, pLine, RECORD_LINE_MAX,
+					&line_num, &len, &offs, pErr);
+		if (status == RECORD_END) {
+			break;
+		} else if (status == RECORD_FAIL) {
+			result = EXIT_FAILURE;
+			break;
 		}
 		
-		/* Fail if we didn't encounter any non-whitespace characters */
-		if (result != EXIT_FAILURE) {
-			if (digit == 0) {
-				fprintf(stderr,
-					"Provide a base-24 digit!\n");
-				result = EXIT_FAILURE;
-			}
+		if (!nelsc_sort_add(pSort,
+				(uint32_t) (offs - NELSC_CYCLE_DAYMIN), pLine, len)) {
+			nelsc_sink_printf(pErr, "Error writing temporary file!\n");
+			result = EXIT_FAILURE;
 		}
 	}
 	
-	/* Convert to decimal value */
+	/* Write the sorted records */
 	if (result != EXIT_FAILURE) {
-		val = (int) base24_digitToInt(digit);
-		if (val == -1) {
-			fprintf(stderr,
-				"Could not parse as base-24 digit!\n");
+		if (!nelsc_sort_finish(pSort, pOut)) {
+			nelsc_sink_printf(pErr,
+				"Error reading or writing temporary file!\n");
 			result = EXIT_FAILURE;
 		}
 	}
 	
-	/* Report results */
-	if (result != EXIT_FAILURE) {
-		printf("Base-24 digit:  %c\n", digit);
-		printf("Decimal value:  %d\n", val);
-	}
+	/* Release resources */
+	nelsc_sort_free(pSort);
+	free(pLine);
 	
 	/* Return result */
 	return result;
 }
 
 /*
- * Subprogram to provide information a particular NELSC absolute day
- * offset.
- * 
- * If the improper number of custom arguments is specified or the
- * subprogram can't parse the arguments, an error message is displayed
- * to the user and EXIT_FAILURE is returned.
+ * Join two files of records by date.
+ * 
+ * Each record is a line that starts with a calendar date in any format
+ * that convert reads, so a file keyed by Gregorian dates can be joined
+ * directly with one keyed by NELSC dates.  For each pair of a left and
+ * a right record with the same day offset, a line is written with the
+ * left record, a tab, and the right record.
+ * 
+ * The first two custom parameters name the left and the right file,
+ * and the left file may be "-" for standard input.  The optional third
+ * custom parameter is the mode.  With "merge", both files must be
+ * sorted by date, as by the sort subprogram, and are read once in step
+ * with joinMerge().  With "hash", the right file is loaded into a day
+ * index with joinHash() and the left file may be in any order, so the
+ * right file should be the smaller.  With "auto", the default, the
+ * right file is first read through to see whether it is sorted.  If it
+ * is, merge is chosen, falling back to a day index of the right file
+ * for the rest of the left file if the left file turns out not to be
+ * sorted; otherwise, hash is chosen.  Either way, the left file is read
+ * only once, so it may be a pipe.
  * 
  * The first custom parameter is *not* checked -- that was assumed to
  * have been interpreted by the main procedure to select this
- * subprogram.
+ * subprogram.  The number of custom parameters is also *not* checked,
+ * since dispatch() verifies it against the subprogram registry before
+ * calling through.
  * 
  * Parameters:
  * 
@@ -1035,6 +6564,10 @@ static int sub_from24digit(int argc, char *argv[]) {
  *   program module, while the second element is the first custom
  *   argument (if it exists)
  * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
  * Return:
  * 
  *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
@@ -1047,70 +6580,137 @@ static int sub_from24digit(int argc, char *argv[]) {
  * 
  *   - If any element of argv is NULL
  * 
+ *   - If memory allocation fails
+ * 
  * Undefined behavior:
  * 
  *   - If argv has fewer elements than are indicated with argc
  * 
  *   - If any string indicated by argv is not null-terminated
  */
-static int sub_day(int argc, char *argv[]) {
+static int sub_join(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
 	
-	const char *arg_decimal = NULL;
-	long day = 0;
 	int result = EXIT_SUCCESS;
+	int mode = JOIN_AUTO;
+	const char *pMode = NULL;
+	const char *pLeftName = NULL;
+	const char *pRightName = NULL;
+	FILE *pLeft = NULL;
+	FILE *pRight = NULL;
+	char *pLine = NULL;
+	bool sorted = false;
+	bool fall_back = false;
 	
-	/* Verify the total number of custom parameters and get the decimal
-	 * argument */
-	if (getCustomCount(argc) != 2) {
-		fprintf(stderr,
-			"day expects exactly one additional argument!\n");
-		result = EXIT_FAILURE;
+	pLeftName = getCustom(argc, argv, 1);
+	pRightName = getCustom(argc, argv, 2);
+	
+	/* Get the optional mode */
+	if (getCustomCount(argc) >= 4) {
+		pMode = getCustom(argc, argv, 3);
+		if (strcmp(pMode, "auto") == 0) {
+			mode = JOIN_AUTO;
+		} else if (strcmp(pMode, "merge") == 0) {
+			mode = JOIN_MERGE;
+		} else if (strcmp(pMode, "hash") == 0) {
+			mode = JOIN_HASH;
+		} else {
+			nelsc_sink_printf(pErr,
+				"join mode must be \"auto\", \"merge\", or "
+				"\"hash\"!\n");
+			result = EXIT_FAILURE;
+		}
 	}
 	
+	/* Open the files */
 	if (result != EXIT_FAILURE) {
-		arg_decimal = getCustom(argc, argv, 1);
+		if (strcmp(pLeftName, "-") == 0) {
+			pLeft = stdin;
+			pLeftName = NULL;
+		} else {
+			pLeft = fopen(pLeftName, "r");
+			if (pLeft == NULL) {
+				nelsc_sink_printf(pErr, "Can't open %s!\n", pLeftName);
+				result = EXIT_FAILURE;
+			}
+		}
 	}
 	
-	/* Convert the argument to a long integer */
 	if (result != EXIT_FAILURE) {
-		if (!stringToLong(arg_decimal, &day)) {
-			fprintf(stderr,
-				"Could not parse argument as decimal integer!\n");
+		pRight = fopen(pRightName, "r");
+		if (pRight == NULL) {
+			nelsc_sink_printf(pErr, "Can't open %s!\n", pRightName);
 			result = EXIT_FAILURE;
 		}
 	}
 	
-	/* Check the range of the argument */
 	if (result != EXIT_FAILURE) {
-		if ((day < NELSC_CYCLE_DAYMIN) || (day > NELSC_CYCLE_DAYMAX)) {
-			fprintf(stderr,
-				"Argument must be in range %d to %d!\n",
-				NELSC_CYCLE_DAYMIN,
-				NELSC_CYCLE_DAYMAX);
+		pLine = (char *) malloc(2 * RECORD_LINE_MAX);
+		if (pLine == NULL) {
+			abort();
+		}
+	}
+	
+	/* Merge if the right file is sorted, falling back if the left file
+	 * is not, and otherwise index the right file */
+	if ((result != EXIT_FAILURE) && (mode == JOIN_AUTO)) {
+		if (!joinCheckSorted(pRight, pRightName, pLine, &sorted,
+				pErr)) {
 			result = EXIT_FAILURE;
 		}
+		mode = (sorted) ? JOIN_MERGE : JOIN_HASH;
+		fall_back = sorted;
 	}
-
-	/* Print information */
+	
+	/* Join the files */
 	if (result != EXIT_FAILURE) {
-		printDayInformation((int32_t) day);
+		if (mode == JOIN_MERGE) {
+			if (!joinMerge(pLeft, pLeftName, pRight, pRightName,
+					pLine, fall_back, pOut, pErr)) {
+				result = EXIT_FAILURE;
+			}
+		
+		} else {
+			if (!joinHash(pLeft, pLeftName, pRight, pRightName,
+					pLine, pOut, pErr)) {
+				result = EXIT_FAILURE;
+			}
+		}
+	}
+	
+	/* Release resources */
+	if ((pLeft != NULL) && (pLeft != stdin)) {
+		fclose(pLeft);
+	}
+	if (pRight != NULL) {
+		fclose(pRight);
 	}
+	free(pLine);
 	
 	/* Return result */
 	return result;
 }
 
 /*
- * Subprogram to provide information a particular NELSC absolute month
- * offset.
- * 
- * If the improper number of custom arguments is specified or the
- * subprogram can't parse the arguments, an error message is displayed
- * to the user and EXIT_FAILURE is returned.
+ * Build and query event stores.
+ * 
+ * The first custom parameter after the subprogram name is the command
+ * and the second is the path of the store file.  With "build", the
+ * third names a file of events, one per line, each starting with a
+ * calendar date, which are laid out by eventsBuild() into a new store.
+ * With "day", the third is a calendar date and the events of that day
+ * are written.  With "range", the third and fourth are the first and
+ * last calendar dates of a range, and the events of every day in the
+ * range are written in order of day.  Queries map the store with
+ * nelsc_events_map(), so no time is spent loading it.  With "verify",
+ * there are no further parameters, and the whole store is checked with
+ * nelsc_events_verify().
  * 
  * The first custom parameter is *not* checked -- that was assumed to
  * have been interpreted by the main procedure to select this
- * subprogram.
+ * subprogram.  The number of custom parameters is only checked against
+ * the command, since dispatch() verifies it against the limits in the
+ * subprogram registry before calling through.
  * 
  * Parameters:
  * 
@@ -1121,6 +6721,10 @@ static int sub_day(int argc, char *argv[]) {
  *   program module, while the second element is the first custom
  *   argument (if it exists)
  * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
  * Return:
  * 
  *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
@@ -1133,71 +6737,136 @@ static int sub_day(int argc, char *argv[]) {
  * 
  *   - If any element of argv is NULL
  * 
+ *   - If memory allocation fails
+ * 
  * Undefined behavior:
  * 
  *   - If argv has fewer elements than are indicated with argc
  * 
  *   - If any string indicated by argv is not null-terminated
  */
-static int sub_month(int argc, char *argv[]) {
+static int sub_events(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
 	
-	const char *arg_decimal = NULL;
-	long month = 0;
 	int result = EXIT_SUCCESS;
+	const char *pCmd = NULL;
+	const char *pStore = NULL;
+	NELSC_EVENTS *pEvents = NULL;
+	int arg_count = 0;
+	int arg_need = 0;
+	int32_t first_day = 0;
+	int32_t last_day = 0;
+	int32_t first = 0;
+	int32_t count = 0;
+	int i = 0;
+	
+	pCmd = getCustom(argc, argv, 1);
+	pStore = getCustom(argc, argv, 2);
+	arg_count = getCustomCount(argc) - 1;
 	
-	/* Verify the total number of custom parameters and get the decimal
-	 * argument */
-	if (getCustomCount(argc) != 2) {
-		fprintf(stderr,
-			"month expects exactly one additional argument!\n");
+	/* Check the command and its number of arguments */
+	if (strcmp(pCmd, "verify") == 0) {
+		arg_need = 2;
+	} else if ((strcmp(pCmd, "build") == 0) ||
+			(strcmp(pCmd, "day") == 0)) {
+		arg_need = 3;
+	} else if (strcmp(pCmd, "range") == 0) {
+		arg_need = 4;
+	} else {
+		nelsc_sink_printf(pErr,
+			"events command must be \"build\", \"day\", \"range\", "
+			"or \"verify\"!\n");
 		result = EXIT_FAILURE;
 	}
 	
-	if (result != EXIT_FAILURE) {
-		arg_decimal = getCustom(argc, argv, 1);
+	if ((result != EXIT_FAILURE) && (arg_count != arg_need)) {
+		nelsc_sink_printf(pErr,
+			"events %s expects exactly %s additional arguments!\n",
+			pCmd, (arg_need == 2) ? "two" :
+					((arg_need == 3) ? "three" : "four"));
+		result = EXIT_FAILURE;
 	}
 	
-	/* Convert the argument to a long integer */
-	if (result != EXIT_FAILURE) {
-		if (!stringToLong(arg_decimal, &month)) {
-			fprintf(stderr,
-				"Could not parse argument as decimal integer!\n");
+	/* Build a store */
+	if ((result != EXIT_FAILURE) && (strcmp(pCmd, "build") == 0)) {
+		if (!eventsBuild(pStore, getCustom(argc, argv, 3), pErr)) {
 			result = EXIT_FAILURE;
 		}
-	}
 	
-	/* Check the range of the argument */
-	if (result != EXIT_FAILURE) {
-		if ((month < NELSC_CYCLE_MONMIN) ||
-				(month > NELSC_CYCLE_MONMAX)) {
-			fprintf(stderr,
-				"Argument must be in range %d to %d!\n",
-				NELSC_CYCLE_MONMIN,
-				NELSC_CYCLE_MONMAX);
-			result = EXIT_FAILURE;
+	/* Query a store */
+	} else if (result != EXIT_FAILURE) {
+		for(i = 3; i <= arg_need; i++) {
+			if (!dateToOffset(getCustom(argc, argv, i), -1,
+					&last_day, NULL, NULL)) {
+				nelsc_sink_printf(pErr,
+					"Could not parse %s as a valid calendar date!\n",
+					getCustom(argc, argv, i));
+				result = EXIT_FAILURE;
+				break;
+			}
+			if (i == 3) {
+				first_day = last_day;
+			}
+		}
+		
+		if (result != EXIT_FAILURE) {
+			pEvents = nelsc_events_map(pStore);
+			if (pEvents == NULL) {
+				nelsc_sink_printf(pErr,
+					"Can't open event store %s!\n", pStore);
+				result = EXIT_FAILURE;
+			}
+		}
+		
+		if (result != EXIT_FAILURE) {
+			if (arg_need == 2) {
+				if (nelsc_events_verify(pEvents)) {
+					nelsc_sink_printf(pOut,
+						"Event store %s verified: %ld events.\n",
+						pStore, (long) nelsc_events_count(pEvents));
+				} else {
+					nelsc_sink_printf(pErr,
+						"Event store %s is damaged!\n", pStore);
+					result = EXIT_FAILURE;
+				}
+			
+			} else {
+				if (arg_need == 3) {
+					count = nelsc_events_day(pEvents, first_day,
+								&first);
+				} else {
+					count = nelsc_events_range(
+								pEvents, first_day, last_day, &first);
+				}
+				eventsWrite(pOut, pEvents, first, count);
+			}
 		}
 	}
 	
-	/* Print information */
-	if (result != EXIT_FAILURE) {
-		printDayInformation(nelsc_cycle_monthToDay((int32_t) month));
-	}
+	/* Release resources */
+	nelsc_events_free(pEvents);
 	
 	/* Return result */
 	return result;
 }
 
 /*
- * Subprogram to provide information a particular calendar date (either
- * NELSC or Gregorian).
- * 
- * If the improper number of custom arguments is specified or the
- * subprogram can't parse the arguments, an error message is displayed
- * to the user and EXIT_FAILURE is returned.
- * 
- * The first custom parameter is *not* checked -- that was assumed to
- * have been interpreted by the main procedure to select this
- * subprogram.
+ * Subprogram to time the month lookups in m_lookups.
+ * 
+ * Each lookup is run over every NELSC day offset, first in order and
+ * then shuffled into a random order that is the same on every run,
+ * which defeats the caches and the branch predictor.  One line is
+ * reported per lookup, giving its name, the average time of a lookup
+ * in each order, and the bytes of data it uses.  If a lookup gives
+ * different results from the first lookup, this is reported to the
+ * user and EXIT_FAILURE is returned once all the lookups have been
+ * timed.
+ * 
+ * This subprogram doesn't use any custom parameters.  The first custom
+ * parameter is *not* checked -- that was assumed to have been
+ * interpreted by the main procedure to select this subprogram.  The
+ * number of custom parameters is also *not* checked, since dispatch()
+ * verifies it against the subprogram registry before calling through.
  * 
  * Parameters:
  * 
@@ -1208,6 +6877,10 @@ static int sub_month(int argc, char *argv[]) {
  *   program module, while the second element is the first custom
  *   argument (if it exists)
  * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
  * Return:
  * 
  *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
@@ -1220,172 +6893,283 @@ static int sub_month(int argc, char *argv[]) {
  * 
  *   - If any element of argv is NULL
  * 
+ *   - If memory allocation fails
+ * 
  * Undefined behavior:
  * 
  *   - If argv has fewer elements than are indicated with argc
  * 
  *   - If any string indicated by argv is not null-terminated
  */
-static int sub_date(int argc, char *argv[]) {
+static int sub_bench(
+		int argc, char *argv[], NELSC_SINK *pOut, NELSC_SINK *pErr) {
 	
-	const char *arg_date = NULL;
-	int32_t offs = 0;
 	int result = EXIT_SUCCESS;
+	const LOOKUP *pLookup = NULL;
+	void *pData = NULL;
+	int32_t *pOrdered = NULL;
+	int32_t *pShuffled = NULL;
+	int32_t count = 0;
+	int32_t i = 0;
+	int32_t j = 0;
+	int32_t t = 0;
+	uint32_t seed = BENCH_SEED;
+	uint64_t ordered_ns = 0;
+	uint64_t shuffled_ns = 0;
+	int64_t ordered_sum = 0;
+	int64_t shuffled_sum = 0;
+	int64_t ref_ordered_sum = 0;
+	int64_t ref_shuffled_sum = 0;
+	int x = 0;
 	
-	/* Verify the total number of custom parameters and get the date
-	 * argument */
-	if (getCustomCount(argc) != 2) {
-		fprintf(stderr, 
-			"date expects exactly one additional argument!\n");
-		result = EXIT_FAILURE;
+	/* Fill in the days in order, and shuffle a copy of them */
+	count = NELSC_CYCLE_DAYMAX - NELSC_CYCLE_DAYMIN + 1;
+	pOrdered = (int32_t *) malloc(((size_t) count) * sizeof(int32_t));
+	pShuffled = (int32_t *) malloc(((size_t) count) * sizeof(int32_t));
+	if ((pOrdered == NULL) || (pShuffled == NULL)) {
+		abort();
 	}
 	
-	if (result != EXIT_FAILURE) {
-		arg_date = getCustom(argc, argv, 1);
+	for(i = 0; i < count; i++) {
+		pOrdered[i] = NELSC_CYCLE_DAYMIN + i;
+		pShuffled[i] = pOrdered[i];
+	}
+	for(i = count - 1; i > 0; i--) {
+		seed ^= seed << 13;
+		seed ^= seed >> 17;
+		seed ^= seed << 5;
+		j = (int32_t) (seed % ((uint32_t) (i + 1)));
+		
+		t = pShuffled[i];
+		pShuffled[i] = pShuffled[j];
+		pShuffled[j] = t;
 	}
 	
-	/* Perform the conversion */
-	if (result != EXIT_FAILURE) {
-		if (!dateToOffset(arg_date, &offs)) {
-			fprintf(stderr,
-				"Could not parse as a valid calendar date!\n"
-				"(Note: Gregorian dates must be in range 1828-04-07 to "
-				"2404-04-11.)\n");
+	/* Time each lookup in turn */
+	for(x = 0; x < LOOKUP_COUNT; x++) {
+		pLookup = &(m_lookups[x]);
+		
+		pData = NULL;
+		if (pLookup->data_size > 0) {
+			if (posix_memalign(&pData, BENCH_ALIGN,
+					pLookup->data_size)) {
+				abort();
+			}
+			(*(pLookup->build))(pData);
+		}
+		
+		ordered_ns = benchRun(pLookup, pData,
+						pOrdered, count, &ordered_sum);
+		shuffled_ns = benchRun(pLookup, pData,
+						pShuffled, count, &shuffled_sum);
+		
+		free(pData);
+		pData = NULL;
+		
+		if (x < 1) {
+			ref_ordered_sum = ordered_sum;
+			ref_shuffled_sum = shuffled_sum;
+		}
+		
+		if ((ordered_sum == ref_ordered_sum) &&
+				(shuffled_sum == ref_shuffled_sum)) {
+			nelsc_sink_printf(pOut,
+				"%-12s %7.2f ns in order %7.2f ns random %8lu bytes\n",
+				pLookup->pName,
+				((double) ordered_ns) / ((double) count),
+				((double) shuffled_ns) / ((double) count),
+				(unsigned long) pLookup->data_size);
+		
+		} else {
+			nelsc_sink_printf(pErr, "%s differs from %s!\n",
+				pLookup->pName, m_lookups[0].pName);
 			result = EXIT_FAILURE;
 		}
 	}
 	
-	/* Print information */
-	if (result != EXIT_FAILURE) {
-		printDayInformation(offs);
-	}
+	/* Release resources */
+	free(pOrdered);
+	free(pShuffled);
+	pOrdered = NULL;
+	pShuffled = NULL;
 	
 	/* Return result */
 	return result;
 }
 
 /*
- * Subprogram to provide the Gregorian dates of the NELSC full moon
- * weeks for a given range of NELSC months.
+ * Compute the hash of a subprogram name.
  * 
- * If the improper number of custom arguments is specified or the
- * subprogram can't parse the arguments, an error message is displayed
- * to the user and EXIT_FAILURE is returned.
- * 
- * The first custom parameter is *not* checked -- that was assumed to
- * have been interpreted by the main procedure to select this
- * subprogram.
+ * The hash combines the length of the name with its first, middle, and
+ * last characters with SUBPROGRAM_HASH().  The multipliers were chosen
+ * so that every name in m_subprograms hashes to a different slot,
+ * making m_slots a perfect hash table.
  * 
  * Parameters:
  * 
- *   argc - the number of program arguments in argv
- * 
- *   argv - an array of null-terminated strings representing the program
- *   arguments, with argc elements; the first element is name of the
- *   program module, while the second element is the first custom
- *   argument (if it exists)
+ *   pName - the subprogram name, which must not be empty
  * 
  * Return:
  * 
- *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
+ *   the slot index, in range zero up to SUBPROGRAM_SLOTS - 1
  * 
  * Faults:
  * 
- *   - If argc is negative
- * 
- *   - If argv is NULL
- * 
- *   - If any element of argv is NULL
+ *   - If pName is NULL or empty
  * 
  * Undefined behavior:
  * 
- *   - If argv has fewer elements than are indicated with argc
- * 
- *   - If any string indicated by argv is not null-terminated
+ *   - If pName is not null-terminated
  */
-static int sub_fullmoon(int argc, char *argv[]) {
+static size_t hashName(const char *pName) {
 	
-	const char *arg_decimal_1 = NULL;
-	const char *arg_decimal_2 = NULL;
-	long month_1 = 0;
-	long month_2 = 0;
-	int result = EXIT_SUCCESS;
+	size_t len = 0;
+	size_t h = 0;
 	
-	/* Verify the total number of custom parameters and get the decimal
-	 * arguments */
-	if (getCustomCount(argc) != 3) {
-		fprintf(stderr,
-			"fullmoon expects exactly two additional arguments!\n");
-		result = EXIT_FAILURE;
+	/* Check parameter */
+	if (pName == NULL) {
+		abort();
 	}
 	
-	if (result != EXIT_FAILURE) {
-		arg_decimal_1 = getCustom(argc, argv, 1);
-		arg_decimal_2 = getCustom(argc, argv, 2);
+	len = strlen(pName);
+	if (len < 1) {
+		abort();
 	}
 	
-	/* Convert the arguments to long integers */
-	if (result != EXIT_FAILURE) {
-		if (!stringToLong(arg_decimal_1, &month_1)) {
-			fprintf(stderr,
-				"Could not parse first argument as decimal integer!\n");
-			result = EXIT_FAILURE;
-		}
-	}
+	/* Combine the length and the selected characters */
+	h = SUBPROGRAM_HASH(len,
+			(size_t) ((unsigned char) pName[0]),
+			(size_t) ((unsigned char) pName[len / 2]),
+			(size_t) ((unsigned char) pName[len - 1]));
 	
-	if (result != EXIT_FAILURE) {
-		if (!stringToLong(arg_decimal_2, &month_2)) {
-			fprintf(stderr,
-			"Could not parse second argument as decimal integer!\n");
-			result = EXIT_FAILURE;
-		}
-	}
+	return h;
+}
+
+/*
+ * Find a subprogram in the registry by name.
+ * 
+ * Parameters:
+ * 
+ *   pName - the subprogram name
+ * 
+ * Return:
+ * 
+ *   the registry record, or NULL if no subprogram has the given name
+ * 
+ * Faults:
+ * 
+ *   - If pName is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If pName is not null-terminated
+ */
+static const SUBPROGRAM *findSubprogram(const char *pName) {
 	
-	/* Check the range of the arguments */
-	if (result != EXIT_FAILURE) {
-		if ((month_1 < NELSC_CYCLE_MONMIN) ||
-				(month_1 > NELSC_CYCLE_MONMAX) ||
-				(month_2 < NELSC_CYCLE_MONMIN) ||
-				(month_2 > NELSC_CYCLE_MONMAX)) {
-			fprintf(stderr,
-				"Arguments must be in range %d to %d!\n",
-				NELSC_CYCLE_MONMIN,
-				NELSC_CYCLE_MONMAX);
-			result = EXIT_FAILURE;
-		}
+	const SUBPROGRAM *pResult = NULL;
+	int i = 0;
+	
+	/* Check parameter */
+	if (pName == NULL) {
+		abort();
 	}
 	
-	/* Check that second argument is not less than first argument */
-	if (result != EXIT_FAILURE) {
-		if (month_2 < month_1) {
-			fprintf(stderr,
-				"Second argument must not be less than first!\n");
-			result = EXIT_FAILURE;
+	/* Look up the slot and confirm the name */
+	if (pName[0] != 0) {
+		i = m_slots[hashName(pName)] - 1;
+		if (i >= 0) {
+			if (strcmp(m_subprograms[i].pName, pName) == 0) {
+				pResult = &(m_subprograms[i]);
+			}
 		}
 	}
 	
-	/* Call through to the computation procedure */
-	if (result != EXIT_FAILURE) {
-		fullMoons((int32_t) month_1, (int32_t) month_2);
+	return pResult;
+}
+
+/*
+ * Report that a subprogram was given the wrong number of additional
+ * arguments.
+ * 
+ * The message is derived from the argument limits in the registry
+ * record.
+ * 
+ * Parameters:
+ * 
+ *   pErr - the sink to write the error message to
+ * 
+ *   pSub - the registry record of the subprogram
+ * 
+ * Faults:
+ * 
+ *   - If pErr or pSub is NULL
+ * 
+ *   - If an argument limit in the record exceeds the number of counts
+ *     that can be written as words
+ */
+static void reportArgCount(NELSC_SINK *pErr, const SUBPROGRAM *pSub) {
+	
+	static const char *m_words[] = {
+		"no", "one", "two", "three", "four"
+	};
+	const int word_count = (int) (sizeof(m_words) / sizeof(m_words[0]));
+	
+	/* Check parameters */
+	if ((pErr == NULL) || (pSub == NULL)) {
+		abort();
+	}
+	if ((pSub->arg_min >= word_count) ||
+			(pSub->arg_max >= word_count)) {
+		abort();
 	}
 	
-	/* Return result */
-	return result;
+	/* Write the message */
+	if (pSub->arg_min == pSub->arg_max) {
+		nelsc_sink_printf(pErr,
+			"%s expects %s%s additional argument%s!\n",
+			pSub->pName,
+			(pSub->arg_min == 0) ? "" : "exactly ",
+			m_words[pSub->arg_min],
+			(pSub->arg_min == 1) ? "" : "s");
+	
+	} else if (pSub->arg_max == ARGS_ANY) {
+		nelsc_sink_printf(pErr,
+			"%s expects at least %s additional argument%s!\n",
+			pSub->pName,
+			m_words[pSub->arg_min],
+			(pSub->arg_min == 1) ? "" : "s");
+	
+	} else if (pSub->arg_min == 0) {
+		nelsc_sink_printf(pErr,
+			"%s expects at most %s additional argument%s!\n",
+			pSub->pName,
+			m_words[pSub->arg_max],
+			(pSub->arg_max == 1) ? "" : "s");
+	
+	} else {
+		nelsc_sink_printf(pErr,
+			"%s expects %s to %s additional arguments!\n",
+			pSub->pName,
+			m_words[pSub->arg_min],
+			m_words[pSub->arg_max]);
+	}
 }
 
 /*
- * Subprogram to provide the Gregorian dates of the first day of each
- * NELSC year, along with minimum and maximum Gregorian month and day of
- * the first day of the NELSC year, and for each year the year drift
- * relative to March 20.
+ * Call through to the subprogram selected by the first custom argument.
  * 
- * If the improper number of custom arguments is specified or the
- * subprogram can't parse the arguments, an error message is displayed
- * to the user and EXIT_FAILURE is returned.
+ * The subprogram is looked up in the m_subprograms registry through
+ * the m_slots perfect hash table.  If there are no custom arguments,
+ * sub_help() is called.  If the subprogram name is not recognized, or
+ * the number of additional arguments is outside the limits given in
+ * the registry, an error message is written to pErr and EXIT_FAILURE
+ * is returned.
  * 
- * The first custom parameter is *not* checked -- that was assumed to
- * have been interpreted by the main procedure to select this
- * subprogram.
+ * When batch is true, the call comes from a command line read by the
+ * batch subprogram.  Subprograms that read standard input themselves
+ * (batch and convert) are then not available, since standard input is
+ * already carrying the batch commands.  These are the subprograms
+ * whose registry records are not marked as available in batch mode.
  * 
  * Parameters:
  * 
@@ -1396,9 +7180,16 @@ static int sub_fullmoon(int argc, char *argv[]) {
  *   program module, while the second element is the first custom
  *   argument (if it exists)
  * 
+ *   pOut - the sink to write the subprogram output to
+ * 
+ *   pErr - the sink to write error messages to
+ * 
+ *   batch - true if dispatching a command within batch mode
+ * 
  * Return:
  * 
- *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful
+ *   EXIT_SUCCESS if successful, EXIT_FAILURE if unsuccessful; passing
+ *   through no custom arguments to invoke sub_help() results in success
  * 
  * Faults:
  * 
@@ -1408,152 +7199,79 @@ static int sub_fullmoon(int argc, char *argv[]) {
  * 
  *   - If any element of argv is NULL
  * 
+ *   - If pOut or pErr is NULL
+ * 
  * Undefined behavior:
  * 
  *   - If argv has fewer elements than are indicated with argc
  * 
  *   - If any string indicated by argv is not null-terminated
  */
-static int sub_newyear(int argc, char *argv[]) {
+static int dispatch(
+		int argc, char *argv[], 
+		NELSC_SINK *pOut, NELSC_SINK *pErr, bool batch) {
 	
-	int result = EXIT_SUCCESS;
-	int32_t y = 0;
-	int32_t d = 0;
-	int32_t abs_month = 0;
-	int32_t abs_equinox = 0;
-	int32_t year_drift = 0;
-	int32_t min_drift = 0;
-	int32_t max_drift = 0;
-	int32_t gr_year = 0;
-	int32_t gr_month = 0;
-	int32_t gr_day = 0;
-	int32_t gr_equinox = 0;
-	int32_t earliest_month = -1;
-	int32_t earliest_day = -1;
-	int32_t latest_month = -1;
-	int32_t latest_day = -1;
+	int retval = 0;
+	int arg_count = 0;
+	const char *spname = NULL;
+	const SUBPROGRAM *pSub = NULL;
+	
+	/* Check parameters */
+	if ((pOut == NULL) || (pErr == NULL)) {
+		abort();
+	}
+	
+	/* Get the first custom argument, which selects the subprogram; an
+	 * empty string is returned if there are no custom arguments, which
+	 * selects the helpscreen */
+	spname = getCustom(argc, argv, 0);
+	if (spname[0] == 0) {
+		spname = "help";
+	}
 	
-	/* Verify the total number of custom parameters and get the decimal
+	/* Look up the subprogram and determine the number of additional
 	 * arguments */
-	if (getCustomCount(argc) != 1) {
-		fprintf(stderr,
-			"newyear expects no additional arguments!\n");
-		result = EXIT_FAILURE;
+	pSub = findSubprogram(spname);
+	arg_count = getCustomCount(argc) - 1;
+	if (arg_count < 0) {
+		arg_count = 0;
 	}
 	
-	/* Generate the report */
-	if (result != EXIT_FAILURE) {
-		/* Go through each year */
-		for(y = NELSC_CYCLE_YEARMIN; y <= NELSC_CYCLE_YEARMAX; y++) {
-			
-			/* If this row is not the first row and its row index is a
-			 * multiple of four, prefix a blank line */
-			if ((y != NELSC_CYCLE_YEARMIN) &&
-				((y - NELSC_CYCLE_YEARMIN) % 4 == 0)) {
-				printf("\n");
-			}
-			
-			/* Begin by printing the year */
-			base24_printPair(stdout, y);
-			
-			/* Convert the year into a day offset and an absolute
-			 * month */
-			abs_month = nelsc_cycle_yearToMonth(y);
-			d = nelsc_cycle_monthToDay(abs_month);
-
-			/* Apply Gregorian offset to convert it to Gregorian */
-			d += NELSC_CYCLE_GROFFS;
-			
-			/* Split into Gregorian year-month-day */
-			grcal_offsetToDate(d, &gr_year, &gr_month, &gr_day);
-
-			/* Figure out the equinox offset that year */
-			grcal_dateToOffset(
-				&gr_equinox, gr_year, EQUINOX_MONTH, EQUINOX_DAY);
-
-			/* Get the NELSC absolute month of the equinox -- except in
-			 * the first year, use one less than the least month, since
-			 * the NELSC calendar doesn't go that far back */
-			if (y > NELSC_CYCLE_YEARMIN) {
-				abs_equinox = nelsc_cycle_dayToMonth(
-								gr_equinox - NELSC_CYCLE_GROFFS,
-								NULL);
-			} else {
-				abs_equinox = abs_month - 1;
-			}
-
-			/* Compute the year drift */
-			year_drift = abs_equinox - abs_month;
-
-			/* If this is first year, use value to initialize minimum
-			 * and maximum statistics; else, update the statistics
-			 * appropriately */
-			if (y == NELSC_CYCLE_YEARMIN) {
-				min_drift = year_drift;
-				max_drift = year_drift;
-			} else {
-				if (year_drift < min_drift) {
-					min_drift = year_drift;
-				}
-				if (year_drift > max_drift) {
-					max_drift = year_drift;
-				}
-			}
-			
-			/* Print the rest of the line */
-			printf("  ");
-			grcal_printDate(stdout, gr_year, gr_month, gr_day);
-			printf("  equinox month offset %2d\n", (int) year_drift);
-			
-			/* Update the earliest and latest first day statistics */
-			if (earliest_month == -1) {
-				earliest_month = gr_month;
-				earliest_day = gr_day;
-			}
-			
-			if ((earliest_month > gr_month) ||
-				((earliest_month == gr_month) &&
-					(earliest_day > gr_day))) {
-				earliest_month = gr_month;
-				earliest_day = gr_day;
-			}
-			
-			if (latest_month == -1) {
-				latest_month = gr_month;
-				latest_day = gr_day;
-			}
-			
-			if ((latest_month < gr_month) ||
-				((latest_month == gr_month) &&
-					(latest_day < gr_day))) {
-				latest_month = gr_month;
-				latest_day = gr_day;
-			}
-		}
-		
-		/* Print the range of new year times and year drifts */
-		printf("\n");
-		printf("Range of first day of year:  %02ld-%02ld - "
-				"%02ld-%02ld\n",
-					(long) earliest_month,
-					(long) earliest_day,
-					(long) latest_month,
-					(long) latest_day);
-		printf("Range of equinox offsets:    [%d, %d]\n",
-					(int) min_drift,
-					(int) max_drift);
+	/* Validate the call and call through to the subprogram procedure */
+	if (pSub == NULL) {
+		/* Unrecognized subprogram argument */
+		nelsc_sink_printf(pErr,
+			"Unrecognized command.  Use \"help\" for help.\n");
+		retval = EXIT_FAILURE;
+	
+	} else if (batch && (!(pSub->batch))) {
+		/* Subprogram not available within batch mode */
+		nelsc_sink_printf(pErr,
+			"%s is not available in batch mode!\n", spname);
+		retval = EXIT_FAILURE;
+	
+	} else if ((arg_count < pSub->arg_min) ||
+				((pSub->arg_max != ARGS_ANY) &&
+					(arg_count > pSub->arg_max))) {
+		/* Wrong number of additional arguments */
+		reportArgCount(pErr, pSub);
+		retval = EXIT_FAILURE;
+	
+	} else {
+		retval = (*(pSub->proc))(argc, argv, pOut, pErr);
 	}
 	
-	/* Return result */
-	return result;
+	/* Return the result */
+	return retval;
 }
 
 /*
  * The program entrypoint.
  * 
- * This checks the first custom argument and calls through to one of the
- * subprogram procedures.  If there are no custom arguments, it calls
- * through to the sub_help() program.
+ * This calls through to dispatch() with the program arguments,
+ * writing to file sinks wrapping standard output and standard error.
+ * If any of the output could not be written, this is reported on
+ * standard error and EXIT_FAILURE is returned.
  * 
  * Parameters:
  * 
@@ -1584,51 +7302,45 @@ static int sub_newyear(int argc, char *argv[]) {
  *   - If any string indicated by argv is not null-terminated
  */
 int main(int argc, char *argv[]) {
+	
 	int retval = 0;
-	const char *spname = NULL;
+	NELSC_SINK *pOut = NULL;
+	NELSC_SINK *pErr = NULL;
+	const char *pEnv = NULL;
 	
-	/* Get the first custom argument, which selects the subprogram; an
-	 * empty string is returned if there are no custom arguments */
-	spname = getCustom(argc, argv, 0);
+	/* Wrap standard output and standard error in sinks, so that they
+	 * keep their usual stdio buffering */
+	pOut = nelsc_sink_newFile(stdout);
+	pErr = nelsc_sink_newFile(stderr);
 	
-	/* Call through to the appropriate subprogram procedure */
-	if ((strcmp(spname, "") == 0) || (strcmp(spname, "help") == 0)) {
-		retval = sub_help();
+	/* Call through to the subprogram */
+	retval = dispatch(argc, argv, pOut, pErr, false);
 	
-	} else if (strcmp(spname, "to24pair") == 0) {
-		retval = sub_to24pair(argc, argv);
+	/* Release the report thread pool if it was used, which merges the
+	 * counters of its threads */
+	nelsc_pool_free(m_pool);
+	m_pool = NULL;
 	
-	} else if (strcmp(spname, "from24pair") == 0) {
-		retval = sub_from24pair(argc, argv);
+	/* Print the counters if requested */
+	pEnv = getenv("NELSC_STATS");
+	if (pEnv != NULL) {
+		if (strcmp(pEnv, "1") == 0) {
+			nelsc_stats_merge();
+			nelsc_sink_flush(pOut);
+			nelsc_stats_print(pErr);
+		}
+	}
 	
-	} else if (strcmp(spname, "to24digit") == 0) {
-		retval = sub_to24digit(argc, argv);
-		
-	} else if (strcmp(spname, "from24digit") == 0) {
-		retval = sub_from24digit(argc, argv);
-		
-	} else if (strcmp(spname, "day") == 0) {
-		retval = sub_day(argc, argv);
-		
-	} else if (strcmp(spname, "month") == 0) {
-		retval = sub_month(argc, argv);
-		
-	} else if (strcmp(spname, "date") == 0) {
-		retval = sub_date(argc, argv);
-		
-	} else if (strcmp(spname, "fullmoon") == 0) {
-		retval = sub_fullmoon(argc, argv);
-		
-	} else if (strcmp(spname, "newyear") == 0) {
-		retval = sub_newyear(argc, argv);
-		
-	} else {
-		/* Unrecognized subprogram argument */
-		fprintf(stderr,
-			"Unrecognized command.  Use \"help\" for help.\n");
+	/* Make sure all the output was written */
+	nelsc_sink_flush(pOut);
+	if (nelsc_sink_failed(pOut)) {
+		nelsc_sink_printf(pErr, "Error writing standard output!\n");
 		retval = EXIT_FAILURE;
 	}
 	
-	/* Return the result */
+	/* Release the sinks, which flushes them */
+	nelsc_sink_free(pOut);
+	nelsc_sink_free(pErr);
+	
 	return retval;
 }
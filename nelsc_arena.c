@@ -0,0 +1,360 @@
+/*
+ * nelsc_arena.c
+ * 
+ * Implementation of nelsc_arena.h
+ * 
+ * See the header for further information.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "nelsc_arena.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(__GNUC__)
+#error nelsc_arena requires the GCC atomic builtins
+#endif
+
+/*
+ * The header of a block of arena memory.
+ * 
+ * The usable memory of the block follows the header, starting at
+ * offset ARENA_HEADER.
+ */
+typedef struct ARENA_BLOCK_TAG {
+	
+	/*
+	 * The next block of the arena, or NULL if this is the last.
+	 */
+	struct ARENA_BLOCK_TAG *pNext;
+	
+	/*
+	 * The number of usable bytes in the block.
+	 */
+	size_t cap;
+
+} ARENA_BLOCK;
+
+/*
+ * The size of the block header rounded up to the allocation alignment.
+ */
+#define ARENA_HEADER \
+	((sizeof(ARENA_BLOCK) + NELSC_ARENA_ALIGN - 1) & \
+		~((size_t) (NELSC_ARENA_ALIGN - 1)))
+
+/*
+ * NELSC_ARENA structure.
+ * 
+ * Prototype given in the header.
+ * 
+ * The blocks form a list.  Blocks before pCur are full, pCur is being
+ * allocated from, and blocks after pCur are free for reuse.
+ */
+struct NELSC_ARENA_TAG {
+	
+	/*
+	 * The size of a regular block.
+	 */
+	size_t block;
+	
+	/*
+	 * The first block, or NULL if none has been allocated yet.
+	 */
+	ARENA_BLOCK *pFirst;
+	
+	/*
+	 * The block being allocated from, or NULL if nothing has been
+	 * allocated since the arena was created or reset.
+	 */
+	ARENA_BLOCK *pCur;
+	
+	/*
+	 * The number of bytes used in pCur.
+	 */
+	size_t used;
+	
+	/*
+	 * The counters of this arena.
+	 */
+	NELSC_ARENA_COUNTERS counters;
+};
+
+/*
+ * The counters of the whole process, updated along with the counters
+ * of each arena.  Only accessed with atomic operations.
+ */
+static NELSC_ARENA_COUNTERS m_totals;
+
+/*
+ * The key of the thread-local arenas, created once.
+ */
+static pthread_once_t m_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t m_key;
+
+/*
+ * Function prototypes
+ */
+static ARENA_BLOCK *newBlock(NELSC_ARENA *pArena, size_t cap);
+static void destroyLocal(void *pValue);
+static void createKey(void);
+
+/*
+ * Allocate a new block from the heap and count it.
+ * 
+ * The block is not linked into the arena.
+ * 
+ * Parameters:
+ * 
+ *   pArena - the arena the block is for
+ * 
+ *   cap - the number of usable bytes in the block
+ * 
+ * Return:
+ * 
+ *   the new block
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static ARENA_BLOCK *newBlock(NELSC_ARENA *pArena, size_t cap) {
+	
+	void *pMem = NULL;
+	ARENA_BLOCK *pBlock = NULL;
+	
+	if (cap > SIZE_MAX - ARENA_HEADER) {
+		abort();
+	}
+	if (posix_memalign(&pMem, NELSC_ARENA_ALIGN, ARENA_HEADER + cap)) {
+		abort();
+	}
+	
+	pBlock = (ARENA_BLOCK *) pMem;
+	pBlock->pNext = NULL;
+	pBlock->cap = cap;
+	
+	(pArena->counters.block_mallocs)++;
+	pArena->counters.block_bytes += (uint64_t) cap;
+	__atomic_fetch_add(&(m_totals.block_mallocs), 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&(m_totals.block_bytes), (uint64_t) cap,
+		__ATOMIC_RELAXED);
+	
+	return pBlock;
+}
+
+/*
+ * Release the thread-local arena of an exiting thread.
+ * 
+ * This is the destructor of the thread-local key.
+ * 
+ * Parameters:
+ * 
+ *   pValue - the arena
+ */
+static void destroyLocal(void *pValue) {
+	nelsc_arena_free((NELSC_ARENA *) pValue);
+}
+
+/*
+ * Create the key of the thread-local arenas.
+ * 
+ * Called once through pthread_once().
+ */
+static void createKey(void) {
+	if (pthread_key_create(&m_key, &destroyLocal)) {
+		abort();
+	}
+}
+
+/*
+ * nelsc_arena_new function.
+ */
+NELSC_ARENA *nelsc_arena_new(size_t block) {
+	
+	NELSC_ARENA *pArena = NULL;
+	
+	/* Check parameters */
+	if (block < NELSC_ARENA_ALIGN) {
+		abort();
+	}
+	
+	/* Allocate the arena */
+	pArena = (NELSC_ARENA *) malloc(sizeof(NELSC_ARENA));
+	if (pArena == NULL) {
+		abort();
+	}
+	memset(pArena, 0, sizeof(NELSC_ARENA));
+	
+	pArena->block = block;
+	pArena->pFirst = NULL;
+	pArena->pCur = NULL;
+	pArena->used = 0;
+	
+	return pArena;
+}
+
+/*
+ * nelsc_arena_free function.
+ */
+void nelsc_arena_free(NELSC_ARENA *pArena) {
+	
+	ARENA_BLOCK *pBlock = NULL;
+	ARENA_BLOCK *pNext = NULL;
+	
+	if (pArena != NULL) {
+		for(pBlock = pArena->pFirst; pBlock != NULL; pBlock = pNext) {
+			pNext = pBlock->pNext;
+			__atomic_fetch_add(&(m_totals.block_frees), 1,
+				__ATOMIC_RELAXED);
+			__atomic_fetch_sub(&(m_totals.block_bytes),
+				(uint64_t) pBlock->cap, __ATOMIC_RELAXED);
+			free(pBlock);
+		}
+		
+		free(pArena);
+	}
+}
+
+/*
+ * nelsc_arena_local function.
+ */
+NELSC_ARENA *nelsc_arena_local(void) {
+	
+	NELSC_ARENA *pArena = NULL;
+	
+	if (pthread_once(&m_key_once, &createKey)) {
+		abort();
+	}
+	
+	pArena = (NELSC_ARENA *) pthread_getspecific(m_key);
+	if (pArena == NULL) {
+		pArena = nelsc_arena_new(NELSC_ARENA_LOCAL_BLOCK);
+		if (pthread_setspecific(m_key, pArena)) {
+			abort();
+		}
+	}
+	
+	return pArena;
+}
+
+/*
+ * nelsc_arena_alloc function.
+ */
+void *nelsc_arena_alloc(NELSC_ARENA *pArena, size_t len) {
+	
+	ARENA_BLOCK *pNext = NULL;
+	ARENA_BLOCK *pBlock = NULL;
+	size_t cap = 0;
+	
+	/* Check parameters */
+	if (pArena == NULL) {
+		abort();
+	}
+	
+	/* Round the length up to the alignment */
+	if (len < 1) {
+		len = 1;
+	}
+	if (len > SIZE_MAX - NELSC_ARENA_ALIGN) {
+		abort();
+	}
+	len = (len + NELSC_ARENA_ALIGN - 1) &
+			~((size_t) (NELSC_ARENA_ALIGN - 1));
+	
+	/* If the current block is missing or too full, move on to the next
+	 * free block, or insert a new block if the next one is too small */
+	if ((pArena->pCur == NULL) ||
+			(pArena->pCur->cap - pArena->used < len)) {
+		if (pArena->pCur != NULL) {
+			pNext = pArena->pCur->pNext;
+		} else {
+			pNext = pArena->pFirst;
+		}
+		
+		if ((pNext != NULL) && (pNext->cap >= len)) {
+			pBlock = pNext;
+		
+		} else {
+			cap = pArena->block;
+			if (cap < len) {
+				cap = len;
+			}
+			pBlock = newBlock(pArena, cap);
+			pBlock->pNext = pNext;
+			if (pArena->pCur != NULL) {
+				pArena->pCur->pNext = pBlock;
+			} else {
+				pArena->pFirst = pBlock;
+			}
+		}
+		
+		pArena->pCur = pBlock;
+		pArena->used = 0;
+	}
+	
+	/* Bump the pointer */
+	pBlock = pArena->pCur;
+	pArena->used += len;
+	(pArena->counters.allocs)++;
+	__atomic_fetch_add(&(m_totals.allocs), 1, __ATOMIC_RELAXED);
+	
+	return ((char *) pBlock) + ARENA_HEADER + (pArena->used - len);
+}
+
+/*
+ * nelsc_arena_reset function.
+ */
+void nelsc_arena_reset(NELSC_ARENA *pArena) {
+	
+	/* Check parameters */
+	if (pArena == NULL) {
+		abort();
+	}
+	
+	/* Rewind to before the first block */
+	pArena->pCur = NULL;
+	pArena->used = 0;
+	
+	(pArena->counters.resets)++;
+	__atomic_fetch_add(&(m_totals.resets), 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * nelsc_arena_counters function.
+ */
+void nelsc_arena_counters(
+		const NELSC_ARENA *pArena,
+		NELSC_ARENA_COUNTERS *pCounters) {
+	
+	/* Check parameters */
+	if ((pArena == NULL) || (pCounters == NULL)) {
+		abort();
+	}
+	
+	memcpy(pCounters, &(pArena->counters),
+		sizeof(NELSC_ARENA_COUNTERS));
+}
+
+/*
+ * nelsc_arena_totals function.
+ */
+void nelsc_arena_totals(NELSC_ARENA_COUNTERS *pCounters) {
+	
+	/* Check parameters */
+	if (pCounters == NULL) {
+		abort();
+	}
+	
+	pCounters->allocs = __atomic_load_n(
+				&(m_totals.allocs), __ATOMIC_RELAXED);
+	pCounters->resets = __atomic_load_n(
+				&(m_totals.resets), __ATOMIC_RELAXED);
+	pCounters->block_mallocs = __atomic_load_n(
+				&(m_totals.block_mallocs), __ATOMIC_RELAXED);
+	pCounters->block_frees = __atomic_load_n(
+				&(m_totals.block_frees), __ATOMIC_RELAXED);
+	pCounters->block_bytes = __atomic_load_n(
+				&(m_totals.block_bytes), __ATOMIC_RELAXED);
+}
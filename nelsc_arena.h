@@ -0,0 +1,206 @@
+#ifndef NELSC_ARENA_H_INCLUDED
+#define NELSC_ARENA_H_INCLUDED
+
+/*
+ * nelsc_arena.h
+ * 
+ * Provides arena allocators for the short-lived scratch space used
+ * while processing a batch of records or a single request.
+ * 
+ * An arena hands out memory by bumping a pointer through large blocks
+ * that it allocates from the heap.  Individual allocations are never
+ * released.  Instead, the whole arena is reset once the batch or
+ * request is done, which makes all of its memory available again while
+ * keeping the blocks for reuse.  Once an arena has grown to the size a
+ * workload needs, it therefore makes no further heap allocations.
+ * 
+ * Each thread can have its own arena, which is created on first use by
+ * nelsc_arena_local() and released when the thread exits.
+ * 
+ * Counters are kept both for each arena and for the whole process, so
+ * that it can be checked that steady-state processing does not touch
+ * the heap.
+ * 
+ * Thread-local arenas use POSIX threads.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The alignment in bytes of every allocation from an arena.
+ */
+#define NELSC_ARENA_ALIGN 16
+
+/*
+ * The block size used by the thread-local arenas.
+ */
+#define NELSC_ARENA_LOCAL_BLOCK 262144
+
+/*
+ * Allocation counters of an arena or of the whole process.
+ */
+typedef struct {
+	
+	/*
+	 * The number of allocations made from arenas.
+	 */
+	uint64_t allocs;
+	
+	/*
+	 * The number of times arenas were reset.
+	 */
+	uint64_t resets;
+	
+	/*
+	 * The number of blocks allocated from and released to the heap.
+	 */
+	uint64_t block_mallocs;
+	uint64_t block_frees;
+	
+	/*
+	 * The total number of bytes in the blocks currently held.
+	 */
+	uint64_t block_bytes;
+
+} NELSC_ARENA_COUNTERS;
+
+/*
+ * NELSC_ARENA structure prototype.
+ * 
+ * See the implementation file for definition.
+ */
+struct NELSC_ARENA_TAG;
+typedef struct NELSC_ARENA_TAG NELSC_ARENA;
+
+/*
+ * Create a new arena.
+ * 
+ * No blocks are allocated until the first allocation.  Allocations
+ * larger than the block size get a block of their own.  The arena must
+ * eventually be released with nelsc_arena_free().
+ * 
+ * Parameters:
+ * 
+ *   block - the size in bytes of each block
+ * 
+ * Return:
+ * 
+ *   the new arena
+ * 
+ * Faults:
+ * 
+ *   - If block is less than NELSC_ARENA_ALIGN
+ * 
+ *   - If memory allocation fails
+ */
+NELSC_ARENA *nelsc_arena_new(size_t block);
+
+/*
+ * Release an arena and all memory allocated from it.
+ * 
+ * Does nothing if pArena is NULL.
+ * 
+ * Parameters:
+ * 
+ *   pArena - the arena to release, or NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If pArena is the thread-local arena of a thread
+ */
+void nelsc_arena_free(NELSC_ARENA *pArena);
+
+/*
+ * Get the arena of the calling thread, creating it if necessary.
+ * 
+ * The arena uses NELSC_ARENA_LOCAL_BLOCK byte blocks and is released
+ * automatically when the thread exits.  The arena of the main thread is
+ * only released when the process exits.
+ * 
+ * Return:
+ * 
+ *   the arena of the calling thread
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+NELSC_ARENA *nelsc_arena_local(void);
+
+/*
+ * Allocate memory from an arena.
+ * 
+ * The memory is aligned to NELSC_ARENA_ALIGN and is not cleared.  It
+ * remains valid until the arena is reset or released.  A len of zero
+ * is treated as one.
+ * 
+ * Parameters:
+ * 
+ *   pArena - the arena
+ * 
+ *   len - the number of bytes to allocate
+ * 
+ * Return:
+ * 
+ *   pointer to the allocated memory
+ * 
+ * Faults:
+ * 
+ *   - If pArena is NULL
+ * 
+ *   - If memory allocation fails
+ */
+void *nelsc_arena_alloc(NELSC_ARENA *pArena, size_t len);
+
+/*
+ * Reset an arena, making all memory allocated from it available again.
+ * 
+ * All pointers previously returned by nelsc_arena_alloc() for this
+ * arena become invalid.  The blocks are kept for reuse.
+ * 
+ * Parameters:
+ * 
+ *   pArena - the arena
+ * 
+ * Faults:
+ * 
+ *   - If pArena is NULL
+ */
+void nelsc_arena_reset(NELSC_ARENA *pArena);
+
+/*
+ * Get the counters of a single arena.
+ * 
+ * Parameters:
+ * 
+ *   pArena - the arena
+ * 
+ *   pCounters - the structure to receive the counters
+ * 
+ * Faults:
+ * 
+ *   - If pArena or pCounters is NULL
+ */
+void nelsc_arena_counters(
+		const NELSC_ARENA *pArena,
+		NELSC_ARENA_COUNTERS *pCounters);
+
+/*
+ * Get the counters of all arenas in the process.
+ * 
+ * The counters are updated as each arena allocates, resets, and
+ * releases memory, so they include arenas that are still in use, such
+ * as the arena of the main thread.
+ * 
+ * Parameters:
+ * 
+ *   pCounters - the structure to receive the counters
+ * 
+ * Faults:
+ * 
+ *   - If pCounters is NULL
+ */
+void nelsc_arena_totals(NELSC_ARENA_COUNTERS *pCounters);
+
+#endif
@@ -9,6 +9,8 @@
 #include "nelsc_cycle.h"
 #include <stdlib.h>
 
+#include "nelsc_stats.h"
+
 /*
  * Number of days in a short month of four weeks.
  */
@@ -191,6 +193,7 @@ int32_t nelsc_cycle_dayToMonth(int32_t d, int32_t *pOffset) {
 	int32_t month_count = 0;
 	const char *pc = NULL;
 	bool mlong = false;
+	NELSC_STATS_BEGIN(stats_start);
 	
 	/* Check parameter */
 	if ((d < NELSC_CYCLE_DAYMIN) || (d > NELSC_CYCLE_DAYMAX)) {
@@ -254,6 +257,8 @@ int32_t nelsc_cycle_dayToMonth(int32_t d, int32_t *pOffset) {
 		*pOffset = d;
 	}
 	
+	NELSC_STATS_END(NELSC_PROBE_CYCLE_DAYTOMONTH, stats_start, true);
+	
 	/* Return the absolute month offset */
 	return month_count;
 }
@@ -267,6 +272,7 @@ int32_t nelsc_cycle_monthToDay(int32_t m) {
 	int32_t day_count = 0;
 	int32_t i = 0;
 	bool mlong = false;
+	NELSC_STATS_BEGIN(stats_start);
 	
 	/* Check parameter */
 	if ((m < NELSC_CYCLE_MONMIN) || (m > NELSC_CYCLE_MONMAX)) {
@@ -312,6 +318,8 @@ int32_t nelsc_cycle_monthToDay(int32_t m) {
 	/* Apply the absolute day offset */
 	day_count -= ABSOLUTE_DAY_OFFSET;
 	
+	NELSC_STATS_END(NELSC_PROBE_CYCLE_MONTHTODAY, stats_start, true);
+	
 	/* Return the absolute day offset */
 	return day_count;
 }
@@ -325,6 +333,7 @@ int32_t nelsc_cycle_monthToYear(int32_t m, int32_t *pOffset) {
 	int32_t year_count = 0;
 	const char *pc = NULL;
 	bool mlong = false;
+	NELSC_STATS_BEGIN(stats_start);
 	
 	/* Check parameter */
 	if ((m < NELSC_CYCLE_MONMIN) || (m > NELSC_CYCLE_MONMAX)) {
@@ -400,6 +409,8 @@ int32_t nelsc_cycle_monthToYear(int32_t m, int32_t *pOffset) {
 		*pOffset = m;
 	}
 	
+	NELSC_STATS_END(NELSC_PROBE_CYCLE_MONTHTOYEAR, stats_start, true);
+	
 	/* Return the year */
 	return year_count;
 }
@@ -412,6 +423,7 @@ int32_t nelsc_cycle_yearToMonth(int32_t y) {
 	int32_t month_count = 0;
 	int32_t i = 0;
 	bool mlong = false;
+	NELSC_STATS_BEGIN(stats_start);
 	
 	/* Check parameter */
 	if ((y < NELSC_CYCLE_YEARMIN) || (y > NELSC_CYCLE_YEARMAX)) {
@@ -452,6 +464,8 @@ int32_t nelsc_cycle_yearToMonth(int32_t y) {
 	/* Apply the absolute month offset */
 	month_count -= ABSOLUTE_MONTH_OFFSET;
 	
+	NELSC_STATS_END(NELSC_PROBE_CYCLE_YEARTOMONTH, stats_start, true);
+	
 	/* Return the month */
 	return month_count;
 }
@@ -464,6 +478,7 @@ bool nelsc_cycle_isLongMonth(int32_t m) {
 	int32_t day_begin = 0;
 	int32_t day_next = 0;
 	bool longmonth = false;
+	NELSC_STATS_BEGIN(stats_start);
 	
 	/* Check parameter */
 	if ((m < NELSC_CYCLE_MONMIN) || (m > NELSC_CYCLE_MONMAX)) {
@@ -491,6 +506,8 @@ bool nelsc_cycle_isLongMonth(int32_t m) {
 		longmonth = false;
 	}
 	
+	NELSC_STATS_END(NELSC_PROBE_CYCLE_ISLONGMONTH, stats_start, true);
+	
 	/* Return result */
 	return longmonth;
 }
@@ -503,6 +520,7 @@ bool nelsc_cycle_isLongYear(int32_t y) {
 	int32_t month_begin = 0;
 	int32_t month_next = 0;
 	bool longyear = false;
+	NELSC_STATS_BEGIN(stats_start);
 	
 	/* Check parameter */
 	if ((y < NELSC_CYCLE_YEARMIN) || (y > NELSC_CYCLE_YEARMAX)) {
@@ -530,6 +548,8 @@ bool nelsc_cycle_isLongYear(int32_t y) {
 		longyear = false;
 	}
 	
+	NELSC_STATS_END(NELSC_PROBE_CYCLE_ISLONGYEAR, stats_start, true);
+	
 	/* Return result */
 	return longyear;
 }
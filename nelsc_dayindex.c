@@ -0,0 +1,320 @@
+/*
+ * nelsc_dayindex.c
+ * 
+ * Implementation of nelsc_dayindex.h
+ * 
+ * See the header for further information.
+ */
+
+#include "nelsc_dayindex.h"
+#include <stdlib.h>
+#include <string.h>
+
+#include "nelsc_cycle.h"
+
+/*
+ * The initial capacities of the text buffer and the line array.
+ */
+#define TEXT_INIT_CAP 4096
+#define LINE_INIT_CAP 256
+
+/*
+ * A line that has been added to the index.
+ */
+typedef struct {
+	
+	/*
+	 * The day offset of the line.
+	 */
+	int32_t day;
+	
+	/*
+	 * The offset of the line in the text buffer, and its length.
+	 */
+	size_t off;
+	size_t len;
+
+} DAYINDEX_LINE;
+
+/*
+ * NELSC_DAYINDEX structure, prototyped in header.
+ */
+struct NELSC_DAYINDEX_TAG {
+	
+	/*
+	 * The text of all the lines, back to back, its length, and its
+	 * capacity.
+	 */
+	char *pText;
+	size_t text_len;
+	size_t text_cap;
+	
+	/*
+	 * The lines in the order they were added, their number, and the
+	 * capacity of the array.
+	 */
+	DAYINDEX_LINE *pLines;
+	int32_t line_count;
+	int32_t line_cap;
+	
+	/*
+	 * The earliest and latest days of the lines.
+	 */
+	int32_t day_min;
+	int32_t day_max;
+	
+	/*
+	 * Once built, the number of the first line of each day from day_min
+	 * up to day_max, followed by the number of lines, and the index in
+	 * pLines of each numbered line.  NULL until the index is built.
+	 */
+	int32_t *pStart;
+	int32_t *pOrder;
+};
+
+/*
+ * nelsc_dayindex_new function.
+ */
+NELSC_DAYINDEX *nelsc_dayindex_new(void) {
+	
+	NELSC_DAYINDEX *pIndex = NULL;
+	
+	pIndex = (NELSC_DAYINDEX *) calloc(1, sizeof(NELSC_DAYINDEX));
+	if (pIndex == NULL) {
+		abort();
+	}
+	
+	pIndex->text_cap = TEXT_INIT_CAP;
+	pIndex->pText = (char *) malloc(pIndex->text_cap);
+	
+	pIndex->line_cap = LINE_INIT_CAP;
+	pIndex->pLines = (DAYINDEX_LINE *) malloc(
+				((size_t) pIndex->line_cap) * sizeof(DAYINDEX_LINE));
+	
+	if ((pIndex->pText == NULL) || (pIndex->pLines == NULL)) {
+		abort();
+	}
+	
+	pIndex->day_min = NELSC_CYCLE_DAYMAX;
+	pIndex->day_max = NELSC_CYCLE_DAYMIN;
+	
+	return pIndex;
+}
+
+/*
+ * nelsc_dayindex_free function.
+ */
+void nelsc_dayindex_free(NELSC_DAYINDEX *pIndex) {
+	
+	if (pIndex != NULL) {
+		free(pIndex->pText);
+		free(pIndex->pLines);
+		free(pIndex->pStart);
+		free(pIndex->pOrder);
+		free(pIndex);
+	}
+}
+
+/*
+ * nelsc_dayindex_add function.
+ */
+void nelsc_dayindex_add(
+		NELSC_DAYINDEX *pIndex,
+		int32_t day,
+		const char *pLine,
+		size_t len) {
+	
+	DAYINDEX_LINE *pRec = NULL;
+	
+	/* Check parameters */
+	if (pIndex == NULL) {
+		abort();
+	}
+	if ((len > 0) && (pLine == NULL)) {
+		abort();
+	}
+	if ((day < NELSC_CYCLE_DAYMIN) || (day > NELSC_CYCLE_DAYMAX)) {
+		abort();
+	}
+	if ((pIndex->pStart != NULL) || (pIndex->line_count >= INT32_MAX)) {
+		abort();
+	}
+	
+	/* Grow the text buffer and the line array as needed */
+	if (len > pIndex->text_cap - pIndex->text_len) {
+		while (len > pIndex->text_cap - pIndex->text_len) {
+			if (pIndex->text_cap > SIZE_MAX / 2) {
+				abort();
+			}
+			pIndex->text_cap *= 2;
+		}
+		pIndex->pText = (char *) realloc(
+							pIndex->pText, pIndex->text_cap);
+		if (pIndex->pText == NULL) {
+			abort();
+		}
+	}
+	
+	if (pIndex->line_count >= pIndex->line_cap) {
+		if (pIndex->line_cap > INT32_MAX / 2) {
+			pIndex->line_cap = INT32_MAX;
+		} else {
+			pIndex->line_cap *= 2;
+		}
+		pIndex->pLines = (DAYINDEX_LINE *) realloc(pIndex->pLines,
+				((size_t) pIndex->line_cap) * sizeof(DAYINDEX_LINE));
+		if (pIndex->pLines == NULL) {
+			abort();
+		}
+	}
+	
+	/* Add the line */
+	if (len > 0) {
+		memcpy(pIndex->pText + pIndex->text_len, pLine, len);
+	}
+	
+	pRec = &(pIndex->pLines[pIndex->line_count]);
+	pRec->day = day;
+	pRec->off = pIndex->text_len;
+	pRec->len = len;
+	
+	pIndex->text_len += len;
+	(pIndex->line_count)++;
+	
+	if (day < pIndex->day_min) {
+		pIndex->day_min = day;
+	}
+	if (day > pIndex->day_max) {
+		pIndex->day_max = day;
+	}
+}
+
+/*
+ * nelsc_dayindex_build function.
+ */
+void nelsc_dayindex_build(NELSC_DAYINDEX *pIndex) {
+	
+	int32_t span = 0;
+	int32_t i = 0;
+	int32_t d = 0;
+	int32_t total = 0;
+	int32_t count = 0;
+	
+	/* Check parameters */
+	if (pIndex == NULL) {
+		abort();
+	}
+	if (pIndex->pStart != NULL) {
+		abort();
+	}
+	
+	/* An empty index gets a table covering a single day */
+	if (pIndex->line_count < 1) {
+		pIndex->day_min = 0;
+		pIndex->day_max = 0;
+	}
+	span = pIndex->day_max - pIndex->day_min + 1;
+	
+	pIndex->pStart = (int32_t *) calloc(
+						((size_t) span) + 1, sizeof(int32_t));
+	pIndex->pOrder = (int32_t *) malloc(
+			((size_t) pIndex->line_count + 1) * sizeof(int32_t));
+	if ((pIndex->pStart == NULL) || (pIndex->pOrder == NULL)) {
+		abort();
+	}
+	
+	/* Count the lines of each day */
+	for(i = 0; i < pIndex->line_count; i++) {
+		(pIndex->pStart[pIndex->pLines[i].day - pIndex->day_min])++;
+	}
+	
+	/* Turn the counts into the start of each day */
+	for(d = 0; d <= span; d++) {
+		count = pIndex->pStart[d];
+		pIndex->pStart[d] = total;
+		total += count;
+	}
+	
+	/* Place each line after the earlier lines of its day, advancing the
+	 * start of the day as a fill position */
+	for(i = 0; i < pIndex->line_count; i++) {
+		d = pIndex->pLines[i].day - pIndex->day_min;
+		pIndex->pOrder[pIndex->pStart[d]] = i;
+		(pIndex->pStart[d])++;
+	}
+	
+	/* Each fill position has advanced to the start of the day after it,
+	 * so shifting the table by one day restores the starts */
+	memmove(pIndex->pStart + 1, pIndex->pStart,
+		((size_t) span) * sizeof(int32_t));
+	pIndex->pStart[0] = 0;
+}
+
+/*
+ * nelsc_dayindex_find function.
+ */
+int32_t nelsc_dayindex_find(
+		const NELSC_DAYINDEX *pIndex,
+		int32_t day,
+		int32_t *pFirst) {
+	
+	int32_t result = 0;
+	int32_t d = 0;
+	
+	/* Check parameters */
+	if ((pIndex == NULL) || (pFirst == NULL)) {
+		abort();
+	}
+	if (pIndex->pStart == NULL) {
+		abort();
+	}
+	
+	*pFirst = 0;
+	if ((day >= pIndex->day_min) && (day <= pIndex->day_max)) {
+		d = day - pIndex->day_min;
+		*pFirst = pIndex->pStart[d];
+		result = pIndex->pStart[d + 1] - pIndex->pStart[d];
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_dayindex_line function.
+ */
+const char *nelsc_dayindex_line(
+		const NELSC_DAYINDEX *pIndex,
+		int32_t i,
+		size_t *pLen) {
+	
+	const DAYINDEX_LINE *pRec = NULL;
+	
+	/* Check parameters */
+	if ((pIndex == NULL) || (pLen == NULL)) {
+		abort();
+	}
+	if (pIndex->pStart == NULL) {
+		abort();
+	}
+	if ((i < 0) || (i >= pIndex->line_count)) {
+		abort();
+	}
+	
+	pRec = &(pIndex->pLines[pIndex->pOrder[i]]);
+	*pLen = pRec->len;
+	
+	return pIndex->pText + pRec->off;
+}
+
+/*
+ * nelsc_dayindex_count function.
+ */
+int32_t nelsc_dayindex_count(const NELSC_DAYINDEX *pIndex) {
+	
+	/* Check parameters */
+	if (pIndex == NULL) {
+		abort();
+	}
+	
+	return pIndex->line_count;
+}
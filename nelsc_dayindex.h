@@ -0,0 +1,194 @@
+#ifndef NELSC_DAYINDEX_H_INCLUDED
+#define NELSC_DAYINDEX_H_INCLUDED
+
+/*
+ * nelsc_dayindex.h
+ * 
+ * In-memory index of text lines by NELSC day offset.
+ * 
+ * Lines are added in any order along with their day offsets, and the
+ * index is then built once.  Building counts the lines on each day of
+ * the span between the earliest and latest days that were added, and
+ * turns the counts into a dense table of where each day's lines start,
+ * so finding the lines of a day is a single table lookup with no
+ * hashing or searching.  Lines of the same day keep the order in which
+ * they were added.
+ * 
+ * Since day offsets are limited to the NELSC range, the table never has
+ * more than a few hundred thousand entries, whatever the lines.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * NELSC_DAYINDEX structure prototype.
+ * 
+ * See the implementation file for definition.
+ */
+struct NELSC_DAYINDEX_TAG;
+typedef struct NELSC_DAYINDEX_TAG NELSC_DAYINDEX;
+
+/*
+ * Create a new, empty index.
+ * 
+ * The index must eventually be released with nelsc_dayindex_free().
+ * 
+ * Return:
+ * 
+ *   the new index
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+NELSC_DAYINDEX *nelsc_dayindex_new(void);
+
+/*
+ * Release an index.
+ * 
+ * Does nothing if pIndex is NULL.
+ * 
+ * Parameters:
+ * 
+ *   pIndex - the index to release, or NULL
+ */
+void nelsc_dayindex_free(NELSC_DAYINDEX *pIndex);
+
+/*
+ * Add a line to an index.
+ * 
+ * The text of the line is copied into the index.
+ * 
+ * Parameters:
+ * 
+ *   pIndex - the index
+ * 
+ *   day - the NELSC day offset of the line
+ * 
+ *   pLine - the text of the line
+ * 
+ *   len - the number of characters in the line
+ * 
+ * Faults:
+ * 
+ *   - If pIndex is NULL
+ * 
+ *   - If len is greater than zero and pLine is NULL
+ * 
+ *   - If day is outside the range NELSC_CYCLE_DAYMIN to
+ *     NELSC_CYCLE_DAYMAX
+ * 
+ *   - If the index has already been built
+ * 
+ *   - If the index already has INT32_MAX lines
+ * 
+ *   - If memory allocation fails
+ */
+void nelsc_dayindex_add(
+		NELSC_DAYINDEX *pIndex,
+		int32_t day,
+		const char *pLine,
+		size_t len);
+
+/*
+ * Build the day table of an index.
+ * 
+ * No more lines may be added afterwards.
+ * 
+ * Parameters:
+ * 
+ *   pIndex - the index
+ * 
+ * Faults:
+ * 
+ *   - If pIndex is NULL
+ * 
+ *   - If the index has already been built
+ * 
+ *   - If memory allocation fails
+ */
+void nelsc_dayindex_build(NELSC_DAYINDEX *pIndex);
+
+/*
+ * Find the lines of a day in a built index.
+ * 
+ * The lines are numbered consecutively in the built index, so the lines
+ * of the day are the count lines starting at *pFirst, which can be read
+ * with nelsc_dayindex_line().
+ * 
+ * Parameters:
+ * 
+ *   pIndex - the index
+ * 
+ *   day - the day offset to look up, which may be any value
+ * 
+ *   pFirst - receives the number of the first line of the day, or zero
+ *   if there are none
+ * 
+ * Return:
+ * 
+ *   the number of lines on the day
+ * 
+ * Faults:
+ * 
+ *   - If pIndex or pFirst is NULL
+ * 
+ *   - If the index has not been built
+ */
+int32_t nelsc_dayindex_find(
+		const NELSC_DAYINDEX *pIndex,
+		int32_t day,
+		int32_t *pFirst);
+
+/*
+ * Get a line of a built index.
+ * 
+ * The returned text is not null-terminated, and remains valid until the
+ * index is released.
+ * 
+ * Parameters:
+ * 
+ *   pIndex - the index
+ * 
+ *   i - the number of the line, from zero up to one less than the
+ *   number of lines
+ * 
+ *   pLen - receives the number of characters in the line
+ * 
+ * Return:
+ * 
+ *   the text of the line
+ * 
+ * Faults:
+ * 
+ *   - If pIndex or pLen is NULL
+ * 
+ *   - If the index has not been built
+ * 
+ *   - If i is out of range
+ */
+const char *nelsc_dayindex_line(
+		const NELSC_DAYINDEX *pIndex,
+		int32_t i,
+		size_t *pLen);
+
+/*
+ * Get the number of lines in an index.
+ * 
+ * Parameters:
+ * 
+ *   pIndex - the index
+ * 
+ * Return:
+ * 
+ *   the number of lines added so far
+ * 
+ * Faults:
+ * 
+ *   - If pIndex is NULL
+ */
+int32_t nelsc_dayindex_count(const NELSC_DAYINDEX *pIndex);
+
+#endif
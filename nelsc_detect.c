@@ -0,0 +1,201 @@
+/*
+ * nelsc_detect.c
+ * 
+ * Implementation of nelsc_detect.h
+ * 
+ * See the header for further information.
+ */
+
+#include "nelsc_detect.h"
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(__GNUC__)
+#error nelsc_detect requires the GCC atomic builtins
+#endif
+
+/*
+ * The lengths of the date formats.  Gregorian dates in YYYY-MM-DD
+ * format may be shortened by single-digit fields down to SHORT_LENGTH.
+ */
+#define NELSC_LENGTH 7
+#define SHORT_LENGTH 8
+#define FULL_LENGTH 10
+
+/*
+ * The name of each format, indexed by NELSC_DETECT constant.
+ */
+static const char *m_names[NELSC_DETECT_COUNT] = {
+	"nelsc", "gregorian", "compact", "slash", "dotted", "week",
+	"ordinal", "daycount"
+};
+
+/*
+ * The process totals of parsed dates of each format.  Accessed with
+ * atomic operations.
+ */
+static uint64_t m_totals[NELSC_DETECT_COUNT];
+
+/*
+ * Function prototypes
+ * ===================
+ */
+
+static bool allDigits(const char *str, size_t len);
+
+/*
+ * Check whether a span of text is made only of decimal digits.
+ * 
+ * Parameters:
+ * 
+ *   str - the text
+ * 
+ *   len - the number of characters in the text
+ * 
+ * Return:
+ * 
+ *   true if every character is a decimal digit, false otherwise
+ */
+static bool allDigits(const char *str, size_t len) {
+	
+	size_t i = 0;
+	bool result = true;
+	
+	for(i = 0; i < len; i++) {
+		if ((str[i] < '0') || (str[i] > '9')) {
+			result = false;
+			break;
+		}
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_detect_classify function.
+ */
+int nelsc_detect_classify(const char *str, size_t len) {
+	
+	int result = NELSC_DETECT_UNKNOWN;
+	char c2 = 0;
+	char c4 = 0;
+	char c5 = 0;
+	char c7 = 0;
+	
+	/* Check parameters */
+	if (str == NULL) {
+		abort();
+	}
+	
+	/* Get the characters at the separator positions, using zero for
+	 * positions past the end */
+	if (len > 2) {
+		c2 = str[2];
+	}
+	if (len > 4) {
+		c4 = str[4];
+	}
+	if (len > 5) {
+		c5 = str[5];
+	}
+	if (len > 7) {
+		c7 = str[7];
+	}
+	
+	/* NELSC dates are checked first, since base-24 years may start
+	 * with the same letters as the names of day counts; the other
+	 * formats are told apart by length and separators */
+	if (len < 1) {
+		result = NELSC_DETECT_UNKNOWN;
+	
+	} else if ((len == NELSC_LENGTH) && (c2 == ':')) {
+		result = NELSC_DETECT_NELSC;
+	
+	} else if ((str[0] == 'J') || (str[0] == 'M') || (str[0] == 'R')) {
+		result = NELSC_DETECT_DAYCOUNT;
+	
+	} else if ((len >= SHORT_LENGTH) && (len <= FULL_LENGTH) &&
+				(c4 == '-')) {
+		/* A week date has the week designator, and a Gregorian date
+		 * has a second dash that an ordinal date lacks */
+		if (c5 == 'W') {
+			result = NELSC_DETECT_WEEK;
+		} else if (memchr(str + 5, '-', len - 5) != NULL) {
+			result = NELSC_DETECT_GREGORIAN;
+		} else {
+			result = NELSC_DETECT_ORDINAL;
+		}
+	
+	} else if ((len == FULL_LENGTH) && (c4 == '/') && (c7 == '/')) {
+		result = NELSC_DETECT_SLASH;
+	
+	} else if ((len == FULL_LENGTH) && (c2 == '.') && (c5 == '.')) {
+		result = NELSC_DETECT_DOTTED;
+	
+	} else if ((len == SHORT_LENGTH) && allDigits(str, len)) {
+		result = NELSC_DETECT_COMPACT;
+	
+	} else if ((len >= SHORT_LENGTH) && (len <= FULL_LENGTH)) {
+		/* Dates with misplaced separators, such as single-digit
+		 * fields, go to the parser of their separator so that it can
+		 * report where they are wrong */
+		if (memchr(str, '.', len) != NULL) {
+			result = NELSC_DETECT_DOTTED;
+		} else if (memchr(str, '/', len) != NULL) {
+			result = NELSC_DETECT_SLASH;
+		}
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_detect_name function.
+ */
+const char *nelsc_detect_name(int fmt) {
+	
+	/* Check parameters */
+	if ((fmt < 0) || (fmt >= NELSC_DETECT_COUNT)) {
+		abort();
+	}
+	
+	return m_names[fmt];
+}
+
+/*
+ * nelsc_detect_add function.
+ */
+void nelsc_detect_add(const uint64_t *pCounts) {
+	
+	int i = 0;
+	
+	/* Check parameters */
+	if (pCounts == NULL) {
+		abort();
+	}
+	
+	for(i = 0; i < NELSC_DETECT_COUNT; i++) {
+		if (pCounts[i] > 0) {
+			__atomic_fetch_add(&(m_totals[i]), pCounts[i],
+				__ATOMIC_RELAXED);
+		}
+	}
+}
+
+/*
+ * nelsc_detect_totals function.
+ */
+void nelsc_detect_totals(uint64_t *pCounts) {
+	
+	int i = 0;
+	
+	/* Check parameters */
+	if (pCounts == NULL) {
+		abort();
+	}
+	
+	for(i = 0; i < NELSC_DETECT_COUNT; i++) {
+		pCounts[i] = __atomic_load_n(&(m_totals[i]), __ATOMIC_RELAXED);
+	}
+}
@@ -0,0 +1,133 @@
+#ifndef NELSC_DETECT_H_INCLUDED
+#define NELSC_DETECT_H_INCLUDED
+
+/*
+ * nelsc_detect.h
+ * 
+ * Classifies calendar date text by its format, so that a date of
+ * unknown format can be handed straight to the one parser that can
+ * read it rather than being tried against each parser in turn.
+ * 
+ * Classification only looks at the length of the date, the characters
+ * at the separator positions, whether the first character is a letter,
+ * and, since a compact date has no separators, whether an eight
+ * character date is all digits.  Other eight to ten character dates
+ * with a dot or a slash are given to the dotted or slash parser to
+ * report the error.  The ranges of the fields are left to the parser.
+ * A date that is classified as a format may still fail to parse, but a
+ * date that any of the parsers could read is never classified as a
+ * different format.
+ * 
+ * The module also keeps process totals of how many dates of each
+ * format have been parsed, which nelsc_stats_print() reports.  The
+ * totals are updated with the GCC atomic builtins.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The date formats:
+ * 
+ *   NELSC     - NELSC date, such as 3T:C4-7
+ *   GREGORIAN - YYYY-MM-DD, where MM and DD may be a single digit
+ *   COMPACT   - YYYYMMDD
+ *   SLASH     - YYYY/MM/DD
+ *   DOTTED    - DD.MM.YYYY
+ *   WEEK      - ISO 8601 week date, YYYY-Www-D
+ *   ORDINAL   - ISO 8601 ordinal date, YYYY-DDD
+ *   DAYCOUNT  - day count in the text form of jdn_scan(), such as
+ *               JD2451545
+ */
+#define NELSC_DETECT_NELSC     0
+#define NELSC_DETECT_GREGORIAN 1
+#define NELSC_DETECT_COMPACT   2
+#define NELSC_DETECT_SLASH     3
+#define NELSC_DETECT_DOTTED    4
+#define NELSC_DETECT_WEEK      5
+#define NELSC_DETECT_ORDINAL   6
+#define NELSC_DETECT_DAYCOUNT  7
+
+/*
+ * The number of date formats.
+ */
+#define NELSC_DETECT_COUNT 8
+
+/*
+ * The value returned when the text does not have the shape of any
+ * format.
+ */
+#define NELSC_DETECT_UNKNOWN (-1)
+
+/*
+ * Classify the date in a span of text.
+ * 
+ * The span must hold only the date, without any leading or trailing
+ * whitespace.  It does not have to be null-terminated.
+ * 
+ * Parameters:
+ * 
+ *   str - the text of the date
+ * 
+ *   len - the number of characters in the date
+ * 
+ * Return:
+ * 
+ *   one of the NELSC_DETECT format constants, or NELSC_DETECT_UNKNOWN
+ * 
+ * Faults:
+ * 
+ *   - If str is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If str has fewer than len characters
+ */
+int nelsc_detect_classify(const char *str, size_t len);
+
+/*
+ * Return the name of a date format.
+ * 
+ * Parameters:
+ * 
+ *   fmt - one of the NELSC_DETECT format constants
+ * 
+ * Return:
+ * 
+ *   the null-terminated name of the format
+ * 
+ * Faults:
+ * 
+ *   - If fmt is not a valid format
+ */
+const char *nelsc_detect_name(int fmt);
+
+/*
+ * Add to the process totals of parsed dates of each format.
+ * 
+ * Parameters:
+ * 
+ *   pCounts - the number of dates of each format, with
+ *   NELSC_DETECT_COUNT elements indexed by format
+ * 
+ * Faults:
+ * 
+ *   - If pCounts is NULL
+ */
+void nelsc_detect_add(const uint64_t *pCounts);
+
+/*
+ * Get the process totals of parsed dates of each format.
+ * 
+ * Parameters:
+ * 
+ *   pCounts - the array to receive the totals, with NELSC_DETECT_COUNT
+ *   elements indexed by format
+ * 
+ * Faults:
+ * 
+ *   - If pCounts is NULL
+ */
+void nelsc_detect_totals(uint64_t *pCounts);
+
+#endif
@@ -0,0 +1,910 @@
+/*
+ * nelsc_events.c
+ * 
+ * Implementation of nelsc_events.h
+ * 
+ * See the header for further information.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "nelsc_events.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "nelsc_cycle.h"
+
+/*
+ * The magic value at the start of each store image.
+ */
+#define EVENTS_MAGIC "NELSCEVT"
+#define EVENTS_MAGIC_LEN 8
+
+/*
+ * The value written in the byte order field of the header, which reads
+ * differently on a machine of the other byte order.
+ */
+#define EVENTS_ORDER 0x01020304
+
+/*
+ * The offset of the index within the image, which keeps it on its own
+ * cache line after the header.
+ */
+#define EVENTS_INDEX_OFFSET 64
+
+/*
+ * The alignment of each array within the image.
+ */
+#define EVENTS_ALIGN 8
+
+/*
+ * The number of days in the NELSC range, which is the number of
+ * entries in the index not counting the final entry.
+ */
+#define EVENTS_DAYS (NELSC_CYCLE_DAYMAX - NELSC_CYCLE_DAYMIN + 1)
+
+/*
+ * The suffix of the name of the temporary file written by
+ * nelsc_events_save(), which mkstemp() replaces with a unique name.
+ */
+#define EVENTS_TEMP_SUFFIX ".XXXXXX"
+
+/*
+ * The header at the start of each store image.
+ */
+typedef struct {
+	
+	/*
+	 * The magic value EVENTS_MAGIC, without terminating nul.
+	 */
+	char magic[EVENTS_MAGIC_LEN];
+	
+	/*
+	 * The format version, NELSC_EVENTS_VERSION.
+	 */
+	uint32_t version;
+	
+	/*
+	 * EVENTS_ORDER, in the byte order of the machine that wrote the
+	 * image.
+	 */
+	uint32_t order;
+	
+	/*
+	 * The day offset of the first entry of the index, and the number of
+	 * days that the index covers, which must match the NELSC range of
+	 * the reader.
+	 */
+	int32_t day_min;
+	uint32_t day_count;
+	
+	/*
+	 * The number of events, and the number of bytes of text.
+	 */
+	uint32_t event_count;
+	uint32_t text_size;
+	
+	/*
+	 * The size in bytes of the whole image.
+	 */
+	uint64_t size;
+
+} EVENTS_HEADER;
+
+/*
+ * The offsets in bytes of the arrays within an image, and its total
+ * size.
+ */
+typedef struct {
+	
+	/*
+	 * The index, with day_count + 1 uint32_t entries giving the number
+	 * of the first event of each day, and then the number of events.
+	 */
+	uint64_t index;
+	
+	/*
+	 * The day of each event, as event_count int32_t values.
+	 */
+	uint64_t days;
+	
+	/*
+	 * The offset of the text of each event, as event_count + 1 uint32_t
+	 * values, the last of which is the size of the text.
+	 */
+	uint64_t offs;
+	
+	/*
+	 * The text of all the events, back to back.
+	 */
+	uint64_t text;
+	
+	/*
+	 * The total size of the image.
+	 */
+	uint64_t size;
+
+} EVENTS_LAYOUT;
+
+/*
+ * NELSC_EVENTS structure, prototyped in header.
+ */
+struct NELSC_EVENTS_TAG {
+	
+	/*
+	 * The image, its size, and whether it is a mapping of a file rather
+	 * than allocated memory.
+	 */
+	void *pImage;
+	size_t size;
+	bool mapped;
+	
+	/*
+	 * The header and the arrays within the image.
+	 */
+	const EVENTS_HEADER *pHeader;
+	const uint32_t *pIndex;
+	const int32_t *pDays;
+	const uint32_t *pOffs;
+	const char *pText;
+};
+
+/*
+ * Function prototypes
+ * ===================
+ */
+
+static uint64_t alignUp(uint64_t n);
+static void computeLayout(
+		uint32_t event_count,
+		uint32_t text_size,
+		EVENTS_LAYOUT *pLayout);
+static NELSC_EVENTS *wrapImage(void *pImage, size_t size, bool mapped);
+static bool checkHeader(const void *pImage, size_t size);
+static int32_t indexRun(
+		const NELSC_EVENTS *pEvents,
+		int32_t a,
+		int32_t b,
+		int32_t *pFirst);
+static bool writeAll(int fd, const void *pData, size_t size);
+static bool syncDir(const char *pPath);
+
+/*
+ * Round a size up to a multiple of EVENTS_ALIGN.
+ * 
+ * Parameters:
+ * 
+ *   n - the size
+ * 
+ * Return:
+ * 
+ *   the rounded size
+ */
+static uint64_t alignUp(uint64_t n) {
+	return (n + (EVENTS_ALIGN - 1)) & ~((uint64_t) (EVENTS_ALIGN - 1));
+}
+
+/*
+ * Compute where each array goes within an image.
+ * 
+ * The sizes are computed in 64 bits, so they cannot overflow whatever
+ * the counts in a header.
+ * 
+ * Parameters:
+ * 
+ *   event_count - the number of events
+ * 
+ *   text_size - the number of bytes of text
+ * 
+ *   pLayout - receives the layout
+ */
+static void computeLayout(
+		uint32_t event_count,
+		uint32_t text_size,
+		EVENTS_LAYOUT *pLayout) {
+	
+	pLayout->index = EVENTS_INDEX_OFFSET;
+	pLayout->days = alignUp(pLayout->index +
+				(((uint64_t) EVENTS_DAYS) + 1) * sizeof(uint32_t));
+	pLayout->offs = alignUp(pLayout->days +
+				((uint64_t) event_count) * sizeof(int32_t));
+	pLayout->text = alignUp(pLayout->offs +
+				(((uint64_t) event_count) + 1) * sizeof(uint32_t));
+	pLayout->size = alignUp(pLayout->text + (uint64_t) text_size);
+}
+
+/*
+ * Wrap an image in a new store object, locating its arrays from its
+ * header.
+ * 
+ * Parameters:
+ * 
+ *   pImage - the image, which must have a valid header
+ * 
+ *   size - the size of the image in bytes
+ * 
+ *   mapped - true if the image is a mapping to release with munmap(),
+ *   false if it was allocated with malloc()
+ * 
+ * Return:
+ * 
+ *   the new store
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static NELSC_EVENTS *wrapImage(void *pImage, size_t size, bool mapped) {
+	
+	NELSC_EVENTS *pEvents = NULL;
+	const unsigned char *pBase = NULL;
+	EVENTS_LAYOUT layout;
+	
+	memset(&layout, 0, sizeof(EVENTS_LAYOUT));
+	
+	pEvents = (NELSC_EVENTS *) calloc(1, sizeof(NELSC_EVENTS));
+	if (pEvents == NULL) {
+		abort();
+	}
+	
+	pBase = (const unsigned char *) pImage;
+	pEvents->pImage = pImage;
+	pEvents->size = size;
+	pEvents->mapped = mapped;
+	pEvents->pHeader = (const EVENTS_HEADER *) pImage;
+	
+	computeLayout(pEvents->pHeader->event_count,
+		pEvents->pHeader->text_size, &layout);
+	
+	pEvents->pIndex = (const uint32_t *) (pBase + layout.index);
+	pEvents->pDays = (const int32_t *) (pBase + layout.days);
+	pEvents->pOffs = (const uint32_t *) (pBase + layout.offs);
+	pEvents->pText = (const char *) (pBase + layout.text);
+	
+	return pEvents;
+}
+
+/*
+ * Check that the header of an image is valid for this module and
+ * matches the size of the image.
+ * 
+ * Only the header and the first and last index entries are read, so
+ * that mapping a store takes the same time whatever its size.  The
+ * other index entries and text offsets are checked by the lookups that
+ * read them, and all of them by nelsc_events_verify().
+ * 
+ * Parameters:
+ * 
+ *   pImage - the image, which must be aligned for uint64_t
+ * 
+ *   size - the size of the image in bytes
+ * 
+ * Return:
+ * 
+ *   true if the header is valid, false if not
+ */
+static bool checkHeader(const void *pImage, size_t size) {
+	
+	bool result = true;
+	const EVENTS_HEADER *pHeader = NULL;
+	const uint32_t *pIndex = NULL;
+	EVENTS_LAYOUT layout;
+	
+	memset(&layout, 0, sizeof(EVENTS_LAYOUT));
+	
+	if (size < EVENTS_INDEX_OFFSET) {
+		result = false;
+	}
+	
+	if (result) {
+		pHeader = (const EVENTS_HEADER *) pImage;
+		if ((memcmp(pHeader->magic, EVENTS_MAGIC, EVENTS_MAGIC_LEN)
+					!= 0) ||
+				(pHeader->version != NELSC_EVENTS_VERSION) ||
+				(pHeader->order != EVENTS_ORDER) ||
+				(pHeader->day_min != NELSC_CYCLE_DAYMIN) ||
+				(pHeader->day_count != EVENTS_DAYS) ||
+				(pHeader->event_count > INT32_MAX) ||
+				(pHeader->text_size == UINT32_MAX) ||
+				(pHeader->size != (uint64_t) size)) {
+			result = false;
+		}
+	}
+	
+	if (result) {
+		computeLayout(pHeader->event_count, pHeader->text_size,
+			&layout);
+		if (layout.size != (uint64_t) size) {
+			result = false;
+		}
+	}
+	
+	if (result) {
+		pIndex = (const uint32_t *) (((const unsigned char *) pImage) +
+										layout.index);
+		if ((pIndex[0] != 0) ||
+				(pIndex[EVENTS_DAYS] != pHeader->event_count)) {
+			result = false;
+		}
+	}
+	
+	return result;
+}
+
+/*
+ * Find the events between two entries of the index of a store.
+ * 
+ * The entries are checked against each other and the number of events,
+ * and if a damaged store has them out of order, no events are found.
+ * 
+ * Parameters:
+ * 
+ *   pEvents - the store
+ * 
+ *   a - the index entry of the first day
+ * 
+ *   b - the index entry following the last day, which is greater than
+ *   a and at most EVENTS_DAYS
+ * 
+ *   pFirst - receives the number of the first event
+ * 
+ * Return:
+ * 
+ *   the number of events
+ */
+static int32_t indexRun(
+		const NELSC_EVENTS *pEvents,
+		int32_t a,
+		int32_t b,
+		int32_t *pFirst) {
+	
+	uint32_t first = 0;
+	uint32_t end = 0;
+	
+	first = pEvents->pIndex[a];
+	end = pEvents->pIndex[b];
+	if ((end < first) || (end > pEvents->pHeader->event_count)) {
+		first = 0;
+		end = 0;
+	}
+	
+	*pFirst = (int32_t) first;
+	return (int32_t) (end - first);
+}
+
+/*
+ * Write the whole of a buffer to a file descriptor, retrying short and
+ * interrupted writes.
+ * 
+ * Parameters:
+ * 
+ *   fd - the file descriptor
+ * 
+ *   pData - the data to write
+ * 
+ *   size - the number of bytes to write
+ * 
+ * Return:
+ * 
+ *   true if successful, false if writing failed
+ */
+static bool writeAll(int fd, const void *pData, size_t size) {
+	
+	bool result = true;
+	const unsigned char *pc = NULL;
+	ssize_t retval = 0;
+	
+	pc = (const unsigned char *) pData;
+	while (size > 0) {
+		retval = write(fd, pc, size);
+		if (retval < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			result = false;
+			break;
+		}
+		pc += retval;
+		size -= (size_t) retval;
+	}
+	
+	return result;
+}
+
+/*
+ * Flush the directory holding a file to disk, so that a rename of the
+ * file survives a crash.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path of the file
+ * 
+ * Return:
+ * 
+ *   true if successful, false if the directory couldn't be opened or
+ *   flushed
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static bool syncDir(const char *pPath) {
+	
+	bool result = true;
+	char *pDir = NULL;
+	char *pSlash = NULL;
+	int fd = -1;
+	
+	/* Get the directory part of the path, which is the current
+	 * directory if there is none */
+	pDir = (char *) malloc(strlen(pPath) + 2);
+	if (pDir == NULL) {
+		abort();
+	}
+	strcpy(pDir, pPath);
+	pSlash = strrchr(pDir, '/');
+	if (pSlash == NULL) {
+		strcpy(pDir, ".");
+	} else if (pSlash == pDir) {
+		pDir[1] = 0;
+	} else {
+		*pSlash = 0;
+	}
+	
+	fd = open(pDir, O_RDONLY);
+	if (fd < 0) {
+		result = false;
+	}
+	if (result) {
+		if (fsync(fd) != 0) {
+			result = false;
+		}
+	}
+	if (fd >= 0) {
+		close(fd);
+	}
+	
+	free(pDir);
+	return result;
+}
+
+/*
+ * nelsc_events_new function.
+ */
+NELSC_EVENTS *nelsc_events_new(const NELSC_DAYINDEX *pIndex) {
+	
+	unsigned char *pImage = NULL;
+	EVENTS_HEADER *pHeader = NULL;
+	uint32_t *pDayIndex = NULL;
+	int32_t *pDays = NULL;
+	uint32_t *pOffs = NULL;
+	char *pText = NULL;
+	EVENTS_LAYOUT layout;
+	
+	const char *pLine = NULL;
+	size_t len = 0;
+	uint64_t text_size = 0;
+	int32_t count = 0;
+	int32_t first = 0;
+	int32_t day_count = 0;
+	int32_t i = 0;
+	int32_t j = 0;
+	int32_t n = 0;
+	int32_t d = 0;
+	
+	memset(&layout, 0, sizeof(EVENTS_LAYOUT));
+	
+	/* Check parameters */
+	if (pIndex == NULL) {
+		abort();
+	}
+	
+	/* Total the text, which must fit in 32-bit offsets */
+	count = nelsc_dayindex_count(pIndex);
+	for(i = 0; i < count; i++) {
+		nelsc_dayindex_line(pIndex, i, &len);
+		text_size += (uint64_t) len;
+	}
+	if (text_size >= UINT32_MAX) {
+		abort();
+	}
+	
+	/* Allocate the image, with zeros in the padding */
+	computeLayout((uint32_t) count, (uint32_t) text_size, &layout);
+	if (layout.size > SIZE_MAX) {
+		abort();
+	}
+	pImage = (unsigned char *) calloc(1, (size_t) layout.size);
+	if (pImage == NULL) {
+		abort();
+	}
+	
+	pHeader = (EVENTS_HEADER *) pImage;
+	pDayIndex = (uint32_t *) (pImage + layout.index);
+	pDays = (int32_t *) (pImage + layout.days);
+	pOffs = (uint32_t *) (pImage + layout.offs);
+	pText = (char *) (pImage + layout.text);
+	
+	memcpy(pHeader->magic, EVENTS_MAGIC, EVENTS_MAGIC_LEN);
+	pHeader->version = NELSC_EVENTS_VERSION;
+	pHeader->order = EVENTS_ORDER;
+	pHeader->day_min = NELSC_CYCLE_DAYMIN;
+	pHeader->day_count = EVENTS_DAYS;
+	pHeader->event_count = (uint32_t) count;
+	pHeader->text_size = (uint32_t) text_size;
+	pHeader->size = layout.size;
+	
+	/* Copy the lines of each day in turn */
+	text_size = 0;
+	for(d = 0; d < EVENTS_DAYS; d++) {
+		pDayIndex[d] = (uint32_t) n;
+		day_count = nelsc_dayindex_find(
+						pIndex, NELSC_CYCLE_DAYMIN + d, &first);
+		for(j = 0; j < day_count; j++) {
+			pLine = nelsc_dayindex_line(pIndex, first + j, &len);
+			if (len > 0) {
+				memcpy(pText + text_size, pLine, len);
+			}
+			pDays[n] = NELSC_CYCLE_DAYMIN + d;
+			pOffs[n] = (uint32_t) text_size;
+			text_size += (uint64_t) len;
+			n++;
+		}
+	}
+	pDayIndex[EVENTS_DAYS] = (uint32_t) n;
+	pOffs[n] = (uint32_t) text_size;
+	
+	return wrapImage(pImage, (size_t) layout.size, false);
+}
+
+/*
+ * nelsc_events_map function.
+ */
+NELSC_EVENTS *nelsc_events_map(const char *pPath) {
+	
+	int fd = -1;
+	struct stat st;
+	void *pMap = MAP_FAILED;
+	size_t size = 0;
+	NELSC_EVENTS *pEvents = NULL;
+	bool status = true;
+	
+	/* Initialize structures */
+	memset(&st, 0, sizeof(struct stat));
+	
+	/* Check parameters */
+	if (pPath == NULL) {
+		abort();
+	}
+	
+	/* Open the file and map all of it read-only */
+	fd = open(pPath, O_RDONLY);
+	if (fd < 0) {
+		status = false;
+	}
+	
+	if (status) {
+		if (fstat(fd, &st) != 0) {
+			status = false;
+		}
+	}
+	if (status) {
+		size = (size_t) st.st_size;
+		if (size < EVENTS_INDEX_OFFSET) {
+			status = false;
+		}
+	}
+	
+	if (status) {
+		pMap = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+		if (pMap == MAP_FAILED) {
+			status = false;
+		}
+	}
+	if (fd >= 0) {
+		close(fd);
+	}
+	
+	/* Wrap the mapping if it has a valid header, or else release it */
+	if (status) {
+		status = checkHeader(pMap, size);
+	}
+	
+	if (status) {
+		pEvents = wrapImage(pMap, size, true);
+	} else if (pMap != MAP_FAILED) {
+		munmap(pMap, size);
+	}
+	
+	return pEvents;
+}
+
+/*
+ * nelsc_events_free function.
+ */
+void nelsc_events_free(NELSC_EVENTS *pEvents) {
+	
+	if (pEvents != NULL) {
+		if (pEvents->mapped) {
+			munmap(pEvents->pImage, pEvents->size);
+		} else {
+			free(pEvents->pImage);
+		}
+		free(pEvents);
+	}
+}
+
+/*
+ * nelsc_events_save function.
+ */
+bool nelsc_events_save(const NELSC_EVENTS *pEvents, const char *pPath) {
+	
+	bool result = true;
+	char *pTemp = NULL;
+	mode_t mask = 0;
+	int fd = -1;
+	
+	/* Check parameters */
+	if ((pEvents == NULL) || (pPath == NULL)) {
+		abort();
+	}
+	
+	/* Create a temporary file with a unique name beside the store, so
+	 * that a file left over from an earlier save can't get in the
+	 * way */
+	pTemp = (char *) malloc(strlen(pPath) + sizeof(EVENTS_TEMP_SUFFIX));
+	if (pTemp == NULL) {
+		abort();
+	}
+	strcpy(pTemp, pPath);
+	strcat(pTemp, EVENTS_TEMP_SUFFIX);
+	
+	fd = mkstemp(pTemp);
+	if (fd < 0) {
+		result = false;
+	}
+	
+	/* mkstemp() only lets the owner read the file, so give it the
+	 * permissions a newly created store would get */
+	if (result) {
+		mask = umask(0);
+		umask(mask);
+		if (fchmod(fd, ((mode_t) 0666) & (~mask)) != 0) {
+			result = false;
+		}
+	}
+	
+	/* Write the image to the temporary file and flush it to disk */
+	if (result) {
+		result = writeAll(fd, pEvents->pImage, pEvents->size);
+	}
+	if (result) {
+		if (fsync(fd) != 0) {
+			result = false;
+		}
+	}
+	
+	if (fd >= 0) {
+		if (close(fd) != 0) {
+			result = false;
+		}
+	}
+	
+	/* Replace the store in one step, so that processes with the old
+	 * file mapped keep reading the old file */
+	if (result) {
+		if (rename(pTemp, pPath) != 0) {
+			result = false;
+		}
+	}
+	if ((!result) && (fd >= 0)) {
+		unlink(pTemp);
+	}
+	
+	/* Flush the directory, so that the rename is on disk too */
+	if (result) {
+		result = syncDir(pPath);
+	}
+	
+	free(pTemp);
+	
+	return result;
+}
+
+/*
+ * nelsc_events_verify function.
+ */
+bool nelsc_events_verify(const NELSC_EVENTS *pEvents) {
+	
+	bool result = true;
+	const EVENTS_HEADER *pHeader = NULL;
+	const uint32_t *pIndex = NULL;
+	const int32_t *pDays = NULL;
+	const uint32_t *pOffs = NULL;
+	uint32_t d = 0;
+	uint32_t i = 0;
+	
+	/* Check parameters */
+	if (pEvents == NULL) {
+		abort();
+	}
+	
+	pHeader = pEvents->pHeader;
+	pIndex = pEvents->pIndex;
+	pDays = pEvents->pDays;
+	pOffs = pEvents->pOffs;
+	
+	/* Check that the index only goes forward and covers all the events,
+	 * and that each event is on the day that the index puts it on */
+	for(d = 0; d < EVENTS_DAYS; d++) {
+		if ((pIndex[d + 1] < pIndex[d]) ||
+				(pIndex[d + 1] > pHeader->event_count)) {
+			result = false;
+			break;
+		}
+		for(i = pIndex[d]; i < pIndex[d + 1]; i++) {
+			if (pDays[i] != NELSC_CYCLE_DAYMIN + (int32_t) d) {
+				result = false;
+				break;
+			}
+		}
+		if (!result) {
+			break;
+		}
+	}
+	
+	/* Check that the text offsets only go forward and end at the end of
+	 * the text */
+	if (result) {
+		if ((pOffs[0] != 0) ||
+				(pOffs[pHeader->event_count] != pHeader->text_size)) {
+			result = false;
+		}
+	}
+	
+	if (result) {
+		for(i = 0; i < pHeader->event_count; i++) {
+			if (pOffs[i + 1] < pOffs[i]) {
+				result = false;
+				break;
+			}
+		}
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_events_count function.
+ */
+int32_t nelsc_events_count(const NELSC_EVENTS *pEvents) {
+	
+	/* Check parameters */
+	if (pEvents == NULL) {
+		abort();
+	}
+	
+	return (int32_t) pEvents->pHeader->event_count;
+}
+
+/*
+ * nelsc_events_day function.
+ */
+int32_t nelsc_events_day(
+		const NELSC_EVENTS *pEvents,
+		int32_t day,
+		int32_t *pFirst) {
+	
+	int32_t result = 0;
+	int32_t d = 0;
+	
+	/* Check parameters */
+	if ((pEvents == NULL) || (pFirst == NULL)) {
+		abort();
+	}
+	
+	*pFirst = 0;
+	if ((day >= NELSC_CYCLE_DAYMIN) && (day <= NELSC_CYCLE_DAYMAX)) {
+		d = day - NELSC_CYCLE_DAYMIN;
+		result = indexRun(pEvents, d, d + 1, pFirst);
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_events_range function.
+ */
+int32_t nelsc_events_range(
+		const NELSC_EVENTS *pEvents,
+		int32_t first_day,
+		int32_t last_day,
+		int32_t *pFirst) {
+	
+	int32_t result = 0;
+	
+	/* Check parameters */
+	if ((pEvents == NULL) || (pFirst == NULL)) {
+		abort();
+	}
+	
+	/* Clip the range */
+	if (first_day < NELSC_CYCLE_DAYMIN) {
+		first_day = NELSC_CYCLE_DAYMIN;
+	}
+	if (last_day > NELSC_CYCLE_DAYMAX) {
+		last_day = NELSC_CYCLE_DAYMAX;
+	}
+	
+	*pFirst = 0;
+	if (first_day <= last_day) {
+		first_day -= NELSC_CYCLE_DAYMIN;
+		last_day -= NELSC_CYCLE_DAYMIN;
+		result = indexRun(pEvents, first_day, last_day + 1, pFirst);
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_events_dayOf function.
+ */
+int32_t nelsc_events_dayOf(const NELSC_EVENTS *pEvents, int32_t i) {
+	
+	int32_t result = 0;
+	
+	/* Check parameters */
+	if (pEvents == NULL) {
+		abort();
+	}
+	if ((i < 0) || (i >= (int32_t) pEvents->pHeader->event_count)) {
+		abort();
+	}
+	
+	/* Keep the day of a damaged store within range */
+	result = pEvents->pDays[i];
+	if (result < NELSC_CYCLE_DAYMIN) {
+		result = NELSC_CYCLE_DAYMIN;
+	} else if (result > NELSC_CYCLE_DAYMAX) {
+		result = NELSC_CYCLE_DAYMAX;
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_events_text function.
+ */
+const char *nelsc_events_text(
+		const NELSC_EVENTS *pEvents,
+		int32_t i,
+		size_t *pLen) {
+	
+	uint32_t start = 0;
+	uint32_t end = 0;
+	
+	/* Check parameters */
+	if ((pEvents == NULL) || (pLen == NULL)) {
+		abort();
+	}
+	if ((i < 0) || (i >= (int32_t) pEvents->pHeader->event_count)) {
+		abort();
+	}
+	
+	/* Give a damaged store's text offsets no text */
+	start = pEvents->pOffs[i];
+	end = pEvents->pOffs[i + 1];
+	if ((end < start) || (end > pEvents->pHeader->text_size)) {
+		start = 0;
+		end = 0;
+	}
+	
+	*pLen = (size_t) (end - start);
+	return pEvents->pText + start;
+}
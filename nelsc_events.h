@@ -0,0 +1,301 @@
+#ifndef NELSC_EVENTS_H_INCLUDED
+#define NELSC_EVENTS_H_INCLUDED
+
+/*
+ * nelsc_events.h
+ * 
+ * Read-only store of events, such as holidays, keyed by NELSC day
+ * offset.
+ * 
+ * The events are kept in compressed sparse row form.  An index array
+ * has an entry for every day of the NELSC range giving the number of
+ * the first event on that day, and the events are numbered in order of
+ * day, so the events of a day, or of any range of days, are always
+ * consecutive.  Finding them takes two index lookups whatever the
+ * number of events, after which the k events found can be read in O(k)
+ * time.  Each event has its day and the offset of its text in a single
+ * text array.
+ * 
+ * A store is a single flat image: a header followed by the index, the
+ * days, the text offsets, and the text.  The image is the same in
+ * memory and on disk, so a store can be saved with one write and loaded
+ * by mapping the file read-only with mmap(), with nothing to parse.
+ * Many processes mapping the same file share one copy of it.  The file
+ * is in the byte order of the machine that wrote it and is refused on
+ * machines of the other byte order.  Mapping only checks the header, so
+ * it takes the same time whatever the size of the store; each lookup
+ * checks the index entries and text offsets that it reads, so a damaged
+ * file may give wrong events but is never read out of bounds.
+ * nelsc_events_verify() checks a whole store from end to end.
+ * 
+ * Stores are saved to a temporary file that then replaces the store,
+ * so processes that have the old file mapped are not disturbed.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "nelsc_dayindex.h"
+
+/*
+ * The format version of store files written by this module.
+ */
+#define NELSC_EVENTS_VERSION 1
+
+/*
+ * NELSC_EVENTS structure prototype.
+ * 
+ * See the implementation file for definition.
+ */
+struct NELSC_EVENTS_TAG;
+typedef struct NELSC_EVENTS_TAG NELSC_EVENTS;
+
+/*
+ * Create a store in memory from the lines of a day index.
+ * 
+ * Each line of the index becomes the text of an event on its day, and
+ * events of the same day keep the order of the index.  The index is not
+ * needed afterwards.  The store must eventually be released with
+ * nelsc_events_free().
+ * 
+ * Parameters:
+ * 
+ *   pIndex - the built day index
+ * 
+ * Return:
+ * 
+ *   the new store
+ * 
+ * Faults:
+ * 
+ *   - If pIndex is NULL
+ * 
+ *   - If the index has not been built
+ * 
+ *   - If the text of all the lines together is UINT32_MAX bytes or more
+ * 
+ *   - If memory allocation fails
+ */
+NELSC_EVENTS *nelsc_events_new(const NELSC_DAYINDEX *pIndex);
+
+/*
+ * Map a store file read-only.
+ * 
+ * The store must eventually be released with nelsc_events_free(),
+ * which unmaps the file.
+ * 
+ * Parameters:
+ * 
+ *   pPath - the path of the file
+ * 
+ * Only the header is checked; use nelsc_events_verify() to check the
+ * rest of the file.
+ * 
+ * Return:
+ * 
+ *   the mapped store, or NULL if the file could not be opened or
+ *   mapped, or does not have a valid header in the format of this
+ *   module
+ * 
+ * Faults:
+ * 
+ *   - If pPath is NULL
+ * 
+ *   - If memory allocation fails
+ */
+NELSC_EVENTS *nelsc_events_map(const char *pPath);
+
+/*
+ * Release a store.
+ * 
+ * Does nothing if pEvents is NULL.
+ * 
+ * Parameters:
+ * 
+ *   pEvents - the store to release, or NULL
+ */
+void nelsc_events_free(NELSC_EVENTS *pEvents);
+
+/*
+ * Write a store to a file, replacing the file if it exists.
+ * 
+ * The store is written to a temporary file with a unique name beside
+ * the file, which is then renamed over it, so the file is replaced in
+ * one step and readers that have the old file mapped keep their copy.
+ * The directory is flushed to disk after the rename, so that the new
+ * file is in place even after a crash.
+ * 
+ * Parameters:
+ * 
+ *   pEvents - the store
+ * 
+ *   pPath - the path of the file
+ * 
+ * Return:
+ * 
+ *   true if successful, false if the file could not be created,
+ *   written, or renamed, or its directory could not be flushed
+ * 
+ * Faults:
+ * 
+ *   - If pEvents or pPath is NULL
+ * 
+ *   - If memory allocation fails
+ */
+bool nelsc_events_save(const NELSC_EVENTS *pEvents, const char *pPath);
+
+/*
+ * Check every index entry, day, and text offset of a store.
+ * 
+ * This reads the whole store, so it is meant for checking a file once,
+ * such as after building it, rather than every time it is mapped.
+ * 
+ * Parameters:
+ * 
+ *   pEvents - the store
+ * 
+ * Return:
+ * 
+ *   true if the store is valid, false if it is damaged
+ * 
+ * Faults:
+ * 
+ *   - If pEvents is NULL
+ */
+bool nelsc_events_verify(const NELSC_EVENTS *pEvents);
+
+/*
+ * Get the number of events in a store.
+ * 
+ * Parameters:
+ * 
+ *   pEvents - the store
+ * 
+ * Return:
+ * 
+ *   the number of events
+ * 
+ * Faults:
+ * 
+ *   - If pEvents is NULL
+ */
+int32_t nelsc_events_count(const NELSC_EVENTS *pEvents);
+
+/*
+ * Find the events of a day.
+ * 
+ * The events are the count events numbered from *pFirst.  In a damaged
+ * store whose index entries for the day are out of order, no events
+ * are found.
+ * 
+ * Parameters:
+ * 
+ *   pEvents - the store
+ * 
+ *   day - the NELSC day offset, which may be any value
+ * 
+ *   pFirst - receives the number of the first event of the day
+ * 
+ * Return:
+ * 
+ *   the number of events on the day, which is zero for days outside
+ *   the NELSC range
+ * 
+ * Faults:
+ * 
+ *   - If pEvents or pFirst is NULL
+ */
+int32_t nelsc_events_day(
+		const NELSC_EVENTS *pEvents,
+		int32_t day,
+		int32_t *pFirst);
+
+/*
+ * Find the events of a range of days.
+ * 
+ * The events are the count events numbered from *pFirst, in order of
+ * day.  The range is clipped to the NELSC range.  As with
+ * nelsc_events_day(), no events are found in a damaged store whose
+ * index entries for the range are out of order.
+ * 
+ * Parameters:
+ * 
+ *   pEvents - the store
+ * 
+ *   first_day - the NELSC day offset of the first day of the range
+ * 
+ *   last_day - the NELSC day offset of the last day of the range
+ * 
+ *   pFirst - receives the number of the first event of the range
+ * 
+ * Return:
+ * 
+ *   the number of events in the range, which is zero if last_day is
+ *   less than first_day
+ * 
+ * Faults:
+ * 
+ *   - If pEvents or pFirst is NULL
+ */
+int32_t nelsc_events_range(
+		const NELSC_EVENTS *pEvents,
+		int32_t first_day,
+		int32_t last_day,
+		int32_t *pFirst);
+
+/*
+ * Get the day of an event.
+ * 
+ * In a damaged store, the day may be wrong, but is always in the NELSC
+ * range.
+ * 
+ * Parameters:
+ * 
+ *   pEvents - the store
+ * 
+ *   i - the number of the event
+ * 
+ * Return:
+ * 
+ *   the NELSC day offset of the event
+ * 
+ * Faults:
+ * 
+ *   - If pEvents is NULL
+ * 
+ *   - If i is out of range
+ */
+int32_t nelsc_events_dayOf(const NELSC_EVENTS *pEvents, int32_t i);
+
+/*
+ * Get the text of an event.
+ * 
+ * The text is not null-terminated, and remains valid until the store is
+ * released.  In a damaged store, the text may be wrong, or empty if its
+ * offsets are out of order.
+ * 
+ * Parameters:
+ * 
+ *   pEvents - the store
+ * 
+ *   i - the number of the event
+ * 
+ *   pLen - receives the number of characters in the text
+ * 
+ * Return:
+ * 
+ *   the text of the event
+ * 
+ * Faults:
+ * 
+ *   - If pEvents or pLen is NULL
+ * 
+ *   - If i is out of range
+ */
+const char *nelsc_events_text(
+		const NELSC_EVENTS *pEvents,
+		int32_t i,
+		size_t *pLen);
+
+#endif
@@ -0,0 +1,193 @@
+/*
+ * nelsc_eytz.c
+ * 
+ * Implementation of nelsc_eytz.h
+ * 
+ * See the header for further information.
+ */
+
+#include "nelsc_eytz.h"
+#include <stdlib.h>
+
+#if !defined(__GNUC__)
+#error nelsc_eytz requires the GCC prefetch and bit scan builtins
+#endif
+
+/*
+ * The number of tree elements in a cache line.  The descendants of
+ * element k four levels down are the EYTZ_BLOCK elements starting at
+ * element EYTZ_BLOCK * k, which share one cache line since the tree is
+ * aligned to NELSC_EYTZ_ALIGN and element zero is unused.
+ */
+#define EYTZ_BLOCK (NELSC_EYTZ_ALIGN / 4)
+
+/*
+ * Function prototypes
+ * ===================
+ */
+
+static int32_t fillRanks(
+		uint16_t *pRank,
+		int32_t n,
+		int32_t k,
+		int32_t i);
+static int32_t searchTree(const int32_t *pTree, int32_t n, int32_t x);
+
+/*
+ * Number the elements of a tree in Eytzinger order with their positions
+ * in sorted order.
+ * 
+ * The subtree rooted at element k is visited in order, so the elements
+ * receive consecutive numbers starting at i.
+ * 
+ * Parameters:
+ * 
+ *   pRank - the array to receive the numbers, with n + 1 elements
+ * 
+ *   n - the number of elements in the tree
+ * 
+ *   k - the root of the subtree to number
+ * 
+ *   i - the number of the first element of the subtree in order
+ * 
+ * Return:
+ * 
+ *   the number following the last element of the subtree
+ */
+static int32_t fillRanks(
+		uint16_t *pRank,
+		int32_t n,
+		int32_t k,
+		int32_t i) {
+	
+	if (k <= n) {
+		i = fillRanks(pRank, n, 2 * k, i);
+		pRank[k] = (uint16_t) i;
+		i++;
+		i = fillRanks(pRank, n, (2 * k) + 1, i);
+	}
+	
+	return i;
+}
+
+/*
+ * Find the last element of a tree that is not greater than a value.
+ * 
+ * Each step adds the result of the comparison into the index, and the
+ * path down the tree is left in the bits of the index.  The cache line
+ * four levels down is prefetched at each step.  Its address is computed
+ * as an integer, since near the bottom of the tree it is past the end
+ * of the array, where pointer arithmetic would be undefined and a
+ * prefetch is harmless.  The final right
+ * turn was at the element wanted, so dropping the trailing left turns
+ * and that right turn yields it.
+ * 
+ * Parameters:
+ * 
+ *   pTree - the tree, in Eytzinger order from element 1, aligned to
+ *   NELSC_EYTZ_ALIGN
+ * 
+ *   n - the number of elements in the tree
+ * 
+ *   x - the value to search for
+ * 
+ * Return:
+ * 
+ *   the index in pTree of the element, or zero if every element is
+ *   greater than x
+ */
+static int32_t searchTree(const int32_t *pTree, int32_t n, int32_t x) {
+	
+	uint32_t k = 1;
+	
+	while (k <= (uint32_t) n) {
+		__builtin_prefetch((const void *) (((uintptr_t) pTree) +
+			(((uintptr_t) k) * (EYTZ_BLOCK * sizeof(int32_t)))));
+		k = (2 * k) + ((uint32_t) (pTree[k] <= x));
+	}
+	k >>= __builtin_ffs((int) k);
+	
+	return (int32_t) k;
+}
+
+/*
+ * nelsc_eytz_build function.
+ */
+void nelsc_eytz_build(NELSC_EYTZ *pEytz) {
+	
+	int32_t k = 0;
+	
+	/* Check parameters */
+	if (pEytz == NULL) {
+		abort();
+	}
+	
+	/* Lay out the month and year numbers in tree order */
+	fillRanks(pEytz->month_rank, NELSC_TABLE_MONTHS, 1, 0);
+	fillRanks(pEytz->year_rank, NELSC_TABLE_YEARS, 1, 0);
+	(pEytz->month_rank)[0] = 0;
+	(pEytz->year_rank)[0] = 0;
+	
+	/* Fill in the start of each month and year */
+	(pEytz->month_day)[0] = 0;
+	for(k = 1; k <= NELSC_TABLE_MONTHS; k++) {
+		(pEytz->month_day)[k] = nelsc_cycle_monthToDay(
+			((int32_t) (pEytz->month_rank)[k]) + NELSC_CYCLE_MONMIN);
+	}
+	
+	(pEytz->year_month)[0] = 0;
+	for(k = 1; k <= NELSC_TABLE_YEARS; k++) {
+		(pEytz->year_month)[k] = nelsc_cycle_yearToMonth(
+			((int32_t) (pEytz->year_rank)[k]) + NELSC_CYCLE_YEARMIN);
+	}
+}
+
+/*
+ * nelsc_eytz_dayToMonth function.
+ */
+int32_t nelsc_eytz_dayToMonth(
+		const NELSC_EYTZ *pEytz,
+		int32_t d,
+		int32_t *pOffset) {
+	
+	int32_t k = 0;
+	
+	/* Check parameters */
+	if ((pEytz == NULL) ||
+			(d < NELSC_CYCLE_DAYMIN) || (d > NELSC_CYCLE_DAYMAX)) {
+		abort();
+	}
+	
+	/* Find the last month that starts on or before the day */
+	k = searchTree(pEytz->month_day, NELSC_TABLE_MONTHS, d);
+	
+	if (pOffset != NULL) {
+		*pOffset = d - (pEytz->month_day)[k];
+	}
+	return ((int32_t) (pEytz->month_rank)[k]) + NELSC_CYCLE_MONMIN;
+}
+
+/*
+ * nelsc_eytz_monthToYear function.
+ */
+int32_t nelsc_eytz_monthToYear(
+		const NELSC_EYTZ *pEytz,
+		int32_t m,
+		int32_t *pOffset) {
+	
+	int32_t k = 0;
+	
+	/* Check parameters */
+	if ((pEytz == NULL) ||
+			(m < NELSC_CYCLE_MONMIN) || (m > NELSC_CYCLE_MONMAX)) {
+		abort();
+	}
+	
+	/* Find the last year that starts on or before the month */
+	k = searchTree(pEytz->year_month, NELSC_TABLE_YEARS, m);
+	
+	if (pOffset != NULL) {
+		*pOffset = m - (pEytz->year_month)[k];
+	}
+	return ((int32_t) (pEytz->year_rank)[k]) + NELSC_CYCLE_YEARMIN;
+}
@@ -0,0 +1,151 @@
+#ifndef NELSC_EYTZ_H_INCLUDED
+#define NELSC_EYTZ_H_INCLUDED
+
+/*
+ * nelsc_eytz.h
+ * 
+ * Finds the NELSC month that contains a day, and the year that contains
+ * a month, by searching the first day of each month and the first
+ * month of each year, for use where the full tables of nelsc_table are
+ * too large.
+ * 
+ * The month starts and year starts are stored in Eytzinger order, that
+ * is, as a complete binary search tree laid out breadth first, with the
+ * root at element 1 and the children of element k at elements 2k and
+ * 2k + 1.  A search walks down from the root, choosing the child with a
+ * comparison whose result is added into the index rather than branched
+ * on, so there are no mispredicted branches.  The top levels of the
+ * tree, which every search passes through, share a few cache lines,
+ * and since each tree is aligned to a cache line, the sixteen
+ * descendants of a node four levels down fill one cache line, which the
+ * search prefetches while the levels in between are being walked.
+ * 
+ * Both trees together take about 45 kilobytes, against more than 400
+ * kilobytes for the tables of nelsc_table.  Like those tables, they are
+ * held in a single structure of fixed size that contains no pointers.
+ * The structure must be allocated with an alignment of
+ * NELSC_EYTZ_ALIGN.
+ */
+
+#include <stdint.h>
+#include "nelsc_cycle.h"
+#include "nelsc_table.h"
+
+#if !defined(__GNUC__)
+#error nelsc_eytz requires the GCC aligned attribute
+#endif
+
+/*
+ * The alignment in bytes of each search tree, which is the size of a
+ * cache line.
+ */
+#define NELSC_EYTZ_ALIGN 64
+
+/*
+ * The search trees of month starts and year starts.
+ * 
+ * Use nelsc_eytz_build() to fill in the trees.  Element zero of each
+ * array is unused.  Structures allocated dynamically must be aligned to
+ * NELSC_EYTZ_ALIGN, as with posix_memalign().
+ */
+typedef struct {
+	
+	/*
+	 * The NELSC absolute day offset of the first day of each month, in
+	 * Eytzinger order.
+	 */
+	int32_t month_day[NELSC_TABLE_MONTHS + 1]
+		__attribute__((aligned(NELSC_EYTZ_ALIGN)));
+	
+	/*
+	 * The NELSC absolute month offset of the first month of each year,
+	 * in Eytzinger order.
+	 */
+	int32_t year_month[NELSC_TABLE_YEARS + 1]
+		__attribute__((aligned(NELSC_EYTZ_ALIGN)));
+	
+	/*
+	 * The month of each element of month_day, as month offset minus
+	 * NELSC_CYCLE_MONMIN.
+	 */
+	uint16_t month_rank[NELSC_TABLE_MONTHS + 1];
+	
+	/*
+	 * The year of each element of year_month, as year minus
+	 * NELSC_CYCLE_YEARMIN.
+	 */
+	uint16_t year_rank[NELSC_TABLE_YEARS + 1];
+
+} NELSC_EYTZ;
+
+/*
+ * Fill in the search trees.
+ * 
+ * The month and year starts are computed with the nelsc_cycle
+ * conversion functions.
+ * 
+ * Parameters:
+ * 
+ *   pEytz - the trees to fill in
+ * 
+ * Faults:
+ * 
+ *   - If pEytz is NULL
+ */
+void nelsc_eytz_build(NELSC_EYTZ *pEytz);
+
+/*
+ * Search tree version of nelsc_cycle_dayToMonth().
+ * 
+ * Parameters:
+ * 
+ *   pEytz - the trees
+ * 
+ *   d - the NELSC absolute day offset
+ * 
+ *   pOffset - pointer to variable to receive the offset of the day
+ *   within the month, or NULL
+ * 
+ * Return:
+ * 
+ *   the NELSC absolute month offset of the month that contains day d
+ * 
+ * Faults:
+ * 
+ *   - If pEytz is NULL
+ * 
+ *   - If d is out of NELSC range
+ */
+int32_t nelsc_eytz_dayToMonth(
+		const NELSC_EYTZ *pEytz,
+		int32_t d,
+		int32_t *pOffset);
+
+/*
+ * Search tree version of nelsc_cycle_monthToYear().
+ * 
+ * Parameters:
+ * 
+ *   pEytz - the trees
+ * 
+ *   m - the NELSC absolute month offset
+ * 
+ *   pOffset - pointer to variable to receive the offset of the month
+ *   within the year, or NULL
+ * 
+ * Return:
+ * 
+ *   the year that contains month m
+ * 
+ * Faults:
+ * 
+ *   - If pEytz is NULL
+ * 
+ *   - If m is out of NELSC range
+ */
+int32_t nelsc_eytz_monthToYear(
+		const NELSC_EYTZ *pEytz,
+		int32_t m,
+		int32_t *pOffset);
+
+#endif
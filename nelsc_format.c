@@ -9,6 +9,8 @@
 #include "nelsc_format.h"
 #include <stdlib.h>
 
+#include "nelsc_stats.h"
+
 /*
  * The number of days in a week.
  */
@@ -44,11 +46,6 @@
  */
 #define WEEKS_PER_LONG_MONTH 5
 
-/*
- * The number of characters in a formatted day of month.
- */
-#define MONTHDAY_CHARS 3
-
 /*
  * The character offset within a NELSC date of the separator that keeps
  * the year and month apart from each other.
@@ -94,10 +91,152 @@
 #define DATEFIELD_DAY 6
 
 /*
- * nelsc_format_printDate function.
+ * The number of years that can be written as a base-24 pair, and the
+ * unsigned value of the first pair that stands for a negative year.
  */
-void nelsc_format_printDate(
-		FILE *pFile,
+#define YEAR_COUNT 576
+#define YEAR_NEGATIVE 480
+
+/*
+ * The value of each base-24 digit plus one, indexed by character, or
+ * zero for characters that are not base-24 digits.  Lowercase letters
+ * are accepted, as they are by base24_digitToInt().
+ */
+static const uint8_t m_digit[256] = {
+	['0'] =  1, ['1'] =  2, ['2'] =  3, ['3'] =  4, ['4'] =  5,
+	['5'] =  6, ['6'] =  7, ['7'] =  8, ['8'] =  9, ['9'] = 10,
+	['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15,
+	['F'] = 16, ['G'] = 17, ['M'] = 18, ['P'] = 19, ['R'] = 20,
+	['T'] = 21, ['V'] = 22, ['X'] = 23, ['Y'] = 24,
+	['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15,
+	['f'] = 16, ['g'] = 17, ['m'] = 18, ['p'] = 19, ['r'] = 20,
+	['t'] = 21, ['v'] = 22, ['x'] = 23, ['y'] = 24
+};
+
+/*
+ * Function prototypes
+ * ===================
+ */
+
+static bool scanKey(uint8_t *pKey, const char *str, SCANERR *pErr);
+
+/*
+ * Make the sort key of the NELSC_FORMAT_DATE_LENGTH characters at str.
+ * 
+ * The fields are read with m_digit rather than the base24 functions,
+ * and no year or month lengths are looked up, so this is only a few
+ * table reads and compares.
+ * 
+ * Parameters:
+ * 
+ *   pKey - the buffer to write the key into
+ * 
+ *   str - the characters of the date, which need not be
+ *   null-terminated
+ * 
+ *   pErr - pointer to the structure to receive the reason if the
+ *   function fails, or NULL
+ * 
+ * Return:
+ * 
+ *   true if successful, false if the characters don't form a NELSC date
+ */
+static bool scanKey(uint8_t *pKey, const char *str, SCANERR *pErr) {
+	
+	bool result = true;
+	int32_t y_hi = 0;
+	int32_t y_lo = 0;
+	int32_t m = 0;
+	int32_t w = 0;
+	int32_t d = 0;
+	int32_t year = 0;
+	
+	/* Check the separators */
+	if (str[DATESEP_YEAR_OFFS] != DATESEP_YEAR) {
+		scanerr_set(pErr, SCANERR_SEPARATOR, SCANERR_FIELD_NONE,
+			DATESEP_YEAR_OFFS, 0);
+		result = false;
+	
+	} else if (str[DATESEP_WEEK_OFFS] != DATESEP_WEEK) {
+		scanerr_set(pErr, SCANERR_SEPARATOR, SCANERR_FIELD_NONE,
+			DATESEP_WEEK_OFFS, 0);
+		result = false;
+	}
+	
+	/* Read the digits, which are one more than their values */
+	if (result) {
+		y_hi = m_digit[(unsigned char) str[DATEFIELD_YEAR]];
+		y_lo = m_digit[(unsigned char) str[DATEFIELD_YEAR + 1]];
+		m = m_digit[(unsigned char) str[DATEFIELD_MONTH]];
+		w = m_digit[(unsigned char) str[DATEFIELD_WEEK]];
+		d = m_digit[(unsigned char) str[DATEFIELD_DAY]];
+		
+		if ((y_hi == 0) || (y_lo == 0)) {
+			scanerr_set(pErr, SCANERR_DIGIT, SCANERR_FIELD_YEAR,
+				DATEFIELD_YEAR, 0);
+			result = false;
+		
+		} else if (m == 0) {
+			scanerr_set(pErr, SCANERR_DIGIT, SCANERR_FIELD_MONTH,
+				DATEFIELD_MONTH, 0);
+			result = false;
+		
+		} else if (w == 0) {
+			scanerr_set(pErr, SCANERR_DIGIT, SCANERR_FIELD_WEEK,
+				DATEFIELD_WEEK, 0);
+			result = false;
+		
+		} else if (d == 0) {
+			scanerr_set(pErr, SCANERR_DIGIT, SCANERR_FIELD_DAY,
+				DATEFIELD_DAY, 0);
+			result = false;
+		}
+	}
+	
+	/* Check the ranges of the one-based fields */
+	if (result) {
+		m--;
+		w--;
+		d--;
+		
+		if ((m < 1) || (m > MONTHS_PER_LONG_YEAR)) {
+			scanerr_set(pErr, SCANERR_RANGE, SCANERR_FIELD_MONTH,
+				DATEFIELD_MONTH, m);
+			result = false;
+		
+		} else if ((w < 1) || (w > WEEKS_PER_LONG_MONTH)) {
+			scanerr_set(pErr, SCANERR_RANGE, SCANERR_FIELD_WEEK,
+				DATEFIELD_WEEK, w);
+			result = false;
+		
+		} else if ((d < 1) || (d > DAYS_PER_WEEK)) {
+			scanerr_set(pErr, SCANERR_RANGE, SCANERR_FIELD_DAY,
+				DATEFIELD_DAY, d);
+			result = false;
+		}
+	}
+	
+	/* Offsetting the signed year by -BASE24_PAIR_MIN is the same as
+	 * rotating the unsigned pair so that the negative years come
+	 * first */
+	if (result) {
+		year = ((y_hi - 1) * 24) + (y_lo - 1);
+		year = (year + YEAR_COUNT - YEAR_NEGATIVE) % YEAR_COUNT;
+		
+		pKey[0] = (uint8_t) (year >> 8);
+		pKey[1] = (uint8_t) (year & 0xff);
+		pKey[2] = (uint8_t) m;
+		pKey[3] = (uint8_t) ((w << 4) | d);
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_format_writeDate function.
+ */
+void nelsc_format_writeDate(
+		char *pBuf,
 		int32_t y,
 		int32_t m,
 		int32_t d) {
@@ -106,9 +245,10 @@ void nelsc_format_printDate(
 	int day_digit = 0;
 	
 	int32_t abs_month = 0;
+	NELSC_STATS_BEGIN(stats_start);
 	
 	/* Check parameters */
-	if ((pFile == NULL) ||
+	if ((pBuf == NULL) ||
 		(y < NELSC_CYCLE_YEARMIN) || (y > NELSC_CYCLE_YEARMAX) ||
 		(m < 0) || (d < 0)) {
 		abort();
@@ -142,13 +282,12 @@ void nelsc_format_printDate(
 		}
 	}
 	
-	/* Print the year */
-	base24_printPair(pFile, y);
+	/* Write the year */
+	base24_writePair(pBuf, y);
 	
-	/* Print the month separator and the month */
-	if (fprintf(pFile, ":%c", (int) base24_intToDigit(m + 1)) != 2) {
-		abort();
-	}
+	/* Write the month separator and the month */
+	pBuf[DATESEP_YEAR_OFFS] = DATESEP_YEAR;
+	pBuf[DATEFIELD_MONTH] = base24_intToDigit(m + 1);
 	
 	/* Split day offset in week and day */
 	week_digit = (int) (d / DAYS_PER_WEEK);
@@ -158,9 +297,36 @@ void nelsc_format_printDate(
 	week_digit++;
 	day_digit++;
 	
-	/* Print the three characters */
-	if (fprintf(pFile, "%d-%d", week_digit, day_digit)
-					!= MONTHDAY_CHARS) {
+	/* Write the week, the week separator, and the day */
+	pBuf[DATEFIELD_WEEK] = (char) ('0' + week_digit);
+	pBuf[DATESEP_WEEK_OFFS] = DATESEP_WEEK;
+	pBuf[DATEFIELD_DAY] = (char) ('0' + day_digit);
+	
+	NELSC_STATS_END(NELSC_PROBE_FORMAT_WRITEDATE, stats_start, true);
+}
+
+/*
+ * nelsc_format_printDate function.
+ */
+void nelsc_format_printDate(
+		FILE *pFile,
+		int32_t y,
+		int32_t m,
+		int32_t d) {
+	
+	char buf[NELSC_FORMAT_DATE_LENGTH];
+	
+	/* Check parameters */
+	if (pFile == NULL) {
+		abort();
+	}
+	
+	/* Write the date into the buffer, which also checks the date */
+	nelsc_format_writeDate(buf, y, m, d);
+	
+	/* Print the characters */
+	if (fwrite(buf, 1, NELSC_FORMAT_DATE_LENGTH, pFile) !=
+			NELSC_FORMAT_DATE_LENGTH) {
 		abort();
 	}
 }
@@ -168,7 +334,10 @@ void nelsc_format_printDate(
 /*
  * nelsc_format_scanDate function.
  */
-bool nelsc_format_scanDate(const char *str, int32_t *pOffset) {
+bool nelsc_format_scanDate(
+		const char *str,
+		int32_t *pOffset,
+		SCANERR *pErr) {
 	
 	bool result = true;
 	int32_t x = 0;
@@ -180,9 +349,11 @@ bool nelsc_format_scanDate(const char *str, int32_t *pOffset) {
 	
 	int32_t abs_month = 0;
 	int32_t offs = 0;
+	NELSC_STATS_BEGIN(stats_start);
 	
 	/* Fail if str is NULL */
 	if (str == NULL) {
+		scanerr_set(pErr, SCANERR_END, SCANERR_FIELD_NONE, 0, 0);
 		result = false;
 	}
 	
@@ -191,6 +362,8 @@ bool nelsc_format_scanDate(const char *str, int32_t *pOffset) {
 	if (result) {
 		for(x = 0; x < NELSC_FORMAT_DATE_LENGTH; x++) {
 			if (str[x] == 0) {
+				scanerr_set(pErr, SCANERR_END, SCANERR_FIELD_NONE,
+					x, 0);
 				result = false;
 				break;
 			}
@@ -200,23 +373,42 @@ bool nelsc_format_scanDate(const char *str, int32_t *pOffset) {
 	/* Fail if the separator characters are not in the proper
 	 * positions */
 	if (result) {
-		if ((str[DATESEP_YEAR_OFFS] != DATESEP_YEAR) ||
-			(str[DATESEP_WEEK_OFFS] != DATESEP_WEEK)) {
+		if (str[DATESEP_YEAR_OFFS] != DATESEP_YEAR) {
+			scanerr_set(pErr, SCANERR_SEPARATOR, SCANERR_FIELD_NONE,
+				DATESEP_YEAR_OFFS, 0);
+			result = false;
+		
+		} else if (str[DATESEP_WEEK_OFFS] != DATESEP_WEEK) {
+			scanerr_set(pErr, SCANERR_SEPARATOR, SCANERR_FIELD_NONE,
+				DATESEP_WEEK_OFFS, 0);
 			result = false;
 		}
 	}
 	
 	/* Read each of the individual fields of the date */
 	if (result) {
-		if (!base24_pairToInt(&(str[DATEFIELD_YEAR]), &s_year)) {
-			result = false;
-		}
-		
 		s_month = base24_digitToInt(str[DATEFIELD_MONTH]);
 		s_week  = base24_digitToInt(str[DATEFIELD_WEEK ]);
 		s_day   = base24_digitToInt(str[DATEFIELD_DAY  ]);
 		
-		if ((s_month == -1) || (s_week == -1) || (s_day == -1)) {
+		if (!base24_pairToInt(&(str[DATEFIELD_YEAR]), &s_year)) {
+			scanerr_set(pErr, SCANERR_DIGIT, SCANERR_FIELD_YEAR,
+				DATEFIELD_YEAR, 0);
+			result = false;
+		
+		} else if (s_month == -1) {
+			scanerr_set(pErr, SCANERR_DIGIT, SCANERR_FIELD_MONTH,
+				DATEFIELD_MONTH, 0);
+			result = false;
+		
+		} else if (s_week == -1) {
+			scanerr_set(pErr, SCANERR_DIGIT, SCANERR_FIELD_WEEK,
+				DATEFIELD_WEEK, 0);
+			result = false;
+		
+		} else if (s_day == -1) {
+			scanerr_set(pErr, SCANERR_DIGIT, SCANERR_FIELD_DAY,
+				DATEFIELD_DAY, 0);
 			result = false;
 		}
 	}
@@ -233,16 +425,16 @@ bool nelsc_format_scanDate(const char *str, int32_t *pOffset) {
 	 * to the absolute month offset of the first month of the year to
 	 * yield the absolute month offset of the date */
 	if (result) {
-		if (nelsc_cycle_isLongYear(s_year)) {
-			/* Long year */
-			if ((s_month < 1) || (s_month > MONTHS_PER_LONG_YEAR)) {
-				result = false;
-			}
-		} else {
-			/* Short year */
-			if ((s_month < 1) || (s_month > MONTHS_PER_SHORT_YEAR)) {
-				result = false;
-			}
+		if ((s_month < 1) || (s_month > MONTHS_PER_LONG_YEAR)) {
+			scanerr_set(pErr, SCANERR_RANGE, SCANERR_FIELD_MONTH,
+				DATEFIELD_MONTH, s_month);
+			result = false;
+		
+		} else if ((s_month > MONTHS_PER_SHORT_YEAR) &&
+				(!nelsc_cycle_isLongYear(s_year))) {
+			scanerr_set(pErr, SCANERR_YEAR_END, SCANERR_FIELD_MONTH,
+				DATEFIELD_MONTH, s_month);
+			result = false;
 		}
 	}
 	
@@ -259,16 +451,16 @@ bool nelsc_format_scanDate(const char *str, int32_t *pOffset) {
 	 * length of the month, convert it to a zero-based offset, and add
 	 * the corresponding number of days to the day offset */
 	if (result) {
-		if (nelsc_cycle_isLongMonth(abs_month)) {
-			/* Long month */
-			if ((s_week < 1) || (s_week > WEEKS_PER_LONG_MONTH)) {
-				result = false;
-			}
-		} else {
-			/* Short month */
-			if ((s_week < 1) || (s_week > WEEKS_PER_SHORT_MONTH)) {
-				result = false;
-			}
+		if ((s_week < 1) || (s_week > WEEKS_PER_LONG_MONTH)) {
+			scanerr_set(pErr, SCANERR_RANGE, SCANERR_FIELD_WEEK,
+				DATEFIELD_WEEK, s_week);
+			result = false;
+		
+		} else if ((s_week > WEEKS_PER_SHORT_MONTH) &&
+				(!nelsc_cycle_isLongMonth(abs_month))) {
+			scanerr_set(pErr, SCANERR_MONTH_END, SCANERR_FIELD_WEEK,
+				DATEFIELD_WEEK, s_week);
+			result = false;
 		}
 	}
 	
@@ -281,6 +473,8 @@ bool nelsc_format_scanDate(const char *str, int32_t *pOffset) {
 	 * offset of the date */
 	if (result) {
 		if ((s_day < 1) || (s_day > DAYS_PER_WEEK)) {
+			scanerr_set(pErr, SCANERR_RANGE, SCANERR_FIELD_DAY,
+				DATEFIELD_DAY, s_day);
 			result = false;
 		}
 	}
@@ -296,6 +490,137 @@ bool nelsc_format_scanDate(const char *str, int32_t *pOffset) {
 		}
 	}
 	
+	NELSC_STATS_END(NELSC_PROBE_FORMAT_SCANDATE, stats_start, result);
+	
 	/* Return status */
 	return result;
 }
+
+/*
+ * nelsc_format_fieldsToKey function.
+ */
+void nelsc_format_fieldsToKey(
+		uint8_t *pKey,
+		int32_t y,
+		int32_t m,
+		int32_t w,
+		int32_t d) {
+	
+	/* Check parameters */
+	if (pKey == NULL) {
+		abort();
+	}
+	if ((y < BASE24_PAIR_MIN) || (y > BASE24_PAIR_MAX) ||
+			(m < 1) || (m > MONTHS_PER_LONG_YEAR) ||
+			(w < 1) || (w > WEEKS_PER_LONG_MONTH) ||
+			(d < 1) || (d > DAYS_PER_WEEK)) {
+		abort();
+	}
+	
+	y -= BASE24_PAIR_MIN;
+	pKey[0] = (uint8_t) (y >> 8);
+	pKey[1] = (uint8_t) (y & 0xff);
+	pKey[2] = (uint8_t) m;
+	pKey[3] = (uint8_t) ((w << 4) | d);
+}
+
+/*
+ * nelsc_format_dateToKey function.
+ */
+bool nelsc_format_dateToKey(
+		uint8_t *pKey,
+		const char *str,
+		SCANERR *pErr) {
+	
+	bool result = true;
+	int32_t x = 0;
+	
+	/* Check parameters */
+	if ((pKey == NULL) || (str == NULL)) {
+		abort();
+	}
+	
+	/* Fail if a null termination character occurs within the date */
+	for(x = 0; x < NELSC_FORMAT_DATE_LENGTH; x++) {
+		if (str[x] == 0) {
+			scanerr_set(pErr, SCANERR_END, SCANERR_FIELD_NONE, x, 0);
+			result = false;
+			break;
+		}
+	}
+	
+	if (result) {
+		result = scanKey(pKey, str, pErr);
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_format_dateToKeyBatch function.
+ */
+size_t nelsc_format_dateToKeyBatch(
+		uint8_t *pKeys,
+		const char *pDates,
+		size_t count,
+		SCANERR *pErr) {
+	
+	size_t i = 0;
+	
+	/* Check parameters */
+	if ((count > 0) && ((pKeys == NULL) || (pDates == NULL))) {
+		abort();
+	}
+	
+	for(i = 0; i < count; i++) {
+		if (!scanKey(pKeys, pDates, pErr)) {
+			break;
+		}
+		pKeys += NELSC_FORMAT_KEY_LENGTH;
+		pDates += NELSC_FORMAT_DATE_LENGTH;
+	}
+	
+	return i;
+}
+
+/*
+ * nelsc_format_keyToDate function.
+ */
+bool nelsc_format_keyToDate(char *pBuf, const uint8_t *pKey) {
+	
+	bool result = true;
+	int32_t y = 0;
+	int32_t m = 0;
+	int32_t w = 0;
+	int32_t d = 0;
+	
+	/* Check parameters */
+	if ((pBuf == NULL) || (pKey == NULL)) {
+		abort();
+	}
+	
+	/* Unpack and check the fields */
+	y = (((int32_t) pKey[0]) << 8) | ((int32_t) pKey[1]);
+	m = (int32_t) pKey[2];
+	w = (int32_t) (pKey[3] >> 4);
+	d = (int32_t) (pKey[3] & 0xf);
+	
+	if ((y >= YEAR_COUNT) ||
+			(m < 1) || (m > MONTHS_PER_LONG_YEAR) ||
+			(w < 1) || (w > WEEKS_PER_LONG_MONTH) ||
+			(d < 1) || (d > DAYS_PER_WEEK)) {
+		result = false;
+	}
+	
+	/* Write the date */
+	if (result) {
+		base24_writePair(pBuf + DATEFIELD_YEAR, y + BASE24_PAIR_MIN);
+		pBuf[DATESEP_YEAR_OFFS] = DATESEP_YEAR;
+		pBuf[DATEFIELD_MONTH] = base24_intToDigit(m);
+		pBuf[DATEFIELD_WEEK] = (char) ('0' + w);
+		pBuf[DATESEP_WEEK_OFFS] = DATESEP_WEEK;
+		pBuf[DATEFIELD_DAY] = (char) ('0' + d);
+	}
+	
+	return result;
+}
@@ -15,12 +15,63 @@
 
 #include "base24.h"
 #include "nelsc_cycle.h"
+#include "scanerr.h"
 
 /*
  * The number of characters in a formatted NELSC date.
  */
 #define NELSC_FORMAT_DATE_LENGTH 7
 
+/*
+ * The number of bytes in a NELSC date key.
+ * 
+ * A key is the year (offset by -BASE24_PAIR_MIN) as a big-endian 16-bit
+ * value, then the month, then the week in the high four bits of the
+ * last byte and the day of the week in the low four bits.  Comparing
+ * two keys with memcmp() therefore orders them by date, unlike the
+ * NELSC strings themselves, where base-24 digits are not in ASCII order
+ * and negative years start with T, V, X, or Y.
+ */
+#define NELSC_FORMAT_KEY_LENGTH 4
+
+/*
+ * Write a formatted NELSC date into the given character buffer in ASCII
+ * format.
+ * 
+ * Exactly NELSC_FORMAT_DATE_LENGTH characters are written.  No
+ * terminating null is written.
+ * 
+ * The format and the meaning of the y, m, and d arguments are the same
+ * as for nelsc_format_printDate().
+ * 
+ * Parameters:
+ * 
+ *   pBuf - the buffer to write into
+ * 
+ *   y - the year
+ * 
+ *   m - the month of the year
+ * 
+ *   d - the day of the month
+ * 
+ * Faults:
+ * 
+ *   - If pBuf is NULL
+ * 
+ *   - If y, m, and d are not a valid NELSC combination of year, month,
+ *     and day in month
+ * 
+ * Undefined behavior:
+ * 
+ *   - If pBuf has room for fewer than NELSC_FORMAT_DATE_LENGTH
+ *     characters
+ */
+void nelsc_format_writeDate(
+		char *pBuf,
+		int32_t y,
+		int32_t m,
+		int32_t d);
+
 /*
  * Print a formatted NELSC date to the given file in ASCII format.
  * 
@@ -91,7 +142,8 @@ void nelsc_format_printDate(
  * absolute day offset indicated by the provided date is written to
  * *pOffset, if pOffset is not NULL.  (Passing a NULL pOffset can be
  * useful for just checking whether a valid NELSC date is present.)  If
- * the conversion fails, false is returned.
+ * the conversion fails, false is returned, and if pErr is not NULL, the
+ * reason is written to *pErr.
  * 
  * This function will apply all the NELSC rules to verify the specific
  * date is valid.  So, for example, if the fifth week is specified for
@@ -105,6 +157,9 @@ void nelsc_format_printDate(
  *   pOffset - pointer to the variable to receive the parsed NELSC day
  *   offset if the function succeeds, or NULL
  * 
+ *   pErr - pointer to the structure to receive the reason if the
+ *   function fails, or NULL
+ * 
  * Return:
  * 
  *   true if conversion is successful, false if the characters at str
@@ -114,6 +169,151 @@ void nelsc_format_printDate(
  * 
  *   - If the string at *str is not null-terminated
  */
-bool nelsc_format_scanDate(const char *str, int32_t *pOffset);
+bool nelsc_format_scanDate(
+		const char *str,
+		int32_t *pOffset,
+		SCANERR *pErr);
+
+/*
+ * Make the sort key of a NELSC date from its fields.
+ * 
+ * Exactly NELSC_FORMAT_KEY_LENGTH bytes are written.  The fields are
+ * one-based, as they appear in the formatted date.
+ * 
+ * Parameters:
+ * 
+ *   pKey - the buffer to write the key into
+ * 
+ *   y - the year
+ * 
+ *   m - the month of the year, one up to 13
+ * 
+ *   w - the week of the month, one up to 5
+ * 
+ *   d - the day of the week, one up to 7
+ * 
+ * Faults:
+ * 
+ *   - If pKey is NULL
+ * 
+ *   - If any field is out of range
+ */
+void nelsc_format_fieldsToKey(
+		uint8_t *pKey,
+		int32_t y,
+		int32_t m,
+		int32_t w,
+		int32_t d);
+
+/*
+ * Make the sort key of a formatted NELSC date.
+ * 
+ * The string is read in the same way as nelsc_format_scanDate(), and
+ * parse errors are reported the same way, but the date is never
+ * converted to a day offset.  Each field is only checked against its
+ * full range, so a key is made for the thirteenth month of a short year
+ * or the fifth week of a short month, which sorts where that date would
+ * be if the year or month were long.  Use nelsc_format_scanDate() when
+ * the date must be valid.
+ * 
+ * Parameters:
+ * 
+ *   pKey - the buffer to write the NELSC_FORMAT_KEY_LENGTH bytes of the
+ *   key into
+ * 
+ *   str - the ASCII-formatted NELSC date
+ * 
+ *   pErr - pointer to the structure to receive the reason if the
+ *   function fails, or NULL
+ * 
+ * Return:
+ * 
+ *   true if successful, false if the characters at str don't form a
+ *   NELSC date
+ * 
+ * Faults:
+ * 
+ *   - If pKey or str is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If the string at *str is not null-terminated
+ */
+bool nelsc_format_dateToKey(
+		uint8_t *pKey,
+		const char *str,
+		SCANERR *pErr);
+
+/*
+ * Make the sort keys of an array of formatted NELSC dates.
+ * 
+ * The dates are stored back to back, NELSC_FORMAT_DATE_LENGTH
+ * characters each, with no separators or terminating nulls, as in a
+ * fixed-width column.  The keys are written back to back in the same
+ * order.  Each date is checked as by nelsc_format_dateToKey().
+ * Conversion stops at the first date that fails, and if pErr is not
+ * NULL, the reason is written to *pErr with the position counted from
+ * the start of that date.
+ * 
+ * Parameters:
+ * 
+ *   pKeys - the buffer to write count keys into
+ * 
+ *   pDates - the dates
+ * 
+ *   count - the number of dates
+ * 
+ *   pErr - pointer to the structure to receive the reason if a date
+ *   fails, or NULL
+ * 
+ * Return:
+ * 
+ *   the number of keys written, which is count if every date was
+ *   converted, or else the index of the date that failed
+ * 
+ * Faults:
+ * 
+ *   - If count is greater than zero and pKeys or pDates is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If pDates has fewer than count dates or pKeys has room for fewer
+ *     than count keys
+ */
+size_t nelsc_format_dateToKeyBatch(
+		uint8_t *pKeys,
+		const char *pDates,
+		size_t count,
+		SCANERR *pErr);
+
+/*
+ * Write the formatted NELSC date of a sort key.
+ * 
+ * Exactly NELSC_FORMAT_DATE_LENGTH characters are written if the key is
+ * valid.  No terminating null is written.  The key is only checked
+ * field by field, as in nelsc_format_dateToKey(), so every key made by
+ * that function can be turned back into its string.
+ * 
+ * Parameters:
+ * 
+ *   pBuf - the buffer to write into
+ * 
+ *   pKey - the NELSC_FORMAT_KEY_LENGTH bytes of the key
+ * 
+ * Return:
+ * 
+ *   true if successful, false if a field of the key is out of range, in
+ *   which case nothing is written
+ * 
+ * Faults:
+ * 
+ *   - If pBuf or pKey is NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If pBuf has room for fewer than NELSC_FORMAT_DATE_LENGTH
+ *     characters
+ */
+bool nelsc_format_keyToDate(char *pBuf, const uint8_t *pKey);
 
 #endif
@@ -0,0 +1,259 @@
+/*
+ * nelsc_hist.c
+ * 
+ * Implementation of nelsc_hist.h
+ * 
+ * See the header for further information.
+ */
+
+#include "nelsc_hist.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * The number of bits of precision within each power of two range, and
+ * the resulting number of buckets in each range.
+ */
+#define HIST_SUB_BITS 5
+#define HIST_SUB_COUNT (1 << HIST_SUB_BITS)
+
+/*
+ * The total number of buckets.
+ * 
+ * Values below 2 * HIST_SUB_COUNT get a bucket each, which takes the
+ * first two ranges.  Each further most significant bit position up to
+ * 63 adds one more range.
+ */
+#define HIST_BUCKETS ((64 - HIST_SUB_BITS + 1) * HIST_SUB_COUNT)
+
+/*
+ * NELSC_HIST structure.
+ * 
+ * Prototype given in the header.
+ */
+struct NELSC_HIST_TAG {
+	
+	/*
+	 * The number of values recorded in each bucket.
+	 */
+	uint64_t buckets[HIST_BUCKETS];
+	
+	/*
+	 * The total number of values recorded.
+	 */
+	uint64_t count;
+	
+	/*
+	 * The largest value recorded.
+	 */
+	uint64_t max;
+};
+
+/*
+ * Function prototypes
+ */
+static int highBit(uint64_t v);
+static int bucketIndex(uint64_t v);
+static uint64_t bucketTop(int i);
+
+/*
+ * Find the most significant set bit of a value.
+ * 
+ * Parameters:
+ * 
+ *   v - the value, which must not be zero
+ * 
+ * Return:
+ * 
+ *   the bit position, in range 0 up to 63
+ */
+static int highBit(uint64_t v) {
+	
+	int result = 0;
+	int step = 0;
+	
+	for(step = 32; step > 0; step /= 2) {
+		if ((v >> step) != 0) {
+			v >>= step;
+			result += step;
+		}
+	}
+	
+	return result;
+}
+
+/*
+ * Find the bucket of a value.
+ * 
+ * Parameters:
+ * 
+ *   v - the value
+ * 
+ * Return:
+ * 
+ *   the bucket index
+ */
+static int bucketIndex(uint64_t v) {
+	
+	int shift = 0;
+	int result = 0;
+	
+	if (v < (uint64_t) (2 * HIST_SUB_COUNT)) {
+		result = (int) v;
+	
+	} else {
+		shift = highBit(v) - HIST_SUB_BITS;
+		result = ((shift + 1) * HIST_SUB_COUNT) +
+					((int) (v >> shift) - HIST_SUB_COUNT);
+	}
+	
+	return result;
+}
+
+/*
+ * Find the highest value that falls in a bucket.
+ * 
+ * Parameters:
+ * 
+ *   i - the bucket index
+ * 
+ * Return:
+ * 
+ *   the highest value of the bucket
+ */
+static uint64_t bucketTop(int i) {
+	
+	int shift = 0;
+	uint64_t top = 0;
+	uint64_t result = 0;
+	
+	if (i < 2 * HIST_SUB_COUNT) {
+		result = (uint64_t) i;
+	
+	} else {
+		shift = (i / HIST_SUB_COUNT) - 1;
+		top = (uint64_t) (HIST_SUB_COUNT + (i % HIST_SUB_COUNT));
+		result = (top << shift) + ((((uint64_t) 1) << shift) - 1);
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_hist_new function.
+ */
+NELSC_HIST *nelsc_hist_new(void) {
+	
+	NELSC_HIST *pHist = NULL;
+	
+	pHist = (NELSC_HIST *) malloc(sizeof(NELSC_HIST));
+	if (pHist == NULL) {
+		abort();
+	}
+	nelsc_hist_clear(pHist);
+	
+	return pHist;
+}
+
+/*
+ * nelsc_hist_free function.
+ */
+void nelsc_hist_free(NELSC_HIST *pHist) {
+	free(pHist);
+}
+
+/*
+ * nelsc_hist_clear function.
+ */
+void nelsc_hist_clear(NELSC_HIST *pHist) {
+	
+	/* Check parameters */
+	if (pHist == NULL) {
+		abort();
+	}
+	
+	memset(pHist, 0, sizeof(NELSC_HIST));
+}
+
+/*
+ * nelsc_hist_record function.
+ */
+void nelsc_hist_record(NELSC_HIST *pHist, uint64_t v) {
+	
+	/* Check parameters */
+	if (pHist == NULL) {
+		abort();
+	}
+	
+	(pHist->buckets[bucketIndex(v)])++;
+	(pHist->count)++;
+	if (v > pHist->max) {
+		pHist->max = v;
+	}
+}
+
+/*
+ * nelsc_hist_count function.
+ */
+uint64_t nelsc_hist_count(const NELSC_HIST *pHist) {
+	
+	/* Check parameters */
+	if (pHist == NULL) {
+		abort();
+	}
+	
+	return pHist->count;
+}
+
+/*
+ * nelsc_hist_max function.
+ */
+uint64_t nelsc_hist_max(const NELSC_HIST *pHist) {
+	
+	/* Check parameters */
+	if (pHist == NULL) {
+		abort();
+	}
+	
+	return pHist->max;
+}
+
+/*
+ * nelsc_hist_percentile function.
+ */
+uint64_t nelsc_hist_percentile(const NELSC_HIST *pHist, int permille) {
+	
+	uint64_t rank = 0;
+	uint64_t seen = 0;
+	uint64_t result = 0;
+	int i = 0;
+	
+	/* Check parameters */
+	if ((pHist == NULL) || (permille < 0) || (permille > 1000)) {
+		abort();
+	}
+	
+	/* Find the number of values that must lie at or below the result,
+	 * rounding up and counting at least one value */
+	if (pHist->count > 0) {
+		rank = ((pHist->count * (uint64_t) permille) + 999) / 1000;
+		if (rank < 1) {
+			rank = 1;
+		}
+		
+		/* Walk the buckets until enough values have been seen */
+		for(i = 0; i < HIST_BUCKETS; i++) {
+			seen += pHist->buckets[i];
+			if (seen >= rank) {
+				break;
+			}
+		}
+		
+		result = bucketTop(i);
+		if (result > pHist->max) {
+			result = pHist->max;
+		}
+	}
+	
+	return result;
+}
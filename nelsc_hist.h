@@ -0,0 +1,145 @@
+#ifndef NELSC_HIST_H_INCLUDED
+#define NELSC_HIST_H_INCLUDED
+
+/*
+ * nelsc_hist.h
+ * 
+ * Provides histograms of unsigned 64-bit values, such as latencies in
+ * nanoseconds, with log-bucketed precision in the style of HDR
+ * histograms.
+ * 
+ * Values below 64 are counted exactly.  Above that, each power of two
+ * range is split into 32 equal buckets, so that any recorded value is
+ * known to within about three percent.  This covers the whole 64-bit
+ * range with a fixed number of buckets, and recording a value takes
+ * constant time.
+ * 
+ * Percentiles are reported as the highest value in the bucket holding
+ * the requested rank, but never more than the largest value recorded.
+ */
+
+#include <stdint.h>
+
+/*
+ * NELSC_HIST structure prototype.
+ * 
+ * See the implementation file for definition.
+ */
+struct NELSC_HIST_TAG;
+typedef struct NELSC_HIST_TAG NELSC_HIST;
+
+/*
+ * Create a new, empty histogram.
+ * 
+ * The histogram must eventually be released with nelsc_hist_free().
+ * 
+ * Return:
+ * 
+ *   the new histogram
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+NELSC_HIST *nelsc_hist_new(void);
+
+/*
+ * Release a histogram.
+ * 
+ * Does nothing if pHist is NULL.
+ * 
+ * Parameters:
+ * 
+ *   pHist - the histogram to release, or NULL
+ */
+void nelsc_hist_free(NELSC_HIST *pHist);
+
+/*
+ * Remove all recorded values from a histogram.
+ * 
+ * Parameters:
+ * 
+ *   pHist - the histogram
+ * 
+ * Faults:
+ * 
+ *   - If pHist is NULL
+ */
+void nelsc_hist_clear(NELSC_HIST *pHist);
+
+/*
+ * Record a value in a histogram.
+ * 
+ * Parameters:
+ * 
+ *   pHist - the histogram
+ * 
+ *   v - the value to record
+ * 
+ * Faults:
+ * 
+ *   - If pHist is NULL
+ */
+void nelsc_hist_record(NELSC_HIST *pHist, uint64_t v);
+
+/*
+ * Get the number of values recorded in a histogram.
+ * 
+ * Parameters:
+ * 
+ *   pHist - the histogram
+ * 
+ * Return:
+ * 
+ *   the number of values
+ * 
+ * Faults:
+ * 
+ *   - If pHist is NULL
+ */
+uint64_t nelsc_hist_count(const NELSC_HIST *pHist);
+
+/*
+ * Get the largest value recorded in a histogram.
+ * 
+ * Parameters:
+ * 
+ *   pHist - the histogram
+ * 
+ * Return:
+ * 
+ *   the largest value, or zero if the histogram is empty
+ * 
+ * Faults:
+ * 
+ *   - If pHist is NULL
+ */
+uint64_t nelsc_hist_max(const NELSC_HIST *pHist);
+
+/*
+ * Get a percentile of the values recorded in a histogram.
+ * 
+ * The percentile is given in thousandths, so that 500 is the median,
+ * 990 is the 99th percentile, and 999 is the 99.9th percentile.  The
+ * result is the smallest bucket value at or below which at least that
+ * fraction of the recorded values lie.
+ * 
+ * Parameters:
+ * 
+ *   pHist - the histogram
+ * 
+ *   permille - the percentile in thousandths, in range 0 up to 1000
+ * 
+ * Return:
+ * 
+ *   the percentile value, or zero if the histogram is empty
+ * 
+ * Faults:
+ * 
+ *   - If pHist is NULL
+ * 
+ *   - If permille is out of range
+ */
+uint64_t nelsc_hist_percentile(const NELSC_HIST *pHist, int permille);
+
+#endif
@@ -0,0 +1,514 @@
+/*
+ * nelsc_pool.c
+ * 
+ * Implementation of nelsc_pool.h
+ * 
+ * See the header for further information.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "nelsc_pool.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * The chunk queue of a single worker.
+ * 
+ * The queue holds the chunk indices from lo up to but excluding hi.
+ * The owning worker takes chunks from lo and thieves take chunks from
+ * hi, both while holding the lock.
+ */
+typedef struct {
+	
+	/*
+	 * Lock protecting lo and hi.
+	 */
+	pthread_mutex_t lock;
+	
+	/*
+	 * The first chunk index remaining in the queue.
+	 */
+	int32_t lo;
+	
+	/*
+	 * One past the last chunk index remaining in the queue.
+	 */
+	int32_t hi;
+
+} POOL_QUEUE;
+
+/*
+ * The start parameter of a worker thread.
+ */
+typedef struct {
+	
+	/*
+	 * The pool the worker belongs to.
+	 */
+	NELSC_POOL *pPool;
+	
+	/*
+	 * The index of the worker, which is also the index of its queue.
+	 */
+	int32_t index;
+
+} POOL_WORKER;
+
+/*
+ * NELSC_POOL structure.
+ * 
+ * Prototype given in the header.
+ */
+struct NELSC_POOL_TAG {
+	
+	/*
+	 * The total number of workers, including the thread that runs jobs,
+	 * which is always worker zero.
+	 */
+	int32_t workers;
+	
+	/*
+	 * The started threads, for workers one up to workers - 1.
+	 */
+	pthread_t *pThreads;
+	
+	/*
+	 * The start parameters of the started threads.
+	 */
+	POOL_WORKER *pParams;
+	
+	/*
+	 * The chunk queues of all the workers.
+	 */
+	POOL_QUEUE *pQueues;
+	
+	/*
+	 * Lock that makes jobs run one after the other.
+	 */
+	pthread_mutex_t run_lock;
+	
+	/*
+	 * Lock protecting the fields below.
+	 */
+	pthread_mutex_t lock;
+	
+	/*
+	 * Signalled when a new job starts or the pool is being released.
+	 */
+	pthread_cond_t wake;
+	
+	/*
+	 * Signalled when a started thread finishes its part of a job.
+	 */
+	pthread_cond_t done;
+	
+	/*
+	 * Incremented each time a new job starts.
+	 */
+	uint32_t generation;
+	
+	/*
+	 * The number of started threads still working on the current job.
+	 */
+	int32_t active;
+	
+	/*
+	 * Set when the started threads should stop.
+	 */
+	bool quit;
+	
+	/*
+	 * The task function of the current job.
+	 */
+	NELSC_POOL_TASK task;
+	
+	/*
+	 * The custom data of the current job.
+	 */
+	void *pCustom;
+};
+
+/*
+ * Function prototypes
+ */
+static bool takeChunk(
+		NELSC_POOL *pPool, int32_t index, int32_t *pChunk);
+static void runWorker(NELSC_POOL *pPool, int32_t index);
+static void *threadMain(void *pParam);
+
+/*
+ * Take the next chunk for a worker.
+ * 
+ * The chunk is taken from the front of the worker's own queue if it
+ * is not empty.  Otherwise, a chunk is stolen from the back of the
+ * first non-empty queue of another worker, checking the other workers
+ * in turn starting after this one.
+ * 
+ * Parameters:
+ * 
+ *   pPool - the pool
+ * 
+ *   index - the index of the worker
+ * 
+ *   pChunk - pointer to the variable to receive the chunk index
+ * 
+ * Return:
+ * 
+ *   true if a chunk was taken, false if all queues are empty
+ */
+static bool takeChunk(
+		NELSC_POOL *pPool, int32_t index, int32_t *pChunk) {
+	
+	bool result = false;
+	int32_t i = 0;
+	int32_t v = 0;
+	POOL_QUEUE *pq = NULL;
+	
+	/* Try the worker's own queue first */
+	pq = &((pPool->pQueues)[index]);
+	if (pthread_mutex_lock(&(pq->lock)) != 0) {
+		abort();
+	}
+	if (pq->lo < pq->hi) {
+		*pChunk = pq->lo;
+		(pq->lo)++;
+		result = true;
+	}
+	if (pthread_mutex_unlock(&(pq->lock)) != 0) {
+		abort();
+	}
+	
+	/* Steal from the other workers */
+	for(i = 1; (!result) && (i < pPool->workers); i++) {
+		v = (index + i) % pPool->workers;
+		pq = &((pPool->pQueues)[v]);
+		
+		if (pthread_mutex_lock(&(pq->lock)) != 0) {
+			abort();
+		}
+		if (pq->lo < pq->hi) {
+			(pq->hi)--;
+			*pChunk = pq->hi;
+			result = true;
+		}
+		if (pthread_mutex_unlock(&(pq->lock)) != 0) {
+			abort();
+		}
+	}
+	
+	return result;
+}
+
+/*
+ * Process chunks of the current job as a given worker until no chunks
+ * remain in any queue.
+ * 
+ * Parameters:
+ * 
+ *   pPool - the pool
+ * 
+ *   index - the index of the worker
+ */
+static void runWorker(NELSC_POOL *pPool, int32_t index) {
+	
+	int32_t chunk = 0;
+	
+	while (takeChunk(pPool, index, &chunk)) {
+		(*(pPool->task))(pPool->pCustom, chunk);
+	}
+}
+
+/*
+ * The start function of the started worker threads.
+ * 
+ * Each thread waits for a new job, takes part in it, reports that it
+ * is done, and then waits again, until the pool is released.
+ * 
+ * Parameters:
+ * 
+ *   pParam - pointer to the POOL_WORKER of the thread
+ * 
+ * Return:
+ * 
+ *   always NULL
+ */
+static void *threadMain(void *pParam) {
+	
+	POOL_WORKER *pw = NULL;
+	NELSC_POOL *pPool = NULL;
+	uint32_t seen = 0;
+	
+	pw = (POOL_WORKER *) pParam;
+	pPool = pw->pPool;
+	
+	/* The thread starts out having seen generation zero, which is the
+	 * generation when the pool is created, so a job started before the
+	 * thread gets here is not missed */
+	if (pthread_mutex_lock(&(pPool->lock)) != 0) {
+		abort();
+	}
+	
+	while (true) {
+		/* Wait for a new job or for the pool to be released */
+		while ((!(pPool->quit)) && (pPool->generation == seen)) {
+			if (pthread_cond_wait(
+					&(pPool->wake), &(pPool->lock)) != 0) {
+				abort();
+			}
+		}
+		if (pPool->quit) {
+			break;
+		}
+		seen = pPool->generation;
+		
+		/* Take part in the job without holding the pool lock */
+		if (pthread_mutex_unlock(&(pPool->lock)) != 0) {
+			abort();
+		}
+		runWorker(pPool, pw->index);
+		if (pthread_mutex_lock(&(pPool->lock)) != 0) {
+			abort();
+		}
+		
+		/* Report that this thread is done */
+		(pPool->active)--;
+		if (pPool->active < 1) {
+			if (pthread_cond_signal(&(pPool->done)) != 0) {
+				abort();
+			}
+		}
+	}
+	
+	if (pthread_mutex_unlock(&(pPool->lock)) != 0) {
+		abort();
+	}
+	
+	return NULL;
+}
+
+/*
+ * nelsc_pool_new function.
+ */
+NELSC_POOL *nelsc_pool_new(int32_t workers) {
+	
+	NELSC_POOL *pPool = NULL;
+	long online = 0;
+	int32_t i = 0;
+	
+	/* Check parameters */
+	if ((workers < 0) || (workers > NELSC_POOL_MAX_WORKERS)) {
+		abort();
+	}
+	
+	/* Choose the number of workers if requested */
+	if (workers < 1) {
+		online = sysconf(_SC_NPROCESSORS_ONLN);
+		if (online < 1) {
+			workers = 1;
+		} else if (online > NELSC_POOL_MAX_WORKERS) {
+			workers = NELSC_POOL_MAX_WORKERS;
+		} else {
+			workers = (int32_t) online;
+		}
+	}
+	
+	/* Allocate the pool structure and its arrays */
+	pPool = (NELSC_POOL *) malloc(sizeof(NELSC_POOL));
+	if (pPool == NULL) {
+		abort();
+	}
+	memset(pPool, 0, sizeof(NELSC_POOL));
+	
+	pPool->workers = workers;
+	pPool->pThreads = NULL;
+	pPool->pParams = NULL;
+	pPool->generation = 0;
+	pPool->active = 0;
+	pPool->quit = false;
+	pPool->task = NULL;
+	pPool->pCustom = NULL;
+	
+	pPool->pQueues = (POOL_QUEUE *) malloc(
+						((size_t) workers) * sizeof(POOL_QUEUE));
+	if (pPool->pQueues == NULL) {
+		abort();
+	}
+	
+	if (workers > 1) {
+		pPool->pThreads = (pthread_t *) malloc(
+						((size_t) (workers - 1)) * sizeof(pthread_t));
+		pPool->pParams = (POOL_WORKER *) malloc(
+						((size_t) (workers - 1)) * sizeof(POOL_WORKER));
+		if ((pPool->pThreads == NULL) || (pPool->pParams == NULL)) {
+			abort();
+		}
+	}
+	
+	/* Initialize the synchronization objects */
+	for(i = 0; i < workers; i++) {
+		if (pthread_mutex_init(
+				&((pPool->pQueues)[i].lock), NULL) != 0) {
+			abort();
+		}
+		(pPool->pQueues)[i].lo = 0;
+		(pPool->pQueues)[i].hi = 0;
+	}
+	
+	if ((pthread_mutex_init(&(pPool->run_lock), NULL) != 0) ||
+			(pthread_mutex_init(&(pPool->lock), NULL) != 0) ||
+			(pthread_cond_init(&(pPool->wake), NULL) != 0) ||
+			(pthread_cond_init(&(pPool->done), NULL) != 0)) {
+		abort();
+	}
+	
+	/* Start the worker threads */
+	for(i = 1; i < workers; i++) {
+		(pPool->pParams)[i - 1].pPool = pPool;
+		(pPool->pParams)[i - 1].index = i;
+		if (pthread_create(
+				&((pPool->pThreads)[i - 1]),
+				NULL,
+				&threadMain,
+				&((pPool->pParams)[i - 1])) != 0) {
+			abort();
+		}
+	}
+	
+	return pPool;
+}
+
+/*
+ * nelsc_pool_free function.
+ */
+void nelsc_pool_free(NELSC_POOL *pPool) {
+	
+	int32_t i = 0;
+	
+	if (pPool != NULL) {
+		/* Stop the worker threads */
+		if (pthread_mutex_lock(&(pPool->lock)) != 0) {
+			abort();
+		}
+		pPool->quit = true;
+		if (pthread_cond_broadcast(&(pPool->wake)) != 0) {
+			abort();
+		}
+		if (pthread_mutex_unlock(&(pPool->lock)) != 0) {
+			abort();
+		}
+		
+		for(i = 1; i < pPool->workers; i++) {
+			if (pthread_join((pPool->pThreads)[i - 1], NULL) != 0) {
+				abort();
+			}
+		}
+		
+		/* Release the synchronization objects and memory */
+		for(i = 0; i < pPool->workers; i++) {
+			pthread_mutex_destroy(&((pPool->pQueues)[i].lock));
+		}
+		pthread_mutex_destroy(&(pPool->run_lock));
+		pthread_mutex_destroy(&(pPool->lock));
+		pthread_cond_destroy(&(pPool->wake));
+		pthread_cond_destroy(&(pPool->done));
+		
+		free(pPool->pThreads);
+		free(pPool->pParams);
+		free(pPool->pQueues);
+		free(pPool);
+	}
+}
+
+/*
+ * nelsc_pool_workers function.
+ */
+int32_t nelsc_pool_workers(const NELSC_POOL *pPool) {
+	
+	/* Check parameters */
+	if (pPool == NULL) {
+		abort();
+	}
+	
+	return pPool->workers;
+}
+
+/*
+ * nelsc_pool_run function.
+ */
+void nelsc_pool_run(
+		NELSC_POOL *pPool,
+		NELSC_POOL_TASK task,
+		void *pCustom,
+		int32_t chunks) {
+	
+	int32_t i = 0;
+	int32_t share = 0;
+	int32_t extra = 0;
+	int32_t lo = 0;
+	
+	/* Check parameters */
+	if ((pPool == NULL) || (task == NULL) || (chunks < 0)) {
+		abort();
+	}
+	
+	/* Only one job at a time */
+	if (pthread_mutex_lock(&(pPool->run_lock)) != 0) {
+		abort();
+	}
+	
+	/* Deal out the chunks evenly in contiguous runs, so that each
+	 * worker mostly processes neighbouring chunks; no worker threads
+	 * are running, so the queues can be filled without locking */
+	share = chunks / pPool->workers;
+	extra = chunks % pPool->workers;
+	lo = 0;
+	for(i = 0; i < pPool->workers; i++) {
+		(pPool->pQueues)[i].lo = lo;
+		lo += share;
+		if (i < extra) {
+			lo++;
+		}
+		(pPool->pQueues)[i].hi = lo;
+	}
+	
+	/* Start the job on the worker threads */
+	if (pthread_mutex_lock(&(pPool->lock)) != 0) {
+		abort();
+	}
+	pPool->task = task;
+	pPool->pCustom = pCustom;
+	pPool->active = pPool->workers - 1;
+	(pPool->generation)++;
+	if (pthread_cond_broadcast(&(pPool->wake)) != 0) {
+		abort();
+	}
+	if (pthread_mutex_unlock(&(pPool->lock)) != 0) {
+		abort();
+	}
+	
+	/* Take part in the job as worker zero */
+	runWorker(pPool, 0);
+	
+	/* Wait for the worker threads to finish */
+	if (pthread_mutex_lock(&(pPool->lock)) != 0) {
+		abort();
+	}
+	while (pPool->active > 0) {
+		if (pthread_cond_wait(&(pPool->done), &(pPool->lock)) != 0) {
+			abort();
+		}
+	}
+	pPool->task = NULL;
+	pPool->pCustom = NULL;
+	if (pthread_mutex_unlock(&(pPool->lock)) != 0) {
+		abort();
+	}
+	
+	if (pthread_mutex_unlock(&(pPool->run_lock)) != 0) {
+		abort();
+	}
+}
@@ -0,0 +1,149 @@
+#ifndef NELSC_POOL_H_INCLUDED
+#define NELSC_POOL_H_INCLUDED
+
+/*
+ * nelsc_pool.h
+ * 
+ * Provides a work-stealing thread pool for running a job made up of a
+ * fixed number of independent chunks.
+ * 
+ * Each worker starts out with an even share of the chunks in its own
+ * queue and takes chunks from the front of it.  A worker that runs out
+ * of chunks steals from the back of the other workers' queues, so that
+ * chunks of uneven cost still keep all the workers busy.  The thread
+ * that runs a job takes part in it as one of the workers.
+ * 
+ * The pool uses POSIX threads.
+ */
+
+#include <stdint.h>
+
+/*
+ * The maximum number of workers in a pool, including the thread that
+ * runs jobs.
+ */
+#define NELSC_POOL_MAX_WORKERS 64
+
+/*
+ * Pointer to a function that processes a single chunk of a job.
+ * 
+ * The function may be called on any worker thread.  Different chunks
+ * of the same job may be processed at the same time, so the function
+ * must not modify anything shared between chunks without its own
+ * synchronization.
+ * 
+ * Parameters:
+ * 
+ *   pCustom - the custom data pointer passed to nelsc_pool_run()
+ * 
+ *   chunk - the index of the chunk to process
+ */
+typedef void (*NELSC_POOL_TASK)(void *pCustom, int32_t chunk);
+
+/*
+ * NELSC_POOL structure prototype.
+ * 
+ * See the implementation file for definition.
+ */
+struct NELSC_POOL_TAG;
+typedef struct NELSC_POOL_TAG NELSC_POOL;
+
+/*
+ * Create a new thread pool.
+ * 
+ * workers is the total number of workers, including the thread that
+ * runs jobs.  A pool with one worker starts no threads and runs all
+ * chunks on the calling thread.  If workers is zero, the number of
+ * online processors is used, limited to NELSC_POOL_MAX_WORKERS.
+ * 
+ * The pool must eventually be released with nelsc_pool_free().
+ * 
+ * Parameters:
+ * 
+ *   workers - the number of workers, or zero to choose automatically
+ * 
+ * Return:
+ * 
+ *   the new pool
+ * 
+ * Faults:
+ * 
+ *   - If workers is negative or greater than NELSC_POOL_MAX_WORKERS
+ * 
+ *   - If memory allocation fails
+ * 
+ *   - If a thread can't be started
+ */
+NELSC_POOL *nelsc_pool_new(int32_t workers);
+
+/*
+ * Release a thread pool.
+ * 
+ * The worker threads are stopped and joined.  Does nothing if pPool is
+ * NULL.
+ * 
+ * Parameters:
+ * 
+ *   pPool - the pool to release, or NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If a job is running on the pool
+ */
+void nelsc_pool_free(NELSC_POOL *pPool);
+
+/*
+ * Get the number of workers in a thread pool.
+ * 
+ * Parameters:
+ * 
+ *   pPool - the pool
+ * 
+ * Return:
+ * 
+ *   the number of workers, including the thread that runs jobs
+ * 
+ * Faults:
+ * 
+ *   - If pPool is NULL
+ */
+int32_t nelsc_pool_workers(const NELSC_POOL *pPool);
+
+/*
+ * Run a job on a thread pool.
+ * 
+ * The task function is called exactly once for each chunk index from
+ * zero up to chunks - 1, in no particular order and possibly at the
+ * same time on different threads.  This function returns once all the
+ * chunks have been processed.
+ * 
+ * Jobs run on the same pool from different threads are run one after
+ * the other.
+ * 
+ * Parameters:
+ * 
+ *   pPool - the pool
+ * 
+ *   task - the function that processes each chunk
+ * 
+ *   pCustom - custom data passed through to the task function
+ * 
+ *   chunks - the number of chunks in the job
+ * 
+ * Faults:
+ * 
+ *   - If pPool or task is NULL
+ * 
+ *   - If chunks is negative
+ * 
+ * Undefined behavior:
+ * 
+ *   - If called from within a task of a job running on the same pool
+ */
+void nelsc_pool_run(
+		NELSC_POOL *pPool,
+		NELSC_POOL_TASK task,
+		void *pCustom,
+		int32_t chunks);
+
+#endif
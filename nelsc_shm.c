@@ -0,0 +1,636 @@
+/*
+ * nelsc_shm.c
+ * 
+ * Implementation of nelsc_shm.h
+ * 
+ * See the header for further information.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "nelsc_shm.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#if !defined(__GNUC__)
+#error nelsc_shm requires the GCC atomic builtins
+#endif
+
+/*
+ * The magic value at the start of each segment.
+ */
+#define SHM_MAGIC "NELSCTBL"
+#define SHM_MAGIC_LEN 8
+
+/*
+ * The offset of the tables within the segment, which keeps them on
+ * their own cache lines after the header.
+ */
+#define SHM_TABLE_OFFSET 64
+
+/*
+ * The total size of a segment.
+ */
+#define SHM_SIZE (SHM_TABLE_OFFSET + sizeof(NELSC_TABLE))
+
+/*
+ * The longest time in nanoseconds that a reader waits for a publication
+ * in progress before it gives up.  Building the tables takes a few
+ * milliseconds.
+ */
+#define SHM_WAIT_NS INT64_C(1000000000)
+
+/*
+ * The header at the start of each segment.
+ */
+typedef struct {
+	
+	/*
+	 * The magic value SHM_MAGIC, without terminating nul.
+	 */
+	char magic[SHM_MAGIC_LEN];
+	
+	/*
+	 * The format version, NELSC_SHM_VERSION.
+	 */
+	uint32_t version;
+	
+	/*
+	 * The sequence lock.  Odd while the publisher is writing.
+	 */
+	uint32_t seq;
+	
+	/*
+	 * The size in bytes of the tables, which must match the size of
+	 * NELSC_TABLE for clients to use them.
+	 */
+	uint64_t table_size;
+	
+	/*
+	 * The offset in bytes of the tables from the start of the segment.
+	 */
+	uint64_t table_offset;
+	
+	/*
+	 * The number of times the tables have been published.
+	 */
+	uint64_t generation;
+
+} SHM_HEADER;
+
+/*
+ * NELSC_SHM structure.
+ * 
+ * Prototype given in the header.
+ */
+struct NELSC_SHM_TAG {
+	
+	/*
+	 * The read-only mapping of the segment.
+	 */
+	void *pMap;
+	
+	/*
+	 * The size in bytes of the mapping.
+	 */
+	size_t size;
+	
+	/*
+	 * The header and the tables within the mapping.
+	 */
+	const SHM_HEADER *pHeader;
+	const NELSC_TABLE *pTable;
+	
+	/*
+	 * The read-only descriptor of the segment, kept open to test for
+	 * the lock of a publisher.
+	 */
+	int fd;
+};
+
+/*
+ * Function prototypes
+ * ===================
+ */
+
+static int64_t clockNs(void);
+static bool lockSegment(int fd);
+static bool publisherActive(const NELSC_SHM *pShm);
+
+/*
+ * Read the monotonic clock.
+ * 
+ * Return:
+ * 
+ *   the clock reading in nanoseconds
+ * 
+ * Faults:
+ * 
+ *   - If the clock can't be read
+ */
+static int64_t clockNs(void) {
+	
+	struct timespec ts;
+	
+	memset(&ts, 0, sizeof(struct timespec));
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+		abort();
+	}
+	
+	return (((int64_t) ts.tv_sec) * INT64_C(1000000000)) +
+				((int64_t) ts.tv_nsec);
+}
+
+/*
+ * Take the publisher lock on a segment, waiting for any other publisher
+ * to release it.
+ * 
+ * The lock is a POSIX record lock over the whole segment.  It is
+ * released when the descriptor is closed, including when the process
+ * dies, so a publisher that dies while writing never blocks the next.
+ * 
+ * Parameters:
+ * 
+ *   fd - the descriptor of the segment, open for writing
+ * 
+ * Return:
+ * 
+ *   true if successful, false if the lock could not be taken, in which
+ *   case errno is set
+ */
+static bool lockSegment(int fd) {
+	
+	struct flock fl;
+	bool result = true;
+	
+	memset(&fl, 0, sizeof(struct flock));
+	fl.l_type = F_WRLCK;
+	fl.l_whence = SEEK_SET;
+	fl.l_start = 0;
+	fl.l_len = 0;
+	
+	while (fcntl(fd, F_SETLKW, &fl) != 0) {
+		if (errno != EINTR) {
+			result = false;
+			break;
+		}
+	}
+	
+	return result;
+}
+
+/*
+ * Check whether a publisher holds the lock on a mapped segment.
+ * 
+ * A segment whose sequence number is odd while no publisher holds the
+ * lock was left by a publisher that died while writing.  Record locks
+ * belong to processes, so a publisher in the calling process itself is
+ * not seen.  If the lock can't be tested, the publisher is assumed to
+ * be active.
+ * 
+ * Parameters:
+ * 
+ *   pShm - the mapped segment
+ * 
+ * Return:
+ * 
+ *   true if another process may be publishing, false if not
+ */
+static bool publisherActive(const NELSC_SHM *pShm) {
+	
+	struct flock fl;
+	bool result = true;
+	
+	memset(&fl, 0, sizeof(struct flock));
+	fl.l_type = F_WRLCK;
+	fl.l_whence = SEEK_SET;
+	fl.l_start = 0;
+	fl.l_len = 0;
+	
+	if (fcntl(pShm->fd, F_GETLK, &fl) == 0) {
+		if (fl.l_type == F_UNLCK) {
+			result = false;
+		}
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_shm_publish function.
+ */
+bool nelsc_shm_publish(const char *pName) {
+	
+	int fd = -1;
+	struct stat st;
+	void *pMap = MAP_FAILED;
+	SHM_HEADER *pHeader = NULL;
+	uint32_t seq = 0;
+	int err = 0;
+	bool result = true;
+	
+	/* Initialize structures */
+	memset(&st, 0, sizeof(struct stat));
+	
+	/* Check parameters */
+	if (pName == NULL) {
+		abort();
+	}
+	
+	/* Open or create the segment */
+	fd = shm_open(pName, O_RDWR | O_CREAT, 0644);
+	if (fd < 0) {
+		result = false;
+	}
+	
+	/* Keep out other publishers until the descriptor is closed */
+	if (result) {
+		if (!lockSegment(fd)) {
+			result = false;
+		}
+	}
+	
+	/* Make sure the segment is large enough; a new segment is filled
+	 * with zero bytes */
+	if (result) {
+		if (fstat(fd, &st) != 0) {
+			result = false;
+		}
+	}
+	if (result && ((size_t) st.st_size < SHM_SIZE)) {
+		if (ftruncate(fd, (off_t) SHM_SIZE) != 0) {
+			result = false;
+		}
+	}
+	
+	/* Map the segment for writing */
+	if (result) {
+		pMap = mmap(NULL, SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED,
+					fd, 0);
+		if (pMap == MAP_FAILED) {
+			result = false;
+		}
+	}
+	
+	/* Write the header and the tables under the sequence lock, keeping
+	 * the sequence number odd if a previous publisher died while
+	 * writing */
+	if (result) {
+		pHeader = (SHM_HEADER *) pMap;
+		
+		seq = __atomic_load_n(&(pHeader->seq), __ATOMIC_RELAXED);
+		seq |= 1;
+		__atomic_store_n(&(pHeader->seq), seq, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+		
+		memcpy(pHeader->magic, SHM_MAGIC, SHM_MAGIC_LEN);
+		pHeader->version = NELSC_SHM_VERSION;
+		pHeader->table_size = (uint64_t) sizeof(NELSC_TABLE);
+		pHeader->table_offset = SHM_TABLE_OFFSET;
+		nelsc_table_build(
+			(NELSC_TABLE *) (((unsigned char *) pMap) +
+								SHM_TABLE_OFFSET));
+		(pHeader->generation)++;
+		
+		__atomic_store_n(&(pHeader->seq), seq + 1, __ATOMIC_RELEASE);
+	}
+	
+	/* Release the mapping and the descriptor, which also releases the
+	 * lock, preserving errno of any error */
+	err = errno;
+	if (pMap != MAP_FAILED) {
+		munmap(pMap, SHM_SIZE);
+	}
+	if (fd >= 0) {
+		close(fd);
+	}
+	errno = err;
+	
+	return result;
+}
+
+/*
+ * nelsc_shm_unlink function.
+ */
+bool nelsc_shm_unlink(const char *pName) {
+	
+	/* Check parameters */
+	if (pName == NULL) {
+		abort();
+	}
+	
+	return (shm_unlink(pName) == 0);
+}
+
+/*
+ * nelsc_shm_open function.
+ */
+NELSC_SHM *nelsc_shm_open(const char *pName) {
+	
+	int fd = -1;
+	struct stat st;
+	void *pMap = MAP_FAILED;
+	size_t size = 0;
+	const SHM_HEADER *pHeader = NULL;
+	NELSC_SHM *pShm = NULL;
+	bool status = true;
+	
+	/* Initialize structures */
+	memset(&st, 0, sizeof(struct stat));
+	
+	/* Check parameters */
+	if (pName == NULL) {
+		abort();
+	}
+	
+	/* Open the segment and map all of it read-only */
+	fd = shm_open(pName, O_RDONLY, 0);
+	if (fd < 0) {
+		status = false;
+	}
+	
+	if (status) {
+		if (fstat(fd, &st) != 0) {
+			status = false;
+		}
+	}
+	if (status) {
+		size = (size_t) st.st_size;
+		if (size < SHM_SIZE) {
+			status = false;
+		}
+	}
+	
+	if (status) {
+		pMap = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+		if (pMap == MAP_FAILED) {
+			status = false;
+		}
+	}
+	
+	/* Check that the segment holds tables in this format; a segment
+	 * that is still being published for the first time has no magic
+	 * yet */
+	if (status) {
+		pHeader = (const SHM_HEADER *) pMap;
+		if ((memcmp(pHeader->magic, SHM_MAGIC, SHM_MAGIC_LEN) != 0) ||
+				(pHeader->version != NELSC_SHM_VERSION) ||
+				(pHeader->table_size != sizeof(NELSC_TABLE)) ||
+				(pHeader->table_offset != SHM_TABLE_OFFSET)) {
+			status = false;
+		}
+	}
+	
+	/* Wrap the mapping, or release it if it is unusable */
+	if (status) {
+		pShm = (NELSC_SHM *) malloc(sizeof(NELSC_SHM));
+		if (pShm == NULL) {
+			abort();
+		}
+		memset(pShm, 0, sizeof(NELSC_SHM));
+		
+		pShm->pMap = pMap;
+		pShm->size = size;
+		pShm->pHeader = pHeader;
+		pShm->pTable = (const NELSC_TABLE *)
+							(((const unsigned char *) pMap) +
+								SHM_TABLE_OFFSET);
+		pShm->fd = fd;
+	
+	} else {
+		if (pMap != MAP_FAILED) {
+			munmap(pMap, size);
+		}
+		if (fd >= 0) {
+			close(fd);
+		}
+	}
+	
+	return pShm;
+}
+
+/*
+ * nelsc_shm_close function.
+ */
+void nelsc_shm_close(NELSC_SHM *pShm) {
+	if (pShm != NULL) {
+		munmap(pShm->pMap, pShm->size);
+		close(pShm->fd);
+		free(pShm);
+	}
+}
+
+/*
+ * nelsc_shm_generation function.
+ */
+bool nelsc_shm_generation(
+		const NELSC_SHM *pShm,
+		uint64_t *pGeneration) {
+	
+	uint32_t seq = 0;
+	uint64_t generation = 0;
+	bool result = true;
+	
+	/* Check parameters */
+	if ((pShm == NULL) || (pGeneration == NULL)) {
+		abort();
+	}
+	
+	do {
+		if (!nelsc_shm_readBegin(pShm, &seq)) {
+			result = false;
+			break;
+		}
+		generation = pShm->pHeader->generation;
+	} while (!nelsc_shm_readValid(pShm, seq));
+	
+	if (result) {
+		*pGeneration = generation;
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_shm_readBegin function.
+ */
+bool nelsc_shm_readBegin(const NELSC_SHM *pShm, uint32_t *pSeq) {
+	
+	const uint32_t *pLock = NULL;
+	uint32_t seq = 0;
+	int64_t deadline = 0;
+	bool result = true;
+	
+	/* Check parameters */
+	if ((pShm == NULL) || (pSeq == NULL)) {
+		abort();
+	}
+	
+	/* Wait for any publication in progress to finish, unless its
+	 * publisher is gone or it takes too long */
+	pLock = &(pShm->pHeader->seq);
+	seq = __atomic_load_n(pLock, __ATOMIC_ACQUIRE);
+	if ((seq & 1) != 0) {
+		deadline = clockNs() + SHM_WAIT_NS;
+	}
+	while ((seq & 1) != 0) {
+		if ((!publisherActive(pShm)) || (clockNs() >= deadline)) {
+			result = false;
+			break;
+		}
+		sched_yield();
+		seq = __atomic_load_n(pLock, __ATOMIC_ACQUIRE);
+	}
+	
+	*pSeq = seq;
+	return result;
+}
+
+/*
+ * nelsc_shm_readValid function.
+ */
+bool nelsc_shm_readValid(const NELSC_SHM *pShm, uint32_t seq) {
+	
+	/* Check parameters */
+	if (pShm == NULL) {
+		abort();
+	}
+	
+	/* Keep the reads of the tables before the second sequence read */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	
+	return (__atomic_load_n(&(pShm->pHeader->seq), __ATOMIC_RELAXED) ==
+				seq);
+}
+
+/*
+ * nelsc_shm_table function.
+ */
+const NELSC_TABLE *nelsc_shm_table(const NELSC_SHM *pShm) {
+	
+	/* Check parameters */
+	if (pShm == NULL) {
+		abort();
+	}
+	
+	return pShm->pTable;
+}
+
+/*
+ * nelsc_shm_dayToMonth function.
+ */
+int32_t nelsc_shm_dayToMonth(
+		const NELSC_SHM *pShm,
+		int32_t d,
+		int32_t *pOffset) {
+	
+	uint32_t seq = 0;
+	int32_t offs = 0;
+	int32_t result = 0;
+	
+	/* Check parameters */
+	if (pShm == NULL) {
+		abort();
+	}
+	
+	do {
+		if (!nelsc_shm_readBegin(pShm, &seq)) {
+			result = nelsc_cycle_dayToMonth(d, &offs);
+			break;
+		}
+		result = nelsc_table_dayToMonth(pShm->pTable, d, &offs);
+	} while (!nelsc_shm_readValid(pShm, seq));
+	
+	if (pOffset != NULL) {
+		*pOffset = offs;
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_shm_monthToDay function.
+ */
+int32_t nelsc_shm_monthToDay(const NELSC_SHM *pShm, int32_t m) {
+	
+	uint32_t seq = 0;
+	int32_t result = 0;
+	
+	/* Check parameters */
+	if (pShm == NULL) {
+		abort();
+	}
+	
+	do {
+		if (!nelsc_shm_readBegin(pShm, &seq)) {
+			result = nelsc_cycle_monthToDay(m);
+			break;
+		}
+		result = nelsc_table_monthToDay(pShm->pTable, m);
+	} while (!nelsc_shm_readValid(pShm, seq));
+	
+	return result;
+}
+
+/*
+ * nelsc_shm_monthToYear function.
+ */
+int32_t nelsc_shm_monthToYear(
+		const NELSC_SHM *pShm,
+		int32_t m,
+		int32_t *pOffset) {
+	
+	uint32_t seq = 0;
+	int32_t offs = 0;
+	int32_t result = 0;
+	
+	/* Check parameters */
+	if (pShm == NULL) {
+		abort();
+	}
+	
+	do {
+		if (!nelsc_shm_readBegin(pShm, &seq)) {
+			result = nelsc_cycle_monthToYear(m, &offs);
+			break;
+		}
+		result = nelsc_table_monthToYear(pShm->pTable, m, &offs);
+	} while (!nelsc_shm_readValid(pShm, seq));
+	
+	if (pOffset != NULL) {
+		*pOffset = offs;
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_shm_yearToMonth function.
+ */
+int32_t nelsc_shm_yearToMonth(const NELSC_SHM *pShm, int32_t y) {
+	
+	uint32_t seq = 0;
+	int32_t result = 0;
+	
+	/* Check parameters */
+	if (pShm == NULL) {
+		abort();
+	}
+	
+	do {
+		if (!nelsc_shm_readBegin(pShm, &seq)) {
+			result = nelsc_cycle_yearToMonth(y);
+			break;
+		}
+		result = nelsc_table_yearToMonth(pShm->pTable, y);
+	} while (!nelsc_shm_readValid(pShm, seq));
+	
+	return result;
+}
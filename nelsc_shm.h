@@ -0,0 +1,252 @@
+#ifndef NELSC_SHM_H_INCLUDED
+#define NELSC_SHM_H_INCLUDED
+
+/*
+ * nelsc_shm.h
+ * 
+ * Publishes the precomputed NELSC cycle tables of nelsc_table in a
+ * POSIX shared memory segment, and maps a published segment read-only
+ * in client processes.
+ * 
+ * The tables are built once by the publishing process.  Any number of
+ * client processes on the same host can then map the same segment and
+ * use the tables without building their own copy, so all of them share
+ * one physical copy of the tables.
+ * 
+ * The segment starts with a header holding a magic value, a format
+ * version, the layout size, and a generation count that increases with
+ * each publication.  Clients refuse segments with a different format.
+ * 
+ * Publishing into a segment that clients already have mapped is safe.
+ * The header includes a sequence lock: the publisher makes the
+ * sequence number odd while it writes and even again when it is done,
+ * and clients retry any lookup that overlapped with a write.  The
+ * lookup functions of this module do the retrying automatically.
+ * 
+ * Publishers take a POSIX record lock on the segment while they write,
+ * so only one writes at a time.  The lock is released if a publisher
+ * dies, leaving the sequence number odd; the next publisher repairs the
+ * segment.  Clients do not wait for such a segment, nor for longer than
+ * a second for a live publisher, and the lookup functions of this
+ * module then fall back to the nelsc_cycle functions.
+ * 
+ * The sequence lock uses the GCC atomic builtins.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "nelsc_table.h"
+
+/*
+ * The name of the segment used when no other name is given.
+ */
+#define NELSC_SHM_DEFAULT_NAME "/nelsc"
+
+/*
+ * The format version of segments written by this module.
+ */
+#define NELSC_SHM_VERSION 1
+
+/*
+ * NELSC_SHM structure prototype.
+ * 
+ * See the implementation file for definition.
+ */
+struct NELSC_SHM_TAG;
+typedef struct NELSC_SHM_TAG NELSC_SHM;
+
+/*
+ * Build the cycle tables and publish them in a shared memory segment.
+ * 
+ * The segment is created if it doesn't exist yet, readable by all
+ * users.  If it already exists, the tables are written again in place
+ * under the sequence lock and the generation count is incremented.
+ * Waits for any other publisher of the segment to finish first.
+ * 
+ * Parameters:
+ * 
+ *   pName - the name of the segment, which should start with "/"
+ * 
+ * Return:
+ * 
+ *   true if successful, false if the segment could not be created,
+ *   locked, resized, or mapped, in which case errno is set
+ * 
+ * Faults:
+ * 
+ *   - If pName is NULL
+ */
+bool nelsc_shm_publish(const char *pName);
+
+/*
+ * Remove a shared memory segment name.
+ * 
+ * Processes that have the segment mapped keep their mapping.
+ * 
+ * Parameters:
+ * 
+ *   pName - the name of the segment
+ * 
+ * Return:
+ * 
+ *   true if successful, false if not, in which case errno is set
+ * 
+ * Faults:
+ * 
+ *   - If pName is NULL
+ */
+bool nelsc_shm_unlink(const char *pName);
+
+/*
+ * Map a published shared memory segment read-only.
+ * 
+ * The mapping must eventually be released with nelsc_shm_close().
+ * 
+ * Parameters:
+ * 
+ *   pName - the name of the segment
+ * 
+ * Return:
+ * 
+ *   the mapped segment, or NULL if the segment could not be opened or
+ *   mapped, or does not hold tables in the format of this module
+ * 
+ * Faults:
+ * 
+ *   - If pName is NULL
+ * 
+ *   - If memory allocation fails
+ */
+NELSC_SHM *nelsc_shm_open(const char *pName);
+
+/*
+ * Release a mapped segment.
+ * 
+ * Does nothing if pShm is NULL.
+ * 
+ * Parameters:
+ * 
+ *   pShm - the mapped segment, or NULL
+ */
+void nelsc_shm_close(NELSC_SHM *pShm);
+
+/*
+ * Get the generation count of a mapped segment.
+ * 
+ * Parameters:
+ * 
+ *   pShm - the mapped segment
+ * 
+ *   pGeneration - pointer to variable to receive the number of times
+ *   the tables have been published in the segment
+ * 
+ * Return:
+ * 
+ *   true if successful, false if a publication in progress did not
+ *   finish, as for nelsc_shm_readBegin()
+ * 
+ * Faults:
+ * 
+ *   - If pShm or pGeneration is NULL
+ */
+bool nelsc_shm_generation(
+		const NELSC_SHM *pShm,
+		uint64_t *pGeneration);
+
+/*
+ * Begin reading the tables of a mapped segment directly.
+ * 
+ * Waits while a publication is in progress and gets the sequence
+ * number to pass to nelsc_shm_readValid() once reading is done.
+ * 
+ * Gives up at once if the publisher died while writing, and after a
+ * second if a publisher is still writing.  The tables must not be read
+ * in that case; the caller should use the nelsc_cycle functions or
+ * tables of its own instead.  A publisher in the calling process is
+ * not seen, so it counts as having died.
+ * 
+ * Parameters:
+ * 
+ *   pShm - the mapped segment
+ * 
+ *   pSeq - pointer to variable to receive the sequence number
+ * 
+ * Return:
+ * 
+ *   true if the tables may be read, false if the publication in
+ *   progress did not finish
+ * 
+ * Faults:
+ * 
+ *   - If pShm or pSeq is NULL
+ */
+bool nelsc_shm_readBegin(const NELSC_SHM *pShm, uint32_t *pSeq);
+
+/*
+ * Check whether the tables of a mapped segment were read without
+ * overlapping a publication.
+ * 
+ * If this returns false, everything read since nelsc_shm_readBegin()
+ * must be discarded and read again.
+ * 
+ * Parameters:
+ * 
+ *   pShm - the mapped segment
+ * 
+ *   seq - the sequence number returned by nelsc_shm_readBegin()
+ * 
+ * Return:
+ * 
+ *   true if the reads are valid, false if they must be retried
+ * 
+ * Faults:
+ * 
+ *   - If pShm is NULL
+ */
+bool nelsc_shm_readValid(const NELSC_SHM *pShm, uint32_t seq);
+
+/*
+ * Get the tables of a mapped segment for reading directly.
+ * 
+ * Reads must be enclosed in nelsc_shm_readBegin() and
+ * nelsc_shm_readValid().
+ * 
+ * Parameters:
+ * 
+ *   pShm - the mapped segment
+ * 
+ * Return:
+ * 
+ *   the tables
+ * 
+ * Faults:
+ * 
+ *   - If pShm is NULL
+ */
+const NELSC_TABLE *nelsc_shm_table(const NELSC_SHM *pShm);
+
+/*
+ * Versions of the nelsc_table lookups that use the tables of a mapped
+ * segment under the sequence lock.
+ * 
+ * If nelsc_shm_readBegin() gives up, the lookup is computed with the
+ * nelsc_cycle functions instead, which give the same results.
+ * 
+ * Faults:
+ * 
+ *   - If pShm is NULL
+ * 
+ *   - If the day, month, or year is out of NELSC range
+ */
+int32_t nelsc_shm_dayToMonth(
+		const NELSC_SHM *pShm,
+		int32_t d,
+		int32_t *pOffset);
+int32_t nelsc_shm_monthToDay(const NELSC_SHM *pShm, int32_t m);
+int32_t nelsc_shm_monthToYear(
+		const NELSC_SHM *pShm,
+		int32_t m,
+		int32_t *pOffset);
+int32_t nelsc_shm_yearToMonth(const NELSC_SHM *pShm, int32_t y);
+
+#endif
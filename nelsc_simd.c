@@ -0,0 +1,105 @@
+/*
+ * nelsc_simd.c
+ * 
+ * Implementation of nelsc_simd.h
+ * 
+ * See the header for further information.
+ */
+
+#include "nelsc_simd.h"
+#include <stdlib.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/*
+ * nelsc_simd_build function.
+ */
+void nelsc_simd_build(NELSC_SIMD *pSimd) {
+	
+	int32_t m = 0;
+	int32_t i = 0;
+	int32_t start = 0;
+	
+	/* Check parameters */
+	if (pSimd == NULL) {
+		abort();
+	}
+	
+	/* Begin the first pattern at the start of the NELSC range */
+	pSimd->base_month = NELSC_CYCLE_MONMIN;
+	pSimd->base_day = nelsc_cycle_monthToDay(NELSC_CYCLE_MONMIN);
+	
+	for(i = 0; i < NELSC_SIMD_MONTHS; i++) {
+		(pSimd->month_start)[i] = (int16_t) (nelsc_cycle_monthToDay(
+				NELSC_CYCLE_MONMIN + i) - pSimd->base_day);
+	}
+	
+	/* Make sure the pattern repeats over the whole range */
+	for(m = NELSC_CYCLE_MONMIN; m <= NELSC_CYCLE_MONMAX; m++) {
+		i = m - NELSC_CYCLE_MONMIN;
+		start = pSimd->base_day +
+					((i / NELSC_SIMD_MONTHS) * NELSC_SIMD_DAYS) +
+					(pSimd->month_start)[i % NELSC_SIMD_MONTHS];
+		if (nelsc_cycle_monthToDay(m) != start) {
+			abort();
+		}
+	}
+}
+
+/*
+ * nelsc_simd_dayToMonth function.
+ */
+int32_t nelsc_simd_dayToMonth(
+		const NELSC_SIMD *pSimd,
+		int32_t d,
+		int32_t *pOffset) {
+	
+	int32_t patterns = 0;
+	int32_t rem = 0;
+	int32_t later = 0;
+	int32_t i = 0;
+#ifdef __AVX2__
+	__m256i days;
+	__m256i lo;
+	__m256i hi;
+	__m256i mask;
+#endif
+	
+	/* Check parameters */
+	if ((pSimd == NULL) ||
+			(d < NELSC_CYCLE_DAYMIN) || (d > NELSC_CYCLE_DAYMAX)) {
+		abort();
+	}
+	
+	/* Count whole patterns, leaving the days within the pattern */
+	rem = d - pSimd->base_day;
+	patterns = rem / NELSC_SIMD_DAYS;
+	rem = rem % NELSC_SIMD_DAYS;
+	
+	/* Count the months of the pattern that start after the day */
+#ifdef __AVX2__
+	days = _mm256_set1_epi16((short) rem);
+	lo = _mm256_loadu_si256((const __m256i *) (pSimd->month_start));
+	hi = _mm256_loadu_si256(
+			(const __m256i *) (pSimd->month_start + 16));
+	mask = _mm256_packs_epi16(
+				_mm256_cmpgt_epi16(lo, days),
+				_mm256_cmpgt_epi16(hi, days));
+	later = (int32_t) __builtin_popcount(
+				(unsigned int) _mm256_movemask_epi8(mask));
+#else
+	for(i = 0; i < NELSC_SIMD_MONTHS; i++) {
+		later += (int32_t) ((pSimd->month_start)[i] > rem);
+	}
+#endif
+	
+	/* The day is in the last month that starts on or before it */
+	i = NELSC_SIMD_MONTHS - 1 - later;
+	
+	if (pOffset != NULL) {
+		*pOffset = rem - (pSimd->month_start)[i];
+	}
+	return pSimd->base_month + (patterns * NELSC_SIMD_MONTHS) + i;
+}
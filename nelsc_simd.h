@@ -0,0 +1,116 @@
+#ifndef NELSC_SIMD_H_INCLUDED
+#define NELSC_SIMD_H_INCLUDED
+
+/*
+ * nelsc_simd.h
+ * 
+ * Finds the NELSC month that contains a day by searching the 32-month
+ * pattern of long and short months with vector compares, in place of
+ * the month-by-month walk of nelsc_cycle_dayToMonth().
+ * 
+ * The 32-month pattern spans 945 days and repeats without exception
+ * over the whole NELSC range.  Dividing the days since the start of the
+ * range by 945 gives the number of whole patterns before the day.  The
+ * first day of each of the 32 months within the pattern is kept as a
+ * 16-bit offset from the start of the pattern, and the month within the
+ * pattern is the number of these offsets that are not greater than the
+ * remaining days, less one.
+ * 
+ * When compiled for AVX2, the 32 offsets are held in two 256-bit
+ * vectors.  Each is compared against the remaining days at once, the
+ * two results are packed into a single byte mask, and the month is
+ * found by counting its bits, with no loop and no branches.  Without
+ * AVX2, the same count is made with a scalar loop over the offsets.
+ * NELSC_SIMD_AVX2 is nonzero if the AVX2 version was compiled.
+ * 
+ * The pattern takes 72 bytes, so it stays in cache alongside whatever
+ * else the program is doing.
+ */
+
+#include <stdint.h>
+#include "nelsc_cycle.h"
+
+/*
+ * The number of months in the 32-month pattern, and the number of days
+ * it spans.
+ */
+#define NELSC_SIMD_MONTHS 32
+#define NELSC_SIMD_DAYS 945
+
+/*
+ * Nonzero if nelsc_simd_dayToMonth() uses AVX2 instructions.
+ */
+#ifdef __AVX2__
+#define NELSC_SIMD_AVX2 1
+#else
+#define NELSC_SIMD_AVX2 0
+#endif
+
+/*
+ * The 32-month pattern, aligned to the start of the NELSC range.
+ * 
+ * Use nelsc_simd_build() to fill in the pattern.
+ */
+typedef struct {
+	
+	/*
+	 * The offset in days of the first day of each month of the pattern
+	 * from the first day of the pattern.
+	 */
+	int16_t month_start[NELSC_SIMD_MONTHS];
+	
+	/*
+	 * The NELSC absolute day offset and absolute month offset at which
+	 * the first pattern begins.
+	 */
+	int32_t base_day;
+	int32_t base_month;
+
+} NELSC_SIMD;
+
+/*
+ * Fill in the month pattern.
+ * 
+ * The pattern is computed with the nelsc_cycle conversion functions.
+ * 
+ * Parameters:
+ * 
+ *   pSimd - the pattern to fill in
+ * 
+ * Faults:
+ * 
+ *   - If pSimd is NULL
+ * 
+ *   - If the months computed by nelsc_cycle do not repeat every
+ *     NELSC_SIMD_MONTHS months and NELSC_SIMD_DAYS days
+ */
+void nelsc_simd_build(NELSC_SIMD *pSimd);
+
+/*
+ * Vector search version of nelsc_cycle_dayToMonth().
+ * 
+ * Parameters:
+ * 
+ *   pSimd - the month pattern
+ * 
+ *   d - the NELSC absolute day offset
+ * 
+ *   pOffset - pointer to variable to receive the offset of the day
+ *   within the month, or NULL
+ * 
+ * Return:
+ * 
+ *   the NELSC absolute month offset of the month that contains day d
+ * 
+ * Faults:
+ * 
+ *   - If pSimd is NULL
+ * 
+ *   - If d is out of NELSC range
+ */
+int32_t nelsc_simd_dayToMonth(
+		const NELSC_SIMD *pSimd,
+		int32_t d,
+		int32_t *pOffset);
+
+#endif
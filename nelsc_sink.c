@@ -0,0 +1,502 @@
+/*
+ * nelsc_sink.c
+ * 
+ * Implementation of nelsc_sink.h
+ * 
+ * See the header for further information.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "nelsc_sink.h"
+#include <errno.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * The kinds of sink.
+ */
+#define SINK_BUFFER 1
+#define SINK_FD     2
+#define SINK_FILE   3
+
+/*
+ * The initial capacity in bytes of a buffer sink once something is
+ * written to it.
+ */
+#define SINK_INITIAL_CAP 256
+
+/*
+ * The size of the local buffer used by nelsc_sink_printf().  Longer
+ * output is formatted into a temporary allocated buffer instead.
+ */
+#define SINK_PRINTF_LOCAL 256
+
+/*
+ * NELSC_SINK structure.
+ * 
+ * Prototype given in the header.
+ */
+struct NELSC_SINK_TAG {
+	
+	/*
+	 * The kind of sink, one of the SINK_ constants.
+	 */
+	int kind;
+	
+	/*
+	 * For buffer sinks, the growable buffer.  For descriptor sinks, the
+	 * output buffer, or NULL if unbuffered.  Unused for file sinks.
+	 */
+	char *pBuf;
+	
+	/*
+	 * The number of bytes currently held in pBuf.
+	 */
+	size_t len;
+	
+	/*
+	 * The number of bytes allocated for pBuf.
+	 */
+	size_t cap;
+	
+	/*
+	 * For descriptor sinks, the file descriptor.
+	 */
+	int fd;
+	
+	/*
+	 * For file sinks, the file.
+	 */
+	FILE *pFile;
+	
+	/*
+	 * Whether writing to the destination of a descriptor or file sink
+	 * has failed, after which further output is discarded.
+	 */
+	bool failed;
+};
+
+/*
+ * Function prototypes
+ */
+static NELSC_SINK *newSink(int kind);
+static bool writeFd(int fd, const char *pData, size_t len);
+static void growBuffer(NELSC_SINK *pSink, size_t extra);
+
+/*
+ * Allocate a new sink structure of the given kind with all other fields
+ * cleared.
+ * 
+ * Parameters:
+ * 
+ *   kind - the kind of sink
+ * 
+ * Return:
+ * 
+ *   the new sink
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static NELSC_SINK *newSink(int kind) {
+	
+	NELSC_SINK *pSink = NULL;
+	
+	pSink = (NELSC_SINK *) malloc(sizeof(NELSC_SINK));
+	if (pSink == NULL) {
+		abort();
+	}
+	memset(pSink, 0, sizeof(NELSC_SINK));
+	
+	pSink->kind = kind;
+	pSink->pBuf = NULL;
+	pSink->len = 0;
+	pSink->cap = 0;
+	pSink->fd = -1;
+	pSink->pFile = NULL;
+	pSink->failed = false;
+	
+	return pSink;
+}
+
+/*
+ * Write all the given bytes to a file descriptor.
+ * 
+ * Partial writes are continued and interrupted writes are retried.
+ * 
+ * Parameters:
+ * 
+ *   fd - the file descriptor
+ * 
+ *   pData - the bytes to write
+ * 
+ *   len - the number of bytes to write
+ * 
+ * Return:
+ * 
+ *   true if all the bytes were written, false if writing failed
+ */
+static bool writeFd(int fd, const char *pData, size_t len) {
+	
+	bool result = true;
+	ssize_t retval = 0;
+	
+	while (len > 0) {
+		retval = write(fd, pData, len);
+		if (retval < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			result = false;
+			break;
+		}
+		
+		pData += retval;
+		len -= (size_t) retval;
+	}
+	
+	return result;
+}
+
+/*
+ * Make sure that a buffer sink has room for at least extra more bytes.
+ * 
+ * Parameters:
+ * 
+ *   pSink - the buffer sink
+ * 
+ *   extra - the number of additional bytes needed
+ * 
+ * Faults:
+ * 
+ *   - If the required size overflows
+ * 
+ *   - If memory allocation fails
+ */
+static void growBuffer(NELSC_SINK *pSink, size_t extra) {
+	
+	size_t new_cap = 0;
+	
+	if (extra > ((size_t) -1) - pSink->len) {
+		abort();
+	}
+	
+	if (pSink->len + extra > pSink->cap) {
+		new_cap = pSink->cap;
+		if (new_cap < SINK_INITIAL_CAP) {
+			new_cap = SINK_INITIAL_CAP;
+		}
+		while (new_cap < pSink->len + extra) {
+			if (new_cap > ((size_t) -1) / 2) {
+				new_cap = pSink->len + extra;
+			} else {
+				new_cap *= 2;
+			}
+		}
+		
+		pSink->pBuf = (char *) realloc(pSink->pBuf, new_cap);
+		if (pSink->pBuf == NULL) {
+			abort();
+		}
+		pSink->cap = new_cap;
+	}
+}
+
+/*
+ * nelsc_sink_newBuffer function.
+ */
+NELSC_SINK *nelsc_sink_newBuffer(void) {
+	return newSink(SINK_BUFFER);
+}
+
+/*
+ * nelsc_sink_newFd function.
+ */
+NELSC_SINK *nelsc_sink_newFd(int fd, size_t cap) {
+	
+	NELSC_SINK *pSink = NULL;
+	
+	/* Check parameters */
+	if (fd < 0) {
+		abort();
+	}
+	
+	/* Create the sink and its output buffer */
+	pSink = newSink(SINK_FD);
+	pSink->fd = fd;
+	
+	if (cap > 0) {
+		pSink->pBuf = (char *) malloc(cap);
+		if (pSink->pBuf == NULL) {
+			abort();
+		}
+		pSink->cap = cap;
+	}
+	
+	return pSink;
+}
+
+/*
+ * nelsc_sink_newFile function.
+ */
+NELSC_SINK *nelsc_sink_newFile(FILE *pFile) {
+	
+	NELSC_SINK *pSink = NULL;
+	
+	/* Check parameters */
+	if (pFile == NULL) {
+		abort();
+	}
+	
+	/* Create the sink */
+	pSink = newSink(SINK_FILE);
+	pSink->pFile = pFile;
+	
+	return pSink;
+}
+
+/*
+ * nelsc_sink_free function.
+ */
+void nelsc_sink_free(NELSC_SINK *pSink) {
+	if (pSink != NULL) {
+		nelsc_sink_flush(pSink);
+		free(pSink->pBuf);
+		free(pSink);
+	}
+}
+
+/*
+ * nelsc_sink_write function.
+ */
+void nelsc_sink_write(
+		NELSC_SINK *pSink,
+		const char *pData,
+		size_t len) {
+	
+	/* Check parameters */
+	if (pSink == NULL) {
+		abort();
+	}
+	if ((len > 0) && (pData == NULL)) {
+		abort();
+	}
+	
+	/* Write according to the kind of sink */
+	if ((len < 1) || pSink->failed) {
+		/* Nothing to write, or the destination has already failed */
+	
+	} else if (pSink->kind == SINK_BUFFER) {
+		growBuffer(pSink, len);
+		memcpy(pSink->pBuf + pSink->len, pData, len);
+		pSink->len += len;
+	
+	} else if (pSink->kind == SINK_FD) {
+		/* Flush the buffer first if the new data doesn't fit */
+		if (pSink->len + len > pSink->cap) {
+			nelsc_sink_flush(pSink);
+		}
+		
+		/* Gather the data if it fits in the empty buffer, else write
+		 * it directly */
+		if (pSink->failed) {
+			/* Flushing failed, so the data is discarded */
+		
+		} else if (len <= pSink->cap) {
+			memcpy(pSink->pBuf + pSink->len, pData, len);
+			pSink->len += len;
+		
+		} else if (!writeFd(pSink->fd, pData, len)) {
+			pSink->failed = true;
+		}
+	
+	} else if (pSink->kind == SINK_FILE) {
+		if (fwrite(pData, 1, len, pSink->pFile) != len) {
+			pSink->failed = true;
+		}
+	
+	} else {
+		abort();
+	}
+}
+
+/*
+ * nelsc_sink_puts function.
+ */
+void nelsc_sink_puts(NELSC_SINK *pSink, const char *str) {
+	
+	/* Check parameters */
+	if (str == NULL) {
+		abort();
+	}
+	
+	/* Write the string */
+	nelsc_sink_write(pSink, str, strlen(str));
+}
+
+/*
+ * nelsc_sink_printf function.
+ */
+void nelsc_sink_printf(NELSC_SINK *pSink, const char *pFormat, ...) {
+	
+	va_list ap;
+	va_list ap2;
+	char local[SINK_PRINTF_LOCAL];
+	char *pTemp = NULL;
+	int retval = 0;
+	
+	/* Check parameters */
+	if ((pSink == NULL) || (pFormat == NULL)) {
+		abort();
+	}
+	
+	va_start(ap, pFormat);
+	
+	if (pSink->failed) {
+		/* The destination has already failed, so discard the output */
+	
+	} else if (pSink->kind == SINK_FILE) {
+		/* File sinks format directly into the file */
+		if (vfprintf(pSink->pFile, pFormat, ap) < 0) {
+			pSink->failed = true;
+		}
+	
+	} else {
+		/* Format into the local buffer, falling back to an allocated
+		 * buffer if the output is too long */
+		va_copy(ap2, ap);
+		retval = vsnprintf(local, SINK_PRINTF_LOCAL, pFormat, ap);
+		if (retval < 0) {
+			abort();
+		}
+		
+		if (retval < SINK_PRINTF_LOCAL) {
+			nelsc_sink_write(pSink, local, (size_t) retval);
+		
+		} else {
+			pTemp = (char *) malloc(((size_t) retval) + 1);
+			if (pTemp == NULL) {
+				abort();
+			}
+			if (vsnprintf(pTemp, ((size_t) retval) + 1, pFormat, ap2)
+					!= retval) {
+				abort();
+			}
+			nelsc_sink_write(pSink, pTemp, (size_t) retval);
+			free(pTemp);
+		}
+		
+		va_end(ap2);
+	}
+	
+	va_end(ap);
+}
+
+/*
+ * nelsc_sink_flush function.
+ */
+void nelsc_sink_flush(NELSC_SINK *pSink) {
+	
+	/* Check parameters */
+	if (pSink == NULL) {
+		abort();
+	}
+	
+	/* Flush according to the kind of sink */
+	if (pSink->kind == SINK_FD) {
+		if (!(pSink->failed)) {
+			if (!writeFd(pSink->fd, pSink->pBuf, pSink->len)) {
+				pSink->failed = true;
+			}
+		}
+		pSink->len = 0;
+	
+	} else if (pSink->kind == SINK_FILE) {
+		if (fflush(pSink->pFile) != 0) {
+			pSink->failed = true;
+		}
+	}
+}
+
+/*
+ * nelsc_sink_failed function.
+ */
+bool nelsc_sink_failed(const NELSC_SINK *pSink) {
+	
+	/* Check parameters */
+	if (pSink == NULL) {
+		abort();
+	}
+	
+	return pSink->failed;
+}
+
+/*
+ * nelsc_sink_length function.
+ */
+size_t nelsc_sink_length(const NELSC_SINK *pSink) {
+	
+	/* Check parameters */
+	if (pSink == NULL) {
+		abort();
+	}
+	if (pSink->kind != SINK_BUFFER) {
+		abort();
+	}
+	
+	return pSink->len;
+}
+
+/*
+ * nelsc_sink_data function.
+ */
+const char *nelsc_sink_data(const NELSC_SINK *pSink) {
+	
+	/* Check parameters */
+	if (pSink == NULL) {
+		abort();
+	}
+	if (pSink->kind != SINK_BUFFER) {
+		abort();
+	}
+	
+	return pSink->pBuf;
+}
+
+/*
+ * nelsc_sink_clear function.
+ */
+void nelsc_sink_clear(NELSC_SINK *pSink) {
+	
+	/* Check parameters */
+	if (pSink == NULL) {
+		abort();
+	}
+	if (pSink->kind != SINK_BUFFER) {
+		abort();
+	}
+	
+	pSink->len = 0;
+}
+
+/*
+ * nelsc_sink_drain function.
+ */
+void nelsc_sink_drain(NELSC_SINK *pDest, NELSC_SINK *pSrc) {
+	
+	/* Check parameters */
+	if ((pDest == NULL) || (pSrc == NULL) || (pDest == pSrc)) {
+		abort();
+	}
+	if (pSrc->kind != SINK_BUFFER) {
+		abort();
+	}
+	
+	/* Move the data */
+	nelsc_sink_write(pDest, pSrc->pBuf, pSrc->len);
+	pSrc->len = 0;
+}
@@ -0,0 +1,318 @@
+#ifndef NELSC_SINK_H_INCLUDED
+#define NELSC_SINK_H_INCLUDED
+
+/*
+ * nelsc_sink.h
+ * 
+ * Provides output sinks that the NELSC reporting functions write their
+ * output and error messages into.
+ * 
+ * There are three kinds of sink.  A buffer sink appends everything
+ * written to it into a growable memory buffer, which the owner can
+ * then read back, pass on to another sink, and clear.  A descriptor
+ * sink writes to a POSIX file descriptor with write(), optionally
+ * gathering output in its own buffer first.  A file sink passes output
+ * through to a stdio FILE.
+ * 
+ * Sinks have no shared state.  Different threads can therefore each
+ * write to their own sinks at the same time without any locking, as
+ * long as no two threads use the same sink at once and no two
+ * descriptor or file sinks refer to the same destination.
+ * 
+ * If writing to the destination of a descriptor or file sink fails,
+ * the failure is recorded in the sink and all further output to it is
+ * discarded.  Use nelsc_sink_failed() after flushing to find out
+ * whether everything was written, so that the error can be reported.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+ * NELSC_SINK structure prototype.
+ * 
+ * See the implementation file for definition.
+ */
+struct NELSC_SINK_TAG;
+typedef struct NELSC_SINK_TAG NELSC_SINK;
+
+/*
+ * Create a new buffer sink.
+ * 
+ * The buffer starts out empty and grows as needed.  The sink must
+ * eventually be released with nelsc_sink_free().
+ * 
+ * Return:
+ * 
+ *   the new buffer sink
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+NELSC_SINK *nelsc_sink_newBuffer(void);
+
+/*
+ * Create a new descriptor sink.
+ * 
+ * If cap is greater than zero, output is gathered in a buffer of that
+ * many bytes and only written to the descriptor when the buffer fills
+ * up or the sink is flushed.  If cap is zero, each write to the sink is
+ * passed directly to the descriptor.
+ * 
+ * The descriptor is not closed when the sink is released.  The sink
+ * must eventually be released with nelsc_sink_free().
+ * 
+ * Parameters:
+ * 
+ *   fd - the open file descriptor to write to
+ * 
+ *   cap - the size in bytes of the output buffer, or zero
+ * 
+ * Return:
+ * 
+ *   the new descriptor sink
+ * 
+ * Faults:
+ * 
+ *   - If fd is negative
+ * 
+ *   - If memory allocation fails
+ */
+NELSC_SINK *nelsc_sink_newFd(int fd, size_t cap);
+
+/*
+ * Create a new file sink.
+ * 
+ * All output is passed through to the given file, which keeps its own
+ * buffering.  The file is not closed when the sink is released.  The
+ * sink must eventually be released with nelsc_sink_free().
+ * 
+ * Parameters:
+ * 
+ *   pFile - the file to write to
+ * 
+ * Return:
+ * 
+ *   the new file sink
+ * 
+ * Faults:
+ * 
+ *   - If pFile is NULL
+ * 
+ *   - If memory allocation fails
+ */
+NELSC_SINK *nelsc_sink_newFile(FILE *pFile);
+
+/*
+ * Release a sink.
+ * 
+ * Descriptor and file sinks are flushed first.  Any data remaining in a
+ * buffer sink is discarded.  Does nothing if pSink is NULL.
+ * 
+ * A failure while flushing here can't be reported, so sinks whose
+ * output matters should be flushed and checked with nelsc_sink_failed()
+ * before they are released.
+ * 
+ * Parameters:
+ * 
+ *   pSink - the sink to release, or NULL
+ */
+void nelsc_sink_free(NELSC_SINK *pSink);
+
+/*
+ * Write bytes to a sink.
+ * 
+ * Parameters:
+ * 
+ *   pSink - the sink
+ * 
+ *   pData - the bytes to write
+ * 
+ *   len - the number of bytes to write
+ * 
+ * Faults:
+ * 
+ *   - If pSink is NULL
+ * 
+ *   - If len is greater than zero and pData is NULL
+ * 
+ *   - If memory allocation fails
+ */
+void nelsc_sink_write(NELSC_SINK *pSink, const char *pData, size_t len);
+
+/*
+ * Write a null-terminated string to a sink.
+ * 
+ * The terminating null is not written.
+ * 
+ * Parameters:
+ * 
+ *   pSink - the sink
+ * 
+ *   str - the string to write
+ * 
+ * Faults:
+ * 
+ *   - If pSink or str is NULL
+ * 
+ *   - If memory allocation fails
+ * 
+ * Undefined behavior:
+ * 
+ *   - If str is not null-terminated
+ */
+void nelsc_sink_puts(NELSC_SINK *pSink, const char *str);
+
+/*
+ * Write formatted output to a sink.
+ * 
+ * The format string and arguments are interpreted in the same way as by
+ * printf().
+ * 
+ * Parameters:
+ * 
+ *   pSink - the sink
+ * 
+ *   pFormat - the printf format string
+ * 
+ *   ... - the arguments for the format string
+ * 
+ * Faults:
+ * 
+ *   - If pSink or pFormat is NULL
+ * 
+ *   - If formatting fails
+ * 
+ *   - If memory allocation fails
+ * 
+ * Undefined behavior:
+ * 
+ *   - If the arguments do not match the format string
+ */
+void nelsc_sink_printf(NELSC_SINK *pSink, const char *pFormat, ...);
+
+/*
+ * Flush a sink.
+ * 
+ * For descriptor sinks, any gathered output is written to the
+ * descriptor.  For file sinks, the file is flushed.  Buffer sinks are
+ * not affected.
+ * 
+ * Parameters:
+ * 
+ *   pSink - the sink
+ * 
+ * Faults:
+ * 
+ *   - If pSink is NULL
+ */
+void nelsc_sink_flush(NELSC_SINK *pSink);
+
+/*
+ * Find out whether writing to the destination of a sink has failed.
+ * 
+ * Output is written to the destination of a descriptor sink only when
+ * its buffer fills up or it is flushed, and a file sink may keep output
+ * in the buffer of its file, so the sink should be flushed first.
+ * Buffer sinks never fail.
+ * 
+ * Parameters:
+ * 
+ *   pSink - the sink
+ * 
+ * Return:
+ * 
+ *   true if any output to the sink has been lost, false if not
+ * 
+ * Faults:
+ * 
+ *   - If pSink is NULL
+ */
+bool nelsc_sink_failed(const NELSC_SINK *pSink);
+
+/*
+ * Get the number of bytes held in a buffer sink.
+ * 
+ * Parameters:
+ * 
+ *   pSink - the buffer sink
+ * 
+ * Return:
+ * 
+ *   the number of bytes written since the sink was created or last
+ *   cleared
+ * 
+ * Faults:
+ * 
+ *   - If pSink is NULL
+ * 
+ *   - If pSink is not a buffer sink
+ */
+size_t nelsc_sink_length(const NELSC_SINK *pSink);
+
+/*
+ * Get the data held in a buffer sink.
+ * 
+ * The returned pointer is only valid until the next operation that
+ * modifies the sink.  The data is not null-terminated.  Use
+ * nelsc_sink_length() to get its length.
+ * 
+ * Parameters:
+ * 
+ *   pSink - the buffer sink
+ * 
+ * Return:
+ * 
+ *   pointer to the data, which may be NULL if the length is zero
+ * 
+ * Faults:
+ * 
+ *   - If pSink is NULL
+ * 
+ *   - If pSink is not a buffer sink
+ */
+const char *nelsc_sink_data(const NELSC_SINK *pSink);
+
+/*
+ * Discard all the data held in a buffer sink.
+ * 
+ * The memory allocated for the buffer is kept for reuse.
+ * 
+ * Parameters:
+ * 
+ *   pSink - the buffer sink
+ * 
+ * Faults:
+ * 
+ *   - If pSink is NULL
+ * 
+ *   - If pSink is not a buffer sink
+ */
+void nelsc_sink_clear(NELSC_SINK *pSink);
+
+/*
+ * Move all the data held in a buffer sink to another sink.
+ * 
+ * The data is written to pDest and then pSrc is cleared.
+ * 
+ * Parameters:
+ * 
+ *   pDest - the sink to write to
+ * 
+ *   pSrc - the buffer sink to move the data from
+ * 
+ * Faults:
+ * 
+ *   - If pDest or pSrc is NULL
+ * 
+ *   - If pSrc is not a buffer sink
+ * 
+ *   - If pDest and pSrc are the same
+ * 
+ *   - If memory allocation fails
+ */
+void nelsc_sink_drain(NELSC_SINK *pDest, NELSC_SINK *pSrc);
+
+#endif
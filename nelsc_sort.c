@@ -0,0 +1,915 @@
+/*
+ * nelsc_sort.c
+ * 
+ * Implementation of nelsc_sort.h
+ * 
+ * See the header for further information.
+ */
+
+#include "nelsc_sort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * The number of bits in each digit of the radix sort, the mask of a
+ * digit, the number of buckets for each digit, and the number of passes
+ * needed to cover a 32-bit key.
+ */
+#define RADIX_BITS 11
+#define RADIX_MASK 0x7ff
+#define RADIX_BUCKETS 2048
+#define RADIX_PASSES 3
+
+/*
+ * The fewest records in each section of a run, so that small runs are
+ * not split into sections too small to be worth a thread.
+ */
+#define SECTION_MIN 65536
+
+/*
+ * The most runs that are merged together at once, whatever the memory
+ * limit.
+ */
+#define FANIN_MAX 1024
+
+/*
+ * The head of a source that has no more lines, which is greater than
+ * the head of any line.
+ */
+#define HEAD_DONE UINT64_MAX
+
+/*
+ * A line in the in-memory run.
+ */
+typedef struct {
+	
+	/*
+	 * The sort key.
+	 */
+	uint32_t key;
+	
+	/*
+	 * The offset of the line in the text buffer of the run.  Each line
+	 * in the text buffer ends with a line feed.
+	 */
+	uint32_t off;
+
+} SORT_REC;
+
+/*
+ * A sorted sequence of lines being merged, which is either a section of
+ * the in-memory run or a run in a temporary file.
+ * 
+ * In a temporary file, each line is stored as its key and its length
+ * (including the line feed) as two native uint32_t values, followed by
+ * the text of the line.
+ */
+typedef struct {
+	
+	/*
+	 * The key of the current line in the high 32 bits and the index of
+	 * the source in the low 32 bits, or HEAD_DONE if there are no more
+	 * lines.  Comparing heads puts lines with equal keys from earlier
+	 * sources first, which keeps the sort stable.
+	 */
+	uint64_t head;
+	
+	/*
+	 * The current line, including its line feed, and its length.
+	 */
+	const char *pLine;
+	size_t len;
+	
+	/*
+	 * For a section, the next record, the end of the section, and the
+	 * text buffer of the run.
+	 */
+	const SORT_REC *pRec;
+	const SORT_REC *pEnd;
+	const char *pText;
+	
+	/*
+	 * For a run, the temporary file and the buffer holding the current
+	 * line.  pFile is NULL for a section.
+	 */
+	FILE *pFile;
+	char *pBuf;
+
+} SORT_SOURCE;
+
+/*
+ * NELSC_SORT structure, prototyped in header.
+ */
+struct NELSC_SORT_TAG {
+	
+	/*
+	 * The thread pool that sorts the sections of a run.
+	 */
+	NELSC_POOL *pPool;
+	
+	/*
+	 * The text buffer of the run, its length, and its capacity.
+	 */
+	char *pText;
+	size_t text_len;
+	size_t text_cap;
+	
+	/*
+	 * The records of the run, scratch space of the same size for the
+	 * radix sort, the number of records, and the capacity of both.
+	 */
+	SORT_REC *pRecs;
+	SORT_REC *pScratch;
+	size_t rec_count;
+	size_t rec_cap;
+	
+	/*
+	 * The number of sections the run is split into, and the index of
+	 * the first record of each section, followed by the number of
+	 * records.
+	 */
+	int32_t sections;
+	size_t bounds[NELSC_POOL_MAX_WORKERS + 1];
+	
+	/*
+	 * The runs in temporary files, in input order, their number, and
+	 * the capacity of the array.
+	 */
+	FILE **ppRuns;
+	int32_t run_count;
+	int32_t run_cap;
+	
+	/*
+	 * The most runs that fit in the memory limit to merge at once.
+	 */
+	int32_t fanin;
+	
+	/*
+	 * The number of runs written to temporary files.
+	 */
+	int32_t spills;
+	
+	/*
+	 * Set once the sort has been finished.
+	 */
+	bool finished;
+};
+
+/*
+ * Function prototypes
+ * ===================
+ */
+
+static void sortSection(void *pCustom, int32_t chunk);
+static void sortRun(NELSC_SORT *pSort);
+static bool sourceNext(SORT_SOURCE *pSrc, uint32_t index);
+static int32_t treeBuild(
+		const SORT_SOURCE *pSrc,
+		int32_t *pTree,
+		int32_t k,
+		int32_t node);
+static bool mergeSources(
+		SORT_SOURCE *pSrc,
+		int32_t k,
+		FILE *pRun,
+		NELSC_SINK *pOut);
+static bool mergeSections(
+		NELSC_SORT *pSort,
+		FILE *pRun,
+		NELSC_SINK *pOut);
+static bool mergeRuns(
+		NELSC_SORT *pSort,
+		int32_t first,
+		int32_t count,
+		FILE *pRun,
+		NELSC_SINK *pOut);
+static void pushRun(NELSC_SORT *pSort, FILE *pRun);
+static bool spillRun(NELSC_SORT *pSort);
+
+/*
+ * Radix-sort one section of the run.
+ * 
+ * This is the task function of the sort job on the thread pool.  The
+ * section is sorted with a stable least-significant-digit radix sort,
+ * skipping the passes in which every key has the same digit, which for
+ * day offsets is usually the top one.
+ * 
+ * Parameters:
+ * 
+ *   pCustom - the NELSC_SORT
+ * 
+ *   chunk - the index of the section
+ */
+static void sortSection(void *pCustom, int32_t chunk) {
+	
+	NELSC_SORT *pSort = NULL;
+	SORT_REC *pA = NULL;
+	SORT_REC *pB = NULL;
+	SORT_REC *pT = NULL;
+	size_t n = 0;
+	size_t i = 0;
+	size_t sum = 0;
+	size_t c = 0;
+	int p = 0;
+	int b = 0;
+	uint32_t shift = 0;
+	size_t counts[RADIX_PASSES][RADIX_BUCKETS];
+	
+	pSort = (NELSC_SORT *) pCustom;
+	pA = pSort->pRecs + pSort->bounds[chunk];
+	pB = pSort->pScratch + pSort->bounds[chunk];
+	n = pSort->bounds[chunk + 1] - pSort->bounds[chunk];
+	
+	/* Count the digits of every pass in a single read of the keys */
+	memset(counts, 0, sizeof(counts));
+	for(i = 0; i < n; i++) {
+		for(p = 0; p < RADIX_PASSES; p++) {
+			shift = (uint32_t) (p * RADIX_BITS);
+			(counts[p][(pA[i].key >> shift) & RADIX_MASK])++;
+		}
+	}
+	
+	/* Scatter by each digit from the lowest, ping-ponging between the
+	 * records and the scratch space */
+	for(p = 0; p < RADIX_PASSES; p++) {
+		if (n < 1) {
+			break;
+		}
+		shift = (uint32_t) (p * RADIX_BITS);
+		if (counts[p][(pA[0].key >> shift) & RADIX_MASK] == n) {
+			continue;
+		}
+		
+		sum = 0;
+		for(b = 0; b < RADIX_BUCKETS; b++) {
+			c = counts[p][b];
+			counts[p][b] = sum;
+			sum += c;
+		}
+		for(i = 0; i < n; i++) {
+			b = (int) ((pA[i].key >> shift) & RADIX_MASK);
+			pB[(counts[p][b])++] = pA[i];
+		}
+		
+		pT = pA;
+		pA = pB;
+		pB = pT;
+	}
+	
+	/* Make sure the sorted section ends up in the records */
+	if (pA != pSort->pRecs + pSort->bounds[chunk]) {
+		memcpy(pSort->pRecs + pSort->bounds[chunk], pA,
+			n * sizeof(SORT_REC));
+	}
+}
+
+/*
+ * Split the run into sections and radix-sort them in parallel.
+ * 
+ * There is one section for each worker of the pool, unless that would
+ * make sections smaller than SECTION_MIN records.
+ * 
+ * Parameters:
+ * 
+ *   pSort - the sort
+ */
+static void sortRun(NELSC_SORT *pSort) {
+	
+	int32_t i = 0;
+	
+	pSort->sections = nelsc_pool_workers(pSort->pPool);
+	if (pSort->rec_count / SECTION_MIN < (size_t) pSort->sections) {
+		pSort->sections = (int32_t) (pSort->rec_count / SECTION_MIN);
+	}
+	if (pSort->sections < 1) {
+		pSort->sections = 1;
+	}
+	
+	for(i = 0; i <= pSort->sections; i++) {
+		pSort->bounds[i] = (pSort->rec_count * (size_t) i) /
+								(size_t) pSort->sections;
+	}
+	
+	nelsc_pool_run(pSort->pPool, &sortSection, pSort, pSort->sections);
+}
+
+/*
+ * Move a merge source to its next line.
+ * 
+ * Parameters:
+ * 
+ *   pSrc - the source
+ * 
+ *   index - the index of the source in the merge
+ * 
+ * Return:
+ * 
+ *   true if successful, false if reading the temporary file failed
+ */
+static bool sourceNext(SORT_SOURCE *pSrc, uint32_t index) {
+	
+	bool result = true;
+	uint32_t hdr[2];
+	size_t count = 0;
+	
+	if (pSrc->pFile == NULL) {
+		/* Section of the run in memory */
+		if (pSrc->pRec < pSrc->pEnd) {
+			pSrc->pLine = pSrc->pText + pSrc->pRec->off;
+			pSrc->len = (size_t) (((const char *) memchr(
+							pSrc->pLine, '\n', NELSC_SORT_LINE_MAX)) -
+							pSrc->pLine) + 1;
+			pSrc->head = (((uint64_t) pSrc->pRec->key) << 32) | index;
+			(pSrc->pRec)++;
+		} else {
+			pSrc->head = HEAD_DONE;
+		}
+	
+	} else {
+		/* Run in a temporary file */
+		count = fread(hdr, sizeof(uint32_t), 2, pSrc->pFile);
+		if (count == 2) {
+			if ((hdr[1] < 1) || (hdr[1] > NELSC_SORT_LINE_MAX)) {
+				result = false;
+			} else if (fread(pSrc->pBuf, 1, hdr[1], pSrc->pFile) !=
+					hdr[1]) {
+				result = false;
+			} else {
+				pSrc->pLine = pSrc->pBuf;
+				pSrc->len = hdr[1];
+				pSrc->head = (((uint64_t) hdr[0]) << 32) | index;
+			}
+		
+		} else if ((count == 0) && feof(pSrc->pFile) &&
+				(!ferror(pSrc->pFile))) {
+			pSrc->head = HEAD_DONE;
+		
+		} else {
+			result = false;
+		}
+	}
+	
+	if (!result) {
+		pSrc->head = HEAD_DONE;
+	}
+	
+	return result;
+}
+
+/*
+ * Build the loser tree over a subtree of the merge sources.
+ * 
+ * The tree is stored in heap order, with the internal nodes at indices
+ * one up to k - 1 and source i as the leaf at index k + i.  Each
+ * internal node receives the loser of the match played there.
+ * 
+ * Parameters:
+ * 
+ *   pSrc - the sources
+ * 
+ *   pTree - the internal nodes of the tree
+ * 
+ *   k - the number of sources
+ * 
+ *   node - the index of the root of the subtree
+ * 
+ * Return:
+ * 
+ *   the index of the source that wins the subtree
+ */
+static int32_t treeBuild(
+		const SORT_SOURCE *pSrc,
+		int32_t *pTree,
+		int32_t k,
+		int32_t node) {
+	
+	int32_t a = 0;
+	int32_t b = 0;
+	int32_t result = 0;
+	
+	if (node >= k) {
+		result = node - k;
+	
+	} else {
+		a = treeBuild(pSrc, pTree, k, 2 * node);
+		b = treeBuild(pSrc, pTree, k, 2 * node + 1);
+		if (pSrc[b].head < pSrc[a].head) {
+			pTree[node] = a;
+			result = b;
+		} else {
+			pTree[node] = b;
+			result = a;
+		}
+	}
+	
+	return result;
+}
+
+/*
+ * Merge sorted sources with a loser tree.
+ * 
+ * Each source must already be on its first line.  After the winner's
+ * line is written, only the matches on the path from its leaf to the
+ * root are replayed, so each line costs one comparison per level of the
+ * tree.
+ * 
+ * Parameters:
+ * 
+ *   pSrc - the sources
+ * 
+ *   k - the number of sources, at least one
+ * 
+ *   pRun - the temporary file to write the merged run to, or NULL to
+ *   write the merged lines to pOut
+ * 
+ *   pOut - the sink to write the merged lines to if pRun is NULL
+ * 
+ * Return:
+ * 
+ *   true if successful, false if reading or writing a temporary file
+ *   failed
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static bool mergeSources(
+		SORT_SOURCE *pSrc,
+		int32_t k,
+		FILE *pRun,
+		NELSC_SINK *pOut) {
+	
+	bool result = true;
+	int32_t *pTree = NULL;
+	int32_t w = 0;
+	int32_t s = 0;
+	int32_t t = 0;
+	int32_t x = 0;
+	uint32_t hdr[2];
+	
+	pTree = (int32_t *) calloc((size_t) k, sizeof(int32_t));
+	if (pTree == NULL) {
+		abort();
+	}
+	
+	if (k > 1) {
+		pTree[0] = treeBuild(pSrc, pTree, k, 1);
+	}
+	
+	while (result) {
+		w = pTree[0];
+		if (pSrc[w].head == HEAD_DONE) {
+			break;
+		}
+		
+		/* Write the winning line */
+		if (pRun != NULL) {
+			hdr[0] = (uint32_t) (pSrc[w].head >> 32);
+			hdr[1] = (uint32_t) pSrc[w].len;
+			if ((fwrite(hdr, sizeof(uint32_t), 2, pRun) != 2) ||
+					(fwrite(pSrc[w].pLine, 1, pSrc[w].len, pRun) !=
+						pSrc[w].len)) {
+				result = false;
+			}
+		} else {
+			nelsc_sink_write(pOut, pSrc[w].pLine, pSrc[w].len);
+		}
+		
+		/* Advance the winner and replay its path to the root */
+		if (!sourceNext(&(pSrc[w]), (uint32_t) w)) {
+			result = false;
+		}
+		
+		s = w;
+		for(t = (w + k) / 2; t > 0; t /= 2) {
+			if (pSrc[pTree[t]].head < pSrc[s].head) {
+				x = pTree[t];
+				pTree[t] = s;
+				s = x;
+			}
+		}
+		pTree[0] = s;
+	}
+	
+	free(pTree);
+	return result;
+}
+
+/*
+ * Sort the in-memory run and merge its sections.
+ * 
+ * Parameters:
+ * 
+ *   pSort - the sort
+ * 
+ *   pRun - the temporary file to write the merged run to, or NULL to
+ *   write the merged lines to pOut
+ * 
+ *   pOut - the sink to write the merged lines to if pRun is NULL
+ * 
+ * Return:
+ * 
+ *   true if successful, false if writing the temporary file failed
+ */
+static bool mergeSections(
+		NELSC_SORT *pSort,
+		FILE *pRun,
+		NELSC_SINK *pOut) {
+	
+	SORT_SOURCE src[NELSC_POOL_MAX_WORKERS];
+	int32_t i = 0;
+	
+	sortRun(pSort);
+	
+	memset(src, 0, sizeof(src));
+	for(i = 0; i < pSort->sections; i++) {
+		src[i].pRec = pSort->pRecs + pSort->bounds[i];
+		src[i].pEnd = pSort->pRecs + pSort->bounds[i + 1];
+		src[i].pText = pSort->pText;
+		sourceNext(&(src[i]), (uint32_t) i);
+	}
+	
+	return mergeSources(src, pSort->sections, pRun, pOut);
+}
+
+/*
+ * Merge a group of consecutive runs from temporary files.
+ * 
+ * Parameters:
+ * 
+ *   pSort - the sort
+ * 
+ *   first - the index of the first run to merge
+ * 
+ *   count - the number of runs to merge
+ * 
+ *   pRun - the temporary file to write the merged run to, or NULL to
+ *   write the merged lines to pOut
+ * 
+ *   pOut - the sink to write the merged lines to if pRun is NULL
+ * 
+ * Return:
+ * 
+ *   true if successful, false if reading or writing a temporary file
+ *   failed
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static bool mergeRuns(
+		NELSC_SORT *pSort,
+		int32_t first,
+		int32_t count,
+		FILE *pRun,
+		NELSC_SINK *pOut) {
+	
+	bool result = true;
+	SORT_SOURCE *pSrc = NULL;
+	int32_t i = 0;
+	
+	pSrc = (SORT_SOURCE *) calloc((size_t) count, sizeof(SORT_SOURCE));
+	if (pSrc == NULL) {
+		abort();
+	}
+	
+	for(i = 0; i < count; i++) {
+		pSrc[i].pFile = (pSort->ppRuns)[first + i];
+		pSrc[i].pBuf = (char *) malloc(NELSC_SORT_LINE_MAX);
+		if (pSrc[i].pBuf == NULL) {
+			abort();
+		}
+		if (fseek(pSrc[i].pFile, 0, SEEK_SET)) {
+			result = false;
+		}
+		if (result) {
+			result = sourceNext(&(pSrc[i]), (uint32_t) i);
+		}
+	}
+	
+	if (result) {
+		result = mergeSources(pSrc, count, pRun, pOut);
+	}
+	
+	for(i = 0; i < count; i++) {
+		free(pSrc[i].pBuf);
+	}
+	free(pSrc);
+	
+	return result;
+}
+
+/*
+ * Add a temporary file to the end of the list of runs.
+ * 
+ * Parameters:
+ * 
+ *   pSort - the sort
+ * 
+ *   pRun - the temporary file
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static void pushRun(NELSC_SORT *pSort, FILE *pRun) {
+	
+	if (pSort->run_count >= pSort->run_cap) {
+		pSort->run_cap *= 2;
+		pSort->ppRuns = (FILE **) realloc(pSort->ppRuns,
+							((size_t) pSort->run_cap) * sizeof(FILE *));
+		if (pSort->ppRuns == NULL) {
+			abort();
+		}
+	}
+	
+	(pSort->ppRuns)[pSort->run_count] = pRun;
+	(pSort->run_count)++;
+	(pSort->spills)++;
+}
+
+/*
+ * Sort the in-memory run, write it to a new temporary file, and empty
+ * it.
+ * 
+ * Parameters:
+ * 
+ *   pSort - the sort
+ * 
+ * Return:
+ * 
+ *   true if successful, false if the temporary file couldn't be created
+ *   or written
+ */
+static bool spillRun(NELSC_SORT *pSort) {
+	
+	bool result = true;
+	FILE *pRun = NULL;
+	
+	pRun = tmpfile();
+	if (pRun == NULL) {
+		result = false;
+	}
+	
+	if (result) {
+		result = mergeSections(pSort, pRun, NULL);
+	}
+	if (result) {
+		if (fflush(pRun)) {
+			result = false;
+		}
+	}
+	
+	if (result) {
+		pushRun(pSort, pRun);
+	} else if (pRun != NULL) {
+		fclose(pRun);
+	}
+	
+	pSort->rec_count = 0;
+	pSort->text_len = 0;
+	
+	return result;
+}
+
+/*
+ * nelsc_sort_new function.
+ */
+NELSC_SORT *nelsc_sort_new(NELSC_POOL *pPool, size_t mem) {
+	
+	NELSC_SORT *pSort = NULL;
+	size_t fanin = 0;
+	
+	/* Check parameters */
+	if ((pPool == NULL) || (mem < NELSC_SORT_MEM_MIN)) {
+		abort();
+	}
+	
+	pSort = (NELSC_SORT *) calloc(1, sizeof(NELSC_SORT));
+	if (pSort == NULL) {
+		abort();
+	}
+	
+	pSort->pPool = pPool;
+	
+	/* Half the memory holds the text of the run, and the other half the
+	 * records and the scratch space of the radix sort; offsets into the
+	 * text must fit in 32 bits */
+	pSort->text_cap = mem / 2;
+	if (pSort->text_cap > UINT32_MAX) {
+		pSort->text_cap = UINT32_MAX;
+	}
+	pSort->rec_cap = mem / (4 * sizeof(SORT_REC));
+	
+	pSort->pText = (char *) malloc(pSort->text_cap);
+	pSort->pRecs = (SORT_REC *) malloc(
+							pSort->rec_cap * sizeof(SORT_REC));
+	pSort->pScratch = (SORT_REC *) malloc(
+							pSort->rec_cap * sizeof(SORT_REC));
+	if ((pSort->pText == NULL) || (pSort->pRecs == NULL) ||
+			(pSort->pScratch == NULL)) {
+		abort();
+	}
+	
+	/* Each run being merged needs a line buffer and a stdio buffer */
+	fanin = mem / (NELSC_SORT_LINE_MAX + BUFSIZ);
+	if (fanin > FANIN_MAX) {
+		fanin = FANIN_MAX;
+	}
+	if (fanin < 2) {
+		fanin = 2;
+	}
+	pSort->fanin = (int32_t) fanin;
+	
+	pSort->run_cap = 16;
+	pSort->ppRuns = (FILE **) calloc(
+						(size_t) pSort->run_cap, sizeof(FILE *));
+	if (pSort->ppRuns == NULL) {
+		abort();
+	}
+	
+	return pSort;
+}
+
+/*
+ * nelsc_sort_free function.
+ */
+void nelsc_sort_free(NELSC_SORT *pSort) {
+	
+	int32_t i = 0;
+	
+	if (pSort != NULL) {
+		for(i = 0; i < pSort->run_count; i++) {
+			fclose((pSort->ppRuns)[i]);
+		}
+		free(pSort->ppRuns);
+		free(pSort->pText);
+		free(pSort->pRecs);
+		free(pSort->pScratch);
+		free(pSort);
+	}
+}
+
+/*
+ * nelsc_sort_add function.
+ */
+bool nelsc_sort_add(
+		NELSC_SORT *pSort,
+		uint32_t key,
+		const char *pLine,
+		size_t len) {
+	
+	bool result = true;
+	SORT_REC *pRec = NULL;
+	
+	/* Check parameters and state */
+	if (pSort == NULL) {
+		abort();
+	}
+	if (((len > 0) && (pLine == NULL)) ||
+			(len >= NELSC_SORT_LINE_MAX)) {
+		abort();
+	}
+	if (pSort->finished) {
+		abort();
+	}
+	
+	/* Spill the run if it is full */
+	if ((pSort->rec_count >= pSort->rec_cap) ||
+			(pSort->text_cap - pSort->text_len < len + 1)) {
+		result = spillRun(pSort);
+	}
+	
+	/* Add the line and its record */
+	if (result) {
+		pRec = &((pSort->pRecs)[pSort->rec_count]);
+		pRec->key = key;
+		pRec->off = (uint32_t) pSort->text_len;
+		(pSort->rec_count)++;
+		
+		if (len > 0) {
+			memcpy(pSort->pText + pSort->text_len, pLine, len);
+		}
+		pSort->text_len += len;
+		(pSort->pText)[pSort->text_len] = '\n';
+		(pSort->text_len)++;
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_sort_finish function.
+ */
+bool nelsc_sort_finish(NELSC_SORT *pSort, NELSC_SINK *pOut) {
+	
+	bool result = true;
+	bool done = false;
+	FILE *pRun = NULL;
+	int32_t first = 0;
+	int32_t count = 0;
+	int32_t merged = 0;
+	int32_t i = 0;
+	
+	/* Check parameters and state */
+	if ((pSort == NULL) || (pOut == NULL)) {
+		abort();
+	}
+	if (pSort->finished) {
+		abort();
+	}
+	pSort->finished = true;
+	
+	/* If nothing was spilled, merge the sections straight to output;
+	 * otherwise spill what is left of the run, and release the run
+	 * buffers to make room for the merge buffers */
+	if (pSort->run_count < 1) {
+		result = mergeSections(pSort, NULL, pOut);
+		done = true;
+	
+	} else if (pSort->rec_count > 0) {
+		result = spillRun(pSort);
+	}
+	
+	if (!done) {
+		free(pSort->pText);
+		free(pSort->pRecs);
+		free(pSort->pScratch);
+		pSort->pText = NULL;
+		pSort->pRecs = NULL;
+		pSort->pScratch = NULL;
+	}
+	
+	/* Merge groups of consecutive runs until they can all be merged at
+	 * once; merged runs replace their groups in order, so the merge
+	 * stays stable */
+	while ((!done) && result && (pSort->run_count > pSort->fanin)) {
+		merged = 0;
+		for(first = 0; first < pSort->run_count; first += count) {
+			count = pSort->run_count - first;
+			if (count > pSort->fanin) {
+				count = pSort->fanin;
+			}
+			
+			if (count > 1) {
+				pRun = tmpfile();
+				if (pRun == NULL) {
+					result = false;
+				}
+				if (result) {
+					result = mergeRuns(pSort, first, count, pRun, NULL);
+				}
+				if (result) {
+					if (fflush(pRun)) {
+						result = false;
+					}
+				}
+				if (!result) {
+					if (pRun != NULL) {
+						fclose(pRun);
+					}
+					break;
+				}
+				
+				for(i = first; i < first + count; i++) {
+					fclose((pSort->ppRuns)[i]);
+				}
+				(pSort->ppRuns)[merged] = pRun;
+				(pSort->spills)++;
+			
+			} else {
+				(pSort->ppRuns)[merged] = (pSort->ppRuns)[first];
+			}
+			merged++;
+		}
+		
+		/* On failure, keep the runs that are still open together so
+		 * they are all closed when the sort is released */
+		if (!result) {
+			memmove(pSort->ppRuns + merged, pSort->ppRuns + first,
+				((size_t) (pSort->run_count - first)) * sizeof(FILE *));
+			merged += pSort->run_count - first;
+		}
+		pSort->run_count = merged;
+	}
+	
+	/* Merge the remaining runs to output */
+	if ((!done) && result) {
+		result = mergeRuns(pSort, 0, pSort->run_count, NULL, pOut);
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_sort_spills function.
+ */
+int32_t nelsc_sort_spills(const NELSC_SORT *pSort) {
+	
+	if (pSort == NULL) {
+		abort();
+	}
+	
+	return pSort->spills;
+}
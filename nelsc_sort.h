@@ -0,0 +1,172 @@
+#ifndef NELSC_SORT_H_INCLUDED
+#define NELSC_SORT_H_INCLUDED
+
+/*
+ * nelsc_sort.h
+ * 
+ * External merge sort of text lines by a 32-bit key, such as a day
+ * offset, within a fixed memory limit.
+ * 
+ * Lines are gathered into an in-memory run along with their keys.  When
+ * the run is full, it is split into one section for each worker of a
+ * thread pool, the sections are radix-sorted in parallel, and the
+ * sorted sections are merged into a temporary file.  At the end, the
+ * runs are merged with a loser tree into the output.  If there are more
+ * runs than can be merged at once within the memory limit, they are
+ * first merged in groups into longer runs.  If all the lines fit into a
+ * single run, the sections are merged straight into the output and no
+ * temporary file is used.
+ * 
+ * The sort is stable, so lines with equal keys keep their input order.
+ * 
+ * Temporary files are made with tmpfile(), so they are removed when
+ * they are closed or when the process ends.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "nelsc_pool.h"
+#include "nelsc_sink.h"
+
+/*
+ * The smallest memory limit in bytes.
+ */
+#define NELSC_SORT_MEM_MIN 4194304
+
+/*
+ * The maximum length of a line, including the line feed.
+ */
+#define NELSC_SORT_LINE_MAX 65536
+
+/*
+ * NELSC_SORT structure prototype.
+ * 
+ * See the implementation file for definition.
+ */
+struct NELSC_SORT_TAG;
+typedef struct NELSC_SORT_TAG NELSC_SORT;
+
+/*
+ * Create a new sort.
+ * 
+ * The memory limit covers the run buffers and the buffers used while
+ * merging.  The in-memory runs are sorted with the workers of the given
+ * pool, which must stay valid until the sort is released.  The sort
+ * must eventually be released with nelsc_sort_free().
+ * 
+ * Parameters:
+ * 
+ *   pPool - the thread pool to sort runs with
+ * 
+ *   mem - the memory limit in bytes
+ * 
+ * Return:
+ * 
+ *   the new sort
+ * 
+ * Faults:
+ * 
+ *   - If pPool is NULL
+ * 
+ *   - If mem is less than NELSC_SORT_MEM_MIN
+ * 
+ *   - If memory allocation fails
+ */
+NELSC_SORT *nelsc_sort_new(NELSC_POOL *pPool, size_t mem);
+
+/*
+ * Release a sort, along with any temporary files.
+ * 
+ * Does nothing if pSort is NULL.
+ * 
+ * Parameters:
+ * 
+ *   pSort - the sort to release, or NULL
+ */
+void nelsc_sort_free(NELSC_SORT *pSort);
+
+/*
+ * Add a line to a sort.
+ * 
+ * The line is given without a line feed, and one is added to it in the
+ * output.  If the current run is full, it is sorted and written to a
+ * temporary file first.
+ * 
+ * Parameters:
+ * 
+ *   pSort - the sort
+ * 
+ *   key - the key to sort the line by
+ * 
+ *   pLine - the text of the line
+ * 
+ *   len - the number of characters in the line
+ * 
+ * Return:
+ * 
+ *   true if successful, false if a temporary file couldn't be created
+ *   or written
+ * 
+ * Faults:
+ * 
+ *   - If pSort is NULL
+ * 
+ *   - If len is greater than zero and pLine is NULL
+ * 
+ *   - If len is not less than NELSC_SORT_LINE_MAX
+ * 
+ *   - If the sort has been finished
+ */
+bool nelsc_sort_add(
+		NELSC_SORT *pSort,
+		uint32_t key,
+		const char *pLine,
+		size_t len);
+
+/*
+ * Finish a sort, writing all the lines in order of their keys.
+ * 
+ * No more lines may be added afterwards.
+ * 
+ * Parameters:
+ * 
+ *   pSort - the sort
+ * 
+ *   pOut - the sink to write the sorted lines to
+ * 
+ * Return:
+ * 
+ *   true if successful, false if a temporary file couldn't be created,
+ *   written, or read
+ * 
+ * Faults:
+ * 
+ *   - If pSort or pOut is NULL
+ * 
+ *   - If the sort has already been finished
+ * 
+ *   - If memory allocation fails
+ */
+bool nelsc_sort_finish(NELSC_SORT *pSort, NELSC_SINK *pOut);
+
+/*
+ * Get the number of runs that were written to temporary files.
+ * 
+ * Parameters:
+ * 
+ *   pSort - the sort
+ * 
+ * Return:
+ * 
+ *   the number of runs spilled so far, including those written while
+ *   merging runs in groups
+ * 
+ * Faults:
+ * 
+ *   - If pSort is NULL
+ */
+int32_t nelsc_sort_spills(const NELSC_SORT *pSort);
+
+#endif
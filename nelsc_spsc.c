@@ -0,0 +1,264 @@
+/*
+ * nelsc_spsc.c
+ * 
+ * Implementation of nelsc_spsc.h
+ * 
+ * See the header for further information.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "nelsc_spsc.h"
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if !defined(__GNUC__)
+#error nelsc_spsc requires the GCC atomic builtins
+#endif
+
+/*
+ * The size in bytes of the padding that keeps the producer and consumer
+ * indices on separate cache lines.
+ */
+#define CACHE_LINE 64
+
+/*
+ * The number of times a waiting push or pop retries while yielding the
+ * processor before it starts sleeping.
+ */
+#define SPIN_COUNT 64
+
+/*
+ * The first and the longest sleep in nanoseconds of a waiting push or
+ * pop.  The sleep doubles each time until it reaches the longest.
+ */
+#define SLEEP_MIN_NS 20000L
+#define SLEEP_MAX_NS 1000000L
+
+/*
+ * NELSC_SPSC structure.
+ * 
+ * Prototype given in the header.
+ * 
+ * The indices count up without wrapping at the capacity; the slot of an
+ * index is found by masking.  Unsigned overflow of the indices is
+ * harmless since only their difference matters.
+ */
+struct NELSC_SPSC_TAG {
+	
+	/*
+	 * The slots of the ring buffer.
+	 */
+	void **ppSlots;
+	
+	/*
+	 * The capacity minus one, used to mask indices into slots.
+	 */
+	uint32_t mask;
+	
+	/*
+	 * Padding before the producer index.
+	 */
+	char pad_1[CACHE_LINE];
+	
+	/*
+	 * The index of the next slot the producer writes.  Only written by
+	 * the producer.
+	 */
+	uint32_t tail;
+	
+	/*
+	 * Padding between the producer and consumer indices.
+	 */
+	char pad_2[CACHE_LINE];
+	
+	/*
+	 * The index of the next slot the consumer reads.  Only written by
+	 * the consumer.
+	 */
+	uint32_t head;
+	
+	/*
+	 * Padding after the consumer index.
+	 */
+	char pad_3[CACHE_LINE];
+};
+
+/*
+ * Function prototypes
+ */
+static void backOff(int32_t *pRound);
+
+/*
+ * Wait a little before retrying a queue operation.
+ * 
+ * The first SPIN_COUNT rounds only yield the processor.  Later rounds
+ * sleep for increasing lengths of time.
+ * 
+ * Parameters:
+ * 
+ *   pRound - the number of rounds waited so far, which is incremented
+ */
+static void backOff(int32_t *pRound) {
+	
+	struct timespec ts;
+	long ns = 0;
+	int32_t r = 0;
+	
+	if (*pRound < SPIN_COUNT) {
+		sched_yield();
+		(*pRound)++;
+	
+	} else {
+		ns = SLEEP_MIN_NS;
+		for(r = SPIN_COUNT; r < *pRound; r++) {
+			ns *= 2;
+			if (ns >= SLEEP_MAX_NS) {
+				ns = SLEEP_MAX_NS;
+				break;
+			}
+		}
+		if (ns < SLEEP_MAX_NS) {
+			(*pRound)++;
+		}
+		
+		ts.tv_sec = 0;
+		ts.tv_nsec = ns;
+		nanosleep(&ts, NULL);
+	}
+}
+
+/*
+ * nelsc_spsc_new function.
+ */
+NELSC_SPSC *nelsc_spsc_new(int32_t cap) {
+	
+	NELSC_SPSC *pQueue = NULL;
+	
+	/* Check parameters */
+	if ((cap < 2) || (cap > NELSC_SPSC_MAX_CAP) ||
+			((cap & (cap - 1)) != 0)) {
+		abort();
+	}
+	
+	/* Allocate the queue */
+	pQueue = (NELSC_SPSC *) malloc(sizeof(NELSC_SPSC));
+	if (pQueue == NULL) {
+		abort();
+	}
+	memset(pQueue, 0, sizeof(NELSC_SPSC));
+	
+	pQueue->ppSlots = (void **) malloc(((size_t) cap) * sizeof(void *));
+	if (pQueue->ppSlots == NULL) {
+		abort();
+	}
+	
+	pQueue->mask = (uint32_t) (cap - 1);
+	pQueue->tail = 0;
+	pQueue->head = 0;
+	
+	return pQueue;
+}
+
+/*
+ * nelsc_spsc_free function.
+ */
+void nelsc_spsc_free(NELSC_SPSC *pQueue) {
+	if (pQueue != NULL) {
+		free(pQueue->ppSlots);
+		free(pQueue);
+	}
+}
+
+/*
+ * nelsc_spsc_tryPush function.
+ */
+bool nelsc_spsc_tryPush(NELSC_SPSC *pQueue, void *pItem) {
+	
+	bool result = true;
+	uint32_t t = 0;
+	uint32_t h = 0;
+	
+	/* Check parameters */
+	if (pQueue == NULL) {
+		abort();
+	}
+	
+	/* The producer owns tail; acquire head so that the consumer is done
+	 * reading a slot before it is reused */
+	t = pQueue->tail;
+	h = __atomic_load_n(&(pQueue->head), __ATOMIC_ACQUIRE);
+	
+	if (t - h > pQueue->mask) {
+		result = false;
+	}
+	
+	/* Store the item and then publish it */
+	if (result) {
+		(pQueue->ppSlots)[t & pQueue->mask] = pItem;
+		__atomic_store_n(&(pQueue->tail), t + 1, __ATOMIC_RELEASE);
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_spsc_tryPop function.
+ */
+bool nelsc_spsc_tryPop(NELSC_SPSC *pQueue, void **ppItem) {
+	
+	bool result = true;
+	uint32_t t = 0;
+	uint32_t h = 0;
+	
+	/* Check parameters */
+	if ((pQueue == NULL) || (ppItem == NULL)) {
+		abort();
+	}
+	
+	/* The consumer owns head; acquire tail so that the item stored by
+	 * the producer is visible */
+	h = pQueue->head;
+	t = __atomic_load_n(&(pQueue->tail), __ATOMIC_ACQUIRE);
+	
+	if (t == h) {
+		result = false;
+	}
+	
+	/* Read the item and then release the slot */
+	if (result) {
+		*ppItem = (pQueue->ppSlots)[h & pQueue->mask];
+		__atomic_store_n(&(pQueue->head), h + 1, __ATOMIC_RELEASE);
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_spsc_push function.
+ */
+void nelsc_spsc_push(NELSC_SPSC *pQueue, void *pItem) {
+	
+	int32_t round = 0;
+	
+	while (!nelsc_spsc_tryPush(pQueue, pItem)) {
+		backOff(&round);
+	}
+}
+
+/*
+ * nelsc_spsc_pop function.
+ */
+void *nelsc_spsc_pop(NELSC_SPSC *pQueue) {
+	
+	void *pItem = NULL;
+	int32_t round = 0;
+	
+	while (!nelsc_spsc_tryPop(pQueue, &pItem)) {
+		backOff(&round);
+	}
+	
+	return pItem;
+}
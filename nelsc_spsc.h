@@ -0,0 +1,158 @@
+#ifndef NELSC_SPSC_H_INCLUDED
+#define NELSC_SPSC_H_INCLUDED
+
+/*
+ * nelsc_spsc.h
+ * 
+ * Provides a bounded lock-free queue of pointers connecting exactly one
+ * producer thread to exactly one consumer thread.
+ * 
+ * The queue is a ring buffer with a producer index and a consumer
+ * index kept on separate cache lines.  Each index is only written by
+ * its own side and is published to the other side with release and
+ * acquire ordering, so no locks are needed.
+ * 
+ * The waiting versions of push and pop spin briefly and then back off
+ * with short sleeps, so a full queue holds back the producer and an
+ * empty queue holds back the consumer without busy waiting for long.
+ * 
+ * The implementation uses the GCC atomic builtins, which are also
+ * supported by Clang.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * The maximum capacity of a queue.
+ */
+#define NELSC_SPSC_MAX_CAP 65536
+
+/*
+ * NELSC_SPSC structure prototype.
+ * 
+ * See the implementation file for definition.
+ */
+struct NELSC_SPSC_TAG;
+typedef struct NELSC_SPSC_TAG NELSC_SPSC;
+
+/*
+ * Create a new queue.
+ * 
+ * The capacity must be a power of two in range 2 up to
+ * NELSC_SPSC_MAX_CAP.  The queue must eventually be released with
+ * nelsc_spsc_free().
+ * 
+ * Parameters:
+ * 
+ *   cap - the maximum number of items the queue can hold
+ * 
+ * Return:
+ * 
+ *   the new queue
+ * 
+ * Faults:
+ * 
+ *   - If cap is out of range or not a power of two
+ * 
+ *   - If memory allocation fails
+ */
+NELSC_SPSC *nelsc_spsc_new(int32_t cap);
+
+/*
+ * Release a queue.
+ * 
+ * Any items still in the queue are not released.  Does nothing if
+ * pQueue is NULL.
+ * 
+ * Parameters:
+ * 
+ *   pQueue - the queue to release, or NULL
+ * 
+ * Undefined behavior:
+ * 
+ *   - If another thread is still using the queue
+ */
+void nelsc_spsc_free(NELSC_SPSC *pQueue);
+
+/*
+ * Add an item to the back of a queue if there is room.
+ * 
+ * Only the producer thread of the queue may call this function.  The
+ * item may be NULL.
+ * 
+ * Parameters:
+ * 
+ *   pQueue - the queue
+ * 
+ *   pItem - the item to add
+ * 
+ * Return:
+ * 
+ *   true if the item was added, false if the queue is full
+ * 
+ * Faults:
+ * 
+ *   - If pQueue is NULL
+ */
+bool nelsc_spsc_tryPush(NELSC_SPSC *pQueue, void *pItem);
+
+/*
+ * Remove the item at the front of a queue if there is one.
+ * 
+ * Only the consumer thread of the queue may call this function.
+ * 
+ * Parameters:
+ * 
+ *   pQueue - the queue
+ * 
+ *   ppItem - pointer to the variable to receive the item
+ * 
+ * Return:
+ * 
+ *   true if an item was removed, false if the queue is empty
+ * 
+ * Faults:
+ * 
+ *   - If pQueue or ppItem is NULL
+ */
+bool nelsc_spsc_tryPop(NELSC_SPSC *pQueue, void **ppItem);
+
+/*
+ * Add an item to the back of a queue, waiting while it is full.
+ * 
+ * Only the producer thread of the queue may call this function.  The
+ * item may be NULL.
+ * 
+ * Parameters:
+ * 
+ *   pQueue - the queue
+ * 
+ *   pItem - the item to add
+ * 
+ * Faults:
+ * 
+ *   - If pQueue is NULL
+ */
+void nelsc_spsc_push(NELSC_SPSC *pQueue, void *pItem);
+
+/*
+ * Remove the item at the front of a queue, waiting while it is empty.
+ * 
+ * Only the consumer thread of the queue may call this function.
+ * 
+ * Parameters:
+ * 
+ *   pQueue - the queue
+ * 
+ * Return:
+ * 
+ *   the item, which is NULL if NULL was pushed
+ * 
+ * Faults:
+ * 
+ *   - If pQueue is NULL
+ */
+void *nelsc_spsc_pop(NELSC_SPSC *pQueue);
+
+#endif
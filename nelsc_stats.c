@@ -0,0 +1,296 @@
+/*
+ * nelsc_stats.c
+ * 
+ * Implementation of nelsc_stats.h
+ * 
+ * See the header for further information.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "nelsc_stats.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "nelsc_arena.h"
+#include "nelsc_detect.h"
+
+/*
+ * Whether the processor cycle counter is used as the probe clock.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define STATS_CYCLES 1
+#else
+#define STATS_CYCLES 0
+#endif
+
+/*
+ * The counters of a single probe.
+ */
+typedef struct {
+	
+	/*
+	 * The number of calls.
+	 */
+	uint64_t calls;
+	
+	/*
+	 * The number of calls that failed validation.
+	 */
+	uint64_t failures;
+	
+	/*
+	 * The total clock ticks spent in the calls.
+	 */
+	uint64_t ticks;
+
+} STATS_PROBE;
+
+/*
+ * The names of the probed functions, indexed by probe.
+ */
+static const char *m_names[NELSC_PROBE_COUNT] = {
+	"nelsc_cycle_dayToMonth",
+	"nelsc_cycle_monthToDay",
+	"nelsc_cycle_monthToYear",
+	"nelsc_cycle_yearToMonth",
+	"nelsc_cycle_isLongMonth",
+	"nelsc_cycle_isLongYear",
+	"grcal_offsetToDate",
+	"grcal_dateToOffset",
+	"grcal_writeDate",
+	"grcal_scanDate",
+	"nelsc_format_writeDate",
+	"nelsc_format_scanDate",
+	"base24_pairToInt",
+	"base24_writePair"
+};
+
+/*
+ * The process totals, protected by m_lock.
+ */
+static STATS_PROBE m_totals[NELSC_PROBE_COUNT];
+static pthread_mutex_t m_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * The key of the per-thread counter tables, created once.
+ */
+static pthread_once_t m_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t m_key;
+
+/*
+ * Function prototypes
+ */
+static void mergeTable(STATS_PROBE *pTable);
+static void destroyLocal(void *pValue);
+static void createKey(void);
+
+/*
+ * Add a table of counters into the process totals.
+ * 
+ * Parameters:
+ * 
+ *   pTable - the counters, with NELSC_PROBE_COUNT elements
+ */
+static void mergeTable(STATS_PROBE *pTable) {
+	
+	int i = 0;
+	
+	if (pthread_mutex_lock(&m_lock)) {
+		abort();
+	}
+	
+	for(i = 0; i < NELSC_PROBE_COUNT; i++) {
+		m_totals[i].calls += pTable[i].calls;
+		m_totals[i].failures += pTable[i].failures;
+		m_totals[i].ticks += pTable[i].ticks;
+	}
+	
+	if (pthread_mutex_unlock(&m_lock)) {
+		abort();
+	}
+}
+
+/*
+ * Merge and release the counters of an exiting thread.
+ * 
+ * This is the destructor of the per-thread key.
+ * 
+ * Parameters:
+ * 
+ *   pValue - the counter table
+ */
+static void destroyLocal(void *pValue) {
+	mergeTable((STATS_PROBE *) pValue);
+	free(pValue);
+}
+
+/*
+ * Create the key of the per-thread counter tables.
+ * 
+ * Called once through pthread_once().
+ */
+static void createKey(void) {
+	if (pthread_key_create(&m_key, &destroyLocal)) {
+		abort();
+	}
+}
+
+/*
+ * nelsc_stats_compiled function.
+ */
+bool nelsc_stats_compiled(void) {
+#ifdef NELSC_STATS
+	return true;
+#else
+	return false;
+#endif
+}
+
+/*
+ * nelsc_stats_now function.
+ */
+uint64_t nelsc_stats_now(void) {
+
+#if STATS_CYCLES
+	return (uint64_t) __builtin_ia32_rdtsc();
+#else
+	struct timespec ts;
+	
+	if (clock_gettime(CLOCK_MONOTONIC, &ts)) {
+		abort();
+	}
+	return (((uint64_t) ts.tv_sec) * UINT64_C(1000000000)) +
+			((uint64_t) ts.tv_nsec);
+#endif
+}
+
+/*
+ * nelsc_stats_record function.
+ */
+void nelsc_stats_record(int probe, uint64_t start, bool ok) {
+	
+	uint64_t now = 0;
+	STATS_PROBE *pTable = NULL;
+	
+	now = nelsc_stats_now();
+	
+	/* Check parameters */
+	if ((probe < 0) || (probe >= NELSC_PROBE_COUNT)) {
+		abort();
+	}
+	
+	/* Get the table of the calling thread, creating it if necessary */
+	if (pthread_once(&m_key_once, &createKey)) {
+		abort();
+	}
+	
+	pTable = (STATS_PROBE *) pthread_getspecific(m_key);
+	if (pTable == NULL) {
+		pTable = (STATS_PROBE *) calloc(
+					NELSC_PROBE_COUNT, sizeof(STATS_PROBE));
+		if (pTable == NULL) {
+			abort();
+		}
+		if (pthread_setspecific(m_key, pTable)) {
+			abort();
+		}
+	}
+	
+	/* Count the call */
+	(pTable[probe].calls)++;
+	if (!ok) {
+		(pTable[probe].failures)++;
+	}
+	pTable[probe].ticks += now - start;
+}
+
+/*
+ * nelsc_stats_merge function.
+ */
+void nelsc_stats_merge(void) {
+	
+	STATS_PROBE *pTable = NULL;
+	
+	if (pthread_once(&m_key_once, &createKey)) {
+		abort();
+	}
+	
+	pTable = (STATS_PROBE *) pthread_getspecific(m_key);
+	if (pTable != NULL) {
+		mergeTable(pTable);
+		memset(pTable, 0, NELSC_PROBE_COUNT * sizeof(STATS_PROBE));
+	}
+}
+
+/*
+ * nelsc_stats_print function.
+ */
+void nelsc_stats_print(NELSC_SINK *pOut) {
+	
+	STATS_PROBE totals[NELSC_PROBE_COUNT];
+	NELSC_ARENA_COUNTERS arena;
+	uint64_t formats[NELSC_DETECT_COUNT];
+	int i = 0;
+	
+	/* Check parameters */
+	if (pOut == NULL) {
+		abort();
+	}
+	
+	/* Take a copy of the totals */
+	if (pthread_mutex_lock(&m_lock)) {
+		abort();
+	}
+	memcpy(totals, m_totals, sizeof(totals));
+	if (pthread_mutex_unlock(&m_lock)) {
+		abort();
+	}
+	
+	/* Print the probes */
+	if (nelsc_stats_compiled()) {
+		nelsc_sink_printf(pOut, "%-24s %12s %10s %14s %8s\n",
+			"probe", "calls", "failures",
+			STATS_CYCLES ? "cycles" : "nanoseconds", "per call");
+		
+		for(i = 0; i < NELSC_PROBE_COUNT; i++) {
+			if (totals[i].calls < 1) {
+				continue;
+			}
+			nelsc_sink_printf(pOut,
+				"%-24s %12llu %10llu %14llu %8llu\n",
+				m_names[i],
+				(unsigned long long) totals[i].calls,
+				(unsigned long long) totals[i].failures,
+				(unsigned long long) totals[i].ticks,
+				(unsigned long long)
+					(totals[i].ticks / totals[i].calls));
+		}
+	
+	} else {
+		nelsc_sink_printf(pOut,
+			"Probes not compiled in (build with -DNELSC_STATS)\n");
+	}
+	
+	/* Print the arena totals */
+	nelsc_arena_totals(&arena);
+	nelsc_sink_printf(pOut,
+		"arena: %llu allocs, %llu resets, %llu block mallocs, "
+		"%llu block frees, %llu bytes held\n",
+		(unsigned long long) arena.allocs,
+		(unsigned long long) arena.resets,
+		(unsigned long long) arena.block_mallocs,
+		(unsigned long long) arena.block_frees,
+		(unsigned long long) arena.block_bytes);
+	
+	/* Print the number of dates parsed in each format, if any */
+	nelsc_detect_totals(formats);
+	for(i = 0; i < NELSC_DETECT_COUNT; i++) {
+		if (formats[i] > 0) {
+			nelsc_sink_printf(pOut, "format %-10s %12llu dates\n",
+				nelsc_detect_name(i),
+				(unsigned long long) formats[i]);
+		}
+	}
+}
@@ -0,0 +1,137 @@
+#ifndef NELSC_STATS_H_INCLUDED
+#define NELSC_STATS_H_INCLUDED
+
+/*
+ * nelsc_stats.h
+ * 
+ * Provides optional counters and timing probes for the entry points of
+ * the calendar modules.
+ * 
+ * Each probe counts the calls of one function, how many of those calls
+ * failed validation, and the total time spent in the calls.  The time
+ * is measured in processor cycles where the cycle counter is available
+ * and in nanoseconds otherwise.  Times are inclusive, so a probed
+ * function that calls another probed function is charged for both.
+ * 
+ * Probes are only compiled in if the NELSC_STATS macro is defined when
+ * building, for example with -DNELSC_STATS.  Otherwise, the
+ * NELSC_STATS_BEGIN and NELSC_STATS_END macros expand to nothing and
+ * the probed functions run exactly as before.
+ * 
+ * Counters are kept separately by each thread without locking.  A
+ * thread's counters are merged into the process totals when the thread
+ * exits, or when it calls nelsc_stats_merge().
+ * 
+ * Per-thread counters use POSIX threads.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "nelsc_sink.h"
+
+/*
+ * The probes.
+ */
+#define NELSC_PROBE_CYCLE_DAYTOMONTH  0
+#define NELSC_PROBE_CYCLE_MONTHTODAY  1
+#define NELSC_PROBE_CYCLE_MONTHTOYEAR 2
+#define NELSC_PROBE_CYCLE_YEARTOMONTH 3
+#define NELSC_PROBE_CYCLE_ISLONGMONTH 4
+#define NELSC_PROBE_CYCLE_ISLONGYEAR  5
+#define NELSC_PROBE_GRCAL_OFFSETTODATE 6
+#define NELSC_PROBE_GRCAL_DATETOOFFSET 7
+#define NELSC_PROBE_GRCAL_WRITEDATE    8
+#define NELSC_PROBE_GRCAL_SCANDATE     9
+#define NELSC_PROBE_FORMAT_WRITEDATE 10
+#define NELSC_PROBE_FORMAT_SCANDATE  11
+#define NELSC_PROBE_BASE24_PAIRTOINT 12
+#define NELSC_PROBE_BASE24_WRITEPAIR 13
+
+/*
+ * The number of probes.
+ */
+#define NELSC_PROBE_COUNT 14
+
+/*
+ * Probe macros.
+ * 
+ * NELSC_STATS_BEGIN(t) goes at the end of the local variable
+ * declarations of a probed function and declares the start time t.
+ * NELSC_STATS_END(probe, t, ok) goes right before the function returns
+ * and records the call, with ok false if the call failed validation.
+ */
+#ifdef NELSC_STATS
+#define NELSC_STATS_BEGIN(t) uint64_t t = nelsc_stats_now()
+#define NELSC_STATS_END(probe, t, ok) \
+	nelsc_stats_record((probe), (t), (ok))
+#else
+#define NELSC_STATS_BEGIN(t)
+#define NELSC_STATS_END(probe, t, ok)
+#endif
+
+/*
+ * Check whether probes were compiled in.
+ * 
+ * Return:
+ * 
+ *   true if NELSC_STATS was defined when building, false otherwise
+ */
+bool nelsc_stats_compiled(void);
+
+/*
+ * Read the probe clock.
+ * 
+ * Return:
+ * 
+ *   the current time in clock ticks
+ */
+uint64_t nelsc_stats_now(void);
+
+/*
+ * Record a call to a probed function in the counters of the calling
+ * thread.
+ * 
+ * Parameters:
+ * 
+ *   probe - the probe
+ * 
+ *   start - the clock reading when the call started
+ * 
+ *   ok - true if the call succeeded, false if it failed validation
+ * 
+ * Faults:
+ * 
+ *   - If probe is out of range
+ * 
+ *   - If memory allocation fails
+ */
+void nelsc_stats_record(int probe, uint64_t start, bool ok);
+
+/*
+ * Merge the counters of the calling thread into the process totals and
+ * clear them.
+ * 
+ * Threads that exit are merged automatically, but the main thread must
+ * call this before printing the totals.
+ */
+void nelsc_stats_merge(void);
+
+/*
+ * Print the process totals.
+ * 
+ * A line is printed for each probe that was called, followed by the
+ * totals of the arena allocators and a line for each date format that
+ * the converter has parsed.  If probes were not compiled in, only the
+ * arena and format totals are printed.
+ * 
+ * Parameters:
+ * 
+ *   pOut - the sink to print to
+ * 
+ * Faults:
+ * 
+ *   - If pOut is NULL
+ */
+void nelsc_stats_print(NELSC_SINK *pOut);
+
+#endif
@@ -0,0 +1,703 @@
+/*
+ * nelsc_strftime.c
+ * 
+ * Implementation of nelsc_strftime.h
+ * 
+ * See the header for further information.
+ */
+
+#include "nelsc_strftime.h"
+#include <stdlib.h>
+#include <string.h>
+
+#include "base24.h"
+#include "decimal.h"
+#include "grcal.h"
+#include "jdn.h"
+#include "nelsc_cycle.h"
+#include "nelsc_format.h"
+
+/*
+ * The number of days in a week.
+ */
+#define DAYS_PER_WEEK 7
+
+/*
+ * The character that introduces a conversion in a format string.
+ */
+#define CONV_CHAR '%'
+
+/*
+ * The flag character that suppresses zero padding in a conversion.
+ */
+#define FLAG_NOPAD '-'
+
+/*
+ * The initial capacity of the operation array of a compiled format.
+ */
+#define OPS_INIT_CAP 8
+
+/*
+ * Operation codes within a compiled format.
+ */
+#define OP_LITERAL      0
+#define OP_NDATE        1
+#define OP_NYEAR24      2
+#define OP_NYEAR10      3
+#define OP_NMONTH24     4
+#define OP_NMONTH10     5
+#define OP_NWEEK        6
+#define OP_NWEEKDAY     7
+#define OP_NMONTHDAY    8
+#define OP_ABSDAY       9
+#define OP_ABSMONTH    10
+#define OP_GDATE       11
+#define OP_GYEAR       12
+#define OP_GMONTH      13
+#define OP_GDAY        14
+#define OP_JDN         15
+#define OP_MJD         16
+#define OP_RD          17
+#define OP_WEEKDATE    18
+#define OP_ORDINAL     19
+#define OP_GCOMPACT    20
+#define OP_GSLASH      21
+#define OP_GDOTTED     22
+#define OP_NKEY        23
+
+/*
+ * The hexadecimal digits, in uppercase.
+ */
+static const char *m_hex = "0123456789ABCDEF";
+
+/*
+ * A single operation within a compiled format.
+ */
+typedef struct {
+	
+	/*
+	 * The operation code, one of the OP_ constants.
+	 */
+	uint8_t op;
+	
+	/*
+	 * Whether zero padding is suppressed for this operation.
+	 */
+	uint8_t nopad;
+	
+	/*
+	 * For OP_LITERAL, the number of characters in the literal.
+	 */
+	uint32_t len;
+	
+	/*
+	 * For OP_LITERAL, the offset of the literal within the literal
+	 * pool.
+	 */
+	uint32_t offs;
+
+} FMT_OP;
+
+/*
+ * NELSC_STRFTIME structure.
+ * 
+ * Prototype given in header.
+ */
+struct NELSC_STRFTIME_TAG {
+	
+	/*
+	 * The array of operations.
+	 */
+	FMT_OP *pOps;
+	
+	/*
+	 * The number of operations in pOps.
+	 */
+	size_t op_count;
+	
+	/*
+	 * The allocated capacity of pOps.
+	 */
+	size_t op_cap;
+	
+	/*
+	 * The literal pool, holding the literal characters of all
+	 * OP_LITERAL operations.
+	 */
+	char *pPool;
+	
+	/*
+	 * The maximum formatted length of a single date.
+	 */
+	size_t maxlen;
+};
+
+/*
+ * Function prototypes
+ */
+static void appendOp(NELSC_STRFTIME *pFmt, int op, bool nopad);
+static void appendLiteral(NELSC_STRFTIME *pFmt, size_t offs, char c);
+static int convToOp(char c, bool *pPaddable);
+static size_t opMaxLength(int op);
+
+/*
+ * Append an operation to a compiled format.
+ * 
+ * Parameters:
+ * 
+ *   pFmt - the compiled format
+ * 
+ *   op - the operation code
+ * 
+ *   nopad - true to suppress zero padding
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static void appendOp(NELSC_STRFTIME *pFmt, int op, bool nopad) {
+	
+	FMT_OP *pOp = NULL;
+	
+	/* Grow the operation array if necessary */
+	if (pFmt->op_count >= pFmt->op_cap) {
+		pFmt->op_cap *= 2;
+		pFmt->pOps = (FMT_OP *) realloc(
+						pFmt->pOps,
+						pFmt->op_cap * sizeof(FMT_OP));
+		if (pFmt->pOps == NULL) {
+			abort();
+		}
+	}
+	
+	/* Add the operation */
+	pOp = &((pFmt->pOps)[pFmt->op_count]);
+	memset(pOp, 0, sizeof(FMT_OP));
+	pOp->op = (uint8_t) op;
+	pOp->nopad = (uint8_t) nopad;
+	
+	(pFmt->op_count)++;
+	pFmt->maxlen += opMaxLength(op);
+}
+
+/*
+ * Append a literal character to a compiled format.
+ * 
+ * If the last operation is a literal, the character is merged into it,
+ * so that runs of literal characters become a single copy operation.
+ * Literal characters are stored in the literal pool in the order they
+ * appear in the format string, so the character is written to the pool
+ * at the given offset.
+ * 
+ * Parameters:
+ * 
+ *   pFmt - the compiled format
+ * 
+ *   offs - the offset in the literal pool to store the character at
+ * 
+ *   c - the literal character
+ * 
+ * Faults:
+ * 
+ *   - If memory allocation fails
+ */
+static void appendLiteral(NELSC_STRFTIME *pFmt, size_t offs, char c) {
+	
+	FMT_OP *pLast = NULL;
+	
+	/* Store the character in the pool */
+	(pFmt->pPool)[offs] = c;
+	
+	/* Extend the previous literal if it ends right before this
+	 * character, otherwise start a new literal */
+	if (pFmt->op_count > 0) {
+		pLast = &((pFmt->pOps)[pFmt->op_count - 1]);
+		if ((pLast->op != OP_LITERAL) ||
+				(pLast->offs + pLast->len != offs)) {
+			pLast = NULL;
+		}
+	}
+	
+	if (pLast == NULL) {
+		appendOp(pFmt, OP_LITERAL, false);
+		pLast = &((pFmt->pOps)[pFmt->op_count - 1]);
+		pLast->offs = (uint32_t) offs;
+	}
+	
+	(pLast->len)++;
+	(pFmt->maxlen)++;
+}
+
+/*
+ * Map a conversion character to its operation code.
+ * 
+ * Parameters:
+ * 
+ *   c - the conversion character following the percent sign and flags
+ * 
+ *   pPaddable - pointer to the variable to receive whether the
+ *   conversion allows the no-padding flag
+ * 
+ * Return:
+ * 
+ *   the operation code, or -1 if the conversion character is not
+ *   recognized
+ */
+static int convToOp(char c, bool *pPaddable) {
+	
+	int op = -1;
+	
+	*pPaddable = false;
+	
+	switch (c) {
+		case 'N': op = OP_NDATE;       break;
+		case 'Y': op = OP_NYEAR24;     break;
+		case 'y': op = OP_NYEAR10;     break;
+		case 'M': op = OP_NMONTH24;    break;
+		case 'W': op = OP_NWEEK;       break;
+		case 'w': op = OP_NWEEKDAY;    break;
+		case 'D': op = OP_ABSDAY;      break;
+		case 'A': op = OP_ABSMONTH;    break;
+		case 'F': op = OP_GDATE;       break;
+		case 'G': op = OP_GYEAR;       break;
+		case 'J': op = OP_JDN;         break;
+		case 'j': op = OP_MJD;         break;
+		case 'R': op = OP_RD;          break;
+		case 'V': op = OP_WEEKDATE;    break;
+		case 'v': op = OP_ORDINAL;     break;
+		case 'K': op = OP_GCOMPACT;    break;
+		case 'L': op = OP_GSLASH;      break;
+		case 'P': op = OP_GDOTTED;     break;
+		case 'k': op = OP_NKEY;        break;
+		
+		case 'm': op = OP_NMONTH10;  *pPaddable = true; break;
+		case 'd': op = OP_NMONTHDAY; *pPaddable = true; break;
+		case 'O': op = OP_GMONTH;    *pPaddable = true; break;
+		case 'E': op = OP_GDAY;      *pPaddable = true; break;
+	}
+	
+	return op;
+}
+
+/*
+ * Return the maximum number of characters a non-literal operation can
+ * write.
+ * 
+ * Parameters:
+ * 
+ *   op - the operation code
+ * 
+ * Return:
+ * 
+ *   the maximum number of characters, or zero for OP_LITERAL
+ */
+static size_t opMaxLength(int op) {
+	
+	size_t result = 0;
+	
+	switch (op) {
+		case OP_NDATE:      result = 7;  break;
+		case OP_NYEAR24:    result = 2;  break;
+		case OP_NYEAR10:    result = 3;  break;
+		case OP_NMONTH24:   result = 1;  break;
+		case OP_NMONTH10:   result = 2;  break;
+		case OP_NWEEK:      result = 1;  break;
+		case OP_NWEEKDAY:   result = 1;  break;
+		case OP_NMONTHDAY:  result = 2;  break;
+		case OP_ABSDAY:     result = 6;  break;
+		case OP_ABSMONTH:   result = 5;  break;
+		case OP_GDATE:      result = 10; break;
+		case OP_GYEAR:      result = 4;  break;
+		case OP_GMONTH:     result = 2;  break;
+		case OP_GDAY:       result = 2;  break;
+		case OP_JDN:        result = 7;  break;
+		case OP_MJD:        result = 7;  break;
+		case OP_RD:         result = 7;  break;
+		case OP_WEEKDATE:   result = GRCAL_WEEKDATE_LENGTH; break;
+		case OP_ORDINAL:    result = GRCAL_ORDINAL_LENGTH;  break;
+		case OP_GCOMPACT:   result = 8;  break;
+		case OP_GSLASH:     result = 10; break;
+		case OP_GDOTTED:    result = 10; break;
+		case OP_NKEY:       result = 2 * NELSC_FORMAT_KEY_LENGTH; break;
+	}
+	
+	return result;
+}
+
+/*
+ * nelsc_strftime_compile function.
+ */
+NELSC_STRFTIME *nelsc_strftime_compile(
+		const char *pFormat,
+		int32_t *pErrPos) {
+	
+	NELSC_STRFTIME *pFmt = NULL;
+	size_t flen = 0;
+	size_t pool_len = 0;
+	size_t i = 0;
+	size_t conv_start = 0;
+	bool nopad = false;
+	bool paddable = false;
+	int op = 0;
+	bool result = true;
+	
+	/* Check parameter */
+	if (pFormat == NULL) {
+		abort();
+	}
+	
+	/* Allocate the structure; the literal pool can never be longer than
+	 * the format string */
+	flen = strlen(pFormat);
+	
+	pFmt = (NELSC_STRFTIME *) calloc(1, sizeof(NELSC_STRFTIME));
+	if (pFmt == NULL) {
+		abort();
+	}
+	
+	pFmt->op_cap = OPS_INIT_CAP;
+	pFmt->pOps = (FMT_OP *) malloc(pFmt->op_cap * sizeof(FMT_OP));
+	pFmt->pPool = (char *) malloc(flen + 1);
+	if ((pFmt->pOps == NULL) || (pFmt->pPool == NULL)) {
+		abort();
+	}
+	
+	/* Compile each element of the format string */
+	i = 0;
+	while (pFormat[i] != 0) {
+		/* Literal characters go straight into the pool */
+		if (pFormat[i] != CONV_CHAR) {
+			appendLiteral(pFmt, pool_len, pFormat[i]);
+			pool_len++;
+			i++;
+			continue;
+		}
+		
+		/* Conversion -- skip the percent sign and read the flag */
+		conv_start = i;
+		i++;
+		
+		nopad = false;
+		if (pFormat[i] == FLAG_NOPAD) {
+			nopad = true;
+			i++;
+		}
+		
+		/* Escapes compile into literals */
+		if ((!nopad) && ((pFormat[i] == CONV_CHAR) ||
+				(pFormat[i] == 'n') || (pFormat[i] == 't'))) {
+			if (pFormat[i] == 'n') {
+				appendLiteral(pFmt, pool_len, '\n');
+			} else if (pFormat[i] == 't') {
+				appendLiteral(pFmt, pool_len, '\t');
+			} else {
+				appendLiteral(pFmt, pool_len, CONV_CHAR);
+			}
+			pool_len++;
+			i++;
+			continue;
+		}
+		
+		/* Field conversions compile into operations */
+		op = convToOp(pFormat[i], &paddable);
+		if ((op == -1) || (nopad && (!paddable))) {
+			if (pErrPos != NULL) {
+				*pErrPos = (int32_t) conv_start;
+			}
+			result = false;
+			break;
+		}
+		
+		appendOp(pFmt, op, nopad);
+		i++;
+	}
+	
+	/* Release the structure if compilation failed */
+	if (!result) {
+		nelsc_strftime_free(pFmt);
+		pFmt = NULL;
+	}
+	
+	/* Return the compiled format */
+	return pFmt;
+}
+
+/*
+ * nelsc_strftime_free function.
+ */
+void nelsc_strftime_free(NELSC_STRFTIME *pFmt) {
+	if (pFmt != NULL) {
+		free(pFmt->pOps);
+		free(pFmt->pPool);
+		free(pFmt);
+	}
+}
+
+/*
+ * nelsc_strftime_maxLength function.
+ */
+size_t nelsc_strftime_maxLength(const NELSC_STRFTIME *pFmt) {
+	if (pFmt == NULL) {
+		abort();
+	}
+	return pFmt->maxlen;
+}
+
+/*
+ * nelsc_strftime_decompose function.
+ */
+void nelsc_strftime_decompose(int32_t day, NELSC_STRFTIME_DATE *pDate) {
+	
+	/* Check parameters */
+	if ((pDate == NULL) ||
+			(day < NELSC_CYCLE_DAYMIN) || (day > NELSC_CYCLE_DAYMAX)) {
+		abort();
+	}
+	
+	/* Compute the NELSC fields */
+	pDate->day = day;
+	pDate->month = nelsc_cycle_dayToMonth(day, &(pDate->day_of_month));
+	pDate->year = nelsc_cycle_monthToYear(
+					pDate->month, &(pDate->month_of_year));
+	
+	/* Compute the Gregorian fields */
+	grcal_offsetToDate(
+		day + NELSC_CYCLE_GROFFS,
+		&(pDate->gr_year),
+		&(pDate->gr_month),
+		&(pDate->gr_day));
+}
+
+/*
+ * nelsc_strftime_decomposeBatch function.
+ */
+void nelsc_strftime_decomposeBatch(
+		const int32_t *pDays,
+		size_t count,
+		NELSC_STRFTIME_DATE *pDates) {
+	
+	size_t i = 0;
+	
+	/* Check parameters */
+	if ((count > 0) && ((pDays == NULL) || (pDates == NULL))) {
+		abort();
+	}
+	
+	/* Decompose each day */
+	for(i = 0; i < count; i++) {
+		nelsc_strftime_decompose(pDays[i], &(pDates[i]));
+	}
+}
+
+/*
+ * nelsc_strftime_format function.
+ */
+size_t nelsc_strftime_format(
+		const NELSC_STRFTIME *pFmt,
+		const NELSC_STRFTIME_DATE *pDate,
+		char *pBuf) {
+	
+	const FMT_OP *pOp = NULL;
+	const FMT_OP *pEnd = NULL;
+	char *pc = NULL;
+	char week_char = 0;
+	char wday_char = 0;
+	int32_t width = 0;
+	int32_t i = 0;
+	uint8_t key[NELSC_FORMAT_KEY_LENGTH];
+	
+	/* Check parameters */
+	if ((pFmt == NULL) || (pDate == NULL) || (pBuf == NULL)) {
+		abort();
+	}
+	
+	/* Get the week and day of week digits, which are always a single
+	 * decimal digit */
+	week_char = (char) ('1' + (pDate->day_of_month / DAYS_PER_WEEK));
+	wday_char = (char) ('1' + (pDate->day_of_month % DAYS_PER_WEEK));
+	
+	/* Run each operation */
+	pc = pBuf;
+	pEnd = pFmt->pOps + pFmt->op_count;
+	for(pOp = pFmt->pOps; pOp < pEnd; pOp++) {
+		/* Padded two-digit conversions use a width of one when the
+		 * no-padding flag is set */
+		width = (pOp->nopad) ? 1 : 2;
+		
+		switch (pOp->op) {
+			case OP_LITERAL:
+				memcpy(pc, pFmt->pPool + pOp->offs, pOp->len);
+				pc += pOp->len;
+				break;
+			
+			case OP_NDATE:
+				base24_writePair(pc, pDate->year);
+				pc[2] = ':';
+				pc[3] = base24_intToDigit(pDate->month_of_year + 1);
+				pc[4] = week_char;
+				pc[5] = '-';
+				pc[6] = wday_char;
+				pc += 7;
+				break;
+			
+			case OP_NYEAR24:
+				base24_writePair(pc, pDate->year);
+				pc += 2;
+				break;
+			
+			case OP_NYEAR10:
+				pc += decimal_writeInt(pc, pDate->year, 1);
+				break;
+			
+			case OP_NMONTH24:
+				*pc = base24_intToDigit(pDate->month_of_year + 1);
+				pc++;
+				break;
+			
+			case OP_NMONTH10:
+				pc += decimal_writeInt(
+						pc, pDate->month_of_year + 1, width);
+				break;
+			
+			case OP_NWEEK:
+				*pc = week_char;
+				pc++;
+				break;
+			
+			case OP_NWEEKDAY:
+				*pc = wday_char;
+				pc++;
+				break;
+			
+			case OP_NMONTHDAY:
+				pc += decimal_writeInt(
+						pc, pDate->day_of_month + 1, width);
+				break;
+			
+			case OP_ABSDAY:
+				pc += decimal_writeInt(pc, pDate->day, 1);
+				break;
+			
+			case OP_ABSMONTH:
+				pc += decimal_writeInt(pc, pDate->month, 1);
+				break;
+			
+			case OP_GDATE:
+				decimal_writeInt(pc, pDate->gr_year, 4);
+				pc[4] = '-';
+				decimal_writeInt(pc + 5, pDate->gr_month, 2);
+				pc[7] = '-';
+				decimal_writeInt(pc + 8, pDate->gr_day, 2);
+				pc += 10;
+				break;
+			
+			case OP_GCOMPACT:
+				pc += grcal_writeFormat(pc, GRCAL_FORMAT_COMPACT,
+						pDate->gr_year, pDate->gr_month, pDate->gr_day);
+				break;
+			
+			case OP_GSLASH:
+				pc += grcal_writeFormat(pc, GRCAL_FORMAT_SLASH,
+						pDate->gr_year, pDate->gr_month, pDate->gr_day);
+				break;
+			
+			case OP_GDOTTED:
+				pc += grcal_writeFormat(pc, GRCAL_FORMAT_DOTTED,
+						pDate->gr_year, pDate->gr_month, pDate->gr_day);
+				break;
+			
+			case OP_GYEAR:
+				pc += decimal_writeInt(pc, pDate->gr_year, 4);
+				break;
+			
+			case OP_GMONTH:
+				pc += decimal_writeInt(pc, pDate->gr_month, width);
+				break;
+			
+			case OP_GDAY:
+				pc += decimal_writeInt(pc, pDate->gr_day, width);
+				break;
+			
+			case OP_JDN:
+				pc += decimal_writeInt(pc, jdn_fromGrcal(JDN_SYS_JD,
+						pDate->day + NELSC_CYCLE_GROFFS), 1);
+				break;
+			
+			case OP_MJD:
+				pc += decimal_writeInt(pc, jdn_fromGrcal(JDN_SYS_MJD,
+						pDate->day + NELSC_CYCLE_GROFFS), 1);
+				break;
+			
+			case OP_RD:
+				pc += decimal_writeInt(pc, jdn_fromGrcal(JDN_SYS_RD,
+						pDate->day + NELSC_CYCLE_GROFFS), 1);
+				break;
+			
+			case OP_WEEKDATE:
+				grcal_writeWeekDate(pc,
+						pDate->day + NELSC_CYCLE_GROFFS);
+				pc += GRCAL_WEEKDATE_LENGTH;
+				break;
+			
+			case OP_ORDINAL:
+				grcal_writeOrdinal(pc,
+						pDate->day + NELSC_CYCLE_GROFFS);
+				pc += GRCAL_ORDINAL_LENGTH;
+				break;
+			
+			case OP_NKEY:
+				nelsc_format_fieldsToKey(key, pDate->year,
+						pDate->month_of_year + 1,
+						(pDate->day_of_month / DAYS_PER_WEEK) + 1,
+						(pDate->day_of_month % DAYS_PER_WEEK) + 1);
+				for(i = 0; i < NELSC_FORMAT_KEY_LENGTH; i++) {
+					pc[2 * i] = m_hex[key[i] >> 4];
+					pc[(2 * i) + 1] = m_hex[key[i] & 0xf];
+				}
+				pc += 2 * NELSC_FORMAT_KEY_LENGTH;
+				break;
+			
+			default:
+				abort();
+		}
+	}
+	
+	/* Return the number of characters written */
+	return (size_t) (pc - pBuf);
+}
+
+/*
+ * nelsc_strftime_batch function.
+ */
+size_t nelsc_strftime_batch(
+		const NELSC_STRFTIME *pFmt,
+		const NELSC_STRFTIME_DATE *pDates,
+		size_t count,
+		char *pBuf,
+		size_t cap,
+		size_t *pDone) {
+	
+	size_t len = 0;
+	size_t i = 0;
+	
+	/* Check parameters */
+	if ((pFmt == NULL) || (pBuf == NULL) || (pDone == NULL) ||
+			((count > 0) && (pDates == NULL))) {
+		abort();
+	}
+	
+	/* Format records while there is room for a maximum-length record
+	 * and its line feed */
+	for(i = 0; i < count; i++) {
+		if (cap - len < pFmt->maxlen + 1) {
+			break;
+		}
+		
+		len += nelsc_strftime_format(pFmt, &(pDates[i]), pBuf + len);
+		pBuf[len++] = '\n';
+	}
+	
+	/* Return results */
+	*pDone = i;
+	return len;
+}
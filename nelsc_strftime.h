@@ -0,0 +1,311 @@
+#ifndef NELSC_STRFTIME_H_INCLUDED
+#define NELSC_STRFTIME_H_INCLUDED
+
+/*
+ * nelsc_strftime.h
+ * 
+ * Provides a compiled format-string engine for writing NELSC and
+ * Gregorian date fields according to a custom layout.
+ * 
+ * A format string is compiled once into a sequence of operations.  The
+ * compiled format can then be run over any number of decomposed dates
+ * without parsing the format string again.  The engine writes directly
+ * into caller-provided character buffers and never uses stdio.
+ * 
+ * Format strings are made up of literal characters and conversions.
+ * Each conversion begins with a percent sign, optionally followed by a
+ * "-" flag that suppresses zero padding, followed by one of the
+ * following conversion characters:
+ * 
+ *   %N - full NELSC date, such as 3T:C4-7
+ *   %Y - NELSC year as a signed base-24 pair
+ *   %y - NELSC year as a signed decimal
+ *   %M - NELSC month of year as a base-24 digit (one-based)
+ *   %m - NELSC month of year as a two-digit decimal (one-based)
+ *   %W - NELSC week of month (one-based)
+ *   %w - NELSC day of week (one-based)
+ *   %d - NELSC day of month as a two-digit decimal (one-based)
+ *   %D - NELSC absolute day offset as a signed decimal
+ *   %A - NELSC absolute month offset as a signed decimal
+ *   %F - Gregorian date in YYYY-MM-DD format
+ *   %K - Gregorian date in YYYYMMDD format
+ *   %L - Gregorian date in YYYY/MM/DD format
+ *   %P - Gregorian date in DD.MM.YYYY format
+ *   %G - Gregorian year as four decimal digits
+ *   %O - Gregorian month as a two-digit decimal
+ *   %E - Gregorian day of month as a two-digit decimal
+ *   %J - Julian Day Number as a decimal
+ *   %j - Modified Julian Day as a signed decimal
+ *   %R - Rata Die day count as a decimal
+ *   %V - ISO 8601 week date in YYYY-Www-D format
+ *   %v - ISO 8601 ordinal date in YYYY-DDD format
+ *   %k - NELSC sort key as eight uppercase hexadecimal digits, which
+ *        sort in date order (see nelsc_format_dateToKey())
+ *   %n - a line feed
+ *   %t - a horizontal tab
+ *   %% - a literal percent sign
+ * 
+ * The "-" flag is only allowed with the padded two-digit conversions
+ * %m, %d, %O, and %E.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * A NELSC absolute day offset decomposed into all the fields that the
+ * format engine can write.
+ * 
+ * Use nelsc_strftime_decompose() or nelsc_strftime_decomposeBatch() to
+ * fill in this structure.
+ */
+typedef struct {
+	
+	/*
+	 * The NELSC absolute day offset.
+	 */
+	int32_t day;
+	
+	/*
+	 * The NELSC absolute month offset of the month containing the day.
+	 */
+	int32_t month;
+	
+	/*
+	 * The NELSC year containing the day.
+	 */
+	int32_t year;
+	
+	/*
+	 * The zero-based month within the NELSC year.
+	 */
+	int32_t month_of_year;
+	
+	/*
+	 * The zero-based day within the NELSC month.
+	 */
+	int32_t day_of_month;
+	
+	/*
+	 * The Gregorian year.
+	 */
+	int32_t gr_year;
+	
+	/*
+	 * The one-based Gregorian month.
+	 */
+	int32_t gr_month;
+	
+	/*
+	 * The one-based Gregorian day of month.
+	 */
+	int32_t gr_day;
+
+} NELSC_STRFTIME_DATE;
+
+/*
+ * NELSC_STRFTIME structure prototype.
+ * 
+ * See the implementation file for definition.
+ */
+struct NELSC_STRFTIME_TAG;
+typedef struct NELSC_STRFTIME_TAG NELSC_STRFTIME;
+
+/*
+ * Compile a format string.
+ * 
+ * The format string syntax is described at the top of this header.
+ * 
+ * If the format string is invalid, NULL is returned.  In this case, if
+ * pErrPos is not NULL, the zero-based character offset within the
+ * format string of the conversion that could not be compiled is written
+ * to *pErrPos.
+ * 
+ * The returned compiled format must eventually be released with
+ * nelsc_strftime_free().
+ * 
+ * Parameters:
+ * 
+ *   pFormat - the null-terminated format string to compile
+ * 
+ *   pErrPos - pointer to the variable to receive the location of a
+ *   compilation error, or NULL
+ * 
+ * Return:
+ * 
+ *   the compiled format, or NULL if the format string is invalid
+ * 
+ * Faults:
+ * 
+ *   - If pFormat is NULL
+ * 
+ *   - If memory allocation fails
+ * 
+ * Undefined behavior:
+ * 
+ *   - If pFormat is not null-terminated
+ */
+NELSC_STRFTIME *nelsc_strftime_compile(
+		const char *pFormat,
+		int32_t *pErrPos);
+
+/*
+ * Release a compiled format.
+ * 
+ * Does nothing if pFmt is NULL.
+ * 
+ * Parameters:
+ * 
+ *   pFmt - the compiled format to release, or NULL
+ */
+void nelsc_strftime_free(NELSC_STRFTIME *pFmt);
+
+/*
+ * Determine the maximum number of characters that a single date
+ * formatted with the given compiled format can occupy.
+ * 
+ * This is computed once during compilation.  A buffer of at least this
+ * size is always sufficient for nelsc_strftime_format().
+ * 
+ * Parameters:
+ * 
+ *   pFmt - the compiled format
+ * 
+ * Return:
+ * 
+ *   the maximum formatted length in characters
+ * 
+ * Faults:
+ * 
+ *   - If pFmt is NULL
+ */
+size_t nelsc_strftime_maxLength(const NELSC_STRFTIME *pFmt);
+
+/*
+ * Decompose a NELSC absolute day offset into all its date fields.
+ * 
+ * The provided day offset must be in range NELSC_CYCLE_DAYMIN to
+ * NELSC_CYCLE_DAYMAX (inclusive of boundaries).
+ * 
+ * Parameters:
+ * 
+ *   day - the NELSC absolute day offset
+ * 
+ *   pDate - the structure to fill in
+ * 
+ * Faults:
+ * 
+ *   - If day is out of range
+ * 
+ *   - If pDate is NULL
+ */
+void nelsc_strftime_decompose(int32_t day, NELSC_STRFTIME_DATE *pDate);
+
+/*
+ * Decompose an array of NELSC absolute day offsets.
+ * 
+ * This is equivalent to calling nelsc_strftime_decompose() on each
+ * element of pDays, writing the results to the corresponding elements
+ * of pDates.
+ * 
+ * Parameters:
+ * 
+ *   pDays - the day offsets to decompose
+ * 
+ *   count - the number of elements in pDays and pDates
+ * 
+ *   pDates - the structures to fill in
+ * 
+ * Faults:
+ * 
+ *   - If count is greater than zero and pDays or pDates is NULL
+ * 
+ *   - If any day offset is out of range
+ */
+void nelsc_strftime_decomposeBatch(
+		const int32_t *pDays,
+		size_t count,
+		NELSC_STRFTIME_DATE *pDates);
+
+/*
+ * Format a single decomposed date into a buffer.
+ * 
+ * pBuf must have room for at least nelsc_strftime_maxLength()
+ * characters.  No terminating null is written.
+ * 
+ * Parameters:
+ * 
+ *   pFmt - the compiled format
+ * 
+ *   pDate - the decomposed date to format
+ * 
+ *   pBuf - the buffer to write into
+ * 
+ * Return:
+ * 
+ *   the number of characters written
+ * 
+ * Faults:
+ * 
+ *   - If any parameter is NULL
+ * 
+ *   - If the decomposed date contains out-of-range fields
+ * 
+ * Undefined behavior:
+ * 
+ *   - If pBuf is too small
+ */
+size_t nelsc_strftime_format(
+		const NELSC_STRFTIME *pFmt,
+		const NELSC_STRFTIME_DATE *pDate,
+		char *pBuf);
+
+/*
+ * Format a batch of decomposed dates into a buffer.
+ * 
+ * Each date is formatted in turn and followed by a line feed.  Dates
+ * are formatted until either all count dates have been written or the
+ * buffer does not have room for another record of the maximum possible
+ * length.  The number of dates that were written is stored in *pDone,
+ * allowing the caller to flush the buffer and continue with the
+ * remaining dates.
+ * 
+ * No terminating null is written.
+ * 
+ * Parameters:
+ * 
+ *   pFmt - the compiled format
+ * 
+ *   pDates - the decomposed dates to format
+ * 
+ *   count - the number of dates in pDates
+ * 
+ *   pBuf - the buffer to write into
+ * 
+ *   cap - the number of characters available in pBuf
+ * 
+ *   pDone - pointer to the variable to receive the number of dates that
+ *   were formatted
+ * 
+ * Return:
+ * 
+ *   the number of characters written
+ * 
+ * Faults:
+ * 
+ *   - If pFmt, pBuf, or pDone is NULL
+ * 
+ *   - If count is greater than zero and pDates is NULL
+ * 
+ *   - If any decomposed date contains out-of-range fields
+ */
+size_t nelsc_strftime_batch(
+		const NELSC_STRFTIME *pFmt,
+		const NELSC_STRFTIME_DATE *pDates,
+		size_t count,
+		char *pBuf,
+		size_t cap,
+		size_t *pDone);
+
+#endif
@@ -0,0 +1,140 @@
+/*
+ * nelsc_table.c
+ * 
+ * Implementation of nelsc_table.h
+ * 
+ * See the header for further information.
+ */
+
+#include "nelsc_table.h"
+#include <stdlib.h>
+
+/*
+ * nelsc_table_build function.
+ */
+void nelsc_table_build(NELSC_TABLE *pTable) {
+	
+	int32_t m = 0;
+	int32_t y = 0;
+	int32_t d = 0;
+	int32_t d_end = 0;
+	int32_t m_end = 0;
+	
+	/* Check parameters */
+	if (pTable == NULL) {
+		abort();
+	}
+	
+	/* Fill in the first day of each month and the month of each day */
+	for(m = NELSC_CYCLE_MONMIN; m <= NELSC_CYCLE_MONMAX; m++) {
+		d = nelsc_cycle_monthToDay(m);
+		if (m < NELSC_CYCLE_MONMAX) {
+			d_end = nelsc_cycle_monthToDay(m + 1);
+		} else {
+			d_end = NELSC_CYCLE_DAYMAX + 1;
+		}
+		
+		(pTable->month_day)[m - NELSC_CYCLE_MONMIN] = d;
+		for( ; d < d_end; d++) {
+			(pTable->day_month)[d - NELSC_CYCLE_DAYMIN] =
+				(uint16_t) (m - NELSC_CYCLE_MONMIN);
+		}
+	}
+	(pTable->month_day)[NELSC_TABLE_MONTHS] = NELSC_CYCLE_DAYMAX + 1;
+	
+	/* Fill in the first month of each year and the year of each
+	 * month */
+	for(y = NELSC_CYCLE_YEARMIN; y <= NELSC_CYCLE_YEARMAX; y++) {
+		m = nelsc_cycle_yearToMonth(y);
+		if (y < NELSC_CYCLE_YEARMAX) {
+			m_end = nelsc_cycle_yearToMonth(y + 1);
+		} else {
+			m_end = NELSC_CYCLE_MONMAX + 1;
+		}
+		
+		(pTable->year_month)[y - NELSC_CYCLE_YEARMIN] = m;
+		for( ; m < m_end; m++) {
+			(pTable->month_year)[m - NELSC_CYCLE_MONMIN] =
+				(uint16_t) (y - NELSC_CYCLE_YEARMIN);
+		}
+	}
+	(pTable->year_month)[NELSC_TABLE_YEARS] = NELSC_CYCLE_MONMAX + 1;
+}
+
+/*
+ * nelsc_table_dayToMonth function.
+ */
+int32_t nelsc_table_dayToMonth(
+		const NELSC_TABLE *pTable,
+		int32_t d,
+		int32_t *pOffset) {
+	
+	int32_t mi = 0;
+	
+	/* Check parameters */
+	if ((pTable == NULL) ||
+			(d < NELSC_CYCLE_DAYMIN) || (d > NELSC_CYCLE_DAYMAX)) {
+		abort();
+	}
+	
+	/* Look up the month and the offset within it */
+	mi = (int32_t) (pTable->day_month)[d - NELSC_CYCLE_DAYMIN];
+	if (pOffset != NULL) {
+		*pOffset = d - (pTable->month_day)[mi];
+	}
+	
+	return mi + NELSC_CYCLE_MONMIN;
+}
+
+/*
+ * nelsc_table_monthToDay function.
+ */
+int32_t nelsc_table_monthToDay(const NELSC_TABLE *pTable, int32_t m) {
+	
+	/* Check parameters */
+	if ((pTable == NULL) ||
+			(m < NELSC_CYCLE_MONMIN) || (m > NELSC_CYCLE_MONMAX)) {
+		abort();
+	}
+	
+	return (pTable->month_day)[m - NELSC_CYCLE_MONMIN];
+}
+
+/*
+ * nelsc_table_monthToYear function.
+ */
+int32_t nelsc_table_monthToYear(
+		const NELSC_TABLE *pTable,
+		int32_t m,
+		int32_t *pOffset) {
+	
+	int32_t yi = 0;
+	
+	/* Check parameters */
+	if ((pTable == NULL) ||
+			(m < NELSC_CYCLE_MONMIN) || (m > NELSC_CYCLE_MONMAX)) {
+		abort();
+	}
+	
+	/* Look up the year and the offset within it */
+	yi = (int32_t) (pTable->month_year)[m - NELSC_CYCLE_MONMIN];
+	if (pOffset != NULL) {
+		*pOffset = m - (pTable->year_month)[yi];
+	}
+	
+	return yi + NELSC_CYCLE_YEARMIN;
+}
+
+/*
+ * nelsc_table_yearToMonth function.
+ */
+int32_t nelsc_table_yearToMonth(const NELSC_TABLE *pTable, int32_t y) {
+	
+	/* Check parameters */
+	if ((pTable == NULL) ||
+			(y < NELSC_CYCLE_YEARMIN) || (y > NELSC_CYCLE_YEARMAX)) {
+		abort();
+	}
+	
+	return (pTable->year_month)[y - NELSC_CYCLE_YEARMIN];
+}
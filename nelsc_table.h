@@ -0,0 +1,176 @@
+#ifndef NELSC_TABLE_H_INCLUDED
+#define NELSC_TABLE_H_INCLUDED
+
+/*
+ * nelsc_table.h
+ * 
+ * Provides precomputed NELSC cycle tables, which answer the same
+ * questions as the conversion functions of nelsc_cycle with a single
+ * table lookup each.
+ * 
+ * The tables cover the whole NELSC range.  They are held in a single
+ * structure of fixed size that contains no pointers, so that it can be
+ * placed in memory shared between processes (see nelsc_shm) as well as
+ * in ordinary memory.
+ */
+
+#include <stdint.h>
+#include "nelsc_cycle.h"
+
+/*
+ * The number of days, months, and years in NELSC.
+ */
+#define NELSC_TABLE_DAYS \
+	(NELSC_CYCLE_DAYMAX - NELSC_CYCLE_DAYMIN + 1)
+#define NELSC_TABLE_MONTHS \
+	(NELSC_CYCLE_MONMAX - NELSC_CYCLE_MONMIN + 1)
+#define NELSC_TABLE_YEARS \
+	(NELSC_CYCLE_YEARMAX - NELSC_CYCLE_YEARMIN + 1)
+
+/*
+ * The precomputed cycle tables.
+ * 
+ * Use nelsc_table_build() to fill in the tables.
+ */
+typedef struct {
+	
+	/*
+	 * The NELSC absolute day offset of the first day of each month,
+	 * indexed by month offset minus NELSC_CYCLE_MONMIN.  An extra
+	 * element at the end holds one past the last day of NELSC.
+	 */
+	int32_t month_day[NELSC_TABLE_MONTHS + 1];
+	
+	/*
+	 * The NELSC absolute month offset of the first month of each year,
+	 * indexed by year minus NELSC_CYCLE_YEARMIN.  An extra element at
+	 * the end holds one past the last month of NELSC.
+	 */
+	int32_t year_month[NELSC_TABLE_YEARS + 1];
+	
+	/*
+	 * The month of each day, as month offset minus NELSC_CYCLE_MONMIN,
+	 * indexed by day offset minus NELSC_CYCLE_DAYMIN.
+	 */
+	uint16_t day_month[NELSC_TABLE_DAYS];
+	
+	/*
+	 * The year of each month, as year minus NELSC_CYCLE_YEARMIN,
+	 * indexed by month offset minus NELSC_CYCLE_MONMIN.
+	 */
+	uint16_t month_year[NELSC_TABLE_MONTHS];
+
+} NELSC_TABLE;
+
+/*
+ * Fill in the cycle tables.
+ * 
+ * The tables are computed with the nelsc_cycle conversion functions.
+ * 
+ * Parameters:
+ * 
+ *   pTable - the tables to fill in
+ * 
+ * Faults:
+ * 
+ *   - If pTable is NULL
+ */
+void nelsc_table_build(NELSC_TABLE *pTable);
+
+/*
+ * Table version of nelsc_cycle_dayToMonth().
+ * 
+ * Parameters:
+ * 
+ *   pTable - the tables
+ * 
+ *   d - the NELSC absolute day offset
+ * 
+ *   pOffset - pointer to variable to receive the offset of the day
+ *   within the month, or NULL
+ * 
+ * Return:
+ * 
+ *   the NELSC absolute month offset of the month that contains day d
+ * 
+ * Faults:
+ * 
+ *   - If pTable is NULL
+ * 
+ *   - If d is out of NELSC range
+ */
+int32_t nelsc_table_dayToMonth(
+		const NELSC_TABLE *pTable,
+		int32_t d,
+		int32_t *pOffset);
+
+/*
+ * Table version of nelsc_cycle_monthToDay().
+ * 
+ * Parameters:
+ * 
+ *   pTable - the tables
+ * 
+ *   m - the NELSC absolute month offset
+ * 
+ * Return:
+ * 
+ *   the NELSC absolute day offset of the first day of month m
+ * 
+ * Faults:
+ * 
+ *   - If pTable is NULL
+ * 
+ *   - If m is out of NELSC range
+ */
+int32_t nelsc_table_monthToDay(const NELSC_TABLE *pTable, int32_t m);
+
+/*
+ * Table version of nelsc_cycle_monthToYear().
+ * 
+ * Parameters:
+ * 
+ *   pTable - the tables
+ * 
+ *   m - the NELSC absolute month offset
+ * 
+ *   pOffset - pointer to variable to receive the offset of the month
+ *   within the year, or NULL
+ * 
+ * Return:
+ * 
+ *   the year that contains month m
+ * 
+ * Faults:
+ * 
+ *   - If pTable is NULL
+ * 
+ *   - If m is out of NELSC range
+ */
+int32_t nelsc_table_monthToYear(
+		const NELSC_TABLE *pTable,
+		int32_t m,
+		int32_t *pOffset);
+
+/*
+ * Table version of nelsc_cycle_yearToMonth().
+ * 
+ * Parameters:
+ * 
+ *   pTable - the tables
+ * 
+ *   y - the year
+ * 
+ * Return:
+ * 
+ *   the NELSC absolute month offset of the first month of year y
+ * 
+ * Faults:
+ * 
+ *   - If pTable is NULL
+ * 
+ *   - If y is out of NELSC range
+ */
+int32_t nelsc_table_yearToMonth(const NELSC_TABLE *pTable, int32_t y);
+
+#endif
@@ -0,0 +1,115 @@
+/*
+ * scanerr.c
+ * 
+ * Implementation of scanerr.h
+ * 
+ * See the header for further information.
+ */
+
+#include "scanerr.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * The number of reasons and fields.
+ */
+#define REASON_COUNT 10
+#define FIELD_COUNT 6
+
+/*
+ * The description of each reason, indexed by SCANERR constant.  The
+ * reasons that have a field value are described after the field name
+ * and value.
+ */
+static const char *m_reasons[REASON_COUNT] = {
+	"no error",
+	"unrecognized date format",
+	"date ends early",
+	"wrong separator",
+	"invalid digits",
+	"out of range",
+	"past end of year",
+	"past end of month",
+	"outside supported range",
+	"unexpected characters after date"
+};
+
+/*
+ * The short code of each reason, indexed by SCANERR constant.
+ */
+static const char *m_codes[REASON_COUNT] = {
+	"none", "format", "end", "separator", "digit", "range", "year_end",
+	"month_end", "limit", "trailing"
+};
+
+/*
+ * The name of each field, indexed by SCANERR_FIELD constant.
+ */
+static const char *m_fields[FIELD_COUNT] = {
+	"date", "year", "month", "week", "day", "day count"
+};
+
+/*
+ * scanerr_set function.
+ */
+void scanerr_set(
+		SCANERR *pErr,
+		int reason,
+		int field,
+		int32_t pos,
+		int32_t value) {
+	
+	if (pErr != NULL) {
+		pErr->reason = reason;
+		pErr->field = field;
+		pErr->pos = pos;
+		pErr->value = value;
+	}
+}
+
+/*
+ * scanerr_code function.
+ */
+const char *scanerr_code(int reason) {
+	
+	/* Check parameters */
+	if ((reason < 0) || (reason >= REASON_COUNT)) {
+		abort();
+	}
+	
+	return m_codes[reason];
+}
+
+/*
+ * scanerr_describe function.
+ */
+void scanerr_describe(char *pBuf, const SCANERR *pErr) {
+	
+	/* Check parameters */
+	if ((pBuf == NULL) || (pErr == NULL)) {
+		abort();
+	}
+	if ((pErr->reason < 0) || (pErr->reason >= REASON_COUNT) ||
+			(pErr->field < 0) || (pErr->field >= FIELD_COUNT)) {
+		abort();
+	}
+	
+	/* Field values are given with their field; other errors only name
+	 * the field, if there is one */
+	if ((pErr->reason == SCANERR_RANGE) ||
+			(pErr->reason == SCANERR_YEAR_END) ||
+			(pErr->reason == SCANERR_MONTH_END)) {
+		snprintf(pBuf, SCANERR_DESCRIBE_MAX, "%s %ld %s",
+			m_fields[pErr->field], (long) pErr->value,
+			m_reasons[pErr->reason]);
+	
+	} else if ((pErr->reason == SCANERR_DIGIT) &&
+			(pErr->field != SCANERR_FIELD_NONE)) {
+		snprintf(pBuf, SCANERR_DESCRIBE_MAX, "%s in %s",
+			m_reasons[pErr->reason], m_fields[pErr->field]);
+	
+	} else {
+		snprintf(pBuf, SCANERR_DESCRIBE_MAX, "%s",
+			m_reasons[pErr->reason]);
+	}
+}
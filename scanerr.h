@@ -0,0 +1,160 @@
+#ifndef SCANERR_H_INCLUDED
+#define SCANERR_H_INCLUDED
+
+/*
+ * scanerr.h
+ * 
+ * Structured errors for the date parsers.
+ * 
+ * Each parser that accepts an optional SCANERR pointer fills it in when
+ * parsing fails, recording which field was wrong, where it is, and why,
+ * as it goes along.  Nothing has to be parsed a second time to explain
+ * a failure.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The reasons a date fails to parse.
+ * 
+ *   NONE      - no error
+ *   FORMAT    - the text is not in any supported format
+ *   END       - the text ends before the date is complete
+ *   SEPARATOR - the wrong character where a separator belongs
+ *   DIGIT     - a field is not made of valid digits
+ *   RANGE     - a field value is out of range for any date
+ *   YEAR_END  - a field value is past the end of this particular year,
+ *               such as the thirteenth month of a short NELSC year
+ *   MONTH_END - a field value is past the end of this particular month,
+ *               such as the fifth week of a short NELSC month
+ *   LIMIT     - the date is valid but outside the supported range
+ *   TRAILING  - there are other characters after the date
+ */
+#define SCANERR_NONE      0
+#define SCANERR_FORMAT    1
+#define SCANERR_END       2
+#define SCANERR_SEPARATOR 3
+#define SCANERR_DIGIT     4
+#define SCANERR_RANGE     5
+#define SCANERR_YEAR_END  6
+#define SCANERR_MONTH_END 7
+#define SCANERR_LIMIT     8
+#define SCANERR_TRAILING  9
+
+/*
+ * The fields of a date.  SCANERR_FIELD_NONE is used for errors that are
+ * not about a single field, such as a wrong separator.  The day field
+ * is the day of the month, week, or year, depending on the format.
+ */
+#define SCANERR_FIELD_NONE  0
+#define SCANERR_FIELD_YEAR  1
+#define SCANERR_FIELD_MONTH 2
+#define SCANERR_FIELD_WEEK  3
+#define SCANERR_FIELD_DAY   4
+#define SCANERR_FIELD_COUNT 5
+
+/*
+ * The maximum length of a description written by scanerr_describe(),
+ * including the terminating null.
+ */
+#define SCANERR_DESCRIBE_MAX 64
+
+/*
+ * A parse error.
+ */
+typedef struct {
+	
+	/*
+	 * The reason, one of the SCANERR constants.
+	 */
+	int reason;
+	
+	/*
+	 * The field, one of the SCANERR_FIELD constants.
+	 */
+	int field;
+	
+	/*
+	 * The byte position of the error, counting from zero at the start
+	 * of the text given to the parser.
+	 */
+	int32_t pos;
+	
+	/*
+	 * The value of the field, for RANGE, YEAR_END, and MONTH_END
+	 * errors.
+	 */
+	int32_t value;
+
+} SCANERR;
+
+/*
+ * Record a parse error.
+ * 
+ * Nothing is done if pErr is NULL, so parsers can call this without
+ * checking whether the caller asked for errors.
+ * 
+ * Parameters:
+ * 
+ *   pErr - the error to fill in, or NULL
+ * 
+ *   reason - one of the SCANERR reason constants
+ * 
+ *   field - one of the SCANERR_FIELD constants
+ * 
+ *   pos - the byte position of the error
+ * 
+ *   value - the value of the field, or zero if there is none
+ */
+void scanerr_set(
+		SCANERR *pErr,
+		int reason,
+		int field,
+		int32_t pos,
+		int32_t value);
+
+/*
+ * Return the short code of a parse error reason, such as "month_end",
+ * which is a single word suitable for machine-readable output.
+ * 
+ * Parameters:
+ * 
+ *   reason - one of the SCANERR reason constants
+ * 
+ * Return:
+ * 
+ *   the null-terminated code of the reason
+ * 
+ * Faults:
+ * 
+ *   - If reason is not valid
+ */
+const char *scanerr_code(int reason);
+
+/*
+ * Write a short description of a parse error, such as "week 5 past end
+ * of month".
+ * 
+ * The description is null-terminated and never longer than
+ * SCANERR_DESCRIBE_MAX characters including the terminating null.
+ * 
+ * Parameters:
+ * 
+ *   pBuf - the buffer to write into
+ * 
+ *   pErr - the error to describe
+ * 
+ * Faults:
+ * 
+ *   - If pBuf or pErr is NULL
+ * 
+ *   - If the reason or field of the error is not valid
+ * 
+ * Undefined behavior:
+ * 
+ *   - If pBuf has room for fewer than SCANERR_DESCRIBE_MAX characters
+ */
+void scanerr_describe(char *pBuf, const SCANERR *pErr);
+
+#endif